@@ -63,6 +63,19 @@ static const int ddLogLevel = DDLogLevelWarning;
     return self;
 }
 
+- (void)start {
+    DDLogVerbose(@"%@ start", LOG_TAG);
+
+    // The action deadline is not watched while the executor waits for its admission.
+    [self.twinmeContext admitWithExecutor:self start:^{
+        if (!self.stopped) {
+            [super start];
+        }
+    } cancel:^{
+        [self fireErrorWithErrorCode:TLBaseServiceErrorCodeCanceledOperation];
+    }];
+}
+
 - (void)stop {
     DDLogVerbose(@"%@ stop", LOG_TAG);
     
@@ -71,6 +84,13 @@ static const int ddLogLevel = DDLogLevelWarning;
     [self onFinish];
 }
 
+- (void)onFinish {
+    DDLogVerbose(@"%@ onFinish", LOG_TAG);
+
+    [super onFinish];
+    [self.twinmeContext releaseWithExecutor:self];
+}
+
 - (int64_t)newOperation:(int)operationId {
     DDLogVerbose(@"%@ newOperation; %d", LOG_TAG, operationId);
     
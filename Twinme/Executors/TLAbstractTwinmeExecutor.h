@@ -58,6 +58,9 @@
 
 - (void)stop;
 
+/// Called instead of start when the executor is canceled while it waits to be admitted.
+- (void)onCancel;
+
 - (int64_t)newOperation:(int) operationId;
 
 - (int)getOperationWithRequestId:(int64_t)requestId;
@@ -98,7 +98,21 @@ TL_CREATE_ASSERT_POINT(PARAMETER, 2004)
 - (void)start {
     DDLogVerbose(@"%@ start", LOG_TAG);
     
-    [self.twinmeContext addDelegate:self];
+    // The executor may wait until other executors of the same class are stopped.
+    [self.twinmeContext admitWithExecutor:self start:^{
+        if (!self.stopped) {
+            [self.twinmeContext addDelegate:self];
+        }
+    } cancel:^{
+        self.stopped = YES;
+        [self onCancel];
+    }];
+}
+
+- (void)onCancel {
+    DDLogVerbose(@"%@ onCancel", LOG_TAG);
+
+    [self.twinmeContext fireOnErrorWithRequestId:self.requestId errorCode:TLBaseServiceErrorCodeCanceledOperation errorParameter:nil];
 }
 
 - (void)stop {
@@ -107,6 +121,7 @@ TL_CREATE_ASSERT_POINT(PARAMETER, 2004)
     self.stopped = YES;
 
     [self.twinmeContext removeDelegate:self];
+    [self.twinmeContext releaseWithExecutor:self];
 }
 
 - (int64_t)newOperation:(int)operationId {
@@ -16,6 +16,7 @@
 #import "TLTwinmeAttributes.h"
 #import "TLAbstractTwinmeExecutor.h"
 #import "TLCreateInvitationCodeExecutor.h"
+#import "TLInvitationCodeCache.h"
 #import "TLInvitation.h"
 
 #if 0
@@ -133,6 +134,9 @@ static const int UPDATE_INVITATION_DONE = 1 << 5;
             self.state |= CREATE_INVITATION_CODE_DONE;
             self.invitationCode = invitationCode;
             self.invitation.invitationCode = invitationCode;
+
+            // A lookup made before the code was created must not hide it.
+            [self.twinmeContext.invitationCodeCache invalidateWithCode:invitationCode.code];
             
             [self onOperation];
         }];
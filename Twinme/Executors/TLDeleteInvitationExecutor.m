@@ -19,6 +19,7 @@
 
 #import "TLDeleteInvitationExecutor.h"
 #import "TLInvitation.h"
+#import "TLInvitationCodeCache.h"
 #import "TLTwinmeContextImpl.h"
 #import "TLPairProtocol.h"
 
@@ -191,6 +192,12 @@ static const int DELETE_INVITATION_DESCRIPTOR_DONE = 1 << (TL_DELETE_OBJECT_LAST
 - (void)onFinishDeleteWithObject:(nonnull TLTwinmeObject *)object {
     DDLogVerbose(@"%@ onFinishDeleteWithObject: %@", LOG_TAG, object);
 
+    if (self.invitation.invitationCode) {
+        [self.twinmeContext.invitationCodeCache invalidateWithCode:self.invitation.invitationCode.code];
+    }
+    if (self.invitation.twincodeOutbound) {
+        [self.twinmeContext.invitationCodeCache invalidateWithTwincodeId:self.invitation.twincodeOutbound.uuid];
+    }
     [self.twinmeContext onDeleteInvitationWithRequestId:self.requestId invitationId:self.invitation.uuid];
 }
 
@@ -57,8 +57,12 @@
 
 - (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext requestId:(int64_t)requestId;
 
+/// Start the executor when it is admitted by the twinme context.
 - (void)start;
 
+/// Start the executor operations, called by start() when the executor is admitted.
+- (void)onStart;
+
 /// Execute the given block as soon as the executor has finished.
 - (void)execute:(nonnull void (^)(void))block;
 
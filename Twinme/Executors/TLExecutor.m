@@ -135,6 +135,18 @@ static const int ddLogLevel = DDLogLevelWarning;
 - (void)start {
     DDLogVerbose(@"%@ start", LOG_TAG);
     
+    [self.twinmeContext admitWithExecutor:self start:^{
+        if (!self.stopped) {
+            [self onStart];
+        }
+    } cancel:^{
+        [self onErrorWithOperationId:0 errorCode:TLBaseServiceErrorCodeCanceledOperation errorParameter:nil];
+    }];
+}
+
+- (void)onStart {
+    DDLogVerbose(@"%@ onStart", LOG_TAG);
+    
 }
 
 - (void)execute:(nonnull void (^)(void))block {
@@ -208,6 +220,7 @@ static const int ddLogLevel = DDLogLevelWarning;
 - (void)stop {
     DDLogVerbose(@"%@ stop", LOG_TAG);
 
+    [self.twinmeContext releaseWithExecutor:self];
     while (YES) {
         void (^block)(void);
 
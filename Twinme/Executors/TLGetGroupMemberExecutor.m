@@ -45,7 +45,7 @@ static const int GET_MEMBER_IMAGE_DONE = 1 << 3;
 
 @property (nonatomic, readonly) NSUUID *memberTwincodeOutboundId;
 @property (nonatomic, readonly) id<TLOriginator> owner;
-@property (nonatomic, readonly, nonnull) void (^onGetGroupMember) (TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember);
+@property (nonatomic, nullable) void (^onGetGroupMember) (TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember);
 
 @property (nonatomic) TLGroupMember *groupMember;
 @property (nonatomic) TLImageId *memberAvatarId;
@@ -58,6 +58,10 @@ static const int GET_MEMBER_IMAGE_DONE = 1 << 3;
 
 - (void)onErrorWithOperationId:(int)operationId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(NSString *)errorParameter;
 
+- (void)onCancel;
+
+- (nullable void (^)(TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember))takeBlock;
+
 @end
 
 //
@@ -140,7 +144,10 @@ static const int GET_MEMBER_IMAGE_DONE = 1 << 3;
     // Last Step
     //
 
-    [self.twinmeContext onGetGroupMemberWithErrorCode:TLBaseServiceErrorCodeSuccess groupMember:self.groupMember withBlock:self.onGetGroupMember];
+    void (^block)(TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember) = [self takeBlock];
+    if (block) {
+        [self.twinmeContext onGetGroupMemberWithErrorCode:TLBaseServiceErrorCodeSuccess groupMember:self.groupMember withBlock:block];
+    }
     [self stop];
 }
 
@@ -178,6 +185,35 @@ static const int GET_MEMBER_IMAGE_DONE = 1 << 3;
     }
 
     [super onErrorWithOperationId:operationId errorCode:errorCode errorParameter:errorParameter];
+
+    // The caller is waiting for the member (and other callers may be attached to the same lookup).
+    if (errorCode != TLBaseServiceErrorCodeTwinlifeOffline) {
+        void (^block)(TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember) = [self takeBlock];
+        if (block) {
+            block(errorCode, nil);
+        }
+    }
+}
+
+- (void)onCancel {
+    DDLogVerbose(@"%@ onCancel", LOG_TAG);
+
+    [super onCancel];
+
+    void (^block)(TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember) = [self takeBlock];
+    if (block) {
+        block(TLBaseServiceErrorCodeCanceledOperation, nil);
+    }
+}
+
+/// Get the result block so that it is called only once.
+- (nullable void (^)(TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember))takeBlock {
+
+    @synchronized (self) {
+        void (^block)(TLBaseServiceErrorCode errorCode, TLGroupMember *groupMember) = self.onGetGroupMember;
+        self.onGetGroupMember = nil;
+        return block;
+    }
 }
 
 @end
@@ -45,7 +45,7 @@ static const int GET_GROUP_MEMBER_DONE = 1 << 3;
 
 @property (nonatomic, readonly, nonnull) NSUUID *twincodeInboundId;
 @property (nonatomic, readonly, nonnull) NSUUID *memberTwincodeOutboundId;
-@property (nonatomic, readonly, nonnull) void (^onGetReceiver) (TLBaseServiceErrorCode errorCode, TLGroupMember *receiver);
+@property (nonatomic, nullable) void (^onGetReceiver) (TLBaseServiceErrorCode errorCode, TLGroupMember *receiver);
 
 @property (nonatomic) id<TLOriginator> owner;
 @property (nonatomic) TLGroupMember *groupMember;
@@ -58,6 +58,10 @@ static const int GET_GROUP_MEMBER_DONE = 1 << 3;
 
 - (void)onErrorWithOperationId:(int)operationId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(NSString *)errorParameter;
 
+- (void)onCancel;
+
+- (void)finishWithErrorCode:(TLBaseServiceErrorCode)errorCode receiver:(nullable TLGroupMember *)receiver;
+
 @end
 
 //
@@ -154,7 +158,7 @@ static const int GET_GROUP_MEMBER_DONE = 1 << 3;
         return;
     }
 
-    self.onGetReceiver(TLBaseServiceErrorCodeSuccess, self.groupMember);
+    [self finishWithErrorCode:TLBaseServiceErrorCodeSuccess receiver:self.groupMember];
 
     [self stop];
 }
@@ -183,9 +187,31 @@ static const int GET_GROUP_MEMBER_DONE = 1 << 3;
         return;
     }
 
-    self.onGetReceiver(errorCode, nil);
+    [self finishWithErrorCode:errorCode receiver:nil];
 
     [self stop];
 }
 
+- (void)onCancel {
+    DDLogVerbose(@"%@ onCancel", LOG_TAG);
+
+    [super onCancel];
+
+    [self finishWithErrorCode:TLBaseServiceErrorCodeCanceledOperation receiver:nil];
+}
+
+/// Give the result to the caller only once.
+- (void)finishWithErrorCode:(TLBaseServiceErrorCode)errorCode receiver:(nullable TLGroupMember *)receiver {
+    DDLogVerbose(@"%@ finishWithErrorCode: %d receiver: %@", LOG_TAG, errorCode, receiver);
+
+    void (^block)(TLBaseServiceErrorCode errorCode, TLGroupMember *receiver);
+    @synchronized (self) {
+        block = self.onGetReceiver;
+        self.onGetReceiver = nil;
+    }
+    if (block) {
+        block(errorCode, receiver);
+    }
+}
+
 @end
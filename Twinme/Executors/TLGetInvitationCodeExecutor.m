@@ -16,6 +16,7 @@
 #import "TLTwinmeAttributes.h"
 #import "TLAbstractTwinmeExecutor.h"
 #import "TLGetInvitationCodeExecutor.h"
+#import "TLInvitationCodeCache.h"
 
 #if 0
 static const int ddLogLevel = DDLogLevelVerbose;
@@ -95,19 +96,27 @@ static const int GET_INVITATION_CODE_DONE = 1 << 1;
     if ((self.state & GET_INVITATION_CODE) == 0) {
         self.state |= GET_INVITATION_CODE;
         
-        [self.twinmeContext.getTwincodeOutboundService getInvitationCodeWithCode:self.code withBlock:^(TLBaseServiceErrorCode errorCode, TLTwincodeOutbound * _Nullable twincodeOutbound, NSString * _Nullable publicKey) {
+        // The code is resolved by the server only if it is not cached and not being resolved by another executor.
+        TLInvitationCodeCache *invitationCodes = self.twinmeContext.invitationCodeCache;
+        TLInvitationCodeResolution *resolution = [invitationCodes resolveWithCode:self.code block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
             
-            if (errorCode != TLBaseServiceErrorCodeSuccess || !twincodeOutbound) {
+            if (errorCode != TLBaseServiceErrorCodeSuccess || !twincode) {
                 [self onErrorWithOperationId:GET_INVITATION_CODE errorCode:errorCode errorParameter:nil];
                 return;
             }
             
             self.state |= GET_INVITATION_CODE_DONE;
-            self.twincodeOutbound = twincodeOutbound;
+            self.twincodeOutbound = (TLTwincodeOutbound *)twincode;
             self.publicKey = publicKey;
             
             [self onOperation];
         }];
+        if (resolution) {
+            [self.twinmeContext.getTwincodeOutboundService getInvitationCodeWithCode:self.code withBlock:^(TLBaseServiceErrorCode errorCode, TLTwincodeOutbound * _Nullable twincodeOutbound, NSString * _Nullable publicKey) {
+                [invitationCodes completeWithResolution:resolution errorCode:errorCode twincode:twincodeOutbound twincodeId:twincodeOutbound.uuid publicKey:publicKey];
+            }];
+        }
+        return;
     }
     
     if ((self.state & GET_INVITATION_CODE_DONE) == 0) {
@@ -12,7 +12,6 @@
 
 #import <Twinlife/TLTwinlife.h>
 #import <Twinlife/TLManagementService.h>
-#import <Twinlife/TLBinaryDecoder.h>
 
 #import "TLGetPushNotificationContentExecutor.h"
 #import "TLTwinmeContextImpl.h"
@@ -22,6 +21,7 @@
 #import "TLGroupMember.h"
 #import "TLCallReceiver.h"
 #import "TLPushNotificationContent.h"
+#import "TLSliceDecoder.h"
 
 #if 0
 static const int ddLogLevel = DDLogLevelVerbose;
@@ -278,15 +278,17 @@ static const int GET_RECEIVER_DONE = 1 << 3;
         
         NSData *decryptedData = [[NSData alloc] initWithBytesNoCopy:buffer length:bufferSize];
         
-        TLBinaryDecoder *binaryDecoder = [[TLBinaryDecoder alloc] initWithData:decryptedData];
-        NSUUID *schemaId = nil;
+        TLSliceDecoder *sliceDecoder = [[TLSliceDecoder alloc] initWithData:decryptedData];
+        uuid_t schemaId, expectSchemaId;
         int schemaVersion = -1;
         @try {
-            schemaId = [binaryDecoder readUUID];
-            if ([TLPushNotificationContent.SCHEMA_ID isEqual:schemaId]) {
-                schemaVersion = [binaryDecoder readInt];
+            [sliceDecoder readUUIDWithBytes:schemaId];
+            [TLPushNotificationContent.SCHEMA_ID getUUIDBytes:expectSchemaId];
+            if (uuid_compare(schemaId, expectSchemaId) == 0) {
+                schemaVersion = [sliceDecoder readInt];
                 if (TLPushNotificationContent.SCHEMA_VERSION == schemaVersion) {
-                    self.notificationContent = (TLPushNotificationContent *)[TLPushNotificationContent.SERIALIZER deserializeWithSerializerFactory:[self.twinmeContext getSerializerFactory] decoder:binaryDecoder];
+                    id<TLSliceDeserializer> serializer = (id<TLSliceDeserializer>)TLPushNotificationContent.SERIALIZER;
+                    self.notificationContent = (TLPushNotificationContent *)[serializer deserializeWithSliceDecoder:sliceDecoder];
                 }
             }
         } @catch (NSException *ex) {
@@ -204,8 +204,8 @@ static const int UPDATE_PROFILE_DONE = 1 << 9;
     return self;
 }
 
-- (void)start {
-    DDLogVerbose(@"%@ start", LOG_TAG);
+- (void)onStart {
+    DDLogVerbose(@"%@ onStart", LOG_TAG);
     
     [self.twinmeContext addDelegate:self.twinmeContextDelegate];
 }
@@ -41,7 +41,7 @@ static const int ddLogLevel = DDLogLevelWarning;
 // Executor and delegates are running in the twinlife serial queue provided by the twinlife library
 // Executor and delegates are retained between start() and stop() calls
 //
-// version: 1.15
+// version: 1.16
 //
 
 static const int GET_TWINCODE_OUTBOUND = 1 << 2;
@@ -74,6 +74,8 @@ static const int GET_TWINCODE_OUTBOUND_DONE = 1 << 3;
 
 - (void)onGetTwincodeOutbound:(TLTwincodeOutbound *)twincodeOutbound errorCode:(TLBaseServiceErrorCode)errorCode;
 
+- (void)onCancel;
+
 @end
 
 //
@@ -274,4 +276,13 @@ static const int GET_TWINCODE_OUTBOUND_DONE = 1 << 3;
     [self onOperation];
 }
 
+- (void)onCancel {
+    DDLogVerbose(@"%@ onCancel", LOG_TAG);
+
+    [super onCancel];
+
+    // The executor was canceled while waiting for admission: the consumer must still release the replay slot.
+    self.consumer(TLBaseServiceErrorCodeCanceledOperation, nil);
+}
+
 @end
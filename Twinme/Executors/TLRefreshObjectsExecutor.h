@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import "TLAbstractTwinmeExecutor.h"
+
+//
+// Interface: TLRefreshObjectRequest
+//
+
+@class TLPairRefreshInvocation;
+@class TLSingleFlightKey;
+@protocol TLOriginator;
+
+/// A pair::refresh invocation received for the subject.
+@interface TLRefreshObjectRequest : NSObject
+
+@property (readonly, nonnull) TLPairRefreshInvocation *invocation;
+@property (readonly, nonnull) id<TLOriginator> subject;
+
+- (nonnull instancetype)initWithInvocation:(nonnull TLPairRefreshInvocation *)invocation subject:(nonnull id<TLOriginator>)subject;
+
+/// The key which groups the requests refreshing the same subject or group member in a batch.
+- (nonnull TLSingleFlightKey *)batchKey;
+
+@end
+
+//
+// Interface: TLRefreshObjectsExecutor
+//
+
+@class TLTwinmeContext;
+
+/**
+ * Refresh a batch of objects for the pair::refresh invocations grouped by the twinme context.
+ *
+ * The steps of TLRefreshObjectExecutor are made for the whole batch: the peer twincodes are refreshed
+ * through a pipeline, only the avatars which changed are fetched and the objects are then updated
+ * together.  Each list of requests concerns the same subject and twincode which is refreshed once.
+ */
+@interface TLRefreshObjectsExecutor : TLAbstractConnectedTwinmeExecutor
+
+- (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext requests:(nonnull NSArray<NSArray<TLRefreshObjectRequest *> *> *)requests;
+
+@end
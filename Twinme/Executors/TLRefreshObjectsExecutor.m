@@ -0,0 +1,451 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import <Twinlife/TLTwinlife.h>
+#import <Twinlife/TLRepositoryService.h>
+#import <Twinlife/TLTwincodeOutboundService.h>
+#import <Twinlife/TLImageService.h>
+#import <Twinlife/TLAttributeNameValue.h>
+
+#import "TLRefreshObjectsExecutor.h"
+#import "TLRefreshPipeline.h"
+#import "TLSingleFlight.h"
+#import "TLNotificationCenter.h"
+#import "TLTwinmeContextImpl.h"
+#import "TLPairProtocol.h"
+#import "TLPairRefreshInvocation.h"
+#import "TLContact.h"
+#import "TLGroup.h"
+#import "TLOriginator.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Executor and delegates are running in the twinlife serial queue provided by the twinlife library
+// Executor and delegates are retained between start() and stop() calls
+//
+// version: 1.1
+//
+
+static const int REFRESH_PEER_TWINCODES = 1;
+static const int REFRESH_PEER_TWINCODES_DONE = 1 << 1;
+static const int GET_PEER_IMAGES = 1 << 2;
+static const int GET_PEER_IMAGES_DONE = 1 << 3;
+static const int UPDATE_OBJECTS = 1 << 4;
+static const int UPDATE_OBJECTS_DONE = 1 << 5;
+
+#define REFRESH_WINDOW 8
+#define REFRESH_MAX_RETRY 2
+#define REFRESH_RETRY_DELAY 1.0
+
+//
+// Interface: TLRefreshObjectEntry
+//
+
+/// The refresh of one subject with the state that TLRefreshObjectExecutor keeps for it.
+@interface TLRefreshObjectEntry : NSObject
+
+@property (nonatomic, nonnull, readonly) id<TLOriginator> subject;
+@property (nonatomic, nonnull, readonly) NSMutableArray<NSUUID *> *invocationIds;
+@property (nonatomic, nullable, readonly) TLContact *contact;
+@property (nonatomic, nullable, readonly) TLGroup *group;
+@property (nonatomic, nullable, readonly) id<TLGroupMemberConversation> groupMember;
+@property (nonatomic, nullable, readonly) TLTwincodeOutbound *peerTwincodeOutbound;
+@property (nonatomic, nonnull, readonly) NSString *oldName;
+@property (nonatomic, nullable, readonly) TLImageId *oldAvatarId;
+@property (nonatomic, nullable) TLImageId *avatarId;
+@property (nonatomic, nullable) NSMutableArray<TLAttributeNameValue *> *previousAttributes;
+@property (nonatomic) TLBaseServiceErrorCode errorCode;
+@property (nonatomic) BOOL needUpdate;
+
+- (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext requests:(nonnull NSArray<TLRefreshObjectRequest *> *)requests;
+
+@end
+
+//
+// Interface: TLRefreshObjectsExecutor ()
+//
+
+@interface TLRefreshObjectsExecutor ()
+
+@property (nonatomic, nonnull, readonly) NSArray<TLRefreshObjectEntry *> *entries;
+@property (nonatomic, nullable) TLRefreshPipeline *refreshPipeline;
+@property (nonatomic) int pendingImageCount;
+@property (nonatomic) int pendingUpdateCount;
+
+- (void)onRefreshTwincodeOutbound:(nonnull TLRefreshObjectEntry *)entry previousAttributes:(nullable NSMutableArray<TLAttributeNameValue *> *)previousAttributes errorCode:(TLBaseServiceErrorCode)errorCode;
+
+- (void)onGetImage;
+
+- (void)onUpdateObject:(nullable id<TLRepositoryObject>)object entry:(nonnull TLRefreshObjectEntry *)entry errorCode:(TLBaseServiceErrorCode)errorCode;
+
+- (void)onTwinlifeOnline;
+
+- (void)onOperation;
+
+@end
+
+//
+// Implementation: TLRefreshObjectRequest
+//
+
+@implementation TLRefreshObjectRequest
+
+- (nonnull instancetype)initWithInvocation:(nonnull TLPairRefreshInvocation *)invocation subject:(nonnull id<TLOriginator>)subject {
+
+    self = [super init];
+    if (self) {
+        _invocation = invocation;
+        _subject = subject;
+    }
+    return self;
+}
+
+- (nonnull TLSingleFlightKey *)batchKey {
+
+    // The subject's own peer twincode refreshes the subject as an invocation without twincode:
+    // only a group member twincode needs its own entry.
+    NSUUID *peerTwincodeId = [TLAttributeNameUUIDValue getUUIDAttributeWithName:PAIR_PROTOCOL_PARAM_TWINCODE_OUTBOUND_ID list:self.invocation.invocationAttributes];
+    if (!peerTwincodeId || [peerTwincodeId isEqual:self.subject.peerTwincodeOutbound.uuid]) {
+        peerTwincodeId = self.subject.uuid;
+    }
+    return [[TLSingleFlightKey alloc] initWithFirst:self.subject.uuid second:peerTwincodeId];
+}
+
+@end
+
+//
+// Implementation: TLRefreshObjectEntry
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLRefreshObjectEntry"
+
+@implementation TLRefreshObjectEntry
+
+- (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext requests:(nonnull NSArray<TLRefreshObjectRequest *> *)requests {
+    DDLogVerbose(@"%@ initWithTwinmeContext: %@ requests: %@", LOG_TAG, twinmeContext, requests);
+
+    self = [super init];
+    if (self) {
+        TLRefreshObjectRequest *request = requests.firstObject;
+        id<TLOriginator> subject = request.subject;
+        _subject = subject;
+        _invocationIds = [[NSMutableArray alloc] initWithCapacity:requests.count];
+        for (TLRefreshObjectRequest *item in requests) {
+            [_invocationIds addObject:item.invocation.uuid];
+        }
+
+        // Same resolution of the peer twincode as TLRefreshObjectExecutor.
+        TLTwincodeOutbound *peerTwincodeOutbound = subject.peerTwincodeOutbound;
+        id<TLGroupMemberConversation> groupMember = nil;
+        if ([subject isKindOfClass:[TLContact class]]) {
+            _contact = (TLContact *)subject;
+
+        } else if ([subject isKindOfClass:[TLGroup class]]) {
+            _group = (TLGroup *)subject;
+            NSUUID *peerTwincodeId = [TLAttributeNameUUIDValue getUUIDAttributeWithName:PAIR_PROTOCOL_PARAM_TWINCODE_OUTBOUND_ID list:request.invocation.invocationAttributes];
+            if (peerTwincodeId && peerTwincodeOutbound && ![peerTwincodeId isEqual:peerTwincodeOutbound.uuid]) {
+                groupMember = [[twinmeContext getConversationService] getGroupMemberConversationWithGroupTwincodeId:peerTwincodeOutbound.uuid memberTwincodeId:peerTwincodeId];
+                if (groupMember) {
+                    peerTwincodeOutbound = [groupMember peerTwincodeOutbound];
+                }
+            }
+        }
+
+        _peerTwincodeOutbound = peerTwincodeOutbound;
+        _groupMember = groupMember;
+        _oldName = peerTwincodeOutbound ? [peerTwincodeOutbound name] : @"";
+        _oldAvatarId = peerTwincodeOutbound ? [peerTwincodeOutbound avatarId] : nil;
+        _errorCode = TLBaseServiceErrorCodeSuccess;
+        _needUpdate = YES;
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLRefreshObjectsExecutor
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLRefreshObjectsExecutor"
+
+@implementation TLRefreshObjectsExecutor
+
+- (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext requests:(nonnull NSArray<NSArray<TLRefreshObjectRequest *> *> *)requests {
+    DDLogVerbose(@"%@ initWithTwinmeContext: %@ requests: %lu", LOG_TAG, twinmeContext, (unsigned long)requests.count);
+
+    self = [super initWithTwinmeContext:twinmeContext requestId:[TLBaseService DEFAULT_REQUEST_ID]];
+    if (self) {
+        NSMutableArray<TLRefreshObjectEntry *> *entries = [[NSMutableArray alloc] initWithCapacity:requests.count];
+        for (NSArray<TLRefreshObjectRequest *> *list in requests) {
+            if (list.count > 0) {
+                [entries addObject:[[TLRefreshObjectEntry alloc] initWithTwinmeContext:twinmeContext requests:list]];
+            }
+        }
+        _entries = entries;
+        _pendingImageCount = 0;
+        _pendingUpdateCount = 0;
+    }
+    return self;
+}
+
+#pragma mark - Private methods
+
+- (void)onTwinlifeOnline {
+    DDLogVerbose(@"%@ onTwinlifeOnline", LOG_TAG);
+
+    // Refresh the twincodes parked by the pipeline while we were offline.
+    [self.refreshPipeline resume];
+    [super onTwinlifeOnline];
+}
+
+- (void)onOperation {
+    DDLogVerbose(@"%@ onOperation", LOG_TAG);
+
+    if (self.stopped) {
+        return;
+    }
+
+    //
+    // Step 1: refresh the peer twincodes, a twincode shared by several entries is refreshed once.
+    //
+    if ((self.state & REFRESH_PEER_TWINCODES) == 0) {
+        self.state |= REFRESH_PEER_TWINCODES;
+
+        NSMutableDictionary<NSUUID *, NSMutableArray<TLRefreshObjectEntry *> *> *twincodeEntries = [[NSMutableDictionary alloc] init];
+        TLTwincodeOutboundService *twincodeOutboundService = [self.twinmeContext getTwincodeOutboundService];
+        self.refreshPipeline = [[TLRefreshPipeline alloc] initWithQueue:[self.twinmeContext.twinlife twinlifeQueue] window:REFRESH_WINDOW maxRetry:REFRESH_MAX_RETRY retryDelay:REFRESH_RETRY_DELAY invoke:^(id item, void (^complete)(TLBaseServiceErrorCode errorCode)) {
+            TLTwincodeOutbound *twincodeOutbound = (TLTwincodeOutbound *)item;
+            [twincodeOutboundService refreshTwincodeWithTwincode:twincodeOutbound withBlock:^(TLBaseServiceErrorCode errorCode, NSMutableArray<TLAttributeNameValue *> *previousAttributes) {
+                for (TLRefreshObjectEntry *entry in twincodeEntries[twincodeOutbound.uuid]) {
+                    [self onRefreshTwincodeOutbound:entry previousAttributes:previousAttributes errorCode:errorCode];
+                }
+                complete(errorCode);
+            }];
+        }];
+        for (TLRefreshObjectEntry *entry in self.entries) {
+            TLTwincodeOutbound *peerTwincodeOutbound = entry.peerTwincodeOutbound;
+            if (!peerTwincodeOutbound) {
+                continue;
+            }
+            NSMutableArray<TLRefreshObjectEntry *> *list = twincodeEntries[peerTwincodeOutbound.uuid];
+            if (!list) {
+                list = [[NSMutableArray alloc] init];
+                twincodeEntries[peerTwincodeOutbound.uuid] = list;
+            }
+            [list addObject:entry];
+            [self.refreshPipeline addWithKey:peerTwincodeOutbound.uuid item:peerTwincodeOutbound];
+        }
+
+        DDLogVerbose(@"%@ refresh %lu twincodes for %lu objects", LOG_TAG, (unsigned long)twincodeEntries.count, (unsigned long)self.entries.count);
+        [self.refreshPipeline startWithCompletion:^(int failedCount) {
+            self.refreshPipeline = nil;
+            self.state |= REFRESH_PEER_TWINCODES_DONE;
+            [self onOperation];
+        }];
+        return;
+    }
+    if ((self.state & REFRESH_PEER_TWINCODES_DONE) == 0) {
+        return;
+    }
+
+    //
+    // Step 2: get the peer thumbnail images which changed so that we have them in our local cache.
+    //
+    if ((self.state & GET_PEER_IMAGES) == 0) {
+        self.state |= GET_PEER_IMAGES;
+
+        TLImageService *imageService = [self.twinmeContext getImageService];
+        NSMutableSet<TLImageId *> *imageIds = [[NSMutableSet alloc] init];
+        NSMutableArray<TLImageId *> *oldImageIds = [[NSMutableArray alloc] init];
+        for (TLRefreshObjectEntry *entry in self.entries) {
+            if (entry.avatarId) {
+                [imageIds addObject:entry.avatarId];
+                if (entry.oldAvatarId) {
+                    [oldImageIds addObject:entry.oldAvatarId];
+                }
+            }
+        }
+
+        self.pendingImageCount = (int)imageIds.count;
+        for (TLImageId *imageId in imageIds) {
+            [imageService getImageWithImageId:imageId kind:TLImageServiceKindThumbnail withBlock:^(TLBaseServiceErrorCode errorCode, UIImage *image) {
+                [self onGetImage];
+            }];
+        }
+
+        // Delete the old avatar ids (this is a local delete, ignore the result).
+        for (TLImageId *imageId in oldImageIds) {
+            [imageService deleteImageWithImageId:imageId withBlock:^(TLBaseServiceErrorCode errorCode, TLImageId *imageId) {}];
+        }
+        if (self.pendingImageCount > 0) {
+            return;
+        }
+        self.state |= GET_PEER_IMAGES_DONE;
+    }
+    if ((self.state & GET_PEER_IMAGES_DONE) == 0) {
+        return;
+    }
+
+    //
+    // Step 3: update the objects whose peer's name was changed and was not modified locally.
+    //
+    if ((self.state & UPDATE_OBJECTS) == 0) {
+        self.state |= UPDATE_OBJECTS;
+
+        // Send all the updates from the same block: the repository service handles them one after the other.
+        TLRepositoryService *repositoryService = [self.twinmeContext getRepositoryService];
+        NSMutableArray<TLRefreshObjectEntry *> *updateList = [[NSMutableArray alloc] init];
+        for (TLRefreshObjectEntry *entry in self.entries) {
+            if (entry.needUpdate && entry.errorCode == TLBaseServiceErrorCodeSuccess) {
+                [updateList addObject:entry];
+            }
+        }
+        self.pendingUpdateCount = (int)updateList.count;
+        for (TLRefreshObjectEntry *entry in updateList) {
+            DDLogVerbose(@"%@ updateObjectWithObject: %@", LOG_TAG, entry.subject);
+            [repositoryService updateObjectWithObject:entry.subject localOnly:NO withBlock:^(TLBaseServiceErrorCode errorCode, id<TLRepositoryObject> object) {
+                [self onUpdateObject:object entry:entry errorCode:errorCode];
+            }];
+        }
+        if (self.pendingUpdateCount > 0) {
+            return;
+        }
+        self.state |= UPDATE_OBJECTS_DONE;
+    }
+    if ((self.state & UPDATE_OBJECTS_DONE) == 0) {
+        return;
+    }
+
+    //
+    // Last Step
+    //
+    for (TLRefreshObjectEntry *entry in self.entries) {
+        if (entry.errorCode == TLBaseServiceErrorCodeItemNotFound) {
+            // The peer twincode does not exist anymore, proceed with an unbind: this contact is dead now.
+            if (entry.contact) {
+                [self.twinmeContext unbindContactWithRequestId:self.requestId invocationId:entry.invocationIds.firstObject contact:entry.contact];
+                [entry.invocationIds removeObjectAtIndex:0];
+            }
+            continue;
+        }
+        if (entry.errorCode != TLBaseServiceErrorCodeSuccess) {
+            continue;
+        }
+
+        // Post a notification when the subject's attributes was changed (except if it was a group member).
+        if ([self.twinmeContext isVisible:entry.subject] && entry.previousAttributes && !entry.groupMember) {
+            [self.twinmeContext.notificationCenter onUpdateContactWithContact:entry.subject updatedAttributes:entry.previousAttributes];
+        }
+
+        if (entry.contact) {
+            if (!entry.contact.checkInvariants) {
+                [self.twinmeContext assertionWithAssertPoint:[TLExecutorAssertPoint CONTACT_INVARIANT], [TLAssertValue initWithSubject:entry.contact], [TLAssertValue initWithInvocationId:entry.invocationIds.firstObject], nil];
+            }
+
+            // Trigger the onUpdateContact to give a chance to take into account the name update.
+            [self.twinmeContext onUpdateContactWithRequestId:self.requestId contact:entry.contact];
+
+        } else if (entry.group && !entry.groupMember) {
+            // Trigger the onUpdateGroup to give a chance to take into account the name update.
+            [self.twinmeContext onUpdateGroupWithRequestId:self.requestId group:entry.group];
+        }
+    }
+    [self stop];
+}
+
+- (void)onRefreshTwincodeOutbound:(nonnull TLRefreshObjectEntry *)entry previousAttributes:(nullable NSMutableArray<TLAttributeNameValue *> *)previousAttributes errorCode:(TLBaseServiceErrorCode)errorCode {
+    DDLogVerbose(@"%@ onRefreshTwincodeOutbound: %@ previousAttributes: %@ errorCode: %d", LOG_TAG, entry.subject, previousAttributes, errorCode);
+
+    if (errorCode == TLBaseServiceErrorCodeSuccess && previousAttributes == nil) {
+        errorCode = TLBaseServiceErrorCodeBadRequest;
+    }
+
+    // Keep the last error: a failed attempt can be retried by the pipeline.
+    entry.errorCode = errorCode;
+    if (errorCode != TLBaseServiceErrorCodeSuccess) {
+        return;
+    }
+
+    //
+    // Invariant: Subject <<->> PeerTwincodeOutbound
+    //
+    entry.previousAttributes = previousAttributes;
+    [entry.subject setPeerTwincodeOutbound:entry.peerTwincodeOutbound];
+
+    // Check if we have a new avatarId for this subject.
+    if (!entry.oldAvatarId || ![entry.oldAvatarId isEqual:entry.subject.avatarId]) {
+        entry.avatarId = entry.subject.avatarId;
+    }
+
+    // Update the contact's name if it was not modified locally, likewise for the group name if it was the
+    // group twincode and if it was a group member, no need to update the object.
+    if (entry.contact) {
+        entry.needUpdate = [entry.contact updatePeerName:entry.peerTwincodeOutbound oldName:entry.oldName];
+    } else if (entry.groupMember) {
+        entry.needUpdate = NO;
+    } else if (entry.group) {
+        entry.needUpdate = [entry.group updatePeerName:entry.peerTwincodeOutbound oldName:entry.oldName];
+    }
+}
+
+- (void)onGetImage {
+    DDLogVerbose(@"%@ onGetImage", LOG_TAG);
+
+    self.pendingImageCount--;
+    if (self.pendingImageCount > 0) {
+        return;
+    }
+    self.state |= GET_PEER_IMAGES_DONE;
+    [self onOperation];
+}
+
+- (void)onUpdateObject:(nullable id<TLRepositoryObject>)object entry:(nonnull TLRefreshObjectEntry *)entry errorCode:(TLBaseServiceErrorCode)errorCode {
+    DDLogVerbose(@"%@ onUpdateObject: %@ errorCode: %d", LOG_TAG, object, errorCode);
+
+    if (errorCode != TLBaseServiceErrorCodeSuccess || object == nil) {
+        DDLogWarn(@"%@ update of %@ failed: %d", LOG_TAG, entry.subject, errorCode);
+        entry.errorCode = errorCode == TLBaseServiceErrorCodeTwinlifeOffline ? errorCode : TLBaseServiceErrorCodeBadRequest;
+    }
+
+    self.pendingUpdateCount--;
+    if (self.pendingUpdateCount > 0) {
+        return;
+    }
+    self.state |= UPDATE_OBJECTS_DONE;
+    [self onOperation];
+}
+
+- (void)stop {
+    DDLogVerbose(@"%@ stop", LOG_TAG);
+
+    // The invocations of an object that we failed to update because we are offline are kept to be replayed
+    // (the twincodes that could not be refreshed while offline are parked by the pipeline until we are online).
+    for (TLRefreshObjectEntry *entry in self.entries) {
+        if (entry.errorCode == TLBaseServiceErrorCodeTwinlifeOffline) {
+            continue;
+        }
+        for (NSUUID *invocationId in entry.invocationIds) {
+            [self.twinmeContext acknowledgeInvocationWithInvocationId:invocationId errorCode:TLBaseServiceErrorCodeSuccess];
+        }
+        [entry.invocationIds removeAllObjects];
+    }
+
+    [super stop];
+}
+
+@end
@@ -17,8 +17,18 @@
 
 @interface TLLocationReport : NSObject
 
+/// Record the last known location, it is saved after a short delay by a background writer.
 + (void)recordGeolocationWithDescriptor:(nonnull TLGeolocationDescriptor *)descriptor;
 
+/// Record the last known location from its coordinates.
++ (void)recordWithTimestamp:(int64_t)timestamp longitude:(double)longitude latitude:(double)latitude altitude:(double)altitude;
+
+/// Save the last known location now if it was not saved yet and return YES when it was written.
++ (BOOL)flush;
+
+/// Use another file to save the last known location (nil for the default file): the location kept in memory is forgotten.
++ (void)setPath:(nullable NSString *)path;
+
 + (nullable NSString *)report;
 
 @end
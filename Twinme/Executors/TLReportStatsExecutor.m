@@ -7,6 +7,8 @@
  */
 
 #import <CocoaLumberjack.h>
+#import <fcntl.h>
+#import <unistd.h>
 
 #import <Twinlife/TLTwinlife.h>
 #import <Twinlife/TLRepositoryService.h>
@@ -60,6 +62,40 @@ static const int REPORT_SEND_DONE = 1 << 6;
 #define LATITUDE_PREFERENCE @"latitude"
 #define ALTITUDE_PREFERENCE @"altitude"
 
+// The last known location is appended to a small file as fixed size records, the last valid record wins.
+#define LOCATION_FILE_NAME @"locationReport.dat"
+#define LOCATION_RECORD_MAGIC 0x4c4f4331 // "LOC1"
+#define LOCATION_MAX_RECORDS 64
+#define LOCATION_FLUSH_DELAY (30 * NSEC_PER_SEC)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t checksum;
+    int64_t timestamp;
+    double longitude;
+    double latitude;
+    double altitude;
+} TLLocationRecord;
+
+// The last known location, protected by @synchronized on the TLLocationReport class.
+static TLLocationRecord lastLocation;
+static BOOL hasLastLocation = NO;
+static BOOL flushScheduled = NO;
+static BOOL loaded = NO;
+static NSString *locationPath = nil;
+
+static uint32_t locationChecksum(const TLLocationRecord *record) {
+
+    // FNV-1a over the record content after the magic and checksum.
+    const uint8_t *p = (const uint8_t *)&record->timestamp;
+    const uint8_t *end = (const uint8_t *)record + sizeof(TLLocationRecord);
+    uint32_t hash = 2166136261U;
+    while (p < end) {
+        hash = (hash ^ *p++) * 16777619U;
+    }
+    return hash;
+}
+
 //
 // Implementation: TLLocationReport
 //
@@ -69,45 +105,226 @@ static const int REPORT_SEND_DONE = 1 << 6;
 
 @implementation TLLocationReport
 
++ (nonnull dispatch_queue_t)writerQueue {
+
+    static dispatch_queue_t writerQueue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        writerQueue = dispatch_queue_create("locationReportQueue", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+    });
+    return writerQueue;
+}
+
++ (nullable NSString *)path {
+
+    @synchronized (self) {
+        if (!locationPath) {
+            NSArray<NSString *> *paths = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
+            if (paths.count > 0) {
+                [[NSFileManager defaultManager] createDirectoryAtPath:paths[0] withIntermediateDirectories:YES attributes:nil error:nil];
+                locationPath = [paths[0] stringByAppendingPathComponent:LOCATION_FILE_NAME];
+            }
+        }
+        return locationPath;
+    }
+}
+
++ (void)setPath:(nullable NSString *)path {
+    DDLogVerbose(@"%@ setPath: %@", LOG_TAG, path);
+
+    // Wait for a pending write on the previous file.
+    dispatch_sync([self writerQueue], ^{
+    });
+    @synchronized (self) {
+        locationPath = path;
+        hasLastLocation = NO;
+        flushScheduled = NO;
+        loaded = NO;
+    }
+}
+
 + (void)recordGeolocationWithDescriptor:(nonnull TLGeolocationDescriptor *)descriptor {
 
-    if ([TLTwinmeContext ENABLE_REPORT_LOCATION]) {
-        NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
-        [userDefaults setObject:[[NSNumber alloc] initWithLongLong:descriptor.createdTimestamp] forKey:LOCATION_TIMESTAMP_PREFERENCE];
-        [userDefaults setObject:[[NSNumber alloc] initWithDouble:descriptor.longitude] forKey:LONGITUDE_PREFERENCE];
-        [userDefaults setObject:[[NSNumber alloc] initWithDouble:descriptor.latitude] forKey:LATITUDE_PREFERENCE];
-        [userDefaults setObject:[[NSNumber alloc] initWithDouble:descriptor.altitude] forKey:ALTITUDE_PREFERENCE];
-        [userDefaults synchronize];
+    if (![TLTwinmeContext ENABLE_REPORT_LOCATION]) {
+        return;
     }
+
+    [self recordWithTimestamp:descriptor.createdTimestamp longitude:descriptor.longitude latitude:descriptor.latitude altitude:descriptor.altitude];
 }
 
-+ (nullable NSString *)report {
++ (void)recordWithTimestamp:(int64_t)timestamp longitude:(double)longitude latitude:(double)latitude altitude:(double)altitude {
+    DDLogVerbose(@"%@ recordWithTimestamp: %lld", LOG_TAG, timestamp);
+
+    // Keep the location in memory, it is written by the writer queue after a delay so that
+    // live location sharing produces at most one small append every LOCATION_FLUSH_DELAY.
+    BOOL schedule;
+    @synchronized (self) {
+        lastLocation.magic = LOCATION_RECORD_MAGIC;
+        lastLocation.timestamp = timestamp;
+        lastLocation.longitude = longitude;
+        lastLocation.latitude = latitude;
+        lastLocation.altitude = altitude;
+        lastLocation.checksum = locationChecksum(&lastLocation);
+        hasLastLocation = YES;
+        loaded = YES;
+        schedule = !flushScheduled;
+        flushScheduled = YES;
+    }
+    if (schedule) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, LOCATION_FLUSH_DELAY), [self writerQueue], ^{
+            [self writeLocation];
+        });
+    }
+}
+
++ (BOOL)flush {
+    DDLogVerbose(@"%@ flush", LOG_TAG);
+
+    __block BOOL saved;
+    dispatch_sync([self writerQueue], ^{
+        saved = [self writeLocation];
+    });
+    return saved;
+}
+
++ (BOOL)writeLocation {
+    DDLogVerbose(@"%@ writeLocation", LOG_TAG);
+
+    TLLocationRecord record;
+    @synchronized (self) {
+        if (!flushScheduled) {
+            return NO;
+        }
+        flushScheduled = NO;
+        record = lastLocation;
+    }
+
+    NSString *path = [self path];
+    if (!path) {
+        return NO;
+    }
+
+    // Append the record: a kill during the write leaves a partial record at the end which is ignored by the reader.
+    // When the file is full or ends with a partial record, write a new file with only the last record and rename
+    // it over the old one.
+    int fd = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd < 0) {
+        DDLogError(@"%@ cannot open %@: %d", LOG_TAG, path, errno);
+        return NO;
+    }
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size >= 0 && (size_t)size < LOCATION_MAX_RECORDS * sizeof(record) && (size_t)size % sizeof(record) == 0) {
+        BOOL saved = write(fd, &record, sizeof(record)) == sizeof(record);
+        if (!saved) {
+            DDLogError(@"%@ cannot write %@: %d", LOG_TAG, path, errno);
+        }
+        close(fd);
+        return saved;
+    }
+    close(fd);
+
+    NSData *content = [[NSData alloc] initWithBytes:&record length:sizeof(record)];
+    if (![content writeToFile:path atomically:YES]) {
+        DDLogError(@"%@ cannot compact %@", LOG_TAG, path);
+        return NO;
+    }
+    return YES;
+}
+
++ (BOOL)readLocation:(nonnull TLLocationRecord *)record {
+    DDLogVerbose(@"%@ readLocation", LOG_TAG);
+
+    NSString *path = [self path];
+    NSData *content = path ? [NSData dataWithContentsOfFile:path] : nil;
+    if (!content) {
+        return NO;
+    }
+
+    // Look for the last complete and valid record.
+    const uint8_t *bytes = content.bytes;
+    for (NSUInteger count = content.length / sizeof(TLLocationRecord); count > 0; count--) {
+        memcpy(record, bytes + (count - 1) * sizeof(TLLocationRecord), sizeof(TLLocationRecord));
+        if (record->magic == LOCATION_RECORD_MAGIC && record->checksum == locationChecksum(record)) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
++ (BOOL)readPreferences:(nonnull TLLocationRecord *)record {
+    DDLogVerbose(@"%@ readPreferences", LOG_TAG);
+
+    // Location recorded by a previous version in the user defaults.
     NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+    id timestamp = [userDefaults objectForKey:LOCATION_TIMESTAMP_PREFERENCE];
+    id longitude = [userDefaults objectForKey:LONGITUDE_PREFERENCE];
+    id latitude = [userDefaults objectForKey:LATITUDE_PREFERENCE];
+    id altitude = [userDefaults objectForKey:ALTITUDE_PREFERENCE];
+    if (!timestamp || !longitude || !latitude || !altitude) {
+        return NO;
+    }
 
-    id object = [userDefaults objectForKey:LOCATION_TIMESTAMP_PREFERENCE];
-    if (!object) {
-        return nil;
+    record->magic = LOCATION_RECORD_MAGIC;
+    record->timestamp = [timestamp longLongValue];
+    record->longitude = [longitude doubleValue];
+    record->latitude = [latitude doubleValue];
+    record->altitude = [altitude doubleValue];
+    record->checksum = locationChecksum(record);
+    return YES;
+}
+
++ (void)loadLocation {
+    DDLogVerbose(@"%@ loadLocation", LOG_TAG);
+
+    TLLocationRecord record;
+    BOOL found = [self readLocation:&record];
+    BOOL migrate = NO;
+    if (!found) {
+        found = [self readPreferences:&record];
+        migrate = found;
     }
-    NSMutableString *locationReport = [NSMutableString stringWithCapacity:1024];
-    [locationReport appendFormat:@"%lld:", [object longLongValue]];
-    object = [userDefaults objectForKey:LONGITUDE_PREFERENCE];
-    if (!object) {
-        return nil;
+
+    @synchronized (self) {
+        // A new location was recorded while we were reading.
+        if (loaded) {
+            return;
+        }
+        loaded = YES;
+        hasLastLocation = found;
+        if (found) {
+            lastLocation = record;
+        }
+        flushScheduled = migrate;
     }
-    [locationReport appendFormat:@"%f:", [object doubleValue]];
 
-    object = [userDefaults objectForKey:LATITUDE_PREFERENCE];
-    if (!object) {
-        return nil;
+    // Move the location of the previous version to the file and forget it once it is saved.
+    if (migrate && [self flush]) {
+        NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+        [userDefaults removeObjectForKey:LOCATION_TIMESTAMP_PREFERENCE];
+        [userDefaults removeObjectForKey:LONGITUDE_PREFERENCE];
+        [userDefaults removeObjectForKey:LATITUDE_PREFERENCE];
+        [userDefaults removeObjectForKey:ALTITUDE_PREFERENCE];
     }
-    [locationReport appendFormat:@"%f:", [object doubleValue]];
+}
+
++ (nullable NSString *)report {
 
-    object = [userDefaults objectForKey:ALTITUDE_PREFERENCE];
-    if (!object) {
-        return nil;
+    BOOL load;
+    @synchronized (self) {
+        load = !loaded;
+    }
+    if (load) {
+        [self loadLocation];
+    }
+
+    TLLocationRecord record;
+    @synchronized (self) {
+        if (!hasLastLocation) {
+            return nil;
+        }
+        record = lastLocation;
     }
-    [locationReport appendFormat:@"%f", [object doubleValue]];
-    return locationReport;
+    return [NSString stringWithFormat:@"%lld:%f:%f:%f", record.timestamp, record.longitude, record.latitude, record.altitude];
 }
 
 @end
@@ -22,6 +22,7 @@
 #import "TLSpace.h"
 #import "TLGroup.h"
 #import "TLCapabilities.h"
+#import "TLRefreshPipeline.h"
 
 #if 0
 static const int ddLogLevel = DDLogLevelVerbose;
@@ -33,9 +34,15 @@ static const int ddLogLevel = DDLogLevelWarning;
 // Executor and delegates are running in the SingleThreadExecutor provided by the twinlife library
 // Executor and delegates are reachable (not eligible for garbage collection) between start() and stop() calls
 //
-// version: 1.6
+// version: 1.7
 //
 
+// Refresh at most 8 members at the same time and retry a failed member 3 times after 1s, 2s, 4s,
+// a member that failed because we are offline waits for the next onTwinlifeOnline.
+#define REFRESH_WINDOW 8
+#define REFRESH_MAX_RETRY 3
+#define REFRESH_RETRY_DELAY 1.0
+
 static const int CREATE_GROUP_IMAGE = 1;
 static const int CREATE_GROUP_IMAGE_DONE = 1 << 1;
 static const int CREATE_MEMBER_IMAGE = 1 << 2;
@@ -84,7 +91,8 @@ static const int INVOKE_TWINCODE_OUTBOUND_DONE = 1 << 17;
 
 @property (nonatomic, nullable) TLExportedImageId *groupAvatarId;
 @property (nonatomic, nullable) TLExportedImageId *memberAvatarId;
-@property (nonatomic, nullable) NSMutableArray<TLTwincodeOutbound *> *refreshMembers;
+@property (nonatomic, nullable) TLRefreshPipeline *refreshMembers;
+@property (nonatomic) BOOL groupUpdated;
 @property (nonatomic, nullable) NSMutableArray<TLAttributeNameValue *> *refreshAttributes;
 
 - (void)onTwinlifeOnline;
@@ -264,10 +272,10 @@ static const int INVOKE_TWINCODE_OUTBOUND_DONE = 1 << 17;
         if ((self.state & DELETE_OLD_MEMBER_IMAGE) != 0 && (self.state & DELETE_OLD_MEMBER_IMAGE_DONE) == 0) {
             self.state &= ~DELETE_OLD_MEMBER_IMAGE;
         }
-        if ((self.state & INVOKE_TWINCODE_OUTBOUND) != 0 && (self.state & INVOKE_TWINCODE_OUTBOUND_DONE) == 0) {
-            self.state &= ~INVOKE_TWINCODE_OUTBOUND;
-        }
     }
+    
+    // The members that we failed to refresh while offline are invoked again.
+    [self.refreshMembers resume];
     [super onTwinlifeOnline];
 }
 
@@ -416,16 +424,20 @@ static const int INVOKE_TWINCODE_OUTBOUND_DONE = 1 << 17;
     }
 
     //
-    // Invoke the group members to notify them about the change.
+    // Invoke the group members to notify them about the change: the invocations are pipelined
+    // and retried by the TLRefreshPipeline, the group update is reported without waiting for them.
     //
-    if (self.refreshMembers && self.refreshAttributes && self.memberTwincodeOutbound && self.refreshMembers.count > 0) {
+    if (self.refreshMembers && self.refreshAttributes && self.memberTwincodeOutbound && ((self.state & INVOKE_TWINCODE_OUTBOUND) != 0 || self.refreshMembers.pendingCount > 0)) {
         if ((self.state & INVOKE_TWINCODE_OUTBOUND) == 0) {
             self.state |= INVOKE_TWINCODE_OUTBOUND;
             
-            TLTwincodeOutbound *peerTwincode = self.refreshMembers[0];
-            [[self.twinmeContext getTwincodeOutboundService] secureInvokeTwincodeWithTwincode:self.memberTwincodeOutbound senderTwincode:self.memberTwincodeOutbound receiverTwincode:peerTwincode options:TLInvokeTwincodeWakeup action:[TLPairProtocol ACTION_PAIR_REFRESH] attributes:self.refreshAttributes withBlock:^(TLBaseServiceErrorCode errorCode, NSUUID *invocationId) {
-                [self onInvokeTwincode:invocationId errorCode:errorCode];
+            [self.refreshMembers startWithCompletion:^(int failedCount) {
+                [self onInvokeTwincodeWithFailedCount:failedCount];
             }];
+            if (self.space == self.oldSpace) {
+                self.groupUpdated = YES;
+                [self.twinmeContext onUpdateGroupWithRequestId:self.requestId group:self.group];
+            }
             return;
         }
 
@@ -478,7 +490,7 @@ static const int INVOKE_TWINCODE_OUTBOUND_DONE = 1 << 17;
     
     if (self.space != self.oldSpace) {
         [self.twinmeContext onMoveToSpaceWithRequestId:self.requestId group:self.group oldSpace:self.oldSpace];
-    } else {
+    } else if (!self.groupUpdated) {
         [self.twinmeContext onUpdateGroupWithRequestId:self.requestId group:self.group];
     }
     [self stop];
@@ -579,34 +591,33 @@ static const int INVOKE_TWINCODE_OUTBOUND_DONE = 1 << 17;
         return;
     }
     if (!self.refreshMembers) {
-        self.refreshMembers = [[NSMutableArray alloc] init];
-    }
-    if (!self.refreshAttributes) {
-        self.refreshAttributes = [[NSMutableArray alloc] init];
+        TLTwincodeOutboundService *twincodeOutboundService = [self.twinmeContext getTwincodeOutboundService];
+        TLTwincodeOutbound *memberTwincodeOutbound = self.memberTwincodeOutbound;
+        NSMutableArray<TLAttributeNameValue *> *refreshAttributes = self.refreshAttributes ? self.refreshAttributes : [[NSMutableArray alloc] init];
+        self.refreshAttributes = refreshAttributes;
+        self.refreshMembers = [[TLRefreshPipeline alloc] initWithQueue:[self.twinmeContext.twinlife twinlifeQueue] window:REFRESH_WINDOW maxRetry:REFRESH_MAX_RETRY retryDelay:REFRESH_RETRY_DELAY invoke:^(id item, void (^complete)(TLBaseServiceErrorCode errorCode)) {
+            [twincodeOutboundService secureInvokeTwincodeWithTwincode:memberTwincodeOutbound senderTwincode:memberTwincodeOutbound receiverTwincode:(TLTwincodeOutbound *)item options:TLInvokeTwincodeWakeup action:[TLPairProtocol ACTION_PAIR_REFRESH] attributes:refreshAttributes withBlock:^(TLBaseServiceErrorCode errorCode, NSUUID *invocationId) {
+                complete(errorCode == TLBaseServiceErrorCodeSuccess && !invocationId ? TLBaseServiceErrorCodeItemNotFound : errorCode);
+            }];
+        }];
     }
     [self.refreshAttributes addObject:[[TLAttributeNameStringValue alloc] initWithName:PAIR_PROTOCOL_PARAM_TWINCODE_OUTBOUND_ID stringValue:[updatedTwincode.uuid UUIDString]]];
     NSArray<id<TLGroupMemberConversation>> *members = [groupConversation groupMembersWithFilter:TLGroupMemberFilterTypeJoinedMembers];
     for (id<TLGroupMemberConversation> groupMember in members) {
         TLTwincodeOutbound *peerTwincodeOutbound = groupMember.peerTwincodeOutbound;
         if (peerTwincodeOutbound && [peerTwincodeOutbound isSigned]) {
-            [self.refreshMembers addObject:peerTwincodeOutbound];
+            // A member already in the pipeline is refreshed once with all the attributes.
+            [self.refreshMembers addWithKey:peerTwincodeOutbound.uuid item:peerTwincodeOutbound];
         }
     }
 }
 
-- (void)onInvokeTwincode:(nullable NSUUID *)invocationId errorCode:(TLBaseServiceErrorCode)errorCode {
-    DDLogVerbose(@"%@ onInvokeTwincode: %@ errorCode: %d", LOG_TAG, invocationId, errorCode);
-
-    if (errorCode != TLBaseServiceErrorCodeSuccess || !invocationId) {
-        [self onErrorWithOperationId:INVOKE_TWINCODE_OUTBOUND errorCode:errorCode errorParameter:nil];
-        return;
-    }
+- (void)onInvokeTwincodeWithFailedCount:(int)failedCount {
+    DDLogVerbose(@"%@ onInvokeTwincodeWithFailedCount: %d", LOG_TAG, failedCount);
 
-    self.state &= ~(INVOKE_TWINCODE_OUTBOUND | INVOKE_TWINCODE_OUTBOUND_DONE);
-    
-    if (self.refreshMembers.count > 0) {
-        [self.refreshMembers removeObjectAtIndex:0];
-    }
+    // The group is updated locally: a member that we failed to refresh will get the new
+    // attributes the next time it fetches our twincode.
+    self.state |= INVOKE_TWINCODE_OUTBOUND_DONE;
     [self onOperation];
 }
 
@@ -629,15 +640,6 @@ static const int INVOKE_TWINCODE_OUTBOUND_DONE = 1 << 17;
 - (void)onErrorWithOperationId:(int)operationId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(NSString *)errorParameter {
     DDLogVerbose(@"%@ onErrorWithOperationId: %d errorCode: %d errorParameter: %@", LOG_TAG, operationId, errorCode, errorParameter);
 
-    if (errorCode == TLBaseServiceErrorCodeItemNotFound && operationId == INVOKE_TWINCODE_OUTBOUND) {
-        if (self.refreshMembers.count > 0) {
-            [self.refreshMembers removeObjectAtIndex:0];
-        }
-        self.state &= ~(INVOKE_TWINCODE_OUTBOUND | INVOKE_TWINCODE_OUTBOUND_DONE);
-        [self onOperation];
-        return;
-    }
-
     // Wait for reconnection
     if (errorCode == TLBaseServiceErrorCodeTwinlifeOffline) {
         self.restarted = YES;
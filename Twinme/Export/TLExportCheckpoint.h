@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+//
+// Interface: TLExportCheckpoint
+//
+
+@class TLExportStats;
+
+/**
+ * Checkpoint manifest of an export in progress.
+ *
+ * - the manifest is stored next to the ZIP archive (<path>.checkpoint) and it is saved by the exporter
+ *   when the archive is closed after enough data or time since the previous checkpoint.
+ * - it records the conversations already exported, the export stats, the offset of the ZIP central
+ *   directory and the bytes of the central directory and end of central directory records.
+ * - the central directory entries are kept in memory: a checkpoint only reads the entries added since
+ *   the previous one and the end records.
+ * - when an export is restarted with the same archive path and the same signature (filters, selection and
+ *   password), the archive is truncated at the central directory offset to drop any partial entry, the
+ *   central directory is restored and the exporter continues by appending the conversations that are not
+ *   yet exported.
+ * - the manifest is removed when the export finishes successfully.
+ */
+@interface TLExportCheckpoint : NSObject
+
+@property (nonatomic, readonly, nonnull) NSString *zipPath;
+@property (nonatomic, readonly, nonnull) NSString *path;
+@property (nonatomic, readonly) uint64_t centralDirectoryOffset;
+
+/**
+ * Compute the signature of an export: a keyed hash of the selection so that the password is not
+ * saved in the manifest.
+ *
+ * @param selection the description of the filters and of the exported contacts and groups.
+ * @param password the optional ZIP password.
+ * @return the signature to identify the export.
+ */
++ (nonnull NSString *)signatureWithSelection:(nonnull NSString *)selection password:(nullable NSString *)password;
+
+- (nonnull instancetype)initWithZipPath:(nonnull NSString *)zipPath signature:(nonnull NSString *)signature;
+
+/**
+ * Load the checkpoint manifest and restore the ZIP archive to the state it had when the manifest was saved.
+ *
+ * @param stats the export stats to restore.
+ * @return YES if the archive was restored and must be opened for appending.
+ */
+- (BOOL)restoreWithStats:(nonnull TLExportStats *)stats;
+
+/**
+ * Check whether the conversation was already exported by a previous run.
+ *
+ * @param conversationId the conversation subject identifier.
+ * @return YES if the conversation is already in the archive.
+ */
+- (BOOL)isExportedWithConversationId:(nonnull NSUUID *)conversationId;
+
+/**
+ * Record that the conversation is written in the archive, it is saved by the next checkpoint.
+ *
+ * @param conversationId the conversation subject identifier.
+ */
+- (void)addWithConversationId:(nonnull NSUUID *)conversationId;
+
+/**
+ * Save the manifest with the conversations written so far.  The ZIP archive must be closed.
+ *
+ * @param stats the current export stats.
+ * @return YES if the manifest was saved.
+ */
+- (BOOL)saveWithStats:(nonnull TLExportStats *)stats;
+
+/**
+ * Remove the checkpoint manifest.
+ */
+- (void)remove;
+
+@end
@@ -0,0 +1,325 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+#import <CommonCrypto/CommonCrypto.h>
+
+#import "TLExportExecutor.h"
+#import "TLExportCheckpoint.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+#define CHECKPOINT_VERSION 2
+
+#define CHECKPOINT_VERSION_KEY @"version"
+#define CHECKPOINT_SIGNATURE_KEY @"signature"
+#define CHECKPOINT_OFFSET_KEY @"offset"
+#define CHECKPOINT_DIRECTORY_KEY @"directory"
+#define CHECKPOINT_END_KEY @"end"
+#define CHECKPOINT_CONVERSATIONS_KEY @"conversations"
+#define CHECKPOINT_STATS_KEY @"stats"
+
+// ZIP end of central directory records (APPNOTE.TXT 4.3.14, 4.3.15 and 4.3.16).
+#define ZIP_EOCD_SIGNATURE 0x06054b50
+#define ZIP_EOCD_SIZE 22
+#define ZIP_EOCD_MAX_COMMENT 0xffff
+#define ZIP64_EOCD_SIGNATURE 0x06064b50
+#define ZIP64_EOCD_SIZE 56
+#define ZIP64_LOCATOR_SIGNATURE 0x07064b50
+#define ZIP64_LOCATOR_SIZE 20
+
+// The TLExportStats counters saved in the manifest.
+static NSString *STATS_KEYS[] = {
+    @"conversationCount", @"imageCount", @"imageSize", @"videoCount", @"videoSize", @"fileCount",
+    @"fileSize", @"audioCount", @"audioSize", @"msgCount", @"msgSize", @"totalSize",
+    @"storedCount", @"fastCount", @"deflateCount"
+};
+static const int STATS_KEYS_COUNT = sizeof(STATS_KEYS) / sizeof(STATS_KEYS[0]);
+
+static inline uint32_t getLE32(const uint8_t *p) {
+
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t getLE64(const uint8_t *p) {
+
+    return (uint64_t)getLE32(p) | ((uint64_t)getLE32(p + 4) << 32);
+}
+
+//
+// Interface: TLExportCheckpoint ()
+//
+
+@interface TLExportCheckpoint ()
+
+@property (nonatomic, readonly, nonnull) NSString *signature;
+@property (nonatomic, readonly, nonnull) NSMutableSet<NSString *> *conversations;
+@property (nonatomic) uint64_t centralDirectoryOffset;
+@property (nonatomic, readonly, nonnull) NSMutableData *centralDirectory;
+@property (nonatomic, nullable) NSData *endRecords;
+
+/**
+ * Read the ZIP end of central directory records to find the central directory offset and size.
+ * The central directory entries which are not yet known are appended to the in-memory copy:
+ * the archive is re-opened for appending so that the entries of the previous checkpoint are
+ * at the beginning of the central directory.
+ *
+ * @return YES if the archive has a valid central directory.
+ */
+- (BOOL)readCentralDirectory;
+
+@end
+
+//
+// Implementation: TLExportCheckpoint
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLExportCheckpoint"
+
+@implementation TLExportCheckpoint
+
++ (nonnull NSString *)signatureWithSelection:(nonnull NSString *)selection password:(nullable NSString *)password {
+
+    NSData *key = [(password ? password : @"") dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *data = [selection dataUsingEncoding:NSUTF8StringEncoding];
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+    CCHmac(kCCHmacAlgSHA256, key.bytes, key.length, data.bytes, data.length, digest);
+
+    NSMutableString *result = [[NSMutableString alloc] initWithCapacity:2 * CC_SHA256_DIGEST_LENGTH + 2];
+    [result appendString:password ? @"P:" : @"N:"];
+    for (int i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [result appendFormat:@"%02x", digest[i]];
+    }
+    return result;
+}
+
+- (nonnull instancetype)initWithZipPath:(nonnull NSString *)zipPath signature:(nonnull NSString *)signature {
+    DDLogVerbose(@"%@ initWithZipPath: %@ signature: %@", LOG_TAG, zipPath, signature);
+
+    self = [super init];
+    if (self) {
+        _zipPath = zipPath;
+        _path = [zipPath stringByAppendingString:@".checkpoint"];
+        _signature = signature;
+        _conversations = [[NSMutableSet alloc] init];
+        _centralDirectoryOffset = 0;
+        _centralDirectory = [[NSMutableData alloc] init];
+    }
+    return self;
+}
+
+- (BOOL)restoreWithStats:(nonnull TLExportStats *)stats {
+    DDLogVerbose(@"%@ restoreWithStats: %@", LOG_TAG, stats);
+
+    NSData *content = [NSData dataWithContentsOfFile:self.path];
+    if (!content) {
+        return NO;
+    }
+
+    NSDictionary *manifest = [NSPropertyListSerialization propertyListWithData:content options:NSPropertyListImmutable format:nil error:nil];
+    if (![manifest isKindOfClass:[NSDictionary class]]) {
+        DDLogWarn(@"%@ invalid checkpoint manifest %@", LOG_TAG, self.path);
+        [self remove];
+        return NO;
+    }
+
+    NSNumber *version = manifest[CHECKPOINT_VERSION_KEY];
+    NSString *signature = manifest[CHECKPOINT_SIGNATURE_KEY];
+    NSNumber *offset = manifest[CHECKPOINT_OFFSET_KEY];
+    NSData *directory = manifest[CHECKPOINT_DIRECTORY_KEY];
+    NSData *endRecords = manifest[CHECKPOINT_END_KEY];
+    NSArray<NSString *> *conversations = manifest[CHECKPOINT_CONVERSATIONS_KEY];
+    NSDictionary<NSString *, NSNumber *> *savedStats = manifest[CHECKPOINT_STATS_KEY];
+    if (version.intValue != CHECKPOINT_VERSION || ![self.signature isEqualToString:signature] || !offset || !directory || !endRecords || !conversations || !savedStats) {
+        DDLogInfo(@"%@ checkpoint %@ does not match the current export", LOG_TAG, self.path);
+        [self remove];
+        return NO;
+    }
+
+    // The archive must contain at least everything up to the central directory we saved:
+    // anything after it is a partial entry written after the checkpoint.
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSDictionary<NSFileAttributeKey, id> *attrs = [fileManager attributesOfItemAtPath:self.zipPath error:nil];
+    if (!attrs || [attrs fileSize] < offset.unsignedLongLongValue) {
+        [self remove];
+        return NO;
+    }
+
+    NSFileHandle *file = [NSFileHandle fileHandleForUpdatingAtPath:self.zipPath];
+    if (!file) {
+        [self remove];
+        return NO;
+    }
+    @try {
+        [file truncateFileAtOffset:offset.unsignedLongLongValue];
+        [file writeData:directory];
+        [file writeData:endRecords];
+        [file synchronizeFile];
+        [file closeFile];
+
+    } @catch (NSException *exception) {
+        DDLogError(@"%@ cannot restore archive %@: %@", LOG_TAG, self.zipPath, exception);
+        [self remove];
+        return NO;
+    }
+
+    self.centralDirectoryOffset = offset.unsignedLongLongValue;
+    [self.centralDirectory setData:directory];
+    self.endRecords = endRecords;
+    [self.conversations addObjectsFromArray:conversations];
+    for (int i = 0; i < STATS_KEYS_COUNT; i++) {
+        NSNumber *value = savedStats[STATS_KEYS[i]];
+        if (value) {
+            [stats setValue:value forKey:STATS_KEYS[i]];
+        }
+    }
+    return YES;
+}
+
+- (BOOL)isExportedWithConversationId:(nonnull NSUUID *)conversationId {
+
+    return [self.conversations containsObject:conversationId.UUIDString];
+}
+
+- (void)addWithConversationId:(nonnull NSUUID *)conversationId {
+    DDLogVerbose(@"%@ addWithConversationId: %@", LOG_TAG, conversationId);
+
+    [self.conversations addObject:conversationId.UUIDString];
+}
+
+- (BOOL)saveWithStats:(nonnull TLExportStats *)stats {
+    DDLogVerbose(@"%@ saveWithStats: %@", LOG_TAG, stats);
+
+    if (![self readCentralDirectory]) {
+        return NO;
+    }
+
+    NSMutableDictionary<NSString *, NSNumber *> *savedStats = [[NSMutableDictionary alloc] initWithCapacity:STATS_KEYS_COUNT];
+    for (int i = 0; i < STATS_KEYS_COUNT; i++) {
+        savedStats[STATS_KEYS[i]] = [stats valueForKey:STATS_KEYS[i]];
+    }
+
+    NSDictionary *manifest = @{
+        CHECKPOINT_VERSION_KEY: @(CHECKPOINT_VERSION),
+        CHECKPOINT_SIGNATURE_KEY: self.signature,
+        CHECKPOINT_OFFSET_KEY: @(self.centralDirectoryOffset),
+        CHECKPOINT_DIRECTORY_KEY: self.centralDirectory,
+        CHECKPOINT_END_KEY: self.endRecords,
+        CHECKPOINT_CONVERSATIONS_KEY: [self.conversations allObjects],
+        CHECKPOINT_STATS_KEY: savedStats
+    };
+    NSData *content = [NSPropertyListSerialization dataWithPropertyList:manifest format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+
+    // Write atomically: a crash while saving keeps the previous manifest.
+    if (!content || ![content writeToFile:self.path atomically:YES]) {
+        DDLogError(@"%@ cannot save checkpoint %@", LOG_TAG, self.path);
+        return NO;
+    }
+    return YES;
+}
+
+- (void)remove {
+    DDLogVerbose(@"%@ remove", LOG_TAG);
+
+    [[NSFileManager defaultManager] removeItemAtPath:self.path error:nil];
+    [self.conversations removeAllObjects];
+    [self.centralDirectory setLength:0];
+    self.endRecords = nil;
+    self.centralDirectoryOffset = 0;
+}
+
+#pragma mark - Private methods
+
+- (BOOL)readCentralDirectory {
+    DDLogVerbose(@"%@ readCentralDirectory", LOG_TAG);
+
+    NSFileHandle *file = [NSFileHandle fileHandleForReadingAtPath:self.zipPath];
+    if (!file) {
+        return NO;
+    }
+
+    @try {
+        uint64_t fileSize = [file seekToEndOfFile];
+        if (fileSize < ZIP_EOCD_SIZE) {
+            [file closeFile];
+            return NO;
+        }
+
+        // Look for the end of central directory record, it is followed by an optional comment.
+        uint64_t tailSize = MIN(fileSize, ZIP_EOCD_SIZE + ZIP_EOCD_MAX_COMMENT + ZIP64_LOCATOR_SIZE);
+        [file seekToFileOffset:fileSize - tailSize];
+        NSData *tail = [file readDataOfLength:(NSUInteger)tailSize];
+        const uint8_t *bytes = tail.bytes;
+        int64_t eocd = (int64_t)tail.length - ZIP_EOCD_SIZE;
+        while (eocd >= 0 && getLE32(bytes + eocd) != ZIP_EOCD_SIGNATURE) {
+            eocd--;
+        }
+        if (eocd < 0) {
+            [file closeFile];
+            return NO;
+        }
+
+        uint64_t size = getLE32(bytes + eocd + 12);
+        uint64_t offset = getLE32(bytes + eocd + 16);
+        if (offset == 0xffffffff || size == 0xffffffff) {
+            // Large archive: the offset is in the ZIP64 end of central directory record.
+            int64_t locator = eocd - ZIP64_LOCATOR_SIZE;
+            if (locator < 0 || getLE32(bytes + locator) != ZIP64_LOCATOR_SIGNATURE) {
+                [file closeFile];
+                return NO;
+            }
+            uint64_t zip64Offset = getLE64(bytes + locator + 8);
+            if (zip64Offset + ZIP64_EOCD_SIZE > fileSize) {
+                [file closeFile];
+                return NO;
+            }
+            [file seekToFileOffset:zip64Offset];
+            NSData *zip64 = [file readDataOfLength:ZIP64_EOCD_SIZE];
+            if (zip64.length != ZIP64_EOCD_SIZE || getLE32(zip64.bytes) != ZIP64_EOCD_SIGNATURE) {
+                [file closeFile];
+                return NO;
+            }
+            size = getLE64((const uint8_t *)zip64.bytes + 40);
+            offset = getLE64((const uint8_t *)zip64.bytes + 48);
+        }
+        if (offset > fileSize || size > fileSize - offset) {
+            [file closeFile];
+            return NO;
+        }
+
+        // Read only the entries added since the previous checkpoint, unless the directory was rewritten.
+        uint64_t known = self.centralDirectory.length;
+        if (known > size || offset < self.centralDirectoryOffset) {
+            [self.centralDirectory setLength:0];
+            known = 0;
+        }
+        [file seekToFileOffset:offset + known];
+        NSData *entries = [file readDataOfLength:(NSUInteger)(size - known)];
+        NSData *endRecords = [file readDataToEndOfFile];
+        [file closeFile];
+        if (entries.length != size - known || endRecords.length != fileSize - offset - size) {
+            [self.centralDirectory setLength:0];
+            return NO;
+        }
+        [self.centralDirectory appendData:entries];
+        self.centralDirectoryOffset = offset;
+        self.endRecords = endRecords;
+        return YES;
+
+    } @catch (NSException *exception) {
+        DDLogError(@"%@ cannot read central directory of %@: %@", LOG_TAG, self.zipPath, exception);
+        return NO;
+    }
+}
+
+@end
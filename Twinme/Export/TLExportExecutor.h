@@ -32,9 +32,10 @@ typedef enum {
 /**
  * Interface: TLExportStats
  *
- * Statistics about the export process.
+ * Statistics about the export process.  The delegate receives a copy of the stats
+ * which is not modified by the exporter.
  */
-@interface TLExportStats : NSObject
+@interface TLExportStats : NSObject <NSCopying>
 
 @property (nonatomic) int64_t conversationCount;
 @property (nonatomic) int64_t imageCount;
@@ -49,6 +50,11 @@ typedef enum {
 @property (nonatomic) int64_t msgSize;
 @property (nonatomic) int64_t totalSize;
 
+// Compression level chosen for the ZIP entries: stored, fast or default deflate.
+@property (nonatomic) int64_t storedCount;
+@property (nonatomic) int64_t fastCount;
+@property (nonatomic) int64_t deflateCount;
+
 @end
 
 /**
@@ -59,7 +65,8 @@ typedef enum {
 @protocol TLExportDelegate
 
 /**
- * Give information about the exporter progress.
+ * Give information about the exporter progress.  While scanning and exporting, the progress
+ * is reported at most 10 times per second; state changes are always reported.
  *
  * @param state the current export state.
  * @param stats the current stats about the export.
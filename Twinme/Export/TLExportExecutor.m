@@ -48,6 +48,18 @@ static const int EXPORT_PHASE_1_DONE = 1 << 12;
 static const int EXPORT_PHASE_2 = 1 << 13;
 static const int EXPORT_PHASE_2_DONE = 1 << 14;
 
+#define EXPORT_NAME_BUFFER_SIZE 256
+#define EXPORT_CHAR_BIT(c) (1U << ((c) & 31))
+
+// Bitmap of the ASCII characters that are removed from export names: | \ ? * < " : > / '
+static const uint32_t EXPORT_FORBIDDEN_CHARS[4] = {
+    0,
+    EXPORT_CHAR_BIT('"') | EXPORT_CHAR_BIT('\'') | EXPORT_CHAR_BIT('*') | EXPORT_CHAR_BIT('/')
+    | EXPORT_CHAR_BIT(':') | EXPORT_CHAR_BIT('<') | EXPORT_CHAR_BIT('>') | EXPORT_CHAR_BIT('?'),
+    EXPORT_CHAR_BIT('\\'),
+    EXPORT_CHAR_BIT('|')
+};
+
 //
 // Interface: TLExportExecutorGroupMemberQuery ()
 //
@@ -106,6 +118,27 @@ static const int EXPORT_PHASE_2_DONE = 1 << 14;
 
 @implementation TLExportStats
 
+- (nonnull id)copyWithZone:(nullable NSZone *)zone {
+
+    TLExportStats *stats = [[TLExportStats allocWithZone:zone] init];
+    stats.conversationCount = self.conversationCount;
+    stats.imageCount = self.imageCount;
+    stats.imageSize = self.imageSize;
+    stats.videoCount = self.videoCount;
+    stats.videoSize = self.videoSize;
+    stats.fileCount = self.fileCount;
+    stats.fileSize = self.fileSize;
+    stats.audioCount = self.audioCount;
+    stats.audioSize = self.audioSize;
+    stats.msgCount = self.msgCount;
+    stats.msgSize = self.msgSize;
+    stats.totalSize = self.totalSize;
+    stats.storedCount = self.storedCount;
+    stats.fastCount = self.fastCount;
+    stats.deflateCount = self.deflateCount;
+    return stats;
+}
+
 - (NSString *)description {
     
     NSMutableString *result = [[NSMutableString alloc] initWithCapacity:256];
@@ -124,6 +157,9 @@ static const int EXPORT_PHASE_2_DONE = 1 << 14;
     if (self.videoCount > 0) {
         [result appendFormat:@", videoCount: %lld, videoSize: %lld", self.videoCount, self.videoSize];
     }
+    if (self.storedCount > 0 || self.fastCount > 0 || self.deflateCount > 0) {
+        [result appendFormat:@", stored: %lld, fast: %lld, deflate: %lld", self.storedCount, self.fastCount, self.deflateCount];
+    }
     [result appendFormat:@"}"];
     return result;
 }
@@ -163,7 +199,30 @@ static const int EXPORT_PHASE_2_DONE = 1 << 14;
 
 + (nonnull NSString *)exportWithName:(nonnull NSString *)name {
 
-    return [name stringByReplacingOccurrencesOfString:@"[|\\\\?*<\":>/']" withString:@"" options:NSRegularExpressionSearch range:NSMakeRange(0, name.length)];
+    NSUInteger length = name.length;
+    unichar localBuffer[EXPORT_NAME_BUFFER_SIZE];
+    unichar *buffer = length <= EXPORT_NAME_BUFFER_SIZE ? localBuffer : malloc(length * sizeof(unichar));
+    if (!buffer) {
+        return name;
+    }
+
+    // Single pass over the UTF-16 characters: the forbidden characters are all ASCII
+    // so that surrogate pairs and other unicode characters are always kept.
+    [name getCharacters:buffer range:NSMakeRange(0, length)];
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < length; i++) {
+        unichar c = buffer[i];
+        if (c < 128 && (EXPORT_FORBIDDEN_CHARS[c >> 5] & EXPORT_CHAR_BIT(c)) != 0) {
+            continue;
+        }
+        buffer[count++] = c;
+    }
+
+    NSString *result = count == length ? name : [[NSString alloc] initWithCharacters:buffer length:count];
+    if (buffer != localBuffer) {
+        free(buffer);
+    }
+    return result;
 }
 
 - (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext delegate:(nonnull id<TLExportDelegate>)delegate statAllDescriptors:(BOOL)statAllDescriptors needConversations:(BOOL)needConversations {
@@ -6,6 +6,63 @@
  *   Stephane Carrez (Stephane.Carrez@twin.life)
  */
 
+//
+// Interface: TLExportNames
+//
+
+/**
+ * Allocate unique export names within a directory.
+ *
+ * Special characters are removed from the name and duplicate names get a counter appended.
+ * The next counter to try is remembered for each base name so that many identical names
+ * are resolved without scanning the previous counters again.
+ */
+@interface TLExportNames : NSObject
+
+- (nonnull instancetype)init;
+
+/**
+ * Get a unique name for the given name and reserve it.
+ *
+ * @param name the space/group/contact or member name.
+ * @return the name to use (unique and with special characters removed).
+ */
+- (nonnull NSString *)uniqueNameWithName:(nonnull NSString *)name;
+
+@end
+
+//
+// Interface: TLExportTranscript
+//
+
+/**
+ * Build the messages.txt transcript of a conversation in UTF-8.
+ *
+ * The date formatter and the UTF-8 buffer are kept for the whole export.  A text which cannot be
+ * converted to UTF-8 (lone surrogate) is converted with a replacement character.
+ */
+@interface TLExportTranscript : NSObject
+
+/// The UTF-8 transcript built since the last reset.
+@property (nonatomic, readonly, nonnull) NSData *data;
+
+- (nonnull instancetype)init;
+
+/**
+ * Append the message with its localized date and time.
+ *
+ * @param date the message date in milliseconds.
+ * @param text the message text.
+ */
+- (void)appendWithDate:(int64_t)date text:(nonnull NSString *)text;
+
+/**
+ * Clear the transcript for the next conversation, the buffer of a large conversation is released.
+ */
+- (void)reset;
+
+@end
+
 //
 // Interface: TLExporter
 //
@@ -33,6 +90,22 @@
 @property (nonatomic, nonnull) NSArray<NSNumber *> *typeFilter;
 @property (nonatomic) BOOL addSpacePrefix;
 
+/// The media size and the delay in nanoseconds after which a checkpoint is saved (32Mb and 10s by default).
+@property (nonatomic) int64_t checkpointMaxSize;
+@property (nonatomic) uint64_t checkpointMaxDelay;
+
+/**
+ * Choose the ZIP compression level for a file entry.  Formats which are already compressed are stored,
+ * other files are probed by computing the entropy of their first bytes: high entropy content is stored,
+ * medium entropy content and media use a fast compression and the default compression is used otherwise.
+ *
+ * @param type the descriptor type.
+ * @param path the file to export.
+ * @param ext the file extension.
+ * @return the zlib compression level.
+ */
++ (int)compressionLevelWithType:(TLDescriptorType)type path:(nonnull NSString *)path ext:(nonnull NSString *)ext;
+
 - (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext delegate:(nonnull id<TLExportDelegate>)delegate dateFilter:(int64_t)dateFilter typeFilter:(nullable NSArray<NSNumber *> *)typeFilter statAllDescriptors:(BOOL)statAllDescriptors;
 
 /**
@@ -42,6 +115,9 @@
  */
 - (void)updateWithState:(TLExportState)state;
 
+/// The uptime in nanoseconds used to throttle the progress reports and the checkpoints.
+- (uint64_t)now;
+
 /**
  * Create the ZIP file at the given path. The ZipArchive is created and is ready to be populated by the exportWithXXX operations.
  *
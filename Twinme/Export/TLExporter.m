@@ -20,6 +20,7 @@
 #import "TLSpace.h"
 #import "TLGroupMember.h"
 #import "TLExporter.h"
+#import "TLExportCheckpoint.h"
 
 #if 0
 static const int ddLogLevel = DDLogLevelVerbose;
@@ -28,6 +29,20 @@ static const int ddLogLevel = DDLogLevelWarning;
 #endif
 
 #define MESSAGE_BUFFER_SIZE (64 * 1024)
+
+// Minimum delay between two progress reports while scanning or exporting (10 reports per second).
+#define PROGRESS_REPORT_INTERVAL (NSEC_PER_SEC / 10)
+
+// A checkpoint is saved after a conversation when this amount of media or time was exported since the previous one.
+#define CHECKPOINT_SIZE (32 * 1024 * 1024)
+#define CHECKPOINT_INTERVAL (10 * NSEC_PER_SEC)
+
+// Size of the file header used to estimate whether the content is compressible.
+#define COMPRESSION_PROBE_SIZE (64 * 1024)
+
+// Shannon entropy thresholds (bits per byte) to store the entry or use a fast compression.
+#define STORE_ENTROPY_THRESHOLD 7.5
+#define FAST_ENTROPY_THRESHOLD 6.0
 #define TwinmeLocalizedString(key, comment) NSLocalizedString((key), (comment))
 
 // List of descriptor types that can be exported.
@@ -50,6 +65,36 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
 
 @end
 
+//
+// Interface: TLExportTranscript ()
+//
+
+@interface TLExportTranscript ()
+
+@property (nonatomic, nullable) NSDateFormatter *dateFormatter;
+@property (nonatomic, nonnull) NSMutableData *messageBuffer;
+@property (nonatomic) int64_t lastMinute;
+@property (nonatomic, nullable) NSData *lastDateTime;
+
+/**
+ * Get the localized date and time prefix for the message in UTF-8.  The short time style
+ * has a minute resolution and messages are sorted: the last formatted minute is kept
+ * to avoid formatting the same date again.
+ *
+ * @param date the message date in milliseconds.
+ * @return the UTF-8 date and time string.
+ */
+- (nonnull NSData *)formatWithDate:(int64_t)date;
+
+/**
+ * Append the text converted to UTF-8 by chunks without creating an intermediate NSData.
+ *
+ * @param text the text to append.
+ */
+- (void)appendWithText:(nonnull NSString *)text;
+
+@end
+
 //
 // Interface: TLExporter ()
 //
@@ -59,7 +104,7 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
 @property (nonatomic, weak, nullable) id<TLExportDelegate> delegate;
 @property (nonatomic, readonly, nonnull) TLConversationService *conversationService;
 @property (nonatomic, readonly, nonnull) NSMutableDictionary<NSUUID *, NSString *> *dirNames;
-@property (nonatomic, readonly, nonnull) NSMutableSet<NSString *> *usedDirNames;
+@property (nonatomic, readonly, nonnull) TLExportNames *usedDirNames;
 @property (nonatomic, readonly) BOOL statAllDescriptors;
 
 @property (nonatomic, nonnull) TLExportStats *stats;
@@ -69,7 +114,12 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
 @property (nonatomic, nullable) NSString *dirName;
 @property (nonatomic, nullable) SSZipArchive *zip;
 @property (nonatomic, nullable) NSString *password;
+@property (nonatomic, nullable) TLExportCheckpoint *checkpoint;
+@property (nonatomic) int64_t checkpointSize;
+@property (nonatomic) uint64_t checkpointTime;
+@property (nonatomic) uint64_t lastProgressTime;
 @property (nonatomic, nullable) NSMutableArray<TLExportInfo *> *descriptors;
+@property (nonatomic, nullable) TLExportTranscript *transcript;
 
 /**
  * Report an error message and put the exporter in error state.
@@ -79,17 +129,36 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
 - (void)errorWithMessage:(nonnull NSString *)message;
 
 /**
- * Build a name to associate with a twincode and make sure names are valid to build file and directory
- * names and that they are unique.  Special characters are removed and duplicate names have a counter
- * added at the end.
+ * Report the export progress to the delegate with a snapshot of the stats unless
+ * a progress was reported less than PROGRESS_REPORT_INTERVAL ago.
+ */
+- (void)reportProgress;
+
+/**
+ * Record the conversation that was exported.  When enough media or time was exported since the previous
+ * checkpoint, close the ZIP archive, save the checkpoint manifest and re-open the archive for appending
+ * the next conversations.
  *
- * @param name the name to add.
- * @param usedNames a set of names which are already used in the current directory.
- * @return the name to use (unique and with special characters removed).
+ * @param subject the repository object for the conversation that was exported.
  */
-- (nonnull NSString *)buildNameWithName:(nonnull NSString *)name usedNames:(nonnull NSMutableSet<NSString *> *)usedNames;
+- (void)checkpointWithSubject:(nonnull id<TLRepositoryObject>)subject;
 
-- (nonnull NSString *)buildDirNameWithName:(nonnull NSString *)name usedNames:(nonnull NSMutableSet<NSString *> *)usedNames subject:(nonnull id<TLOriginator>)subject;
+/**
+ * Describe what is exported to identify the export in the checkpoint: the filters and the contacts
+ * and groups with their directory names.
+ *
+ * @return the export selection.
+ */
+- (nonnull NSString *)selection;
+
+/**
+ * Get the size of the media exported so far.
+ *
+ * @return the size of the exported media.
+ */
+- (int64_t)exportedSize;
+
+- (nonnull NSString *)buildDirNameWithName:(nonnull NSString *)name usedNames:(nonnull TLExportNames *)usedNames subject:(nonnull id<TLOriginator>)subject;
 
 /**
  * Export the conversation associated with our identity twincode.
@@ -97,10 +166,10 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
  * @param name the directory base name to export this conversation.
  * @param subject the repository object for the conversation to export.
  * @param names a mapping of twincodes to local prefix names to be used for file export.
- * @param usedNames a set of names which are already used in the current directory.
+ * @param usedNames the names which are already used in the current directory.
  * @param members the group or twinroom members.
  */
-- (void)exportWithName:(nonnull NSString *)name subject:(nonnull id<TLRepositoryObject>)subject names:(nonnull NSMutableDictionary<NSUUID *, NSString *> *)names usedNames:(nonnull NSMutableSet<NSString *> *)usedNames members:(nullable NSDictionary<NSUUID *, NSString *> *)members;
+- (void)exportWithName:(nonnull NSString *)name subject:(nonnull id<TLRepositoryObject>)subject names:(nonnull NSMutableDictionary<NSUUID *, NSString *> *)names usedNames:(nonnull TLExportNames *)usedNames members:(nullable NSDictionary<NSUUID *, NSString *> *)members;
 
 - (void)exportWithObjectDescriptor:(nonnull TLObjectDescriptor *)objectDescriptor senderName:(nonnull NSString *)senderName;
 
@@ -112,6 +181,16 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
 
 - (void)exportWithAudioDescriptor:(nonnull TLAudioDescriptor *)audioDescriptor senderName:(nonnull NSString *)senderName;
 
+/**
+ * Choose the ZIP compression level for a file entry and record the decision in the export stats.
+ *
+ * @param type the descriptor type.
+ * @param path the file to export.
+ * @param ext the file extension.
+ * @return the zlib compression level.
+ */
+- (int)compressionLevelWithType:(TLDescriptorType)type path:(nonnull NSString *)path ext:(nonnull NSString *)ext;
+
 @end
 
 //
@@ -135,6 +214,141 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
 
 @end
 
+//
+// Implementation: TLExportNames
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLExportNames"
+
+@implementation TLExportNames {
+    NSMutableSet<NSString *> *_usedNames;
+    NSMutableDictionary<NSString *, NSNumber *> *_nextCounters;
+}
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _usedNames = [[NSMutableSet alloc] init];
+        _nextCounters = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (nonnull NSString *)uniqueNameWithName:(nonnull NSString *)name {
+    DDLogVerbose(@"%@ uniqueNameWithName: %@", LOG_TAG, name);
+
+    name = [TLExportExecutor exportWithName:name];
+    if ([_usedNames containsObject:name]) {
+        // Counters below the remembered one are either allocated or were found used:
+        // since names are never released, we can resume from it.
+        NSNumber *next = _nextCounters[name];
+        int count = next ? next.intValue : 1;
+        NSString *newString;
+        do {
+            newString = [NSString stringWithFormat:@"%@_%d", name, count];
+            count++;
+        } while ([_usedNames containsObject:newString]);
+        _nextCounters[name] = [NSNumber numberWithInt:count];
+        name = newString;
+    }
+    [_usedNames addObject:name];
+    return name;
+}
+
+@end
+
+//
+// Implementation: TLExportTranscript
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLExportTranscript"
+
+@implementation TLExportTranscript
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _messageBuffer = [[NSMutableData alloc] initWithCapacity:MESSAGE_BUFFER_SIZE];
+    }
+    return self;
+}
+
+- (nonnull NSData *)data {
+
+    return self.messageBuffer;
+}
+
+- (void)appendWithDate:(int64_t)date text:(nonnull NSString *)text {
+
+    NSMutableData *messages = self.messageBuffer;
+    [messages appendBytes:"[" length:1];
+    [messages appendData:[self formatWithDate:date]];
+    [messages appendBytes:"] " length:2];
+    [self appendWithText:text];
+    [messages appendBytes:"\r\n" length:2];
+}
+
+- (void)reset {
+
+    // Release the memory used by large conversations.
+    if (self.messageBuffer.length > MESSAGE_BUFFER_SIZE * 16) {
+        self.messageBuffer = [[NSMutableData alloc] initWithCapacity:MESSAGE_BUFFER_SIZE];
+    } else {
+        [self.messageBuffer setLength:0];
+    }
+}
+
+- (nonnull NSData *)formatWithDate:(int64_t)date {
+
+    int64_t seconds = date / 1000L;
+    int64_t minute = seconds / 60;
+    if (self.lastDateTime && self.lastMinute == minute) {
+        return self.lastDateTime;
+    }
+
+    // Same configuration as [NSDateFormatter localizedStringFromDate:dateStyle:timeStyle:]
+    // but the formatter is created only once.
+    if (!self.dateFormatter) {
+        self.dateFormatter = [[NSDateFormatter alloc] init];
+        self.dateFormatter.dateStyle = NSDateFormatterMediumStyle;
+        self.dateFormatter.timeStyle = NSDateFormatterShortStyle;
+    }
+
+    NSDate *d = [[NSDate alloc] initWithTimeIntervalSince1970:seconds];
+    NSString *localizedDateTime = [self.dateFormatter stringFromDate:d];
+    self.lastMinute = minute;
+    self.lastDateTime = [localizedDateTime dataUsingEncoding:NSUTF8StringEncoding];
+    return self.lastDateTime;
+}
+
+- (void)appendWithText:(nonnull NSString *)text {
+
+    // UTF-8 replacement character U+FFFD for a code unit without UTF-8 form (lone surrogate).
+    static const char REPLACEMENT[] = { (char)0xEF, (char)0xBF, (char)0xBD };
+
+    NSMutableData *data = self.messageBuffer;
+    char buffer[1024];
+    NSUInteger used = 0;
+    NSRange remaining;
+    NSRange range = NSMakeRange(0, text.length);
+    while (range.length > 0) {
+        if (![text getBytes:buffer maxLength:sizeof(buffer) usedLength:&used encoding:NSUTF8StringEncoding options:0 range:range remainingRange:&remaining] && used == 0) {
+            // The conversion stopped on the first code unit: replace it and continue with the rest of the text.
+            [data appendBytes:REPLACEMENT length:sizeof(REPLACEMENT)];
+            range = NSMakeRange(range.location + 1, range.length - 1);
+            continue;
+        }
+        [data appendBytes:buffer length:used];
+        range = remaining;
+    }
+}
+
+@end
+
 //
 // Implementation: TLExporter
 //
@@ -152,7 +366,7 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
         _delegate = delegate;
         _conversationService = [twinmeContext getConversationService];
         _dirNames = [[NSMutableDictionary alloc] init];
-        _usedDirNames = [[NSMutableSet alloc] init];
+        _usedDirNames = [[TLExportNames alloc] init];
         _dateFilter = dateFilter;
         _statAllDescriptors = statAllDescriptors;
         if (typeFilter) {
@@ -161,6 +375,8 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
             _typeFilter = @[@(TLDescriptorTypeImageDescriptor), @(TLDescriptorTypeAudioDescriptor), @(TLDescriptorTypeVideoDescriptor), @(TLDescriptorTypeNamedFileDescriptor)];
         }
         
+        _checkpointMaxSize = CHECKPOINT_SIZE;
+        _checkpointMaxDelay = CHECKPOINT_INTERVAL;
         _state = TLExportStateReady;
         _exportEnabled = NO;
         _stats = [[TLExportStats alloc] init];
@@ -177,10 +393,27 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
     
     if (self.state != TLExportStateError) {
         self.state = state;
-        [self.delegate onProgressWithState:state stats:self.stats];
+        self.lastProgressTime = [self now];
+        [self.delegate onProgressWithState:state stats:[self.stats copy]];
     }
 }
 
+- (uint64_t)now {
+
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+- (void)reportProgress {
+
+    uint64_t now = [self now];
+    if (now - self.lastProgressTime < PROGRESS_REPORT_INTERVAL) {
+        return;
+    }
+
+    self.lastProgressTime = now;
+    [self.delegate onProgressWithState:self.state stats:[self.stats copy]];
+}
+
 - (void)createZipWithPath:(nonnull NSString *)path password:(nullable NSString *)password {
     DDLogVerbose(@"%@ createZipWithPath: %@", LOG_TAG, path);
     
@@ -191,9 +424,22 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
     
     self.stats = [[TLExportStats alloc] init];
     self.exportEnabled = YES;
-    
+
+    // Resume a previous export interrupted with the same archive, the same selection and the same password.
+    NSString *signature = [TLExportCheckpoint signatureWithSelection:[self selection] password:password];
+    self.checkpoint = [[TLExportCheckpoint alloc] initWithZipPath:path signature:signature];
+    BOOL resume = [self.checkpoint restoreWithStats:self.stats];
+    self.checkpointSize = [self exportedSize];
+    self.checkpointTime = [self now];
+
     self.zip = [[SSZipArchive alloc] initWithPath:path];
-    BOOL success = [self.zip open];
+    BOOL success = resume ? [self.zip openForAppending] : [self.zip open];
+    if (!success && resume) {
+        DDLogWarn(@"%@ cannot resume export from checkpoint", LOG_TAG);
+        [self.checkpoint remove];
+        self.stats = [[TLExportStats alloc] init];
+        success = [self.zip open];
+    }
     if (!success) {
         [self errorWithMessage:@"cannot create zip"];
         return;
@@ -207,9 +453,12 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
     if (self.zip) {
         if (![self.zip close]) {
             [self errorWithMessage:@"closing zip with error"];
+        } else {
+            [self.checkpoint remove];
         }
         self.zip = nil;
     }
+    self.checkpoint = nil;
 }
 
 - (void)errorWithMessage:(nonnull NSString *)message {
@@ -252,10 +501,10 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
         }
         
         NSMutableDictionary<NSUUID *, NSString *> *localNames = [[NSMutableDictionary alloc] init];
-        NSMutableSet<NSString *> *usedNames = [[NSMutableSet alloc] init];
+        TLExportNames *usedNames = [[TLExportNames alloc] init];
         NSDictionary<NSUUID *, NSString *> *roomMembers = members[contact.uuid];
-        [localNames setObject:[self buildNameWithName:identityName usedNames:usedNames] forKey:twincodeOutboundId];
-        [localNames setObject:[self buildNameWithName:contactName usedNames:usedNames] forKey:peerTwincodeOutboundId];
+        [localNames setObject:[usedNames uniqueNameWithName:identityName] forKey:twincodeOutboundId];
+        [localNames setObject:[usedNames uniqueNameWithName:contactName] forKey:peerTwincodeOutboundId];
         [self exportWithName:dirName subject:contact names:localNames usedNames:usedNames members:roomMembers];
     }
 }
@@ -288,37 +537,19 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
         }
         
         NSMutableDictionary<NSUUID *, NSString *> *localNames = [[NSMutableDictionary alloc] init];
-        NSMutableSet<NSString *> *usedNames = [[NSMutableSet alloc] init];
+        TLExportNames *usedNames = [[TLExportNames alloc] init];
         NSDictionary<NSUUID *, NSString *> *groupMembers = members[groupId];
-        [localNames setObject:[self buildNameWithName:identityName usedNames:usedNames] forKey:twincodeOutboundId];
+        [localNames setObject:[usedNames uniqueNameWithName:identityName] forKey:twincodeOutboundId];
         [self exportWithName:dirName subject:group names:localNames usedNames:usedNames members:groupMembers];
     }
 }
 
 #pragma mark - Private methods
 
-- (nonnull NSString *)buildNameWithName:(nonnull NSString *)name usedNames:(nonnull NSMutableSet<NSString *> *)usedNames {
-    DDLogVerbose(@"%@ buildNameWithName %@ name: %@", LOG_TAG, name, usedNames);
-    
-    name = [TLExportExecutor exportWithName:name];
-    
-    if ([usedNames containsObject:name]) {
-        int count = 1;
-        NSString *newString;
-        do {
-            newString = [NSString stringWithFormat:@"%@_%d", name, count];
-            count++;
-        } while ([usedNames containsObject:newString]);
-        name = newString;
-    }
-    [usedNames addObject:name];
-    return name;
-}
-
-- (nonnull NSString *)buildDirNameWithName:(nonnull NSString *)name usedNames:(nonnull NSMutableSet<NSString *> *)usedNames subject:(nonnull id<TLOriginator>)subject {
+- (nonnull NSString *)buildDirNameWithName:(nonnull NSString *)name usedNames:(nonnull TLExportNames *)usedNames subject:(nonnull id<TLOriginator>)subject {
     DDLogVerbose(@"%@ buildDirNameWithName %@ name: %@ subject: %@", LOG_TAG, name, usedNames, subject);
 
-    NSString *dirname = [self buildNameWithName:name usedNames:usedNames];
+    NSString *dirname = [usedNames uniqueNameWithName:name];
     if (self.addSpacePrefix) {
         TLSpace *space = subject.space;
         if (space) {
@@ -338,7 +569,7 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
     return NO;
 }
 
-- (void)exportWithName:(nonnull NSString *)name subject:(nonnull id<TLRepositoryObject>)subject names:(nonnull NSMutableDictionary<NSUUID *, NSString *> *)names usedNames:(nonnull NSMutableSet<NSString *> *)usedNames members:(nullable NSDictionary<NSUUID *, NSString *> *)members {
+- (void)exportWithName:(nonnull NSString *)name subject:(nonnull id<TLRepositoryObject>)subject names:(nonnull NSMutableDictionary<NSUUID *, NSString *> *)names usedNames:(nonnull TLExportNames *)usedNames members:(nullable NSDictionary<NSUUID *, NSString *> *)members {
     DDLogVerbose(@"%@ exportWithName %@ subject: %@ names: %@ usedNames: %@ members: %@", LOG_TAG, name, subject, names, usedNames, members);
 
     id<TLConversation> conversation = [self.conversationService getConversationWithSubject:subject];
@@ -347,17 +578,22 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
     }
     NSUUID *twincodeOutboundId = conversation.twincodeOutboundId;
 
+    // Conversation already saved in the archive by an interrupted export.
+    if (self.exportEnabled && [self.checkpoint isExportedWithConversationId:subject.objectId]) {
+        return;
+    }
+
     if (members) {
         for (NSUUID *memberId in members) {
             NSString *name = members[memberId];
             if (name) {
-                [names setObject:[self buildNameWithName:name usedNames:usedNames] forKey:memberId];
+                [names setObject:[usedNames uniqueNameWithName:name] forKey:memberId];
             }
         }
     }
 
     self.stats.conversationCount++;
-    [self.delegate onProgressWithState:self.state stats:self.stats];
+    [self reportProgress];
 
     self.dirCreated = NO;
     self.dirName = name;
@@ -413,7 +649,7 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
                     if (!self.delegate) {
                         return;
                     }
-                    [self.delegate onProgressWithState:self.state stats:self.stats];
+                    [self reportProgress];
                 }
 
             } else {
@@ -471,7 +707,7 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
                     if (!self.delegate) {
                         return;
                     }
-                    [self.delegate onProgressWithState:self.state stats:self.stats];
+                    [self reportProgress];
                 }
             }
 
@@ -483,6 +719,64 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
         [self exportMessages];
         self.descriptors = nil;
     }
+
+    // Nothing was written when the directory was not created.
+    if (self.exportEnabled && self.dirCreated && self.state != TLExportStateError) {
+        [self checkpointWithSubject:subject];
+    }
+}
+
+- (void)checkpointWithSubject:(nonnull id<TLRepositoryObject>)subject {
+    DDLogVerbose(@"%@ checkpointWithSubject: %@", LOG_TAG, subject);
+
+    if (!self.zip || !self.checkpoint) {
+        return;
+    }
+
+    // Closing the archive writes the central directory and re-opening it reads it again:
+    // do it only when enough was exported since the previous checkpoint.
+    [self.checkpoint addWithConversationId:subject.objectId];
+    int64_t size = [self exportedSize];
+    uint64_t now = [self now];
+    if (size - self.checkpointSize < self.checkpointMaxSize && now - self.checkpointTime < self.checkpointMaxDelay) {
+        return;
+    }
+    self.checkpointSize = size;
+    self.checkpointTime = now;
+
+    if (![self.zip close]) {
+        self.zip = nil;
+        [self errorWithMessage:@"closing zip with error"];
+        return;
+    }
+
+    if (![self.checkpoint saveWithStats:self.stats]) {
+        DDLogWarn(@"%@ cannot save checkpoint after %@", LOG_TAG, subject.objectId);
+    }
+
+    self.zip = [[SSZipArchive alloc] initWithPath:self.checkpoint.zipPath];
+    if (![self.zip openForAppending]) {
+        self.zip = nil;
+        [self errorWithMessage:@"cannot re-open zip"];
+    }
+}
+
+- (nonnull NSString *)selection {
+
+    NSMutableString *selection = [[NSMutableString alloc] init];
+    [selection appendFormat:@"%lld:%@:%d\n", self.dateFilter, [self.typeFilter componentsJoinedByString:@","], self.addSpacePrefix];
+    NSMutableArray<NSString *> *lines = [[NSMutableArray alloc] initWithCapacity:self.dirNames.count];
+    for (NSUUID *key in self.dirNames) {
+        [lines addObject:[NSString stringWithFormat:@"%@=%@", key.UUIDString, self.dirNames[key]]];
+    }
+    [lines sortUsingSelector:@selector(compare:)];
+    [selection appendString:[lines componentsJoinedByString:@"\n"]];
+    return selection;
+}
+
+- (int64_t)exportedSize {
+
+    return self.stats.imageSize + self.stats.videoSize + self.stats.audioSize + self.stats.fileSize;
 }
 
 - (void)exportWithObjectDescriptor:(nonnull TLObjectDescriptor *)objectDescriptor senderName:(nonnull NSString *)senderName {
@@ -522,19 +816,21 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
             }
         }];
 
-        NSMutableString *messages = [[NSMutableString alloc] initWithCapacity:MESSAGE_BUFFER_SIZE];
+        // The transcript and its UTF-8 buffer are re-used for each conversation.
+        if (!self.transcript) {
+            self.transcript = [[TLExportTranscript alloc] init];
+        }
+        TLExportTranscript *transcript = self.transcript;
         for (TLExportInfo *info in self.descriptors) {
-            NSDate *date = [[NSDate alloc] initWithTimeIntervalSince1970:info.date / 1000L];
-            NSString *localizedDateTime = [NSDateFormatter localizedStringFromDate:date dateStyle:NSDateFormatterMediumStyle timeStyle:NSDateFormatterShortStyle];
-
-            [messages appendFormat:@"[%@] %@\r\n", localizedDateTime, info.text];
+            [transcript appendWithDate:info.date text:info.text];
         }
 
         NSString *fileName = [NSString stringWithFormat:@"%@/messages.txt", self.dirName];
-        NSData *data = [messages dataUsingEncoding:NSUTF8StringEncoding];
-        if (![self.zip writeData:data filename:fileName compressionLevel:Z_DEFAULT_COMPRESSION password:self.password AES:self.password != nil]) {
+        self.stats.deflateCount++;
+        if (![self.zip writeData:transcript.data filename:fileName compressionLevel:Z_DEFAULT_COMPRESSION password:self.password AES:self.password != nil]) {
             [self errorWithMessage:@"cannot write ZIP entry"];
         }
+        [transcript reset];
     }
 }
 
@@ -554,12 +850,83 @@ static const int EXPORT_TYPES_COUNT = sizeof(EXPORT_TYPES) / sizeof(EXPORT_TYPES
         NSString *suffix = thumbnail ? @"-thumbnail" : @"";
         NSString *fileName = [NSString stringWithFormat:@"%@/%@_%lld%@.%@", self.dirName, senderName, descriptorId.sequenceId, suffix, ext];
         [self.descriptors addObject:[[TLExportInfo alloc] initWithDate:fileDescriptor.createdTimestamp text:[NSString stringWithFormat:@"%@: %@ <%@_%lld.%@>", senderName, TwinmeLocalizedString(@"File", nil), senderName, descriptorId.sequenceId, ext]]];
-        if (![self.zip writeFileAtPath:path withFileName:fileName compressionLevel:Z_DEFAULT_COMPRESSION password:self.password AES:self.password != nil]) {
+        int level = [self compressionLevelWithType:[fileDescriptor getType] path:path ext:ext];
+        if (![self.zip writeFileAtPath:path withFileName:fileName compressionLevel:level password:self.password AES:self.password != nil]) {
             [self errorWithMessage:@"cannot write ZIP entry"];
         }
     }
 }
 
++ (int)compressionLevelWithType:(TLDescriptorType)type path:(nonnull NSString *)path ext:(nonnull NSString *)ext {
+    DDLogVerbose(@"%@ compressionLevelWithType: %d path: %@ ext: %@", LOG_TAG, type, path, ext);
+
+    static NSSet<NSString *> *COMPRESSED_EXTENSIONS = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        COMPRESSED_EXTENSIONS = [NSSet setWithArray:@[
+            // Images
+            @"jpg", @"jpeg", @"heic", @"heif", @"png", @"gif", @"webp",
+            // Video and audio
+            @"mp4", @"m4v", @"mov", @"3gp", @"webm", @"mkv", @"m4a", @"aac", @"mp3", @"ogg", @"opus", @"amr",
+            // Archives and documents which are ZIP files
+            @"zip", @"gz", @"bz2", @"xz", @"7z", @"rar", @"docx", @"xlsx", @"pptx", @"odt", @"ods", @"odp", @"epub", @"apk", @"ipa"
+        ]];
+    });
+
+    int level;
+    if ([COMPRESSED_EXTENSIONS containsObject:[ext lowercaseString]]) {
+        level = 0;
+    } else {
+        double entropy = 8.0;
+        NSFileHandle *file = [NSFileHandle fileHandleForReadingAtPath:path];
+        if (file) {
+            NSData *probe = [file readDataOfLength:COMPRESSION_PROBE_SIZE];
+            [file closeFile];
+
+            NSUInteger length = probe.length;
+            if (length > 0) {
+                NSUInteger counts[256] = { 0 };
+                const uint8_t *bytes = probe.bytes;
+                for (NSUInteger i = 0; i < length; i++) {
+                    counts[bytes[i]]++;
+                }
+                entropy = 0.0;
+                for (int i = 0; i < 256; i++) {
+                    if (counts[i] > 0) {
+                        double p = (double)counts[i] / (double)length;
+                        entropy -= p * log2(p);
+                    }
+                }
+            }
+        }
+
+        // Media with an unknown extension are also most likely compressed.
+        BOOL isMedia = type == TLDescriptorTypeImageDescriptor || type == TLDescriptorTypeVideoDescriptor || type == TLDescriptorTypeAudioDescriptor;
+        if (entropy >= STORE_ENTROPY_THRESHOLD) {
+            level = 0;
+        } else if (entropy >= FAST_ENTROPY_THRESHOLD || isMedia) {
+            level = Z_BEST_SPEED;
+        } else {
+            level = Z_DEFAULT_COMPRESSION;
+        }
+    }
+    return level;
+}
+
+- (int)compressionLevelWithType:(TLDescriptorType)type path:(nonnull NSString *)path ext:(nonnull NSString *)ext {
+    DDLogVerbose(@"%@ compressionLevelWithType: %d path: %@ ext: %@", LOG_TAG, type, path, ext);
+
+    int level = [TLExporter compressionLevelWithType:type path:path ext:ext];
+    if (level == 0) {
+        self.stats.storedCount++;
+    } else if (level == Z_BEST_SPEED) {
+        self.stats.fastCount++;
+    } else {
+        self.stats.deflateCount++;
+    }
+    return level;
+}
+
 - (void)exportWithNameDescriptor:(nonnull TLNamedFileDescriptor *)namedFileDescriptor senderName:(nonnull NSString *)senderName {
     DDLogVerbose(@"%@ exportWithNameDescriptor %@ senderName: %@", LOG_TAG, namedFileDescriptor, senderName);
 
@@ -46,6 +46,24 @@
     return [interval containsDate:date];
 }
 
+- (long)nextTransitionAfter:(long)timestamp timeZone:(nonnull NSTimeZone *)timeZone {
+    long start = (long)[self.start toNSDateWithTimeZone:timeZone].timeIntervalSince1970;
+    long end = (long)[self.end toNSDateWithTimeZone:timeZone].timeIntervalSince1970;
+    
+    if(start > end){
+        return TIME_RANGE_NO_TRANSITION;
+    }
+    
+    // The range includes its end: we leave it one second after.
+    if(timestamp < start){
+        return start;
+    }
+    if(timestamp <= end){
+        return end + 1;
+    }
+    return TIME_RANGE_NO_TRANSITION;
+}
+
 - (nonnull NSString *)serialize {
     return [NSString stringWithFormat:@"%@,%@,%@", DATE_TIME_RANGE_SERIALIZATION_PREFIX, [self.start toString], [self.end toString]];
 }
@@ -26,4 +26,8 @@
 
 - (BOOL) isTimestampInRangeWithTimestamp:(long)timestamp;
 
+/// Get the first timestamp after `timestamp` for which isTimestampInRangeWithTimestamp returns
+/// a different value, or TIME_RANGE_NO_TRANSITION when the schedule never changes.
+- (long) nextTransitionAfter:(long)timestamp;
+
 @end
@@ -14,10 +14,19 @@
 #define CAP_NAME_TIME_RANGE @"tr"
 #define CAP_SEPARATOR @";"
 
+/// Period for which the transitions are computed at once.
+#define COMPILE_PERIOD (8 * 86400L)
+#define MAX_COMPILE_STEPS 1024
+
 @implementation TLSchedule {
     /// Backing mutable array for timeRanges property
     NSMutableArray *_timeRanges;
     NSTimeZone *_timeZone;
+    
+    /// Sorted transitions in ]_compiledFrom, _compiledTo] (nil when they must be computed again).
+    NSData *_transitions;
+    long _compiledFrom;
+    long _compiledTo;
 }
 
 
@@ -36,6 +45,7 @@
     @synchronized (self) {
         [_timeRanges addObject:timeRange];
         [self sortTimeRanges];
+        _transitions = nil;
     }
 }
 
@@ -43,6 +53,14 @@
     @synchronized (self) {
         _timeRanges = [timeRanges mutableCopy];
         [self sortTimeRanges];
+        _transitions = nil;
+    }
+}
+
+- (void) setEnabled:(BOOL)enabled {
+    @synchronized (self) {
+        _enabled = enabled;
+        _transitions = nil;
     }
 }
 
@@ -55,6 +73,7 @@
 - (void) setTimeZone:(nonnull NSTimeZone *)timeZone{
     @synchronized (self) {
         _timeZone = timeZone;
+        _transitions = nil;
     }
 }
 
@@ -83,6 +102,87 @@
     return NO;
 }
 
+- (long)nextTransitionAfter:(long)timestamp {
+    
+    @synchronized (self) {
+        if(!_enabled){
+            return TIME_RANGE_NO_TRANSITION;
+        }
+        
+        if(!_transitions || timestamp < _compiledFrom || timestamp >= _compiledTo){
+            [self compileTransitionsFrom:timestamp];
+        }
+        
+        for(int step = 0; step < MAX_COMPILE_STEPS; step++){
+            // Binary search of the first transition after the timestamp.
+            const long *transitions = _transitions.bytes;
+            NSUInteger count = _transitions.length / sizeof(long);
+            NSUInteger low = 0, high = count;
+            while(low < high){
+                NSUInteger mid = (low + high) / 2;
+                if(transitions[mid] <= timestamp){
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            if(low < count){
+                return transitions[low];
+            }
+            if(_compiledTo == TIME_RANGE_NO_TRANSITION){
+                return TIME_RANGE_NO_TRANSITION;
+            }
+            
+            // Nothing changes until the end of the compiled period, look at the next one.
+            [self compileTransitionsFrom:_compiledTo];
+        }
+        return TIME_RANGE_NO_TRANSITION;
+    }
+}
+
+/// Compute the transitions of the schedule which occur after `from` for at least COMPILE_PERIOD.
+/// The transitions of the time ranges are merged: entering a range while another one is active is not a transition.
+- (void)compileTransitionsFrom:(long)from {
+    
+    NSMutableData *transitions = [[NSMutableData alloc] init];
+    long horizon = from > TIME_RANGE_NO_TRANSITION - COMPILE_PERIOD ? TIME_RANGE_NO_TRANSITION : from + COMPILE_PERIOD;
+    BOOL inRange = [self isInTimeRangesWithTimestamp:from];
+    long timestamp = from;
+    
+    while(timestamp < horizon){
+        long next = TIME_RANGE_NO_TRANSITION;
+        for(id<TLTimeRange> timeRange in _timeRanges){
+            next = MIN(next, [timeRange nextTransitionAfter:timestamp timeZone:_timeZone]);
+        }
+        if(next == TIME_RANGE_NO_TRANSITION){
+            timestamp = TIME_RANGE_NO_TRANSITION;
+            break;
+        }
+        
+        BOOL nextInRange = [self isInTimeRangesWithTimestamp:next];
+        if(nextInRange != inRange){
+            [transitions appendBytes:&next length:sizeof(long)];
+            inRange = nextInRange;
+        }
+        timestamp = next;
+    }
+    
+    // All the transitions in ]from, timestamp] are known.
+    _transitions = transitions;
+    _compiledFrom = from;
+    _compiledTo = timestamp;
+}
+
+- (BOOL)isInTimeRangesWithTimestamp:(long)timestamp {
+    
+    for (id<TLTimeRange> timeRange in _timeRanges) {
+        if([timeRange isTimestampInRangeWithTimeStamp:timestamp timeZone:_timeZone]){
+            return YES;
+        }
+    }
+    return NO;
+}
+
 + (nullable instancetype)ofCapabilityWithCapabilityString:(nonnull NSString *)capability {
     NSArray<NSString *> *split = [capability componentsSeparatedByString:CAP_SEPARATOR];
     
@@ -12,6 +12,9 @@
 #define DATE_TIME_RANGE_SERIALIZATION_PREFIX @"dateTime"
 #define WEEKLY_TIME_RANGE_SERIALIZATION_PREFIX @"weekly"
 
+/// Value returned by nextTransitionAfter when the range never changes after the timestamp.
+#define TIME_RANGE_NO_TRANSITION LONG_MAX
+
 //
 // Interface TLTimeRange
 //
@@ -20,6 +23,10 @@
 
 - (BOOL) isTimestampInRangeWithTimeStamp:(long)timestamp timeZone:(nonnull NSTimeZone *)timeZone;
 
+/// Get the first timestamp after `timestamp` for which isTimestampInRangeWithTimeStamp returns
+/// a different value, or TIME_RANGE_NO_TRANSITION.
+- (long) nextTransitionAfter:(long)timestamp timeZone:(nonnull NSTimeZone *)timeZone;
+
 - (NSComparisonResult) compare:(nonnull id<TLTimeRange>)timeRange;
 
 @end
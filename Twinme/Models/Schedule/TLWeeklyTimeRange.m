@@ -9,6 +9,14 @@
 #import <Foundation/NSCalendar.h>
 #import "TLTimeRange.h"
 
+#define WEEKLY_TRANSITION_DAYS 8
+
+static int compareTimestamps(const void *a, const void *b) {
+    long ta = *(const long *)a;
+    long tb = *(const long *)b;
+    return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
 @implementation TLWeeklyTimeRange: NSObject
 
 - (nonnull instancetype)initWithDays:(nonnull NSArray<NSNumber *> *)days start:(nonnull TLTime *)start end:(nonnull TLTime *)end {
@@ -46,30 +54,73 @@
 }
 
 - (BOOL)isTimestampInRangeWithTimeStamp:(long)timestamp timeZone:(nonnull NSTimeZone *)timeZone {
+    return [self isTimestampInRangeWithTimeStamp:timestamp calendar:[TLWeeklyTimeRange calendarWithTimeZone:timeZone]];
+}
+
+- (BOOL)isTimestampInRangeWithTimeStamp:(long)timestamp calendar:(nonnull NSCalendar *)calendar {
     NSDate* date = [[NSDate alloc] initWithTimeIntervalSince1970:timestamp];
 
-    TLDayOfWeek day = [TLWeeklyTimeRange getDayOfWeekWithDate:date timeZone:timeZone];
+    TLDayOfWeek day = [TLWeeklyTimeRange getDayOfWeekWithDate:date calendar:calendar];
     
     if(![self.days containsObject:[NSNumber numberWithInt:day]]){
         return NO;
     }
     
-    NSDate *start = [TLWeeklyTimeRange copyDateWithNSDate:date time:self.start timeZone:timeZone];
-    NSDate *end = [TLWeeklyTimeRange copyDateWithNSDate:date time:self.end timeZone:timeZone];
+    NSDate *start = [TLWeeklyTimeRange copyDateWithNSDate:date time:self.start calendar:calendar];
+    NSDate *end = [TLWeeklyTimeRange copyDateWithNSDate:date time:self.end calendar:calendar];
         
     NSDateInterval *interval = [[NSDateInterval alloc] initWithStartDate:start endDate:end];
     
     return [interval containsDate:date];
 }
 
+- (long)nextTransitionAfter:(long)timestamp timeZone:(nonnull NSTimeZone *)timeZone {
+    // The same calendar is used for all the candidates.
+    NSCalendar *gregorian = [TLWeeklyTimeRange calendarWithTimeZone:timeZone];
+    
+    // The range can only change at the start and end of each day, at the start of the day
+    // and, when a DST change moves the end after midnight, at the start of the next day.
+    // Look at the current day and the next 8 days to cover a full week.
+    long candidates[3 * (WEEKLY_TRANSITION_DAYS + 1)];
+    int count = 0;
+    NSDate *day = [gregorian startOfDayForDate:[[NSDate alloc] initWithTimeIntervalSince1970:timestamp]];
+    for(int i = 0; i <= WEEKLY_TRANSITION_DAYS; i++){
+        candidates[count++] = (long)day.timeIntervalSince1970;
+        candidates[count++] = (long)[TLWeeklyTimeRange copyDateWithNSDate:day time:self.start calendar:gregorian].timeIntervalSince1970;
+        candidates[count++] = (long)[TLWeeklyTimeRange copyDateWithNSDate:day time:self.end calendar:gregorian].timeIntervalSince1970 + 1;
+        
+        // Use the noon of the day to move to the next day in case of DST change.
+        NSDate *noon = [gregorian dateBySettingHour:12 minute:0 second:0 ofDate:day options:0];
+        day = [gregorian startOfDayForDate:[gregorian dateByAddingUnit:NSCalendarUnitDay value:1 toDate:noon options:0]];
+    }
+    qsort(candidates, count, sizeof(long), compareTimestamps);
+    
+    BOOL inRange = [self isTimestampInRangeWithTimeStamp:timestamp calendar:gregorian];
+    for(int i = 0; i < count; i++){
+        if(candidates[i] > timestamp && (i == 0 || candidates[i] != candidates[i - 1])
+           && [self isTimestampInRangeWithTimeStamp:candidates[i] calendar:gregorian] != inRange){
+            return candidates[i];
+        }
+    }
+    return TIME_RANGE_NO_TRANSITION;
+}
+
 - (nonnull NSString *)serialize {
     NSString *days = [self.days componentsJoinedByString:@"-"];
     return [NSString stringWithFormat:@"%@,%@,%@,%@", WEEKLY_TIME_RANGE_SERIALIZATION_PREFIX, days, [self.start toString], [self.end toString]];
 }
 
-+ (TLDayOfWeek)getDayOfWeekWithDate:(nonnull NSDate *)date timeZone:(nonnull NSTimeZone *)timeZone {
++ (nonnull NSCalendar *)calendarWithTimeZone:(nonnull NSTimeZone *)timeZone {
     NSCalendar *gregorian = [[NSCalendar alloc] initWithCalendarIdentifier:NSCalendarIdentifierGregorian];
     gregorian.timeZone = timeZone;
+    return gregorian;
+}
+
++ (TLDayOfWeek)getDayOfWeekWithDate:(nonnull NSDate *)date timeZone:(nonnull NSTimeZone *)timeZone {
+    return [TLWeeklyTimeRange getDayOfWeekWithDate:date calendar:[TLWeeklyTimeRange calendarWithTimeZone:timeZone]];
+}
+
++ (TLDayOfWeek)getDayOfWeekWithDate:(nonnull NSDate *)date calendar:(nonnull NSCalendar *)gregorian {
     int weekday = (int) [gregorian component:NSCalendarUnitWeekday fromDate:date];
     
     // NSCalendarUnitWeekdays starts with Sunday whereas TLDayOfWeek starts with Monday
@@ -81,8 +132,10 @@
 }
 
 + (nonnull NSDate *)copyDateWithNSDate:(nonnull NSDate *)date time:(nonnull TLTime *)time timeZone:(nonnull NSTimeZone *)timeZone{
-    NSCalendar *gregorian = [[NSCalendar alloc] initWithCalendarIdentifier:NSCalendarIdentifierGregorian];
-    gregorian.timeZone = timeZone;
+    return [TLWeeklyTimeRange copyDateWithNSDate:date time:time calendar:[TLWeeklyTimeRange calendarWithTimeZone:timeZone]];
+}
+
++ (nonnull NSDate *)copyDateWithNSDate:(nonnull NSDate *)date time:(nonnull TLTime *)time calendar:(nonnull NSCalendar *)gregorian{
     NSDateComponents *comps = [gregorian components:(NSCalendarUnitYear | NSCalendarUnitMonth |  NSCalendarUnitDay) fromDate:date ];
 
     comps.hour = time.hour;
@@ -181,21 +181,24 @@ static TLContactFactory *factory;
         twincodeFactoryId = self.twincodeFactoryId;
         hasPrivatePeer = self.hasPrivatePeerTwincode;
     }
-    NSMutableArray *attributes = [NSMutableArray array];
-    if (exportAll) {
-        [self exportAttributes:attributes name:name description:description twincodeInbound:twincodeInbound twincodeOutbound:twincodeOutbound twincodeFactoryId:twincodeFactoryId space:space];
-
-        if (peerTwincodeOutbound) {
-            [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"privatePeerTwincodeOutboundId" stringValue:peerTwincodeOutbound.uuid.UUIDString]];
+    __unsafe_unretained id values[] = { name, description, space, twincodeInbound, twincodeOutbound, twincodeFactoryId, publicPeerTwincodeOutboundId, peerTwincodeOutbound, hasPrivatePeer ? @YES : @NO };
+    return [self attributesWithAll:exportAll values:values count:sizeof(values) / sizeof(values[0]) builder:^NSArray<TLAttributeNameValue *> * {
+        NSMutableArray *attributes = [NSMutableArray array];
+        if (exportAll) {
+            [self exportAttributes:attributes name:name description:description twincodeInbound:twincodeInbound twincodeOutbound:twincodeOutbound twincodeFactoryId:twincodeFactoryId space:space];
+
+            if (peerTwincodeOutbound) {
+                [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"privatePeerTwincodeOutboundId" stringValue:peerTwincodeOutbound.uuid.UUIDString]];
+            }
         }
-    }
-    if (publicPeerTwincodeOutboundId) {
-        [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"publicPeerTwincodeOutboundId" stringValue:publicPeerTwincodeOutboundId.UUIDString]];
-    }
-    if (!hasPrivatePeer) {
-        [attributes addObject:[[TLAttributeNameBooleanValue alloc] initWithName:@"noPrivatePeer" boolValue:true]];
-    }
-    return attributes;
+        if (publicPeerTwincodeOutboundId) {
+            [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"publicPeerTwincodeOutboundId" stringValue:publicPeerTwincodeOutboundId.UUIDString]];
+        }
+        if (!hasPrivatePeer) {
+            [attributes addObject:[[TLAttributeNameBooleanValue alloc] initWithName:@"noPrivatePeer" boolValue:true]];
+        }
+        return attributes;
+    }];
 }
 
 - (void)setTwincodeOutbound:(nullable TLTwincodeOutbound *)identityTwincodeOutbound {
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <Twinlife/TLConversationService.h>
+
+@class TLFilter;
+@class TLConversationDescriptorPair;
+
+//
+// Interface: TLConversationDescriptorDelta
+//
+
+/**
+ * Changes of the conversation list between two versions of a TLConversationDescriptorSnapshot.
+ */
+@interface TLConversationDescriptorDelta : NSObject
+
+/// The snapshot version after the delta is applied.
+@property (readonly) int64_t version;
+
+/// The conversations which are new in the list.
+@property (readonly, nonnull) NSArray<TLConversationDescriptorPair *> *inserted;
+
+/// The conversations whose last descriptor was changed or updated.
+@property (readonly, nonnull) NSArray<TLConversationDescriptorPair *> *updated;
+
+/// The conversations which are no longer in the list.
+@property (readonly, nonnull) NSArray<NSUUID *> *removed;
+
+- (nonnull instancetype)initWithVersion:(int64_t)version inserted:(nonnull NSArray<TLConversationDescriptorPair *> *)inserted updated:(nonnull NSArray<TLConversationDescriptorPair *> *)updated removed:(nonnull NSArray<NSUUID *> *)removed;
+
+- (BOOL)isEmpty;
+
+@end
+
+//
+// Interface: TLConversationDescriptorSnapshot
+//
+
+/**
+ * Last descriptor of each conversation as known by the caller of findConversationDescriptorsWithSnapshot.
+ *
+ * - the snapshot is created with the filter and calls mode of the conversation list and it starts at version 0,
+ * - each call to findConversationDescriptorsWithSnapshot brings the snapshot to the current version of the twinme
+ *   context and returns only the conversations that were inserted, updated or removed since the previous version,
+ * - the snapshot is updated from the twinlife queue and it must not be shared between several conversation lists.
+ */
+@interface TLConversationDescriptorSnapshot : NSObject
+
+@property (readonly) int64_t version;
+@property (readonly, nonnull) TLFilter *filter;
+@property (readonly) TLDisplayCallsMode callsMode;
+
+- (nonnull instancetype)initWithFilter:(nonnull TLFilter *)filter callsMode:(TLDisplayCallsMode)callsMode;
+
+/// The conversations and their last descriptor at the snapshot version.
+- (nonnull NSArray<TLConversationDescriptorPair *> *)list;
+
+/**
+ * Bring the snapshot to the given version from a full list of conversation descriptors.
+ *
+ * @param list the last descriptor of each conversation at the new version.
+ * @param version the new version.
+ * @param dirtyConversations the subject ids of the conversations changed since the snapshot version or nil if they are not known.
+ * @return the changes between the snapshot version and the new version.
+ */
+- (nonnull TLConversationDescriptorDelta *)updateWithList:(nonnull NSArray<TLConversationDescriptorPair *> *)list version:(int64_t)version dirtyConversations:(nullable NSSet<NSUUID *> *)dirtyConversations;
+
+/**
+ * Bring the snapshot to the given version when no conversation was changed.
+ *
+ * @param version the new version.
+ * @return an empty delta.
+ */
+- (nonnull TLConversationDescriptorDelta *)updateWithVersion:(int64_t)version;
+
+@end
+
+//
+// Interface: TLConversationChanges
+//
+
+/**
+ * Version of the conversation list and the conversations changed at each version.
+ *
+ * - every change of a conversation increments the version and records the contact or group subject id,
+ * - a conversation which is added or removed only increments the version: the snapshot finds it from the list,
+ * - at most `capacity` subjects are remembered, the snapshots older than the oldest remembered change
+ *   consider that every conversation was changed.
+ */
+@interface TLConversationChanges : NSObject
+
+@property (readonly) int64_t version;
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/// Record a change of the conversations of the subject or only increment the version when the subject is nil.
+- (void)markWithSubjectId:(nullable NSUUID *)subjectId;
+
+/// The subject ids changed after the version or nil when they are no longer known.
+- (nullable NSSet<NSUUID *> *)subjectIdsSinceVersion:(int64_t)version;
+
+/// Forget the changes and increment the version.
+- (void)reset;
+
+@end
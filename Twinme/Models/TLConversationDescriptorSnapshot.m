@@ -0,0 +1,241 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import <Twinlife/TLConversationService.h>
+#import <Twinlife/TLFilter.h>
+#import <Twinlife/TLRepositoryService.h>
+
+#import "TLConversationDescriptorSnapshot.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Implementation: TLConversationDescriptorDelta
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLConversationDescriptorDelta"
+
+@implementation TLConversationDescriptorDelta
+
+- (nonnull instancetype)initWithVersion:(int64_t)version inserted:(nonnull NSArray<TLConversationDescriptorPair *> *)inserted updated:(nonnull NSArray<TLConversationDescriptorPair *> *)updated removed:(nonnull NSArray<NSUUID *> *)removed {
+    DDLogVerbose(@"%@ initWithVersion: %lld inserted: %lu updated: %lu removed: %lu", LOG_TAG, version, (unsigned long)inserted.count, (unsigned long)updated.count, (unsigned long)removed.count);
+
+    self = [super init];
+    if (self) {
+        _version = version;
+        _inserted = inserted;
+        _updated = updated;
+        _removed = removed;
+    }
+    return self;
+}
+
+- (BOOL)isEmpty {
+
+    return self.inserted.count == 0 && self.updated.count == 0 && self.removed.count == 0;
+}
+
+- (nonnull NSString *)description {
+
+    return [NSString stringWithFormat:@"TLConversationDescriptorDelta[version=%lld inserted=%lu updated=%lu removed=%lu]", self.version, (unsigned long)self.inserted.count, (unsigned long)self.updated.count, (unsigned long)self.removed.count];
+}
+
+@end
+
+//
+// Interface: TLConversationDescriptorSnapshot ()
+//
+
+@interface TLConversationDescriptorSnapshot ()
+
+@property int64_t version;
+@property (nonnull) NSMutableDictionary<NSUUID *, TLConversationDescriptorPair *> *pairs;
+
+@end
+
+//
+// Implementation: TLConversationDescriptorSnapshot
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLConversationDescriptorSnapshot"
+
+@implementation TLConversationDescriptorSnapshot
+
+- (nonnull instancetype)initWithFilter:(nonnull TLFilter *)filter callsMode:(TLDisplayCallsMode)callsMode {
+    DDLogVerbose(@"%@ initWithFilter: %@ callsMode: %d", LOG_TAG, filter, callsMode);
+
+    self = [super init];
+    if (self) {
+        _version = 0;
+        _filter = filter;
+        _callsMode = callsMode;
+        _pairs = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (nonnull NSArray<TLConversationDescriptorPair *> *)list {
+    DDLogVerbose(@"%@ list", LOG_TAG);
+
+    return [self.pairs allValues];
+}
+
+- (nonnull TLConversationDescriptorDelta *)updateWithList:(nonnull NSArray<TLConversationDescriptorPair *> *)list version:(int64_t)version dirtyConversations:(nullable NSSet<NSUUID *> *)dirtyConversations {
+    DDLogVerbose(@"%@ updateWithList: %lu version: %lld dirtyConversations: %lu", LOG_TAG, (unsigned long)list.count, version, (unsigned long)dirtyConversations.count);
+
+    NSMutableArray<TLConversationDescriptorPair *> *inserted = [[NSMutableArray alloc] init];
+    NSMutableArray<TLConversationDescriptorPair *> *updated = [[NSMutableArray alloc] init];
+    NSMutableDictionary<NSUUID *, TLConversationDescriptorPair *> *pairs = [[NSMutableDictionary alloc] initWithCapacity:list.count];
+
+    for (TLConversationDescriptorPair *pair in list) {
+        NSUUID *conversationId = pair.conversation.uuid;
+        TLConversationDescriptorPair *previous = self.pairs[conversationId];
+
+        pairs[conversationId] = pair;
+        if (!previous) {
+            [inserted addObject:pair];
+            continue;
+        }
+        [self.pairs removeObjectForKey:conversationId];
+
+        // Without the dirty conversations, we cannot tell whether the descriptor content was updated.
+        if (!dirtyConversations || [dirtyConversations containsObject:pair.conversation.subject.objectId]) {
+            [updated addObject:pair];
+
+        } else if (previous.descriptor != pair.descriptor && ![previous.descriptor.descriptorId isEqual:pair.descriptor.descriptorId]) {
+            [updated addObject:pair];
+        }
+    }
+
+    // What remains of the previous list are the conversations that are removed.
+    NSArray<NSUUID *> *removed = [self.pairs allKeys];
+    self.pairs = pairs;
+    self.version = version;
+    return [[TLConversationDescriptorDelta alloc] initWithVersion:version inserted:inserted updated:updated removed:removed];
+}
+
+- (nonnull TLConversationDescriptorDelta *)updateWithVersion:(int64_t)version {
+    DDLogVerbose(@"%@ updateWithVersion: %lld", LOG_TAG, version);
+
+    self.version = version;
+    return [[TLConversationDescriptorDelta alloc] initWithVersion:version inserted:@[] updated:@[] removed:@[]];
+}
+
+- (nonnull NSString *)description {
+
+    return [NSString stringWithFormat:@"TLConversationDescriptorSnapshot[version=%lld count=%lu]", self.version, (unsigned long)self.pairs.count];
+}
+
+@end
+
+//
+// Interface: TLConversationChanges ()
+//
+
+@interface TLConversationChanges ()
+
+@property int64_t version;
+@property int64_t resetVersion;
+@property (readonly) NSUInteger capacity;
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, NSNumber *> *subjects;
+
+@end
+
+//
+// Implementation: TLConversationChanges
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLConversationChanges"
+
+@implementation TLConversationChanges
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity {
+    DDLogVerbose(@"%@ initWithCapacity: %lu", LOG_TAG, (unsigned long)capacity);
+
+    self = [super init];
+    if (self) {
+        _version = 1;
+        _resetVersion = 1;
+        _capacity = capacity;
+        _subjects = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (int64_t)version {
+
+    @synchronized (self) {
+        return _version;
+    }
+}
+
+- (void)markWithSubjectId:(nullable NSUUID *)subjectId {
+    DDLogVerbose(@"%@ markWithSubjectId: %@", LOG_TAG, subjectId);
+
+    @synchronized (self) {
+        _version++;
+        if (!subjectId) {
+            return;
+        }
+
+        // Forget the oldest changes when there are too many.
+        if (self.subjects.count >= self.capacity && !self.subjects[subjectId]) {
+            [self.subjects removeAllObjects];
+            self.resetVersion = _version;
+        }
+        self.subjects[subjectId] = [NSNumber numberWithLongLong:_version];
+    }
+}
+
+- (nullable NSSet<NSUUID *> *)subjectIdsSinceVersion:(int64_t)version {
+    DDLogVerbose(@"%@ subjectIdsSinceVersion: %lld", LOG_TAG, version);
+
+    @synchronized (self) {
+        if (version < self.resetVersion) {
+            return nil;
+        }
+
+        NSMutableSet<NSUUID *> *result = [[NSMutableSet alloc] init];
+        if (version < _version) {
+            [self.subjects enumerateKeysAndObjectsUsingBlock:^(NSUUID *subjectId, NSNumber *subjectVersion, BOOL *stop) {
+                if (subjectVersion.longLongValue > version) {
+                    [result addObject:subjectId];
+                }
+            }];
+        }
+        return result;
+    }
+}
+
+- (void)reset {
+    DDLogVerbose(@"%@ reset", LOG_TAG);
+
+    @synchronized (self) {
+        [self.subjects removeAllObjects];
+        _version++;
+        self.resetVersion = _version;
+    }
+}
+
+- (nonnull NSString *)description {
+
+    @synchronized (self) {
+        return [NSString stringWithFormat:@"TLConversationChanges[version=%lld subjects=%lu]", _version, (unsigned long)self.subjects.count];
+    }
+}
+
+@end
@@ -163,20 +163,23 @@ static TLGroupFactory *factory;
         twincodeFactoryId = self.twincodeFactoryId;
         isLeaving = self.isLeaving;
     }
-    NSMutableArray *attributes = [NSMutableArray array];
-    if (exportAll) {
-        [self exportAttributes:attributes name:name description:description twincodeInbound:twincodeInbound twincodeOutbound:twincodeOutbound twincodeFactoryId:twincodeFactoryId space:space];
-        if (groupTwincodeOutbound) {
-            [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"groupTwincodeOutboundId" stringValue:groupTwincodeOutbound.uuid.UUIDString]];
+    __unsafe_unretained id values[] = { name, description, space, twincodeInbound, twincodeOutbound, twincodeFactoryId, groupTwincodeOutbound, groupTwincodeFactoryId, isLeaving ? @YES : @NO };
+    return [self attributesWithAll:exportAll values:values count:sizeof(values) / sizeof(values[0]) builder:^NSArray<TLAttributeNameValue *> * {
+        NSMutableArray *attributes = [NSMutableArray array];
+        if (exportAll) {
+            [self exportAttributes:attributes name:name description:description twincodeInbound:twincodeInbound twincodeOutbound:twincodeOutbound twincodeFactoryId:twincodeFactoryId space:space];
+            if (groupTwincodeOutbound) {
+                [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"groupTwincodeOutboundId" stringValue:groupTwincodeOutbound.uuid.UUIDString]];
+            }
         }
-    }
-    if (groupTwincodeFactoryId) {
-        [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"groupTwincodeFactoryId" stringValue:groupTwincodeFactoryId.UUIDString]];
-    }
-    if (isLeaving) {
-        [attributes addObject:[[TLAttributeNameBooleanValue alloc] initWithName:@"leaving" boolValue:true]];
-    }
-    return attributes;
+        if (groupTwincodeFactoryId) {
+            [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"groupTwincodeFactoryId" stringValue:groupTwincodeFactoryId.UUIDString]];
+        }
+        if (isLeaving) {
+            [attributes addObject:[[TLAttributeNameBooleanValue alloc] initWithName:@"leaving" boolValue:true]];
+        }
+        return attributes;
+    }];
 }
 
 - (void)setTwincodeOutbound:(nullable TLTwincodeOutbound *)identityTwincodeOutbound {
@@ -11,6 +11,7 @@
 #import <Twinlife/TLBinaryDecoder.h>
 
 #import "TLPushNotificationContent.h"
+#import "TLSliceDecoder.h"
 
 /**
  * <pre>
@@ -38,6 +39,14 @@ static NSUUID *TL_PUSH_NOTIFICATION_CONTENT_SCHEMA_ID = nil;
 static int TL_PUSH_NOTIFICATION_CONTENT_SCHEMA_VERSION = 1;
 static TLSerializer *TL_PUSH_NOTIFICATION_CONTENT_SERIALIZER = nil;
 
+//
+// Interface: TLPushNotificationContentSerializer ()
+//
+
+@interface TLPushNotificationContentSerializer () <TLSliceDeserializer>
+
+@end
+
 //
 // Implementation: TLPushNotificationContentSerializer
 //
@@ -150,6 +159,49 @@ static TLSerializer *TL_PUSH_NOTIFICATION_CONTENT_SERIALIZER = nil;
     return [[TLPushNotificationContent alloc] initWithSessionId:sessionId twincodeInboundId:twincodeInboundId priority:priority operation:operation];
 }
 
+- (nullable NSObject *)deserializeWithSliceDecoder:(nonnull TLSliceDecoder *)decoder {
+
+    // The priority and operation are compared on the original bytes.
+    NSUUID *sessionId = [decoder readUUID];
+    NSUUID *twincodeInboundId = [decoder readUUID];
+    TLDataSlice *value = [decoder readStringSlice];
+
+    TLPeerConnectionServiceNotificationPriority priority;
+
+    if ([value isEqualToUTF8String:"high"]) {
+        priority = TLPeerConnectionServiceNotificationPriorityHigh;
+    } else if ([value isEqualToUTF8String:"low"]) {
+        priority = TLPeerConnectionServiceNotificationPriorityLow;
+    } else {
+        priority = TLPeerConnectionServiceNotificationPriorityNotDefined;
+    }
+
+    value = [decoder readStringSlice];
+    TLPeerConnectionServiceNotificationOperation operation;
+
+    if ([value isEqualToUTF8String:"audio-call"]) {
+        operation = TLPeerConnectionServiceNotificationOperationAudioCall;
+    } else if ([value isEqualToUTF8String:"video-call"]) {
+        operation = TLPeerConnectionServiceNotificationOperationVideoCall;
+    } else if ([value isEqualToUTF8String:"video-bell"]) {
+        operation = TLPeerConnectionServiceNotificationOperationVideoBell;
+    } else if ([value isEqualToUTF8String:"push-message"]) {
+        operation = TLPeerConnectionServiceNotificationOperationPushMessage;
+    } else if ([value isEqualToUTF8String:"push-file"]) {
+        operation = TLPeerConnectionServiceNotificationOperationPushFile;
+    } else if ([value isEqualToUTF8String:"push-image"]) {
+        operation = TLPeerConnectionServiceNotificationOperationPushImage;
+    } else if ([value isEqualToUTF8String:"push-audio"]) {
+        operation = TLPeerConnectionServiceNotificationOperationPushAudio;
+    } else if ([value isEqualToUTF8String:"push-video"]) {
+        operation = TLPeerConnectionServiceNotificationOperationPushVideo;
+    } else {
+        operation = TLPeerConnectionServiceNotificationOperationNotDefined;
+    }
+
+    return [[TLPushNotificationContent alloc] initWithSessionId:sessionId twincodeInboundId:twincodeInboundId priority:priority operation:operation];
+}
+
 @end
 
 //
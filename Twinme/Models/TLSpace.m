@@ -120,19 +120,22 @@ static TLSpaceFactory *factory;
         spaceSettings = self.settings;
         profileId = self.profileId;
     }
-    NSMutableArray *attributes = [NSMutableArray array];
-    if (exportAll) {
-        if (spaceSettings) {
-            [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"settingsId" stringValue:spaceSettings.uuid.UUIDString]];
+    __unsafe_unretained id values[] = { twincodeOutbound, spaceSettings, profileId };
+    return [self attributesWithAll:exportAll values:values count:sizeof(values) / sizeof(values[0]) builder:^NSArray<TLAttributeNameValue *> * {
+        NSMutableArray *attributes = [NSMutableArray array];
+        if (exportAll) {
+            if (spaceSettings) {
+                [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"settingsId" stringValue:spaceSettings.uuid.UUIDString]];
+            }
+            if (twincodeOutbound) {
+                [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"spaceTwincodeId" stringValue:twincodeOutbound.uuid.UUIDString]];
+            }
         }
-        if (twincodeOutbound) {
-            [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"spaceTwincodeId" stringValue:twincodeOutbound.uuid.UUIDString]];
+        if (profileId) {
+            [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"profileId" stringValue:profileId.UUIDString]];
         }
-    }
-    if (profileId) {
-        [attributes addObject:[[TLAttributeNameStringValue alloc] initWithName:@"profileId" stringValue:profileId.UUIDString]];
-    }
-    return attributes;
+        return attributes;
+    }];
 }
 
 - (void)setPeerTwincodeOutbound:(nullable TLTwincodeOutbound *)peerTwincodeOutbound {
@@ -60,6 +60,10 @@
 
 - (void)setTwincodeFactory:(nonnull TLTwincodeFactory *)twincodeFactory;
 
+/// Get the attributes built by the builder the last time they were exported with the same flavor and
+/// the same values, or build them again.  The values are compared by identity.
+- (nonnull NSArray<TLAttributeNameValue *> *)attributesWithAll:(BOOL)exportAll values:(__unsafe_unretained id _Nullable const * _Nonnull)values count:(NSUInteger)count builder:(NS_NOESCAPE NSArray<TLAttributeNameValue *> * _Nonnull (^ _Nonnull)(void))builder;
+
 - (nullable TLImageId *)avatarId;
 
 - (nullable NSString *)identityName;
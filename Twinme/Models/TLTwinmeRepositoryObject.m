@@ -48,15 +48,124 @@
 
 @end
 
+//
+// Interface: TLTwinmeObjectState
+//
+
+/**
+ * Values of a TLTwinmeObject that are read by the getters without taking the object lock.
+ *
+ * A state is never modified once it is published: a setter copies the current state,
+ * changes the copy and publishes it while it holds the object lock.
+ */
+@interface TLTwinmeObjectState : NSObject <NSCopying>
+
+@property (nonatomic, nullable) TLTwincodeInbound *twincodeInbound;
+@property (nonatomic, nullable) TLTwincodeOutbound *twincodeOutbound;
+@property (nonatomic, nullable) TLTwincodeOutbound *peerTwincodeOutbound;
+@property (nonatomic, nullable) NSUUID *twincodeFactoryId;
+@property (nonatomic, nullable) NSString *name;
+@property (nonatomic, nullable) NSString *objectDescription;
+@property (nonatomic, nullable) TLSpace *space;
+
+@end
+
+//
+// Implementation: TLTwinmeObjectState
+//
+
+@implementation TLTwinmeObjectState
+
+- (nonnull id)copyWithZone:(nullable NSZone *)zone {
+    
+    TLTwinmeObjectState *state = [[TLTwinmeObjectState allocWithZone:zone] init];
+    state.twincodeInbound = self.twincodeInbound;
+    state.twincodeOutbound = self.twincodeOutbound;
+    state.peerTwincodeOutbound = self.peerTwincodeOutbound;
+    state.twincodeFactoryId = self.twincodeFactoryId;
+    state.name = self.name;
+    state.objectDescription = self.objectDescription;
+    state.space = self.space;
+    return state;
+}
+
+@end
+
+//
+// Interface: TLTwinmeExportedAttributes
+//
+
+/**
+ * Attributes exported by attributesWithAll: with the values used to build them.
+ */
+@interface TLTwinmeExportedAttributes : NSObject
+
+@property (readonly, nonnull) NSArray<TLAttributeNameValue *> *attributes;
+@property (readonly, nonnull) NSArray *values;
+
+- (nonnull instancetype)initWithAttributes:(nonnull NSArray<TLAttributeNameValue *> *)attributes values:(__unsafe_unretained id _Nullable const * _Nonnull)values count:(NSUInteger)count;
+
+- (BOOL)matchWithValues:(__unsafe_unretained id _Nullable const * _Nonnull)values count:(NSUInteger)count;
+
+@end
+
+//
+// Implementation: TLTwinmeExportedAttributes
+//
+
+@implementation TLTwinmeExportedAttributes
+
+- (nonnull instancetype)initWithAttributes:(nonnull NSArray<TLAttributeNameValue *> *)attributes values:(__unsafe_unretained id _Nullable const * _Nonnull)values count:(NSUInteger)count {
+    
+    self = [super init];
+    if (self) {
+        NSMutableArray *list = [[NSMutableArray alloc] initWithCapacity:count];
+        for (NSUInteger i = 0; i < count; i++) {
+            [list addObject:values[i] ?: [NSNull null]];
+        }
+        _attributes = [attributes copy];
+        _values = list;
+    }
+    return self;
+}
+
+- (BOOL)matchWithValues:(__unsafe_unretained id _Nullable const * _Nonnull)values count:(NSUInteger)count {
+    
+    if (self.values.count != count) {
+        return NO;
+    }
+    NSNull *null = [NSNull null];
+    for (NSUInteger i = 0; i < count; i++) {
+        if ((values[i] ?: null) != self.values[i]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+@end
+
+//
+// Interface: TLTwinmeObject ()
+//
+
+@interface TLTwinmeObject ()
+
+/// The current state: the atomic property gives a consistent reference to a state that is never modified.
+@property (atomic, nonnull) TLTwinmeObjectState *state;
+
+/// The last attributes exported with and without exportAll.
+@property (atomic, nullable) TLTwinmeExportedAttributes *exportedAll;
+@property (atomic, nullable) TLTwinmeExportedAttributes *exported;
+
+@end
+
 //
 // Implementation: TLTwinmeObject
 //
 
 @implementation TLTwinmeObject
 
-@synthesize peerTwincodeOutbound;
-@synthesize twincodeOutbound;
-
 - (nonnull instancetype)initWithIdentifier:(nonnull TLDatabaseIdentifier *)identifier uuid:(nonnull NSUUID*)uuid creationDate:(int64_t)creationDate modificationDate:(int64_t)modificationDate {
     
     self = [super init];
@@ -65,10 +174,95 @@
         _uuid = uuid;
         _creationDate = creationDate;
         _modificationDate = modificationDate;
+        _state = [[TLTwinmeObjectState alloc] init];
     }
     return self;
 }
 
+- (nullable TLTwincodeInbound *)twincodeInbound {
+    
+    return self.state.twincodeInbound;
+}
+
+- (void)setTwincodeInbound:(nullable TLTwincodeInbound *)twincodeInbound {
+    
+    @synchronized (self) {
+        TLTwinmeObjectState *state = [self.state copy];
+        state.twincodeInbound = twincodeInbound;
+        self.state = state;
+    }
+}
+
+- (nullable TLTwincodeOutbound *)twincodeOutbound {
+    
+    return self.state.twincodeOutbound;
+}
+
+- (void)setTwincodeOutbound:(nullable TLTwincodeOutbound *)twincodeOutbound {
+    
+    @synchronized (self) {
+        TLTwinmeObjectState *state = [self.state copy];
+        state.twincodeOutbound = twincodeOutbound;
+        self.state = state;
+    }
+}
+
+- (nullable TLTwincodeOutbound *)peerTwincodeOutbound {
+    
+    return self.state.peerTwincodeOutbound;
+}
+
+- (void)setPeerTwincodeOutbound:(nullable TLTwincodeOutbound *)peerTwincodeOutbound {
+    
+    @synchronized (self) {
+        TLTwinmeObjectState *state = [self.state copy];
+        state.peerTwincodeOutbound = peerTwincodeOutbound;
+        self.state = state;
+    }
+}
+
+- (nullable NSUUID *)twincodeFactoryId {
+    
+    return self.state.twincodeFactoryId;
+}
+
+- (void)setTwincodeFactoryId:(nullable NSUUID *)twincodeFactoryId {
+    
+    @synchronized (self) {
+        TLTwinmeObjectState *state = [self.state copy];
+        state.twincodeFactoryId = twincodeFactoryId;
+        self.state = state;
+    }
+}
+
+- (nonnull NSString *)name {
+    
+    return self.state.name;
+}
+
+- (void)setName:(nonnull NSString *)name {
+    
+    @synchronized (self) {
+        TLTwinmeObjectState *state = [self.state copy];
+        state.name = name;
+        self.state = state;
+    }
+}
+
+- (nonnull NSString *)objectDescription {
+    
+    return self.state.objectDescription;
+}
+
+- (void)setObjectDescription:(nonnull NSString *)objectDescription {
+    
+    @synchronized (self) {
+        TLTwinmeObjectState *state = [self.state copy];
+        state.objectDescription = objectDescription;
+        self.state = state;
+    }
+}
+
 - (void)exportAttributes:(nonnull NSMutableArray<TLAttributeNameValue *> *)attributes name:(nullable NSString *)name description:(nullable NSString *)description twincodeInbound:(nullable TLTwincodeInbound *)twincodeInbound twincodeOutbound:(nullable TLTwincodeOutbound *)twincodeOutbound twincodeFactoryId:(nullable NSUUID *)twincodeFactoryId space:(nullable TLSpace *)space {
     
     if (space) {
@@ -94,17 +288,36 @@
 - (void)setTwincodeFactory:(nonnull TLTwincodeFactory *)twincodeFactory {
     
     @synchronized (self) {
-        self.twincodeOutbound = twincodeFactory.twincodeOutbound;
-        self.twincodeInbound = twincodeFactory.twincodeInbound;
-        self.twincodeFactoryId = twincodeFactory.uuid;
+        TLTwinmeObjectState *state = [self.state copy];
+        state.twincodeOutbound = twincodeFactory.twincodeOutbound;
+        state.twincodeInbound = twincodeFactory.twincodeInbound;
+        state.twincodeFactoryId = twincodeFactory.uuid;
+        self.state = state;
     }
 }
 
-- (nullable TLImageId *)avatarId {
+- (nonnull NSArray<TLAttributeNameValue *> *)attributesWithAll:(BOOL)exportAll values:(__unsafe_unretained id _Nullable const * _Nonnull)values count:(NSUInteger)count builder:(NS_NOESCAPE NSArray<TLAttributeNameValue *> * _Nonnull (^ _Nonnull)(void))builder {
     
-    @synchronized (self) {
-        return self.twincodeOutbound == nil ? nil : self.twincodeOutbound.avatarId;
+    // A save that does not change the object gets the same values and reuses the attributes without
+    // creating them and formatting the UUIDs again.  Any setter replaces at least one value.
+    TLTwinmeExportedAttributes *exported = exportAll ? self.exportedAll : self.exported;
+    if (exported && [exported matchWithValues:values count:count]) {
+        return exported.attributes;
     }
+    
+    exported = [[TLTwinmeExportedAttributes alloc] initWithAttributes:builder() values:values count:count];
+    if (exportAll) {
+        self.exportedAll = exported;
+    } else {
+        self.exported = exported;
+    }
+    return exported.attributes;
+}
+
+- (nullable TLImageId *)avatarId {
+    
+    TLTwincodeOutbound *twincodeOutbound = self.state.twincodeOutbound;
+    return twincodeOutbound == nil ? nil : twincodeOutbound.avatarId;
 }
 
 - (BOOL)isValid {
@@ -143,23 +356,20 @@
 
 - (nullable NSString *)identityName {
     
-    @synchronized (self) {
-        return self.twincodeOutbound ? self.twincodeOutbound.name : nil;
-    }
+    TLTwincodeOutbound *twincodeOutbound = self.state.twincodeOutbound;
+    return twincodeOutbound ? twincodeOutbound.name : nil;
 }
 
 - (nullable NSString *)identityDescription {
     
-    @synchronized (self) {
-        return self.twincodeOutbound ? self.twincodeOutbound.twincodeDescription : nil;
-    }
+    TLTwincodeOutbound *twincodeOutbound = self.state.twincodeOutbound;
+    return twincodeOutbound ? twincodeOutbound.twincodeDescription : nil;
 }
 
 - (nullable TLImageId *)identityAvatarId {
     
-    @synchronized (self) {
-        return self.twincodeOutbound ? self.twincodeOutbound.avatarId : nil;
-    }
+    TLTwincodeOutbound *twincodeOutbound = self.state.twincodeOutbound;
+    return twincodeOutbound ? twincodeOutbound.avatarId : nil;
 }
 
 @end
@@ -170,6 +380,20 @@
 
 @implementation TLTwinmeOriginatorObject
 
+- (nullable TLSpace *)space {
+    
+    return self.state.space;
+}
+
+- (void)setSpace:(nullable TLSpace *)space {
+    
+    @synchronized (self) {
+        TLTwinmeObjectState *state = [self.state copy];
+        state.space = space;
+        self.state = state;
+    }
+}
+
 - (nullable id<TLRepositoryObject>)owner {
     
     return self.space;
@@ -177,37 +401,32 @@
 
 - (nullable NSString *)peerDescription {
     
-    @synchronized (self) {
-        return self.peerTwincodeOutbound ? self.peerTwincodeOutbound.twincodeDescription : nil;
-    }
+    TLTwincodeOutbound *peerTwincodeOutbound = self.state.peerTwincodeOutbound;
+    return peerTwincodeOutbound ? peerTwincodeOutbound.twincodeDescription : nil;
 }
 
 - (nullable TLImageId *)avatarId {
 
-    @synchronized (self) {
-        return self.peerTwincodeOutbound ? self.peerTwincodeOutbound.avatarId : nil;
-    }
+    TLTwincodeOutbound *peerTwincodeOutbound = self.state.peerTwincodeOutbound;
+    return peerTwincodeOutbound ? peerTwincodeOutbound.avatarId : nil;
 }
 
 - (nullable NSUUID *)twincodeInboundId {
     
-    @synchronized (self) {
-        return self.twincodeInbound ? self.twincodeInbound.uuid : nil;
-    }
+    TLTwincodeInbound *twincodeInbound = self.state.twincodeInbound;
+    return twincodeInbound ? twincodeInbound.uuid : nil;
 }
 
 - (nullable NSUUID *)twincodeOutboundId {
     
-    @synchronized (self) {
-        return self.twincodeOutbound ? self.twincodeOutbound.uuid : nil;
-    }
+    TLTwincodeOutbound *twincodeOutbound = self.state.twincodeOutbound;
+    return twincodeOutbound ? twincodeOutbound.uuid : nil;
 }
 
 - (nullable NSUUID *)peerTwincodeOutboundId {
     
-    @synchronized (self) {
-        return self.peerTwincodeOutbound ? self.peerTwincodeOutbound.uuid : nil;
-    }
+    TLTwincodeOutbound *peerTwincodeOutbound = self.state.peerTwincodeOutbound;
+    return peerTwincodeOutbound ? peerTwincodeOutbound.uuid : nil;
 }
 
 - (BOOL)hasPeer {
@@ -222,9 +441,7 @@
 
 - (BOOL)hasPrivateIdentity {
     
-    @synchronized (self) {
-        return self.twincodeInbound != nil;
-    }
+    return self.state.twincodeInbound != nil;
 }
 
 /// Get the peer's capabilities describing the operations we can do on this relation.
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+/// The caches with the lowest priority are trimmed first.
+typedef enum {
+    TLCachePriorityLow,
+    TLCachePriorityNormal,
+    TLCachePriorityHigh
+} TLCachePriority;
+
+/// How much memory must be released.
+typedef enum {
+    // The application is suspended: trim the low and normal priority caches down to the budget.
+    TLCacheTrimLevelSuspend,
+    // The system is short of memory: trim the low and normal priority caches down to a quarter of the budget.
+    TLCacheTrimLevelWarning,
+    // The system is critically short of memory: drop the low and normal priority caches.
+    TLCacheTrimLevelCritical,
+    // Drop every cache.
+    TLCacheTrimLevelAll
+} TLCacheTrimLevel;
+
+//
+// Interface: TLCacheFootprint
+//
+
+@interface TLCacheFootprint : NSObject
+
+@property (readonly, nonnull) NSString *name;
+@property (readonly) TLCachePriority priority;
+@property (readonly) NSUInteger count;
+@property (readonly) NSUInteger bytes;
+
+@end
+
+//
+// Interface: TLCacheManager
+//
+
+/**
+ * Manager of the caches of the twinme context.
+ *
+ * Each cache is registered with its priority, the estimated cost of one entry, a block giving its number
+ * of entries and a block to clear it.  When the application is suspended or when the system is short of
+ * memory, the caches are cleared tier by tier, starting with the lowest priority and the largest cache of
+ * the tier, until the estimated footprint is within the target budget.
+ */
+@interface TLCacheManager : NSObject
+
+/// The estimated size of the caches that is kept when the application is suspended.
+@property (readonly) NSUInteger budget;
+
+/// The estimated size of all the caches.
+@property (readonly) NSUInteger footprint;
+
+- (nonnull instancetype)initWithBudget:(NSUInteger)budget;
+
+- (void)registerCacheWithName:(nonnull NSString *)name priority:(TLCachePriority)priority entryCost:(NSUInteger)entryCost count:(nonnull NSUInteger (^)(void))count clear:(nonnull dispatch_block_t)clear;
+
+/// Get the footprint of each cache sorted on the trim order.
+- (nonnull NSArray<TLCacheFootprint *> *)footprintReport;
+
+/// Clear the caches for the trim level and return the names of the caches that were cleared.
+- (nonnull NSArray<NSString *> *)trimWithLevel:(TLCacheTrimLevel)level;
+
+@end
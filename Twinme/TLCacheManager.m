@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLCacheManager.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Interface: TLCacheFootprint ()
+//
+
+@interface TLCacheFootprint ()
+
+- (nonnull instancetype)initWithName:(nonnull NSString *)name priority:(TLCachePriority)priority count:(NSUInteger)count bytes:(NSUInteger)bytes;
+
+@end
+
+//
+// Interface: TLCacheEntry
+//
+
+@interface TLCacheEntry : NSObject
+
+@property (readonly, nonnull) NSString *name;
+@property (readonly) TLCachePriority priority;
+@property (readonly) NSUInteger entryCost;
+@property (readonly, nonnull) NSUInteger (^count)(void);
+@property (readonly, nonnull) dispatch_block_t clear;
+
+- (nonnull instancetype)initWithName:(nonnull NSString *)name priority:(TLCachePriority)priority entryCost:(NSUInteger)entryCost count:(nonnull NSUInteger (^)(void))count clear:(nonnull dispatch_block_t)clear;
+
+@end
+
+//
+// Interface: TLCacheManager ()
+//
+
+@interface TLCacheManager ()
+
+@property (readonly, nonnull) NSMutableArray<TLCacheEntry *> *caches;
+
+@end
+
+//
+// Implementation: TLCacheFootprint
+//
+
+@implementation TLCacheFootprint
+
+- (nonnull instancetype)initWithName:(nonnull NSString *)name priority:(TLCachePriority)priority count:(NSUInteger)count bytes:(NSUInteger)bytes {
+
+    self = [super init];
+    if (self) {
+        _name = name;
+        _priority = priority;
+        _count = count;
+        _bytes = bytes;
+    }
+    return self;
+}
+
+- (NSString *)description {
+
+    return [NSString stringWithFormat:@"%@: %lu entries %lu bytes", self.name, (unsigned long)self.count, (unsigned long)self.bytes];
+}
+
+@end
+
+//
+// Implementation: TLCacheEntry
+//
+
+@implementation TLCacheEntry
+
+- (nonnull instancetype)initWithName:(nonnull NSString *)name priority:(TLCachePriority)priority entryCost:(NSUInteger)entryCost count:(nonnull NSUInteger (^)(void))count clear:(nonnull dispatch_block_t)clear {
+
+    self = [super init];
+    if (self) {
+        _name = name;
+        _priority = priority;
+        _entryCost = entryCost;
+        _count = count;
+        _clear = clear;
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLCacheManager
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLCacheManager"
+
+@implementation TLCacheManager
+
+- (nonnull instancetype)initWithBudget:(NSUInteger)budget {
+    DDLogVerbose(@"%@ initWithBudget: %lu", LOG_TAG, (unsigned long)budget);
+
+    self = [super init];
+    if (self) {
+        _budget = budget;
+        _caches = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)registerCacheWithName:(nonnull NSString *)name priority:(TLCachePriority)priority entryCost:(NSUInteger)entryCost count:(nonnull NSUInteger (^)(void))count clear:(nonnull dispatch_block_t)clear {
+    DDLogVerbose(@"%@ registerCacheWithName: %@ priority: %d entryCost: %lu", LOG_TAG, name, priority, (unsigned long)entryCost);
+
+    @synchronized (self) {
+        [self.caches addObject:[[TLCacheEntry alloc] initWithName:name priority:priority entryCost:entryCost count:count clear:clear]];
+    }
+}
+
+- (NSUInteger)footprint {
+
+    NSUInteger result = 0;
+    for (TLCacheFootprint *footprint in [self footprintReport]) {
+        result += footprint.bytes;
+    }
+    return result;
+}
+
+- (nonnull NSArray<TLCacheFootprint *> *)footprintReport {
+    DDLogVerbose(@"%@ footprintReport", LOG_TAG);
+
+    NSArray<TLCacheEntry *> *caches;
+    @synchronized (self) {
+        caches = [self.caches copy];
+    }
+
+    NSMutableArray<TLCacheFootprint *> *report = [[NSMutableArray alloc] initWithCapacity:caches.count];
+    for (TLCacheEntry *cache in caches) {
+        NSUInteger count = cache.count();
+        [report addObject:[[TLCacheFootprint alloc] initWithName:cache.name priority:cache.priority count:count bytes:count * cache.entryCost]];
+    }
+
+    // Trim order: lowest priority first and the largest cache first in the same priority.
+    [report sortUsingComparator:^NSComparisonResult(TLCacheFootprint *footprint1, TLCacheFootprint *footprint2) {
+        if (footprint1.priority != footprint2.priority) {
+            return footprint1.priority < footprint2.priority ? NSOrderedAscending : NSOrderedDescending;
+        }
+        if (footprint1.bytes != footprint2.bytes) {
+            return footprint1.bytes > footprint2.bytes ? NSOrderedAscending : NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+    return report;
+}
+
+- (nonnull NSArray<NSString *> *)trimWithLevel:(TLCacheTrimLevel)level {
+    DDLogVerbose(@"%@ trimWithLevel: %d", LOG_TAG, level);
+
+    NSUInteger target;
+    TLCachePriority maxPriority;
+    switch (level) {
+        case TLCacheTrimLevelSuspend:
+            target = self.budget;
+            maxPriority = TLCachePriorityNormal;
+            break;
+
+        case TLCacheTrimLevelWarning:
+            target = self.budget / 4;
+            maxPriority = TLCachePriorityNormal;
+            break;
+
+        case TLCacheTrimLevelCritical:
+            target = 0;
+            maxPriority = TLCachePriorityNormal;
+            break;
+
+        case TLCacheTrimLevelAll:
+        default:
+            target = 0;
+            maxPriority = TLCachePriorityHigh;
+            break;
+    }
+
+    NSArray<TLCacheFootprint *> *report = [self footprintReport];
+    NSUInteger footprint = 0;
+    for (TLCacheFootprint *cache in report) {
+        footprint += cache.bytes;
+    }
+
+    NSMutableArray<NSString *> *cleared = [[NSMutableArray alloc] init];
+    NSMutableSet<NSString *> *names = [[NSMutableSet alloc] init];
+    for (TLCacheFootprint *cache in report) {
+        if (footprint <= target && level != TLCacheTrimLevelAll) {
+            break;
+        }
+        if (cache.priority > maxPriority) {
+            break;
+        }
+        if (cache.count > 0 || level == TLCacheTrimLevelAll) {
+            [names addObject:cache.name];
+            [cleared addObject:cache.name];
+            footprint -= cache.bytes;
+        }
+    }
+
+    NSArray<TLCacheEntry *> *caches;
+    @synchronized (self) {
+        caches = [self.caches copy];
+    }
+    for (TLCacheEntry *cache in caches) {
+        if ([names containsObject:cache.name]) {
+            cache.clear();
+        }
+    }
+
+    DDLogInfo(@"%@ trimmed %@ remaining footprint %lu", LOG_TAG, cleared, (unsigned long)footprint);
+    return cleared;
+}
+
+@end
@@ -0,0 +1,31 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import "TLTwinmeContext.h"
+
+@class TLSpace;
+
+//
+// Interface: TLConversationVisibilityFilter
+//
+
+/**
+ * Filter of the conversations on the visibility of their originator and on a predicate.
+ *
+ * The visibility of an originator only depends on its space: the isVisible and isCurrentSpace bits are
+ * computed once per space and the predicate is only called for the conversations which are visible.
+ * The space of each originator is read from the originator so that no lock is needed.
+ */
+@interface TLConversationVisibilityFilter : NSObject
+
+- (nonnull instancetype)initWithCurrentSpace:(nullable TLSpace *)currentSpace visibility:(TLConversationVisibility)visibility;
+
+/// Get the conversations, in their order, whose originator is visible and matches the predicate.
+- (nonnull NSMutableArray<id<TLConversation>> *)filterWithConversations:(nonnull NSArray<id<TLConversation>> *)conversations predicate:(nonnull BOOL (^)(id<TLOriginator> _Nonnull originator))predicate;
+
+@end
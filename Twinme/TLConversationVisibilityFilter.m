@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import <Twinlife/TLConversationService.h>
+
+#import "TLConversationVisibilityFilter.h"
+#import "TLOriginator.h"
+#import "TLSpace.h"
+#import "TLSpaceSettings.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+// Visibility bits of a conversation originator.
+static const int CONVERSATION_VISIBLE = 1 << 0;
+static const int CONVERSATION_CURRENT_SPACE = 1 << 1;
+
+//
+// Interface: TLConversationVisibilityFilter ()
+//
+
+@interface TLConversationVisibilityFilter ()
+
+@property (readonly, nullable) TLSpace *currentSpace;
+@property (readonly) int mask;
+
+- (int)bitsWithSpace:(nullable TLSpace *)space;
+
+@end
+
+//
+// Implementation: TLConversationVisibilityFilter
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLConversationVisibilityFilter"
+
+@implementation TLConversationVisibilityFilter
+
+- (nonnull instancetype)initWithCurrentSpace:(nullable TLSpace *)currentSpace visibility:(TLConversationVisibility)visibility {
+    DDLogVerbose(@"%@ initWithCurrentSpace: %@ visibility: %d", LOG_TAG, currentSpace, visibility);
+
+    self = [super init];
+    if (self) {
+        _currentSpace = currentSpace;
+        switch (visibility) {
+            case TLConversationVisibilityVisible:
+                _mask = CONVERSATION_VISIBLE;
+                break;
+
+            case TLConversationVisibilityCurrentSpace:
+                _mask = CONVERSATION_CURRENT_SPACE;
+                break;
+
+            default:
+                _mask = 0;
+                break;
+        }
+    }
+    return self;
+}
+
+- (nonnull NSMutableArray<id<TLConversation>> *)filterWithConversations:(nonnull NSArray<id<TLConversation>> *)conversations predicate:(nonnull BOOL (^)(id<TLOriginator> _Nonnull originator))predicate {
+    DDLogVerbose(@"%@ filterWithConversations: %lu", LOG_TAG, (unsigned long)conversations.count);
+
+    NSMutableArray<id<TLConversation>> *list = [[NSMutableArray alloc] initWithCapacity:conversations.count];
+
+    // There are only a few spaces for many conversations: remember the bits of each space.
+    NSMapTable<TLSpace *, NSNumber *> *spaceBits = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    for (id<TLConversation> conversation in conversations) {
+        id<TLOriginator> originator = (id<TLOriginator>)conversation.subject;
+        if (self.mask != 0) {
+            TLSpace *space = originator.space;
+            if (!space) {
+                continue;
+            }
+            NSNumber *bits = [spaceBits objectForKey:space];
+            if (!bits) {
+                bits = [NSNumber numberWithInt:[self bitsWithSpace:space]];
+                [spaceBits setObject:bits forKey:space];
+            }
+            if ((bits.intValue & self.mask) == 0) {
+                continue;
+            }
+        }
+        if (predicate(originator)) {
+            [list addObject:conversation];
+        }
+    }
+    return list;
+}
+
+#pragma mark - Private methods
+
+- (int)bitsWithSpace:(nullable TLSpace *)space {
+
+    if (space == self.currentSpace) {
+        return CONVERSATION_VISIBLE | CONVERSATION_CURRENT_SPACE;
+    } else if (!space.settings.isSecret) {
+        return CONVERSATION_VISIBLE;
+    } else {
+        return 0;
+    }
+}
+
+@end
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+/// Executors waiting for a slot are started by decreasing priority, in submission order for the same priority.
+typedef enum {
+    TLExecutorPriorityLow,
+    TLExecutorPriorityNormal,
+    TLExecutorPriorityHigh
+} TLExecutorPriority;
+
+//
+// Interface: TLExecutorAdmission
+//
+
+/**
+ * Admission control of the executors.
+ *
+ * A concurrency limit is configured for an executor class: at most `limit` executors of that class are
+ * running, the other ones wait in a queue until a running executor is released.  Executors of a class
+ * without limit are started immediately and are not tracked.
+ *
+ * The admission only decides when the executor is started: the start block of an admitted executor is run
+ * by the caller of submitWithExecutor when a slot is free, otherwise it is returned by releaseWithExecutor
+ * to the caller which must run it on the twinlife queue.
+ */
+@interface TLExecutorAdmission : NSObject
+
+/// Set the maximum number of running executors of the class, 0 removes the limit.
+- (void)setLimit:(int)limit withClass:(nonnull Class)clazz;
+
+/// Get the maximum number of running executors of the class or 0 when there is no limit.
+- (int)limitWithClass:(nonnull Class)clazz;
+
+/// Submit the executor: the start block is run immediately and YES is returned if the executor is admitted,
+/// otherwise the executor is queued until a slot is released or until it is canceled.
+- (BOOL)submitWithExecutor:(nonnull id)executor priority:(TLExecutorPriority)priority start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel;
+
+/// Release the slot of a running executor or remove a waiting executor from the queue.  Returns the start block
+/// of the next executor admitted in the released slot.  Releasing an executor several times is harmless.
+- (nullable dispatch_block_t)releaseWithExecutor:(nonnull id)executor;
+
+/// The executor classes which have a limit.
+- (nonnull NSArray<Class> *)limitedClasses;
+
+/// Remove the executors of the class that are waiting and return their cancel blocks.
+- (nonnull NSArray<dispatch_block_t> *)cancelWithClass:(nonnull Class)clazz;
+
+/// Number of running executors of the class.
+- (int)runningCountWithClass:(nonnull Class)clazz;
+
+/// Number of executors of the class waiting for a slot.
+- (NSUInteger)waitingCountWithClass:(nonnull Class)clazz;
+
+@end
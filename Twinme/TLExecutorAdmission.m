@@ -0,0 +1,299 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLExecutorAdmission.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+#define PRIORITY_COUNT (TLExecutorPriorityHigh + 1)
+
+//
+// Interface: TLExecutorAdmissionEntry
+//
+
+@interface TLExecutorAdmissionEntry : NSObject
+
+@property (readonly, nonnull) id executor;
+@property (readonly, nonnull) dispatch_block_t start;
+@property (readonly, nullable) dispatch_block_t cancel;
+
+- (nonnull instancetype)initWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel;
+
+@end
+
+//
+// Interface: TLExecutorAdmissionQueue
+//
+
+/// The running executors and the executors waiting for a slot for one executor class.
+@interface TLExecutorAdmissionQueue : NSObject
+
+@property int limit;
+@property (readonly, nonnull) NSHashTable *running;
+@property (readonly, nonnull) NSArray<NSMutableArray<TLExecutorAdmissionEntry *> *> *waiting;
+
+- (nonnull instancetype)initWithLimit:(int)limit;
+
+- (NSUInteger)waitingCount;
+
+- (nullable TLExecutorAdmissionEntry *)nextEntry;
+
+@end
+
+//
+// Interface: TLExecutorAdmission ()
+//
+
+@interface TLExecutorAdmission ()
+
+/// The queues indexed by the executor class, replaced by a new copy when a class gets its first limit so that
+/// the executors of a class without limit are started and released without taking the lock.
+@property (atomic, nonnull) NSDictionary<id, TLExecutorAdmissionQueue *> *queues;
+
+- (nullable TLExecutorAdmissionQueue *)queueWithClass:(nonnull Class)clazz;
+
+@end
+
+//
+// Implementation: TLExecutorAdmissionEntry
+//
+
+@implementation TLExecutorAdmissionEntry
+
+- (nonnull instancetype)initWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+
+    self = [super init];
+    if (self) {
+        _executor = executor;
+        _start = start;
+        _cancel = cancel;
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLExecutorAdmissionQueue
+//
+
+@implementation TLExecutorAdmissionQueue
+
+- (nonnull instancetype)initWithLimit:(int)limit {
+
+    self = [super init];
+    if (self) {
+        _limit = limit;
+        _running = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality capacity:limit];
+        NSMutableArray *waiting = [[NSMutableArray alloc] initWithCapacity:PRIORITY_COUNT];
+        for (int i = 0; i < PRIORITY_COUNT; i++) {
+            [waiting addObject:[[NSMutableArray alloc] init]];
+        }
+        _waiting = waiting;
+    }
+    return self;
+}
+
+- (NSUInteger)waitingCount {
+
+    NSUInteger count = 0;
+    for (NSMutableArray<TLExecutorAdmissionEntry *> *entries in self.waiting) {
+        count += entries.count;
+    }
+    return count;
+}
+
+- (nullable TLExecutorAdmissionEntry *)nextEntry {
+
+    for (int i = PRIORITY_COUNT - 1; i >= 0; i--) {
+        NSMutableArray<TLExecutorAdmissionEntry *> *entries = self.waiting[i];
+        if (entries.count > 0) {
+            TLExecutorAdmissionEntry *entry = entries.firstObject;
+            [entries removeObjectAtIndex:0];
+            return entry;
+        }
+    }
+    return nil;
+}
+
+@end
+
+//
+// Implementation: TLExecutorAdmission
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLExecutorAdmission"
+
+@implementation TLExecutorAdmission
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _queues = [[NSDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)setLimit:(int)limit withClass:(nonnull Class)clazz {
+    DDLogVerbose(@"%@ setLimit: %d withClass: %@", LOG_TAG, limit, clazz);
+
+    NSMutableArray<dispatch_block_t> *startList = nil;
+    @synchronized (self) {
+        TLExecutorAdmissionQueue *queue = [self queueWithClass:clazz];
+        if (!queue) {
+            if (limit > 0) {
+                NSMutableDictionary<id, TLExecutorAdmissionQueue *> *queues = [self.queues mutableCopy];
+                queues[(id<NSCopying>)clazz] = [[TLExecutorAdmissionQueue alloc] initWithLimit:limit];
+                self.queues = queues;
+            }
+            return;
+        }
+
+        // Executors already running are not stopped, waiting executors are started if the limit is raised.
+        queue.limit = limit;
+        while (queue.limit <= 0 || queue.running.count < queue.limit) {
+            TLExecutorAdmissionEntry *entry = [queue nextEntry];
+            if (!entry) {
+                break;
+            }
+            [queue.running addObject:entry.executor];
+            if (!startList) {
+                startList = [[NSMutableArray alloc] init];
+            }
+            [startList addObject:entry.start];
+        }
+    }
+
+    for (dispatch_block_t start in startList) {
+        start();
+    }
+}
+
+- (int)limitWithClass:(nonnull Class)clazz {
+
+    @synchronized (self) {
+        return [self queueWithClass:clazz].limit;
+    }
+}
+
+- (BOOL)submitWithExecutor:(nonnull id)executor priority:(TLExecutorPriority)priority start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+    DDLogVerbose(@"%@ submitWithExecutor: %@ priority: %d", LOG_TAG, executor, priority);
+
+    TLExecutorAdmissionQueue *queue = [self queueWithClass:[executor class]];
+    if (!queue) {
+        start();
+        return YES;
+    }
+
+    @synchronized (self) {
+        if (queue.limit > 0 && queue.running.count >= queue.limit) {
+            [queue.waiting[priority] addObject:[[TLExecutorAdmissionEntry alloc] initWithExecutor:executor start:start cancel:cancel]];
+            return NO;
+        }
+        [queue.running addObject:executor];
+    }
+
+    start();
+    return YES;
+}
+
+- (nullable dispatch_block_t)releaseWithExecutor:(nonnull id)executor {
+    DDLogVerbose(@"%@ releaseWithExecutor: %@", LOG_TAG, executor);
+
+    TLExecutorAdmissionQueue *queue = [self queueWithClass:[executor class]];
+    if (!queue) {
+        return nil;
+    }
+
+    @synchronized (self) {
+        if (![queue.running containsObject:executor]) {
+            // The executor is stopped before being admitted.
+            for (NSMutableArray<TLExecutorAdmissionEntry *> *entries in queue.waiting) {
+                for (NSUInteger i = 0; i < entries.count; i++) {
+                    if (entries[i].executor == executor) {
+                        [entries removeObjectAtIndex:i];
+                        return nil;
+                    }
+                }
+            }
+            return nil;
+        }
+
+        [queue.running removeObject:executor];
+        if (queue.limit > 0 && queue.running.count >= queue.limit) {
+            return nil;
+        }
+        TLExecutorAdmissionEntry *entry = [queue nextEntry];
+        if (!entry) {
+            return nil;
+        }
+        [queue.running addObject:entry.executor];
+        return entry.start;
+    }
+}
+
+- (nonnull NSArray<Class> *)limitedClasses {
+
+    NSMutableArray<Class> *result = [[NSMutableArray alloc] init];
+    @synchronized (self) {
+        [self.queues enumerateKeysAndObjectsUsingBlock:^(id clazz, TLExecutorAdmissionQueue *queue, BOOL *stop) {
+            if (queue.limit > 0) {
+                [result addObject:clazz];
+            }
+        }];
+    }
+    return result;
+}
+
+- (nonnull NSArray<dispatch_block_t> *)cancelWithClass:(nonnull Class)clazz {
+    DDLogVerbose(@"%@ cancelWithClass: %@", LOG_TAG, clazz);
+
+    NSMutableArray<dispatch_block_t> *cancelList = [[NSMutableArray alloc] init];
+    @synchronized (self) {
+        TLExecutorAdmissionQueue *queue = [self queueWithClass:clazz];
+        for (NSMutableArray<TLExecutorAdmissionEntry *> *entries in queue.waiting) {
+            for (TLExecutorAdmissionEntry *entry in entries) {
+                [cancelList addObject:entry.cancel ? entry.cancel : ^{}];
+            }
+            [entries removeAllObjects];
+        }
+    }
+    return cancelList;
+}
+
+- (int)runningCountWithClass:(nonnull Class)clazz {
+
+    @synchronized (self) {
+        return (int)[self queueWithClass:clazz].running.count;
+    }
+}
+
+- (NSUInteger)waitingCountWithClass:(nonnull Class)clazz {
+
+    @synchronized (self) {
+        return [[self queueWithClass:clazz] waitingCount];
+    }
+}
+
+#pragma mark - Private methods
+
+- (nullable TLExecutorAdmissionQueue *)queueWithClass:(nonnull Class)clazz {
+
+    // The class objects are unique: the lookup compares and hashes their pointer.
+    return self.queues[(id<NSCopying>)clazz];
+}
+
+@end
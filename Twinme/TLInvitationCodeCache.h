@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <Twinlife/TLBaseService.h>
+
+/// Result of the resolution of an invitation code: the twincode and its public key.
+typedef void (^TLInvitationCodeBlock)(TLBaseServiceErrorCode errorCode, id _Nullable twincode, NSString * _Nullable publicKey);
+
+@class TLInvitationCodeResolution;
+
+//
+// Interface: TLInvitationCodeCache
+//
+
+/**
+ * Cache of the invitation codes resolved by the server.
+ *
+ * - a resolved code is kept for `ttl` seconds and an unknown code (ItemNotFound) for `negativeTtl` seconds,
+ *   other errors are not cached,
+ * - at most `capacity` codes are kept, the least recently used code is dropped first,
+ * - the first caller for a code which is not cached is given a resolution to complete, the next callers are
+ *   attached to that resolution until it completes,
+ * - an invalidation of the code, of the twincode it resolves to or of the whole cache during a resolution
+ *   prevents its result from being cached, the callers attached to it still get the result.
+ *
+ * The twincode is not copied: every caller of a cached code gets the same TLTwincodeOutbound instance, which is
+ * the object managed by the twincode outbound service.  It is shared and must be treated as read-only.
+ */
+@interface TLInvitationCodeCache : NSObject
+
+/// Number of codes in the cache.
+@property (readonly) NSUInteger count;
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity ttl:(NSTimeInterval)ttl negativeTtl:(NSTimeInterval)negativeTtl;
+
+/// Give the cached result to the block or attach it to the resolution of the code, returns the resolution
+/// when the caller must resolve the code and call completeWithResolution.
+- (nullable TLInvitationCodeResolution *)resolveWithCode:(nonnull NSString *)code block:(nonnull TLInvitationCodeBlock)block;
+
+/// Give the result of the resolution to all the callers attached to it and cache it.
+- (void)completeWithResolution:(nonnull TLInvitationCodeResolution *)resolution errorCode:(TLBaseServiceErrorCode)errorCode twincode:(nullable id)twincode twincodeId:(nullable NSUUID *)twincodeId publicKey:(nullable NSString *)publicKey;
+
+/// Forget the code, for example when it is created.
+- (void)invalidateWithCode:(nonnull NSString *)code;
+
+/// Forget the codes resolved to the twincode, for example when the invitation is deleted.
+- (void)invalidateWithTwincodeId:(nonnull NSUUID *)twincodeId;
+
+/// Forget every code.
+- (void)removeAll;
+
+/// The time used for the expiration of the codes, the current date by default.
+- (NSTimeInterval)now;
+
+@end
@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLInvitationCodeCache.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Interface: TLInvitationCodeEntry
+//
+
+@interface TLInvitationCodeEntry : NSObject
+
+@property (readonly) TLBaseServiceErrorCode errorCode;
+@property (readonly, nullable) id twincode;
+@property (readonly, nullable) NSUUID *twincodeId;
+@property (readonly, nullable) NSString *publicKey;
+@property (readonly) NSTimeInterval expireTime;
+
+- (nonnull instancetype)initWithErrorCode:(TLBaseServiceErrorCode)errorCode twincode:(nullable id)twincode twincodeId:(nullable NSUUID *)twincodeId publicKey:(nullable NSString *)publicKey expireTime:(NSTimeInterval)expireTime;
+
+@end
+
+//
+// Interface: TLInvitationCodeResolution
+//
+
+/// The callers waiting for the resolution of a code and the twincodes invalidated while it is in progress.
+@interface TLInvitationCodeResolution : NSObject
+
+@property (readonly, nonnull) NSString *code;
+@property (readonly, nonnull) NSMutableArray<TLInvitationCodeBlock> *blocks;
+@property (nullable) NSMutableSet<NSUUID *> *invalidatedTwincodeIds;
+@property BOOL invalidated;
+
+- (nonnull instancetype)initWithCode:(nonnull NSString *)code;
+
+@end
+
+//
+// Interface: TLInvitationCodeCache ()
+//
+
+@interface TLInvitationCodeCache ()
+
+@property (readonly) NSUInteger capacity;
+@property (readonly) NSTimeInterval ttl;
+@property (readonly) NSTimeInterval negativeTtl;
+@property (readonly, nonnull) NSMutableDictionary<NSString *, TLInvitationCodeEntry *> *entries;
+/// The cached codes from the least recently used to the most recently used.
+@property (readonly, nonnull) NSMutableArray<NSString *> *lruList;
+@property (readonly, nonnull) NSMutableDictionary<NSString *, TLInvitationCodeResolution *> *resolutions;
+
+- (void)removeEntryWithCode:(nonnull NSString *)code;
+
+@end
+
+//
+// Implementation: TLInvitationCodeEntry
+//
+
+@implementation TLInvitationCodeEntry
+
+- (nonnull instancetype)initWithErrorCode:(TLBaseServiceErrorCode)errorCode twincode:(nullable id)twincode twincodeId:(nullable NSUUID *)twincodeId publicKey:(nullable NSString *)publicKey expireTime:(NSTimeInterval)expireTime {
+
+    self = [super init];
+    if (self) {
+        _errorCode = errorCode;
+        _twincode = twincode;
+        _twincodeId = twincodeId;
+        _publicKey = publicKey;
+        _expireTime = expireTime;
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLInvitationCodeResolution
+//
+
+@implementation TLInvitationCodeResolution
+
+- (nonnull instancetype)initWithCode:(nonnull NSString *)code {
+
+    self = [super init];
+    if (self) {
+        _code = code;
+        _blocks = [[NSMutableArray alloc] init];
+        _invalidated = NO;
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLInvitationCodeCache
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLInvitationCodeCache"
+
+@implementation TLInvitationCodeCache
+
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity ttl:(NSTimeInterval)ttl negativeTtl:(NSTimeInterval)negativeTtl {
+    DDLogVerbose(@"%@ initWithCapacity: %lu ttl: %f negativeTtl: %f", LOG_TAG, (unsigned long)capacity, ttl, negativeTtl);
+
+    self = [super init];
+    if (self) {
+        _capacity = capacity;
+        _ttl = ttl;
+        _negativeTtl = negativeTtl;
+        _entries = [[NSMutableDictionary alloc] initWithCapacity:capacity];
+        _lruList = [[NSMutableArray alloc] initWithCapacity:capacity];
+        _resolutions = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+
+    @synchronized (self) {
+        return self.entries.count;
+    }
+}
+
+- (nullable TLInvitationCodeResolution *)resolveWithCode:(nonnull NSString *)code block:(nonnull TLInvitationCodeBlock)block {
+    DDLogVerbose(@"%@ resolveWithCode: %@", LOG_TAG, code);
+
+    TLInvitationCodeEntry *entry;
+    @synchronized (self) {
+        entry = self.entries[code];
+        if (entry && entry.expireTime <= [self now]) {
+            [self removeEntryWithCode:code];
+            entry = nil;
+        }
+        if (!entry) {
+            TLInvitationCodeResolution *resolution = self.resolutions[code];
+            if (resolution) {
+                [resolution.blocks addObject:block];
+                return nil;
+            }
+            resolution = [[TLInvitationCodeResolution alloc] initWithCode:code];
+            [resolution.blocks addObject:block];
+            self.resolutions[code] = resolution;
+            return resolution;
+        }
+
+        // Move the code at the end of the LRU list.
+        if (![self.lruList.lastObject isEqualToString:code]) {
+            [self.lruList removeObject:code];
+            [self.lruList addObject:code];
+        }
+    }
+
+    block(entry.errorCode, entry.twincode, entry.publicKey);
+    return nil;
+}
+
+- (void)completeWithResolution:(nonnull TLInvitationCodeResolution *)resolution errorCode:(TLBaseServiceErrorCode)errorCode twincode:(nullable id)twincode twincodeId:(nullable NSUUID *)twincodeId publicKey:(nullable NSString *)publicKey {
+    DDLogVerbose(@"%@ completeWithResolution: %@ errorCode: %d", LOG_TAG, resolution.code, errorCode);
+
+    NSString *code = resolution.code;
+    @synchronized (self) {
+        // The resolution is no longer known after removeAll and the code can be resolved again.
+        if (self.resolutions[code] == resolution) {
+            [self.resolutions removeObjectForKey:code];
+        }
+        if (twincodeId && [resolution.invalidatedTwincodeIds containsObject:twincodeId]) {
+            resolution.invalidated = YES;
+        }
+
+        NSTimeInterval ttl = 0;
+        if (errorCode == TLBaseServiceErrorCodeSuccess && twincode) {
+            ttl = self.ttl;
+        } else if (errorCode == TLBaseServiceErrorCodeItemNotFound) {
+            ttl = self.negativeTtl;
+        }
+        if (ttl > 0 && self.capacity > 0 && !resolution.invalidated) {
+            [self removeEntryWithCode:code];
+            while (self.lruList.count >= self.capacity) {
+                [self removeEntryWithCode:self.lruList.firstObject];
+            }
+            self.entries[code] = [[TLInvitationCodeEntry alloc] initWithErrorCode:errorCode twincode:twincode twincodeId:twincodeId publicKey:publicKey expireTime:[self now] + ttl];
+            [self.lruList addObject:code];
+        }
+    }
+
+    for (TLInvitationCodeBlock block in resolution.blocks) {
+        block(errorCode, twincode, publicKey);
+    }
+}
+
+- (void)invalidateWithCode:(nonnull NSString *)code {
+    DDLogVerbose(@"%@ invalidateWithCode: %@", LOG_TAG, code);
+
+    @synchronized (self) {
+        [self removeEntryWithCode:code];
+        self.resolutions[code].invalidated = YES;
+    }
+}
+
+- (void)invalidateWithTwincodeId:(nonnull NSUUID *)twincodeId {
+    DDLogVerbose(@"%@ invalidateWithTwincodeId: %@", LOG_TAG, twincodeId);
+
+    @synchronized (self) {
+        NSMutableArray<NSString *> *codes = nil;
+        for (NSString *code in self.entries) {
+            if ([self.entries[code].twincodeId isEqual:twincodeId]) {
+                if (!codes) {
+                    codes = [[NSMutableArray alloc] init];
+                }
+                [codes addObject:code];
+            }
+        }
+        for (NSString *code in codes) {
+            [self removeEntryWithCode:code];
+        }
+
+        // The codes being resolved may resolve to the twincode: this is known only when they complete.
+        for (NSString *code in self.resolutions) {
+            TLInvitationCodeResolution *resolution = self.resolutions[code];
+            if (!resolution.invalidatedTwincodeIds) {
+                resolution.invalidatedTwincodeIds = [[NSMutableSet alloc] init];
+            }
+            [resolution.invalidatedTwincodeIds addObject:twincodeId];
+        }
+    }
+}
+
+- (void)removeAll {
+    DDLogVerbose(@"%@ removeAll", LOG_TAG);
+
+    @synchronized (self) {
+        [self.entries removeAllObjects];
+        [self.lruList removeAllObjects];
+        for (NSString *code in self.resolutions) {
+            self.resolutions[code].invalidated = YES;
+        }
+        [self.resolutions removeAllObjects];
+    }
+}
+
+- (NSTimeInterval)now {
+
+    return [NSDate timeIntervalSinceReferenceDate];
+}
+
+#pragma mark - Private methods
+
+- (void)removeEntryWithCode:(nonnull NSString *)code {
+
+    if (self.entries[code]) {
+        [self.entries removeObjectForKey:code];
+        [self.lruList removeObject:code];
+    }
+}
+
+@end
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <Twinlife/TLRepositoryService.h>
+
+@class TLTwinmeContext;
+@class TLInvocation;
+
+typedef void (^TLInvocationHandlerBlock)(TLTwinmeContext * _Nonnull twinmeContext, TLInvocation * _Nonnull invocation, id<TLRepositoryObject> _Nonnull receiver);
+
+//
+// Interface: TLInvocationHandler
+//
+
+/**
+ * Handler of an invocation for a (receiver class, invocation class) pair with its execution metrics.
+ *
+ * The metrics are updated by the twinlife queue when the handler is invoked.
+ */
+@interface TLInvocationHandler : NSObject
+
+@property (readonly, nonnull) NSString *name;
+@property (readonly, nonnull) TLInvocationHandlerBlock block;
+
+/// Number of invocations processed by the handler.
+@property (readonly) int64_t count;
+
+/// Total and maximum time spent in the handler in nanoseconds.
+@property (readonly) uint64_t totalTime;
+@property (readonly) uint64_t maxTime;
+
+- (nonnull instancetype)initWithName:(nonnull NSString *)name block:(nonnull TLInvocationHandlerBlock)block;
+
+- (void)invokeWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext invocation:(nonnull TLInvocation *)invocation receiver:(nonnull id<TLRepositoryObject>)receiver;
+
+@end
+
+//
+// Interface: TLInvocationDispatcher
+//
+
+/**
+ * Table of invocation handlers indexed by the exact class of the receiver and the exact class of the invocation.
+ *
+ * - background invocations are dispatched on the (receiver class, invocation class) pair,
+ * - other invocations are dispatched on the receiver class only.
+ *
+ * The handlers are registered once when the table is created and the lookup does not allocate.
+ */
+@interface TLInvocationDispatcher : NSObject
+
+- (nonnull instancetype)init;
+
+- (void)registerWithReceiverClass:(nonnull Class)receiverClass invocationClass:(nonnull Class)invocationClass name:(nonnull NSString *)name block:(nonnull TLInvocationHandlerBlock)block;
+
+- (void)registerWithReceiverClass:(nonnull Class)receiverClass name:(nonnull NSString *)name block:(nonnull TLInvocationHandlerBlock)block;
+
+/// Get the handler for the invocation and its receiver or nil when the invocation must be rejected.
+- (nullable TLInvocationHandler *)handlerWithInvocation:(nonnull TLInvocation *)invocation receiver:(nullable id<TLRepositoryObject>)receiver;
+
+/// Get the handler for a background invocation class sent to the receiver class.
+- (nullable TLInvocationHandler *)handlerWithReceiverClass:(nonnull Class)receiverClass invocationClass:(nonnull Class)invocationClass;
+
+/// Get the handler for a foreground invocation sent to the receiver class.
+- (nullable TLInvocationHandler *)handlerWithReceiverClass:(nonnull Class)receiverClass;
+
+/// The registered handlers for the metrics.
+- (nonnull NSArray<TLInvocationHandler *> *)handlers;
+
+@end
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLInvocationDispatcher.h"
+#import "TLInvocation.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Interface: TLInvocationHandler ()
+//
+
+@interface TLInvocationHandler ()
+
+@property int64_t count;
+@property uint64_t totalTime;
+@property uint64_t maxTime;
+
+@end
+
+//
+// Implementation: TLInvocationHandler
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLInvocationHandler"
+
+@implementation TLInvocationHandler
+
+- (nonnull instancetype)initWithName:(nonnull NSString *)name block:(nonnull TLInvocationHandlerBlock)block {
+    DDLogVerbose(@"%@ initWithName: %@", LOG_TAG, name);
+
+    self = [super init];
+    if (self) {
+        _name = name;
+        _block = block;
+        _count = 0;
+        _totalTime = 0;
+        _maxTime = 0;
+    }
+    return self;
+}
+
+- (void)invokeWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext invocation:(nonnull TLInvocation *)invocation receiver:(nonnull id<TLRepositoryObject>)receiver {
+    DDLogVerbose(@"%@ invokeWithTwinmeContext: %@ invocation: %@", LOG_TAG, self.name, invocation);
+
+    uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    self.block(twinmeContext, invocation, receiver);
+    uint64_t duration = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+
+    self.count++;
+    self.totalTime += duration;
+    if (duration > self.maxTime) {
+        self.maxTime = duration;
+    }
+}
+
+- (nonnull NSString *)description {
+
+    return [NSString stringWithFormat:@"TLInvocationHandler[%@ count=%lld total=%lluns max=%lluns]", self.name, self.count, self.totalTime, self.maxTime];
+}
+
+@end
+
+//
+// Interface: TLInvocationDispatcher ()
+//
+
+@interface TLInvocationDispatcher ()
+
+@property (readonly, nonnull) NSMutableDictionary<Class, NSMutableDictionary<Class, TLInvocationHandler *> *> *backgroundHandlers;
+@property (readonly, nonnull) NSMutableDictionary<Class, TLInvocationHandler *> *foregroundHandlers;
+@property (readonly, nonnull) NSMutableArray<TLInvocationHandler *> *handlerList;
+
+@end
+
+//
+// Implementation: TLInvocationDispatcher
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLInvocationDispatcher"
+
+@implementation TLInvocationDispatcher
+
+- (nonnull instancetype)init {
+    DDLogVerbose(@"%@ init", LOG_TAG);
+
+    self = [super init];
+    if (self) {
+        _backgroundHandlers = [[NSMutableDictionary alloc] init];
+        _foregroundHandlers = [[NSMutableDictionary alloc] init];
+        _handlerList = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)registerWithReceiverClass:(nonnull Class)receiverClass invocationClass:(nonnull Class)invocationClass name:(nonnull NSString *)name block:(nonnull TLInvocationHandlerBlock)block {
+    DDLogVerbose(@"%@ registerWithReceiverClass: %@ invocationClass: %@ name: %@", LOG_TAG, receiverClass, invocationClass, name);
+
+    NSMutableDictionary<Class, TLInvocationHandler *> *handlers = self.backgroundHandlers[(id<NSCopying>)receiverClass];
+    if (!handlers) {
+        handlers = [[NSMutableDictionary alloc] init];
+        self.backgroundHandlers[(id<NSCopying>)receiverClass] = handlers;
+    }
+
+    TLInvocationHandler *handler = [[TLInvocationHandler alloc] initWithName:name block:block];
+    handlers[(id<NSCopying>)invocationClass] = handler;
+    [self.handlerList addObject:handler];
+}
+
+- (void)registerWithReceiverClass:(nonnull Class)receiverClass name:(nonnull NSString *)name block:(nonnull TLInvocationHandlerBlock)block {
+    DDLogVerbose(@"%@ registerWithReceiverClass: %@ name: %@", LOG_TAG, receiverClass, name);
+
+    TLInvocationHandler *handler = [[TLInvocationHandler alloc] initWithName:name block:block];
+    self.foregroundHandlers[(id<NSCopying>)receiverClass] = handler;
+    [self.handlerList addObject:handler];
+}
+
+- (nullable TLInvocationHandler *)handlerWithInvocation:(nonnull TLInvocation *)invocation receiver:(nullable id<TLRepositoryObject>)receiver {
+    DDLogVerbose(@"%@ handlerWithInvocation: %@ receiver: %@", LOG_TAG, invocation, receiver);
+
+    if (!receiver) {
+        return nil;
+    }
+    if (invocation.background) {
+        return [self handlerWithReceiverClass:[receiver class] invocationClass:[invocation class]];
+    } else {
+        return [self handlerWithReceiverClass:[receiver class]];
+    }
+}
+
+- (nullable TLInvocationHandler *)handlerWithReceiverClass:(nonnull Class)receiverClass invocationClass:(nonnull Class)invocationClass {
+
+    return self.backgroundHandlers[(id<NSCopying>)receiverClass][(id<NSCopying>)invocationClass];
+}
+
+- (nullable TLInvocationHandler *)handlerWithReceiverClass:(nonnull Class)receiverClass {
+
+    return self.foregroundHandlers[(id<NSCopying>)receiverClass];
+}
+
+- (nonnull NSArray<TLInvocationHandler *> *)handlers {
+
+    return self.handlerList;
+}
+
+@end
@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+typedef enum {
+    TLInvocationReplayPriorityHigh,
+    TLInvocationReplayPriorityNormal
+} TLInvocationReplayPriority;
+
+/// Job started by the scheduler: it must call the completion block on the scheduler queue when it has finished.
+typedef void (^TLInvocationReplayJob)(dispatch_block_t _Nonnull completion);
+
+//
+// Interface: TLInvocationReplayScheduler
+//
+
+/**
+ * Scheduler of the invocations replayed when we are connected again.
+ *
+ * The invocations are started in bounded slices from the serial queue:
+ * - at most `window` invocations are processed at the same time,
+ * - at most `sliceSize` invocations are started by one block of the queue, the scheduler
+ *   then yields to let other blocks of the queue execute before starting the next slice,
+ * - the high priority invocations are started before the normal ones.
+ */
+@interface TLInvocationReplayScheduler : NSObject
+
+/// Number of jobs that are waiting and number of jobs being processed.
+@property (readonly) NSUInteger pendingCount;
+@property (readonly) int runningCount;
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue window:(int)window sliceSize:(int)sliceSize;
+
+/// Queue the job, it will be started from the scheduler queue.
+- (void)addJobWithPriority:(TLInvocationReplayPriority)priority job:(nonnull TLInvocationReplayJob)job;
+
+/// Drop the jobs which are not started and forget the running ones (the invocations are replayed again by the server).
+- (void)reset;
+
+@end
@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLInvocationReplayScheduler.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Interface: TLInvocationReplayScheduler ()
+//
+
+@interface TLInvocationReplayScheduler ()
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly) int window;
+@property (readonly) int sliceSize;
+@property (readonly, nonnull) NSMutableArray<TLInvocationReplayJob> *highJobs;
+@property (readonly, nonnull) NSMutableArray<TLInvocationReplayJob> *normalJobs;
+@property int running;
+@property int64_t generation;
+@property BOOL scheduled;
+
+- (void)runSlice;
+
+- (void)onCompleteWithGeneration:(int64_t)generation;
+
+@end
+
+//
+// Implementation: TLInvocationReplayScheduler
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLInvocationReplayScheduler"
+
+@implementation TLInvocationReplayScheduler
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue window:(int)window sliceSize:(int)sliceSize {
+    DDLogVerbose(@"%@ initWithQueue: %@ window: %d sliceSize: %d", LOG_TAG, queue, window, sliceSize);
+
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _window = window;
+        _sliceSize = sliceSize;
+        _highJobs = [[NSMutableArray alloc] init];
+        _normalJobs = [[NSMutableArray alloc] init];
+        _running = 0;
+        _generation = 0;
+        _scheduled = NO;
+    }
+    return self;
+}
+
+- (NSUInteger)pendingCount {
+
+    @synchronized (self) {
+        return self.highJobs.count + self.normalJobs.count;
+    }
+}
+
+- (int)runningCount {
+
+    @synchronized (self) {
+        return self.running;
+    }
+}
+
+- (void)addJobWithPriority:(TLInvocationReplayPriority)priority job:(nonnull TLInvocationReplayJob)job {
+    DDLogVerbose(@"%@ addJobWithPriority: %d", LOG_TAG, priority);
+
+    BOOL schedule = NO;
+    @synchronized (self) {
+        if (priority == TLInvocationReplayPriorityHigh) {
+            [self.highJobs addObject:job];
+        } else {
+            [self.normalJobs addObject:job];
+        }
+        if (!self.scheduled && self.running < self.window) {
+            self.scheduled = YES;
+            schedule = YES;
+        }
+    }
+    if (schedule) {
+        dispatch_async(self.queue, ^{
+            [self runSlice];
+        });
+    }
+}
+
+- (void)reset {
+    DDLogVerbose(@"%@ reset", LOG_TAG);
+
+    @synchronized (self) {
+        [self.highJobs removeAllObjects];
+        [self.normalJobs removeAllObjects];
+        self.running = 0;
+        self.generation++;
+    }
+}
+
+#pragma mark - Private methods
+
+- (void)runSlice {
+    DDLogVerbose(@"%@ runSlice", LOG_TAG);
+
+    NSMutableArray<TLInvocationReplayJob> *jobs = [[NSMutableArray alloc] initWithCapacity:self.sliceSize];
+    int64_t generation;
+    BOOL more;
+    @synchronized (self) {
+        self.scheduled = NO;
+        while (jobs.count < self.sliceSize && self.running < self.window) {
+            NSMutableArray<TLInvocationReplayJob> *list = self.highJobs.count > 0 ? self.highJobs : self.normalJobs;
+            if (list.count == 0) {
+                break;
+            }
+            [jobs addObject:list[0]];
+            [list removeObjectAtIndex:0];
+            self.running++;
+        }
+        generation = self.generation;
+
+        // Yield to the other blocks of the queue before starting the next slice.
+        more = self.running < self.window && self.highJobs.count + self.normalJobs.count > 0;
+        if (more) {
+            self.scheduled = YES;
+        }
+    }
+
+    for (TLInvocationReplayJob job in jobs) {
+        job(^{
+            [self onCompleteWithGeneration:generation];
+        });
+    }
+
+    if (more) {
+        dispatch_async(self.queue, ^{
+            [self runSlice];
+        });
+    }
+}
+
+- (void)onCompleteWithGeneration:(int64_t)generation {
+    DDLogVerbose(@"%@ onCompleteWithGeneration: %lld", LOG_TAG, generation);
+
+    BOOL schedule = NO;
+    @synchronized (self) {
+        // The job was started before a reset.
+        if (generation != self.generation) {
+            return;
+        }
+        self.running--;
+        if (!self.scheduled && self.highJobs.count + self.normalJobs.count > 0) {
+            self.scheduled = YES;
+            schedule = YES;
+        }
+    }
+    if (schedule) {
+        dispatch_async(self.queue, ^{
+            [self runSlice];
+        });
+    }
+}
+
+@end
@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <uuid/uuid.h>
+
+typedef enum {
+    // The peer id is not of the form <twincode>@inbound.twincode.twinlife[/<resource>].
+    TLPeerIdStatusInvalid,
+    // The peer id has the inbound twincode domain but the twincode is not a valid UUID.
+    TLPeerIdStatusBadTwincode,
+    TLPeerIdStatusSuccess
+} TLPeerIdStatus;
+
+typedef struct {
+    uuid_t twincodeInboundId;
+    uuid_t callingUserTwincodeId;
+    BOOL hasCallingUserTwincodeId;
+} TLPeerIdInfo;
+
+//
+// Interface: TLPeerIdParser
+//
+
+/**
+ * Parser for the peer id of an incoming peer connection.
+ *
+ * The peer id has the form `<twincode inbound id>@inbound.twincode.twinlife[...][/<calling user twincode id>]`.
+ * The parser makes a single pass over the UTF-8 bytes and decodes the UUIDs in the TLPeerIdInfo without
+ * creating intermediate strings or arrays.  It accepts and rejects the same peer ids as splitting the
+ * string on '@' and '/' and creating the NSUUID with initWithUUIDString.
+ */
+@interface TLPeerIdParser : NSObject
+
++ (TLPeerIdStatus)parseWithPeerId:(nonnull NSString *)peerId info:(nonnull TLPeerIdInfo *)info;
+
+@end
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import "TLPeerIdParser.h"
+
+#define PEER_ID_BUFFER_SIZE 256
+#define UUID_STRING_LENGTH 36
+
+static const char INBOUND_TWINCODE_DOMAIN[] = "inbound.twincode.twinlife";
+
+static inline int hexValue(uint8_t c) {
+
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Decode a UUID in the 8-4-4-4-12 hexadecimal form.
+ */
+static BOOL parseUUID(const uint8_t *p, NSUInteger length, uuid_t uuid) {
+
+    if (length != UUID_STRING_LENGTH) {
+        return NO;
+    }
+
+    int pos = 0;
+    for (NSUInteger i = 0; i < UUID_STRING_LENGTH; ) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            if (p[i] != '-') {
+                return NO;
+            }
+            i++;
+            continue;
+        }
+        int high = hexValue(p[i]);
+        int low = hexValue(p[i + 1]);
+        if (high < 0 || low < 0) {
+            return NO;
+        }
+        uuid[pos++] = (unsigned char)((high << 4) | low);
+        i += 2;
+    }
+    return YES;
+}
+
+//
+// Implementation: TLPeerIdParser
+//
+
+@implementation TLPeerIdParser
+
++ (TLPeerIdStatus)parseWithPeerId:(nonnull NSString *)peerId info:(nonnull TLPeerIdInfo *)info {
+
+    uint8_t buffer[PEER_ID_BUFFER_SIZE];
+    const uint8_t *bytes = buffer;
+    NSUInteger length;
+    NSRange remaining;
+
+    // Peer ids are short and ASCII: copy them on the stack, allocate only for the unusual long ones.
+    // Invalid characters are replaced, they are never part of a UUID or of the domain.
+    NSData *data = nil;
+    [peerId getBytes:buffer maxLength:sizeof(buffer) usedLength:&length encoding:NSUTF8StringEncoding options:NSStringEncodingConversionAllowLossy range:NSMakeRange(0, peerId.length) remainingRange:&remaining];
+    if (remaining.length > 0) {
+        data = [peerId dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES];
+        bytes = data.bytes;
+        length = data.length;
+    }
+
+    // Find the '@' separator which must be unique and the last '/' of the domain which must be unique too.
+    NSUInteger at = NSNotFound;
+    NSUInteger slash = NSNotFound;
+    int slashCount = 0;
+    for (NSUInteger i = 0; i < length; i++) {
+        uint8_t c = bytes[i];
+        if (c == '@') {
+            if (at != NSNotFound) {
+                return TLPeerIdStatusInvalid;
+            }
+            at = i;
+        } else if (c == '/' && at != NSNotFound) {
+            slash = i;
+            slashCount++;
+        }
+    }
+    if (at == NSNotFound) {
+        return TLPeerIdStatusInvalid;
+    }
+
+    const uint8_t *domain = bytes + at + 1;
+    NSUInteger domainLength = length - at - 1;
+    if (domainLength < sizeof(INBOUND_TWINCODE_DOMAIN) - 1 || memcmp(domain, INBOUND_TWINCODE_DOMAIN, sizeof(INBOUND_TWINCODE_DOMAIN) - 1) != 0) {
+        return TLPeerIdStatusInvalid;
+    }
+
+    if (!parseUUID(bytes, at, info->twincodeInboundId)) {
+        return TLPeerIdStatusBadTwincode;
+    }
+
+    info->hasCallingUserTwincodeId = slashCount == 1 && parseUUID(bytes + slash + 1, length - slash - 1, info->callingUserTwincodeId);
+    return TLPeerIdStatusSuccess;
+}
+
+@end
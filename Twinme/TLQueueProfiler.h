@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+//
+// Interface: TLLatencyHistogram
+//
+
+/**
+ * Histogram of durations in microseconds with a precision of about 3%.
+ *
+ * The values are recorded in log-linear buckets as a HDR histogram: the first 64 buckets hold the
+ * values 0..63 and each following group of 32 buckets covers the next power of 2.
+ */
+@interface TLLatencyHistogram : NSObject
+
+@property (readonly) int64_t count;
+@property (readonly) int64_t totalValue;
+@property (readonly) int64_t maxValue;
+
+- (nonnull instancetype)init;
+
+- (void)recordValue:(int64_t)value;
+
+/// Get the lowest value such that `percentile` % of the recorded values are below or equal.
+- (int64_t)valueAtPercentile:(double)percentile;
+
+@end
+
+//
+// Interface: TLQueueProfileEntry
+//
+
+/// Statistics of the blocks dispatched with the same label.
+@interface TLQueueProfileEntry : NSObject
+
+@property (readonly, nonnull) NSString *label;
+/// Time between the dispatch and the start of the block.
+@property (readonly, nonnull) TLLatencyHistogram *wait;
+/// Execution time of the block.
+@property (readonly, nonnull) TLLatencyHistogram *run;
+
+@end
+
+//
+// Interface: TLQueueProfileReport
+//
+
+@interface TLQueueProfileReport : NSObject
+
+/// The labels which used the queue the most, sorted on the total run time.
+@property (readonly, nonnull) NSArray<TLQueueProfileEntry *> *topEntries;
+/// The number of blocks dispatched and not finished sampled every `sampleInterval`.
+@property (readonly, nonnull) NSArray<NSNumber *> *depthSamples;
+@property (readonly) int64_t blockCount;
+/// Percentage of time the queue was busy during the report period.
+@property (readonly) double occupancy;
+
+@end
+
+//
+// Interface: TLQueueProfiler
+//
+
+/**
+ * Profiler of the blocks dispatched on a serial queue.
+ *
+ * Each block is dispatched with a label and the profiler records how long it waited in the queue and how
+ * long it ran.  Every `reportInterval`, the labels which used the queue the most and the queue depth
+ * samples are given to the `onReport` block (and logged in verbose mode), then the statistics are reset.  The statistics
+ * are updated from the queue so that recording a block only reads the clock twice and updates two
+ * histograms.
+ */
+@interface TLQueueProfiler : NSObject
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (nullable) void (^onReport)(TLQueueProfileReport * _Nonnull report);
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue reportInterval:(NSTimeInterval)reportInterval sampleInterval:(NSTimeInterval)sampleInterval topCount:(int)topCount;
+
+- (void)start;
+
+- (void)stop;
+
+- (void)dispatchWithLabel:(nonnull NSString *)label block:(nonnull dispatch_block_t)block;
+
+/// Build the report of the current period, must be called from the queue.
+- (nonnull TLQueueProfileReport *)reportWithTopCount:(int)topCount;
+
+@end
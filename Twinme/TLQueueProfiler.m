@@ -0,0 +1,364 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+#import "TLQueueProfiler.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+#define SUB_BUCKET_BITS 6
+#define SUB_BUCKET_HALF (1 << (SUB_BUCKET_BITS - 1))
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+// Values are limited to 2^32 us (71 minutes).
+#define MAX_VALUE_BITS 32
+#define BUCKET_COUNT ((MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_HALF + SUB_BUCKET_HALF)
+#define MAX_DEPTH_SAMPLES 600
+
+static mach_timebase_info_data_t timebase;
+
+static inline int64_t toMicroseconds(uint64_t ticks) {
+
+    return (int64_t)(ticks * timebase.numer / timebase.denom / 1000);
+}
+
+static inline int bucketIndex(int64_t value) {
+
+    if (value < SUB_BUCKET_COUNT) {
+        return (int)value;
+    }
+    int msb = 63 - __builtin_clzll((uint64_t)value);
+    int shift = msb - (SUB_BUCKET_BITS - 1);
+    return shift * SUB_BUCKET_HALF + (int)(value >> shift);
+}
+
+static inline int64_t bucketValue(int index) {
+
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    int shift = index / SUB_BUCKET_HALF - 1;
+    int64_t sub = index - shift * SUB_BUCKET_HALF;
+    // Report the highest value of the bucket.
+    return ((sub + 1) << shift) - 1;
+}
+
+//
+// Interface: TLLatencyHistogram ()
+//
+
+@interface TLLatencyHistogram ()
+{
+    uint32_t _counts[BUCKET_COUNT];
+}
+
+@end
+
+//
+// Interface: TLQueueProfileEntry ()
+//
+
+@interface TLQueueProfileEntry ()
+
+- (nonnull instancetype)initWithLabel:(nonnull NSString *)label;
+
+@end
+
+//
+// Interface: TLQueueProfileReport ()
+//
+
+@interface TLQueueProfileReport ()
+
+- (nonnull instancetype)initWithTopEntries:(nonnull NSArray<TLQueueProfileEntry *> *)topEntries depthSamples:(nonnull NSArray<NSNumber *> *)depthSamples blockCount:(int64_t)blockCount occupancy:(double)occupancy;
+
+@end
+
+//
+// Interface: TLQueueProfiler ()
+//
+
+@interface TLQueueProfiler ()
+{
+    atomic_int _depth;
+}
+
+@property (readonly) NSTimeInterval reportInterval;
+@property (readonly) NSTimeInterval sampleInterval;
+@property (readonly) int topCount;
+@property (readonly, nonnull) NSMutableDictionary<NSString *, TLQueueProfileEntry *> *entries;
+@property (readonly, nonnull) NSMutableArray<NSNumber *> *depthSamples;
+@property (nullable) dispatch_source_t reportTimer;
+@property (nullable) dispatch_source_t sampleTimer;
+@property uint64_t periodStart;
+@property uint64_t busyTicks;
+@property int64_t blockCount;
+
+- (void)runReport;
+
+- (void)runSample;
+
+@end
+
+//
+// Implementation: TLLatencyHistogram
+//
+
+@implementation TLLatencyHistogram
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _count = 0;
+        _totalValue = 0;
+        _maxValue = 0;
+    }
+    return self;
+}
+
+- (void)recordValue:(int64_t)value {
+
+    if (value < 0) {
+        value = 0;
+    } else if (value >= (1LL << MAX_VALUE_BITS)) {
+        value = (1LL << MAX_VALUE_BITS) - 1;
+    }
+    _counts[bucketIndex(value)]++;
+    _count++;
+    _totalValue += value;
+    if (value > _maxValue) {
+        _maxValue = value;
+    }
+}
+
+- (int64_t)valueAtPercentile:(double)percentile {
+
+    if (_count == 0) {
+        return 0;
+    }
+    int64_t limit = (int64_t)ceil(_count * percentile / 100.0);
+    if (limit < 1) {
+        limit = 1;
+    }
+    int64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        total += _counts[i];
+        if (total >= limit) {
+            return MIN(bucketValue(i), _maxValue);
+        }
+    }
+    return _maxValue;
+}
+
+@end
+
+//
+// Implementation: TLQueueProfileEntry
+//
+
+@implementation TLQueueProfileEntry
+
+- (nonnull instancetype)initWithLabel:(nonnull NSString *)label {
+
+    self = [super init];
+    if (self) {
+        _label = label;
+        _wait = [[TLLatencyHistogram alloc] init];
+        _run = [[TLLatencyHistogram alloc] init];
+    }
+    return self;
+}
+
+- (NSString *)description {
+
+    return [NSString stringWithFormat:@"%@: count %lld run total %lld us p50 %lld p99 %lld max %lld wait p50 %lld p99 %lld max %lld", self.label, self.run.count, self.run.totalValue, [self.run valueAtPercentile:50], [self.run valueAtPercentile:99], self.run.maxValue, [self.wait valueAtPercentile:50], [self.wait valueAtPercentile:99], self.wait.maxValue];
+}
+
+@end
+
+//
+// Implementation: TLQueueProfileReport
+//
+
+@implementation TLQueueProfileReport
+
+- (nonnull instancetype)initWithTopEntries:(nonnull NSArray<TLQueueProfileEntry *> *)topEntries depthSamples:(nonnull NSArray<NSNumber *> *)depthSamples blockCount:(int64_t)blockCount occupancy:(double)occupancy {
+
+    self = [super init];
+    if (self) {
+        _topEntries = topEntries;
+        _depthSamples = depthSamples;
+        _blockCount = blockCount;
+        _occupancy = occupancy;
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLQueueProfiler
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLQueueProfiler"
+
+@implementation TLQueueProfiler
+
++ (void)initialize {
+
+    mach_timebase_info(&timebase);
+}
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue reportInterval:(NSTimeInterval)reportInterval sampleInterval:(NSTimeInterval)sampleInterval topCount:(int)topCount {
+    DDLogVerbose(@"%@ initWithQueue: %@ reportInterval: %f sampleInterval: %f topCount: %d", LOG_TAG, queue, reportInterval, sampleInterval, topCount);
+
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _reportInterval = reportInterval;
+        _sampleInterval = sampleInterval;
+        _topCount = topCount;
+        // The labels are compared on their content: a label built for each dispatch uses the same entry.
+        _entries = [[NSMutableDictionary alloc] initWithCapacity:128];
+        _depthSamples = [[NSMutableArray alloc] init];
+        _periodStart = mach_absolute_time();
+        _busyTicks = 0;
+        _blockCount = 0;
+        atomic_init(&_depth, 0);
+    }
+    return self;
+}
+
+- (void)start {
+    DDLogVerbose(@"%@ start", LOG_TAG);
+
+    if (self.reportTimer) {
+        return;
+    }
+
+    // The report is made from the queue which owns the statistics.
+    self.reportTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+    dispatch_source_set_timer(self.reportTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.reportInterval * NSEC_PER_SEC)), (uint64_t)(self.reportInterval * NSEC_PER_SEC), NSEC_PER_SEC);
+    __weak TLQueueProfiler *weakSelf = self;
+    dispatch_source_set_event_handler(self.reportTimer, ^{
+        [weakSelf runReport];
+    });
+
+    // The depth is sampled outside of the queue so that a busy queue does not delay the samples.
+    self.sampleTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+    dispatch_source_set_timer(self.sampleTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.sampleInterval * NSEC_PER_SEC)), (uint64_t)(self.sampleInterval * NSEC_PER_SEC), (uint64_t)(self.sampleInterval * NSEC_PER_SEC / 10));
+    dispatch_source_set_event_handler(self.sampleTimer, ^{
+        [weakSelf runSample];
+    });
+    dispatch_resume(self.reportTimer);
+    dispatch_resume(self.sampleTimer);
+}
+
+- (void)stop {
+    DDLogVerbose(@"%@ stop", LOG_TAG);
+
+    if (self.reportTimer) {
+        dispatch_source_cancel(self.reportTimer);
+        self.reportTimer = nil;
+    }
+    if (self.sampleTimer) {
+        dispatch_source_cancel(self.sampleTimer);
+        self.sampleTimer = nil;
+    }
+}
+
+- (void)dispatchWithLabel:(nonnull NSString *)label block:(nonnull dispatch_block_t)block {
+
+    uint64_t enqueueTime = mach_absolute_time();
+    atomic_fetch_add_explicit(&_depth, 1, memory_order_relaxed);
+    dispatch_async(self.queue, ^{
+        uint64_t startTime = mach_absolute_time();
+        block();
+        uint64_t endTime = mach_absolute_time();
+        atomic_fetch_sub_explicit(&self->_depth, 1, memory_order_relaxed);
+
+        TLQueueProfileEntry *entry = self.entries[label];
+        if (!entry) {
+            entry = [[TLQueueProfileEntry alloc] initWithLabel:label];
+            self.entries[label] = entry;
+        }
+        [entry.wait recordValue:toMicroseconds(startTime - enqueueTime)];
+        [entry.run recordValue:toMicroseconds(endTime - startTime)];
+        self.busyTicks += endTime - startTime;
+        self.blockCount++;
+    });
+}
+
+- (nonnull TLQueueProfileReport *)reportWithTopCount:(int)topCount {
+    DDLogVerbose(@"%@ reportWithTopCount: %d", LOG_TAG, topCount);
+
+    NSMutableArray<TLQueueProfileEntry *> *entries = [[NSMutableArray alloc] initWithArray:self.entries.allValues];
+    [entries sortUsingComparator:^NSComparisonResult(TLQueueProfileEntry *entry1, TLQueueProfileEntry *entry2) {
+        if (entry1.run.totalValue != entry2.run.totalValue) {
+            return entry1.run.totalValue > entry2.run.totalValue ? NSOrderedAscending : NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+    if (entries.count > (NSUInteger)topCount) {
+        [entries removeObjectsInRange:NSMakeRange((NSUInteger)topCount, entries.count - (NSUInteger)topCount)];
+    }
+
+    NSArray<NSNumber *> *depthSamples;
+    @synchronized (self.depthSamples) {
+        depthSamples = [self.depthSamples copy];
+    }
+    uint64_t period = mach_absolute_time() - self.periodStart;
+    double occupancy = period > 0 ? (100.0 * self.busyTicks) / period : 0;
+    return [[TLQueueProfileReport alloc] initWithTopEntries:entries depthSamples:depthSamples blockCount:self.blockCount occupancy:occupancy];
+}
+
+#pragma mark - Private methods
+
+- (void)runReport {
+    DDLogVerbose(@"%@ runReport", LOG_TAG);
+
+    TLQueueProfileReport *report = [self reportWithTopCount:self.topCount];
+    DDLogVerbose(@"%@ %lld blocks occupancy %.1f%% depth %@", LOG_TAG, report.blockCount, report.occupancy, [report.depthSamples componentsJoinedByString:@" "]);
+    for (TLQueueProfileEntry *entry in report.topEntries) {
+        DDLogVerbose(@"%@ %@", LOG_TAG, entry);
+    }
+
+    [self.entries removeAllObjects];
+    @synchronized (self.depthSamples) {
+        [self.depthSamples removeAllObjects];
+    }
+    self.periodStart = mach_absolute_time();
+    self.busyTicks = 0;
+    self.blockCount = 0;
+
+    void (^onReport)(TLQueueProfileReport *report) = self.onReport;
+    if (onReport) {
+        onReport(report);
+    }
+}
+
+- (void)runSample {
+
+    int depth = atomic_load_explicit(&_depth, memory_order_relaxed);
+    @synchronized (self.depthSamples) {
+        if (self.depthSamples.count >= MAX_DEPTH_SAMPLES) {
+            [self.depthSamples removeObjectAtIndex:0];
+        }
+        [self.depthSamples addObject:[NSNumber numberWithInt:depth]];
+    }
+}
+
+@end
@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+/// Process a batch: the keys are in the order they were first added and each key has the list of its items.
+typedef void (^TLRefreshBatcherFlush)(NSArray<id<NSCopying>> * _Nonnull keys, NSDictionary<id<NSCopying>, NSArray *> * _Nonnull items);
+
+//
+// Interface: TLRefreshBatcher
+//
+
+/**
+ * Group the refresh requests which arrive within a short window (for example the pair::refresh invocations
+ * received when a peer changes its identity on every space).
+ *
+ * - the first item added to an empty batch arms a timer of `delay` seconds, the batch is given to the flush
+ *   block on the queue when the timer fires or as soon as it contains `maxCount` keys,
+ * - the items added with the same key are given together so that the object is refreshed once,
+ * - the items added while a batch is being flushed go in the next batch.
+ */
+@interface TLRefreshBatcher : NSObject
+
+/// Number of keys in the batch being collected.
+@property (readonly) NSUInteger pendingCount;
+
+/// Number of batches given to the flush block.
+@property (readonly) int flushCount;
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue delay:(NSTimeInterval)delay maxCount:(NSUInteger)maxCount flush:(nonnull TLRefreshBatcherFlush)flush;
+
+/// Add the item to the batch, returns NO if the key was already in the batch.
+- (BOOL)addWithKey:(nonnull id<NSCopying>)key item:(nonnull id)item;
+
+/// Give the current batch to the flush block without waiting for the timer.
+- (void)flush;
+
+/// Drop the batch being collected, its timer is ignored.
+- (void)reset;
+
+@end
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLRefreshBatcher.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Interface: TLRefreshBatcher ()
+//
+
+@interface TLRefreshBatcher ()
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly) NSTimeInterval delay;
+@property (readonly) NSUInteger maxCount;
+@property (readonly, nonnull) TLRefreshBatcherFlush flushBlock;
+@property (nonnull) NSMutableArray<id<NSCopying>> *keys;
+@property (nonnull) NSMutableDictionary<id<NSCopying>, NSMutableArray *> *items;
+/// Incremented each time a batch is taken so that the timer of a batch flushed early is ignored.
+@property int64_t generation;
+@property int flushed;
+
+- (void)flushWithGeneration:(int64_t)generation;
+
+@end
+
+//
+// Implementation: TLRefreshBatcher
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLRefreshBatcher"
+
+@implementation TLRefreshBatcher
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue delay:(NSTimeInterval)delay maxCount:(NSUInteger)maxCount flush:(nonnull TLRefreshBatcherFlush)flush {
+    DDLogVerbose(@"%@ initWithQueue: %@ delay: %f maxCount: %lu", LOG_TAG, queue, delay, (unsigned long)maxCount);
+
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _delay = delay;
+        _maxCount = maxCount;
+        _flushBlock = flush;
+        _keys = [[NSMutableArray alloc] init];
+        _items = [[NSMutableDictionary alloc] init];
+        _generation = 0;
+        _flushed = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)pendingCount {
+
+    @synchronized (self) {
+        return self.keys.count;
+    }
+}
+
+- (int)flushCount {
+
+    @synchronized (self) {
+        return self.flushed;
+    }
+}
+
+- (BOOL)addWithKey:(nonnull id<NSCopying>)key item:(nonnull id)item {
+    DDLogVerbose(@"%@ addWithKey: %@", LOG_TAG, key);
+
+    BOOL added;
+    BOOL armTimer = NO;
+    int64_t generation;
+    @synchronized (self) {
+        NSMutableArray *list = self.items[key];
+        added = list == nil;
+        if (added) {
+            armTimer = self.keys.count == 0;
+            list = [[NSMutableArray alloc] init];
+            self.items[key] = list;
+            [self.keys addObject:key];
+        }
+        [list addObject:item];
+        generation = self.generation;
+
+        // Take the full batch now so that it never contains more than maxCount keys, the batches are
+        // queued in the order they are taken.
+        if (self.keys.count >= self.maxCount) {
+            NSArray<id<NSCopying>> *keys = self.keys;
+            NSDictionary<id<NSCopying>, NSArray *> *items = self.items;
+            self.keys = [[NSMutableArray alloc] init];
+            self.items = [[NSMutableDictionary alloc] init];
+            self.generation++;
+            self.flushed++;
+            dispatch_async(self.queue, ^{
+                self.flushBlock(keys, items);
+            });
+            return added;
+        }
+    }
+
+    if (armTimer) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.delay * NSEC_PER_SEC)), self.queue, ^{
+            [self flushWithGeneration:generation];
+        });
+    }
+    return added;
+}
+
+- (void)flush {
+    DDLogVerbose(@"%@ flush", LOG_TAG);
+
+    int64_t generation;
+    @synchronized (self) {
+        generation = self.generation;
+    }
+    dispatch_async(self.queue, ^{
+        [self flushWithGeneration:generation];
+    });
+}
+
+- (void)reset {
+    DDLogVerbose(@"%@ reset", LOG_TAG);
+
+    @synchronized (self) {
+        [self.keys removeAllObjects];
+        [self.items removeAllObjects];
+        self.generation++;
+    }
+}
+
+#pragma mark - Private methods
+
+- (void)flushWithGeneration:(int64_t)generation {
+    DDLogVerbose(@"%@ flushWithGeneration: %lld", LOG_TAG, generation);
+
+    NSArray<id<NSCopying>> *keys;
+    NSDictionary<id<NSCopying>, NSArray *> *items;
+    @synchronized (self) {
+        if (generation != self.generation || self.keys.count == 0) {
+            return;
+        }
+        keys = self.keys;
+        items = self.items;
+        self.keys = [[NSMutableArray alloc] init];
+        self.items = [[NSMutableDictionary alloc] init];
+        self.generation++;
+        self.flushed++;
+    }
+
+    self.flushBlock(keys, items);
+}
+
+@end
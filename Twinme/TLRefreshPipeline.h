@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <Twinlife/TLBaseService.h>
+
+/// Invoke the item: the complete block must be called once with the result of the invocation.
+typedef void (^TLRefreshPipelineInvoke)(id _Nonnull item, void (^ _Nonnull complete)(TLBaseServiceErrorCode errorCode));
+
+//
+// Interface: TLRefreshPipeline
+//
+
+/**
+ * Pipeline of the invocations sent to notify a list of peers (for example the members of a group).
+ *
+ * - the items are invoked in the order they are added and an item added twice is invoked once,
+ * - at most `window` invocations are in progress at the same time,
+ * - a failed invocation is retried `maxRetry` times after `retryDelay`, then 2 * `retryDelay`, ...,
+ *   the waiting item does not use a slot of the window,
+ * - an ItemNotFound error is final since the peer twincode was deleted,
+ * - an item that fails because we are offline is parked without counting an attempt until `resume`
+ *   is called when we are online again,
+ * - the completion block is called once when every item is finished.
+ */
+@interface TLRefreshPipeline : NSObject
+
+/// Number of items waiting to be invoked, being invoked, waiting to be online and that failed after the retries.
+@property (readonly) NSUInteger pendingCount;
+@property (readonly) int runningCount;
+@property (readonly) NSUInteger parkedCount;
+@property (readonly) int failedCount;
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue window:(int)window maxRetry:(int)maxRetry retryDelay:(NSTimeInterval)retryDelay invoke:(nonnull TLRefreshPipelineInvoke)invoke;
+
+/// Add the item to invoke, returns NO if an item with the same key was already added.
+- (BOOL)addWithKey:(nonnull NSUUID *)key item:(nonnull id)item;
+
+/// Start the invocations, the completion block is called from the queue with the number of failed items.
+- (void)startWithCompletion:(nonnull void (^)(int failedCount))completion;
+
+/// Invoke again the items parked while we were offline, in the order they were added.
+- (void)resume;
+
+@end
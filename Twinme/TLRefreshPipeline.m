@@ -0,0 +1,256 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLRefreshPipeline.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Interface: TLRefreshPipelineEntry
+//
+
+@interface TLRefreshPipelineEntry : NSObject
+
+@property (readonly, nonnull) id item;
+@property (readonly) NSUInteger position;
+@property int attempt;
+
+- (nonnull instancetype)initWithItem:(nonnull id)item position:(NSUInteger)position;
+
+@end
+
+//
+// Interface: TLRefreshPipeline ()
+//
+
+@interface TLRefreshPipeline ()
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly) int window;
+@property (readonly) int maxRetry;
+@property (readonly) NSTimeInterval retryDelay;
+@property (readonly, nonnull) TLRefreshPipelineInvoke invoke;
+@property (readonly, nonnull) NSMutableSet<NSUUID *> *keys;
+@property (readonly, nonnull) NSMutableArray<TLRefreshPipelineEntry *> *pending;
+@property (readonly, nonnull) NSMutableArray<TLRefreshPipelineEntry *> *parked;
+@property (nullable) void (^completion)(int failedCount);
+@property int running;
+@property int waiting;
+@property int failed;
+@property BOOL finished;
+
+- (void)runInvocations;
+
+- (void)onCompleteWithEntry:(nonnull TLRefreshPipelineEntry *)entry errorCode:(TLBaseServiceErrorCode)errorCode;
+
+@end
+
+//
+// Implementation: TLRefreshPipelineEntry
+//
+
+@implementation TLRefreshPipelineEntry
+
+- (nonnull instancetype)initWithItem:(nonnull id)item position:(NSUInteger)position {
+
+    self = [super init];
+    if (self) {
+        _item = item;
+        _position = position;
+        _attempt = 0;
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLRefreshPipeline
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLRefreshPipeline"
+
+@implementation TLRefreshPipeline
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue window:(int)window maxRetry:(int)maxRetry retryDelay:(NSTimeInterval)retryDelay invoke:(nonnull TLRefreshPipelineInvoke)invoke {
+    DDLogVerbose(@"%@ initWithQueue: %@ window: %d maxRetry: %d retryDelay: %f", LOG_TAG, queue, window, maxRetry, retryDelay);
+
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _window = window;
+        _maxRetry = maxRetry;
+        _retryDelay = retryDelay;
+        _invoke = invoke;
+        _keys = [[NSMutableSet alloc] init];
+        _pending = [[NSMutableArray alloc] init];
+        _parked = [[NSMutableArray alloc] init];
+        _running = 0;
+        _waiting = 0;
+        _failed = 0;
+        _finished = NO;
+    }
+    return self;
+}
+
+- (NSUInteger)pendingCount {
+
+    @synchronized (self) {
+        return self.pending.count;
+    }
+}
+
+- (int)runningCount {
+
+    @synchronized (self) {
+        return self.running;
+    }
+}
+
+- (NSUInteger)parkedCount {
+
+    @synchronized (self) {
+        return self.parked.count;
+    }
+}
+
+- (int)failedCount {
+
+    @synchronized (self) {
+        return self.failed;
+    }
+}
+
+- (BOOL)addWithKey:(nonnull NSUUID *)key item:(nonnull id)item {
+    DDLogVerbose(@"%@ addWithKey: %@", LOG_TAG, key);
+
+    @synchronized (self) {
+        if ([self.keys containsObject:key]) {
+            return NO;
+        }
+        [self.keys addObject:key];
+        [self.pending addObject:[[TLRefreshPipelineEntry alloc] initWithItem:item position:self.keys.count]];
+        return YES;
+    }
+}
+
+- (void)startWithCompletion:(nonnull void (^)(int failedCount))completion {
+    DDLogVerbose(@"%@ startWithCompletion", LOG_TAG);
+
+    @synchronized (self) {
+        self.completion = completion;
+    }
+    dispatch_async(self.queue, ^{
+        [self runInvocations];
+    });
+}
+
+- (void)resume {
+    DDLogVerbose(@"%@ resume", LOG_TAG);
+
+    @synchronized (self) {
+        if (self.parked.count == 0) {
+            return;
+        }
+
+        // The parked items were added before the pending ones.
+        [self.parked sortUsingComparator:^NSComparisonResult(TLRefreshPipelineEntry *entry1, TLRefreshPipelineEntry *entry2) {
+            return entry1.position < entry2.position ? NSOrderedAscending : (entry1.position > entry2.position ? NSOrderedDescending : NSOrderedSame);
+        }];
+        [self.pending insertObjects:self.parked atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, self.parked.count)]];
+        [self.parked removeAllObjects];
+    }
+    dispatch_async(self.queue, ^{
+        [self runInvocations];
+    });
+}
+
+#pragma mark - Private methods
+
+- (void)runInvocations {
+    DDLogVerbose(@"%@ runInvocations", LOG_TAG);
+
+    NSMutableArray<TLRefreshPipelineEntry *> *entries = nil;
+    void (^completion)(int failedCount) = nil;
+    int failed;
+    @synchronized (self) {
+        while (self.running < self.window && self.pending.count > 0) {
+            if (!entries) {
+                entries = [[NSMutableArray alloc] init];
+            }
+            [entries addObject:self.pending[0]];
+            [self.pending removeObjectAtIndex:0];
+            self.running++;
+        }
+
+        if (!self.finished && self.completion && self.running == 0 && self.waiting == 0 && self.pending.count == 0 && self.parked.count == 0) {
+            self.finished = YES;
+            completion = self.completion;
+            self.completion = nil;
+        }
+        failed = self.failed;
+    }
+
+    for (TLRefreshPipelineEntry *entry in entries) {
+        self.invoke(entry.item, ^(TLBaseServiceErrorCode errorCode) {
+            [self onCompleteWithEntry:entry errorCode:errorCode];
+        });
+    }
+
+    if (completion) {
+        completion(failed);
+    }
+}
+
+- (void)onCompleteWithEntry:(nonnull TLRefreshPipelineEntry *)entry errorCode:(TLBaseServiceErrorCode)errorCode {
+    DDLogVerbose(@"%@ onCompleteWithEntry: %@ errorCode: %d", LOG_TAG, entry.item, errorCode);
+
+    BOOL retry = NO;
+    int64_t delay = 0;
+    @synchronized (self) {
+        self.running--;
+        if (errorCode == TLBaseServiceErrorCodeTwinlifeOffline) {
+            // Retrying before we are online again would only consume the attempts.
+            [self.parked addObject:entry];
+
+        } else if (errorCode != TLBaseServiceErrorCodeSuccess && errorCode != TLBaseServiceErrorCodeItemNotFound) {
+            if (entry.attempt < self.maxRetry) {
+                delay = (int64_t)(self.retryDelay * (1 << entry.attempt) * NSEC_PER_SEC);
+                entry.attempt++;
+                self.waiting++;
+                retry = YES;
+            } else {
+                DDLogWarn(@"%@ invocation of %@ failed: %d", LOG_TAG, entry.item, errorCode);
+                self.failed++;
+            }
+        }
+    }
+
+    if (retry) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay), self.queue, ^{
+            @synchronized (self) {
+                self.waiting--;
+                [self.pending insertObject:entry atIndex:0];
+            }
+            [self runInvocations];
+        });
+    } else {
+        dispatch_async(self.queue, ^{
+            [self runInvocations];
+        });
+    }
+}
+
+@end
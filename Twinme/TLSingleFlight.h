@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <Twinlife/TLBaseService.h>
+
+typedef void (^TLSingleFlightBlock)(TLBaseServiceErrorCode errorCode, id _Nullable result);
+typedef void (^TLSingleFlightStartBlock)(TLSingleFlightBlock _Nonnull complete);
+
+//
+// Interface: TLSingleFlightKey
+//
+
+/// Key made of two identifiers, for example the group and the member twincode.
+@interface TLSingleFlightKey : NSObject <NSCopying>
+
+@property (readonly, nonnull) NSUUID *first;
+@property (readonly, nonnull) NSUUID *second;
+
+- (nonnull instancetype)initWithFirst:(nonnull NSUUID *)first second:(nonnull NSUUID *)second;
+
+@end
+
+//
+// Interface: TLSingleFlight
+//
+
+/**
+ * Table of the lookups in progress to make sure the same object is loaded only once.
+ *
+ * The first caller for a key is asked to start the lookup, the next callers are attached to it
+ * until the lookup completes: the result is then given to every caller and the key is released.
+ * Each lookup has its own generation so that the late completion of a lookup released by
+ * completeAllWithErrorCode is not given to the callers of a newer lookup of the same key.
+ */
+@interface TLSingleFlight : NSObject
+
+/// Number of keys being looked up.
+@property (readonly) NSUInteger count;
+
+/// Attach the block to the lookup of the key, returns the generation of the lookup when the caller must
+/// start it and 0 when the block is attached to a lookup in progress.
+- (int64_t)joinWithKey:(nonnull TLSingleFlightKey *)key block:(nonnull TLSingleFlightBlock)block;
+
+/// Give the result of the lookup to all the callers attached to the key, the result of an older generation is dropped.
+- (void)completeWithKey:(nonnull TLSingleFlightKey *)key generation:(int64_t)generation errorCode:(TLBaseServiceErrorCode)errorCode result:(nullable id)result;
+
+/// Attach the block to the lookup of the key and call `start` when the caller must start the lookup.
+/// The lookup must call the `complete` block on every terminal path, including errors and cancellation.
+- (void)lookupWithKey:(nonnull TLSingleFlightKey *)key block:(nonnull TLSingleFlightBlock)block start:(nonnull TLSingleFlightStartBlock)start;
+
+/// Give the error to the callers of every lookup in progress and release the keys.
+- (void)completeAllWithErrorCode:(TLBaseServiceErrorCode)errorCode;
+
+@end
@@ -0,0 +1,192 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLSingleFlight.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Implementation: TLSingleFlightKey
+//
+
+@implementation TLSingleFlightKey
+
+- (nonnull instancetype)initWithFirst:(nonnull NSUUID *)first second:(nonnull NSUUID *)second {
+
+    self = [super init];
+    if (self) {
+        _first = first;
+        _second = second;
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+
+    return self;
+}
+
+- (BOOL)isEqual:(id)object {
+
+    if (self == object) {
+        return YES;
+    }
+    if (![object isKindOfClass:[TLSingleFlightKey class]]) {
+        return NO;
+    }
+    TLSingleFlightKey *key = (TLSingleFlightKey *)object;
+    return [self.second isEqual:key.second] && [self.first isEqual:key.first];
+}
+
+- (NSUInteger)hash {
+
+    return 31 * self.first.hash + self.second.hash;
+}
+
+- (NSString *)description {
+
+    return [NSString stringWithFormat:@"%@/%@", self.first, self.second];
+}
+
+@end
+
+//
+// Interface: TLSingleFlightLookup
+//
+
+/// The callers attached to a lookup in progress.
+@interface TLSingleFlightLookup : NSObject
+
+@property (readonly) int64_t generation;
+@property (readonly, nonnull) NSMutableArray<TLSingleFlightBlock> *blocks;
+
+- (nonnull instancetype)initWithGeneration:(int64_t)generation block:(nonnull TLSingleFlightBlock)block;
+
+@end
+
+//
+// Interface: TLSingleFlight ()
+//
+
+@interface TLSingleFlight ()
+
+@property (readonly, nonnull) NSMutableDictionary<TLSingleFlightKey *, TLSingleFlightLookup *> *lookups;
+@property int64_t lastGeneration;
+
+@end
+
+//
+// Implementation: TLSingleFlightLookup
+//
+
+@implementation TLSingleFlightLookup
+
+- (nonnull instancetype)initWithGeneration:(int64_t)generation block:(nonnull TLSingleFlightBlock)block {
+
+    self = [super init];
+    if (self) {
+        _generation = generation;
+        _blocks = [[NSMutableArray alloc] initWithObjects:block, nil];
+    }
+    return self;
+}
+
+@end
+
+//
+// Implementation: TLSingleFlight
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLSingleFlight"
+
+@implementation TLSingleFlight
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _lookups = [[NSMutableDictionary alloc] init];
+        _lastGeneration = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+
+    @synchronized (self) {
+        return self.lookups.count;
+    }
+}
+
+- (int64_t)joinWithKey:(nonnull TLSingleFlightKey *)key block:(nonnull TLSingleFlightBlock)block {
+    DDLogVerbose(@"%@ joinWithKey: %@", LOG_TAG, key);
+
+    @synchronized (self) {
+        TLSingleFlightLookup *lookup = self.lookups[key];
+        if (lookup) {
+            [lookup.blocks addObject:block];
+            return 0;
+        }
+        self.lastGeneration++;
+        self.lookups[key] = [[TLSingleFlightLookup alloc] initWithGeneration:self.lastGeneration block:block];
+        return self.lastGeneration;
+    }
+}
+
+- (void)completeWithKey:(nonnull TLSingleFlightKey *)key generation:(int64_t)generation errorCode:(TLBaseServiceErrorCode)errorCode result:(nullable id)result {
+    DDLogVerbose(@"%@ completeWithKey: %@ generation: %lld errorCode: %d", LOG_TAG, key, generation, errorCode);
+
+    TLSingleFlightLookup *lookup;
+    @synchronized (self) {
+        lookup = self.lookups[key];
+        if (!lookup || lookup.generation != generation) {
+            return;
+        }
+        [self.lookups removeObjectForKey:key];
+    }
+
+    for (TLSingleFlightBlock block in lookup.blocks) {
+        block(errorCode, result);
+    }
+}
+
+- (void)lookupWithKey:(nonnull TLSingleFlightKey *)key block:(nonnull TLSingleFlightBlock)block start:(nonnull TLSingleFlightStartBlock)start {
+    DDLogVerbose(@"%@ lookupWithKey: %@", LOG_TAG, key);
+
+    int64_t generation = [self joinWithKey:key block:block];
+    if (generation) {
+        start(^(TLBaseServiceErrorCode errorCode, id result) {
+            [self completeWithKey:key generation:generation errorCode:errorCode result:result];
+        });
+    }
+}
+
+- (void)completeAllWithErrorCode:(TLBaseServiceErrorCode)errorCode {
+    DDLogVerbose(@"%@ completeAllWithErrorCode: %d", LOG_TAG, errorCode);
+
+    NSArray<TLSingleFlightLookup *> *lookups;
+    @synchronized (self) {
+        lookups = self.lookups.allValues;
+        [self.lookups removeAllObjects];
+    }
+
+    for (TLSingleFlightLookup *lookup in lookups) {
+        for (TLSingleFlightBlock block in lookup.blocks) {
+            block(errorCode, nil);
+        }
+    }
+}
+
+@end
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <uuid/uuid.h>
+
+//
+// Interface: TLDataSlice
+//
+
+/**
+ * View on a string or bytes value of a serialized object.
+ *
+ * The slice keeps a reference on the original data and the NSString or NSData is created on the first access.
+ */
+@interface TLDataSlice : NSObject
+
+@property (readonly) NSUInteger length;
+
+/// The UTF-8 string decoded on the first access.
+@property (readonly, nullable) NSString *string;
+
+/// A copy of the bytes made on the first access.
+@property (readonly, nonnull) NSData *data;
+
+/// Compare the UTF-8 bytes of the slice with the C string without decoding the slice.
+- (BOOL)isEqualToUTF8String:(nonnull const char *)value;
+
+@end
+
+//
+// Interface: TLSliceDecoder
+//
+
+/**
+ * Decoder for the binary serialization which reads the values directly from the original bytes.
+ *
+ * It reads the same format as TLBinaryDecoder: int, long and enum values are zig-zag variable length
+ * integers, a UUID is made of two longs and strings and bytes are prefixed by their length.  The strings
+ * and bytes are returned as TLDataSlice so that a value that is only compared or never used is not copied.
+ * A truncated or invalid buffer raises a TLDecoderException as TLBinaryDecoder.
+ */
+@interface TLSliceDecoder : NSObject
+
+/// Position of the next value in the data.
+@property (readonly) NSUInteger offset;
+
+- (nonnull instancetype)initWithData:(nonnull NSData *)data;
+
+- (int64_t)readLong;
+
+- (int)readInt;
+
+- (int)readEnum;
+
+/// Read the UUID without creating the NSUUID object.
+- (void)readUUIDWithBytes:(nonnull uuid_t)uuid;
+
+- (nonnull NSUUID *)readUUID;
+
+- (nonnull TLDataSlice *)readStringSlice;
+
+- (nonnull TLDataSlice *)readDataSlice;
+
+@end
+
+//
+// Protocol: TLSliceDeserializer
+//
+
+/// Serializer which can decode its object from a TLSliceDecoder, after the schema id and version.
+@protocol TLSliceDeserializer
+
+- (nullable NSObject *)deserializeWithSliceDecoder:(nonnull TLSliceDecoder *)decoder;
+
+@end
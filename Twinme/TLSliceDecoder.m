@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import "TLSliceDecoder.h"
+
+// A long value is encoded on at most 10 bytes.
+#define MAX_VARINT_LENGTH 10
+
+static void decoderException(void) {
+
+    @throw [NSException exceptionWithName:@"TLDecoderException" reason:nil userInfo:nil];
+}
+
+//
+// Interface: TLDataSlice ()
+//
+
+@interface TLDataSlice ()
+
+@property (readonly, nonnull) NSData *buffer;
+@property (readonly) NSRange range;
+@property (nullable) NSString *decodedString;
+@property (nullable) NSData *decodedData;
+@property BOOL stringDone;
+
+- (nonnull instancetype)initWithBuffer:(nonnull NSData *)buffer range:(NSRange)range;
+
+@end
+
+//
+// Interface: TLSliceDecoder ()
+//
+
+@interface TLSliceDecoder ()
+
+@property (readonly, nonnull) NSData *data;
+@property (readonly, nonnull) const uint8_t *bytes;
+@property (readonly) NSUInteger length;
+
+@end
+
+//
+// Implementation: TLDataSlice
+//
+
+@implementation TLDataSlice
+
+- (nonnull instancetype)initWithBuffer:(nonnull NSData *)buffer range:(NSRange)range {
+
+    self = [super init];
+    if (self) {
+        _buffer = buffer;
+        _range = range;
+        _stringDone = NO;
+    }
+    return self;
+}
+
+- (NSUInteger)length {
+
+    return self.range.length;
+}
+
+- (nullable NSString *)string {
+
+    @synchronized (self) {
+        if (!self.stringDone) {
+            self.decodedString = [[NSString alloc] initWithBytes:(const uint8_t *)self.buffer.bytes + self.range.location length:self.range.length encoding:NSUTF8StringEncoding];
+            self.stringDone = YES;
+        }
+        return self.decodedString;
+    }
+}
+
+- (nonnull NSData *)data {
+
+    @synchronized (self) {
+        if (!self.decodedData) {
+            self.decodedData = [self.buffer subdataWithRange:self.range];
+        }
+        return self.decodedData;
+    }
+}
+
+- (BOOL)isEqualToUTF8String:(nonnull const char *)value {
+
+    size_t length = strlen(value);
+    return length == self.range.length && memcmp((const uint8_t *)self.buffer.bytes + self.range.location, value, length) == 0;
+}
+
+@end
+
+//
+// Implementation: TLSliceDecoder
+//
+
+@implementation TLSliceDecoder
+
+- (nonnull instancetype)initWithData:(nonnull NSData *)data {
+
+    self = [super init];
+    if (self) {
+        _data = data;
+        _bytes = data.bytes;
+        _length = data.length;
+        _offset = 0;
+    }
+    return self;
+}
+
+- (int64_t)readLong {
+
+    uint64_t value = 0;
+    int shift = 0;
+    for (int i = 0; i < MAX_VARINT_LENGTH; i++) {
+        if (_offset >= _length) {
+            decoderException();
+        }
+        uint8_t b = _bytes[_offset++];
+        value |= (uint64_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+        }
+        shift += 7;
+    }
+    decoderException();
+    return 0;
+}
+
+- (int)readInt {
+
+    return (int)[self readLong];
+}
+
+- (int)readEnum {
+
+    return (int)[self readLong];
+}
+
+- (void)readUUIDWithBytes:(nonnull uuid_t)uuid {
+
+    uint64_t mostSigBits = (uint64_t)[self readLong];
+    uint64_t leastSigBits = (uint64_t)[self readLong];
+    for (int i = 0; i < 8; i++) {
+        uuid[i] = (unsigned char)(mostSigBits >> (56 - 8 * i));
+        uuid[8 + i] = (unsigned char)(leastSigBits >> (56 - 8 * i));
+    }
+}
+
+- (nonnull NSUUID *)readUUID {
+
+    uuid_t uuid;
+    [self readUUIDWithBytes:uuid];
+    return [[NSUUID alloc] initWithUUIDBytes:uuid];
+}
+
+- (nonnull TLDataSlice *)readStringSlice {
+
+    return [self readDataSlice];
+}
+
+- (nonnull TLDataSlice *)readDataSlice {
+
+    int64_t length = [self readLong];
+    if (length < 0 || (uint64_t)length > _length - _offset) {
+        decoderException();
+    }
+    TLDataSlice *slice = [[TLDataSlice alloc] initWithBuffer:_data range:NSMakeRange(_offset, (NSUInteger)length)];
+    _offset += (NSUInteger)length;
+    return slice;
+}
+
+@end
@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+//
+// Interface: TLSpaceOriginatorCache
+//
+
+/**
+ * Cache of the contact and group ids which are part of each space.
+ *
+ * The sets are immutable and they are replaced when a contact or group is created, moved or deleted,
+ * so that a set returned by the cache can be used without lock.  A set loaded from the repository
+ * is stored only if the cache was not modified while it was loaded.
+ */
+@interface TLSpaceOriginatorCache : NSObject
+
+/// Modification counter to give to `putWithSpaceId:originatorSet:version:` after loading a set.
+@property (readonly) int64_t version;
+
+/// Number of originator ids in the cached sets.
+@property (readonly) NSUInteger count;
+
+- (nonnull instancetype)init;
+
+/// Get the cached originator set of the space or nil when it must be loaded.
+- (nullable NSSet<NSUUID *> *)originatorSetWithSpaceId:(nonnull NSUUID *)spaceId;
+
+/// Store the originator set loaded from the repository if the cache was not modified since `version`.
+- (void)putWithSpaceId:(nonnull NSUUID *)spaceId originatorSet:(nonnull NSSet<NSUUID *> *)originatorSet version:(int64_t)version;
+
+/// The contact or group is now part of the space or it was deleted when the space is nil.
+- (void)updateWithOriginatorId:(nonnull NSUUID *)originatorId spaceId:(nullable NSUUID *)spaceId;
+
+- (void)removeWithSpaceId:(nonnull NSUUID *)spaceId;
+
+- (void)removeAll;
+
+@end
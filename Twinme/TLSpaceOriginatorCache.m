@@ -0,0 +1,141 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import <CocoaLumberjack.h>
+
+#import "TLSpaceOriginatorCache.h"
+
+#if 0
+static const int ddLogLevel = DDLogLevelVerbose;
+#else
+static const int ddLogLevel = DDLogLevelWarning;
+#endif
+
+//
+// Interface: TLSpaceOriginatorCache ()
+//
+
+@interface TLSpaceOriginatorCache ()
+
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, NSSet<NSUUID *> *> *spaces;
+@property int64_t modificationCount;
+
+@end
+
+//
+// Implementation: TLSpaceOriginatorCache
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLSpaceOriginatorCache"
+
+@implementation TLSpaceOriginatorCache
+
+- (nonnull instancetype)init {
+    DDLogVerbose(@"%@ init", LOG_TAG);
+
+    self = [super init];
+    if (self) {
+        _spaces = [[NSMutableDictionary alloc] init];
+        _modificationCount = 0;
+    }
+    return self;
+}
+
+- (int64_t)version {
+
+    @synchronized (self) {
+        return self.modificationCount;
+    }
+}
+
+- (NSUInteger)count {
+
+    NSUInteger result = 0;
+    @synchronized (self) {
+        for (NSUUID *spaceId in self.spaces) {
+            result += self.spaces[spaceId].count;
+        }
+    }
+    return result;
+}
+
+- (nullable NSSet<NSUUID *> *)originatorSetWithSpaceId:(nonnull NSUUID *)spaceId {
+    DDLogVerbose(@"%@ originatorSetWithSpaceId: %@", LOG_TAG, spaceId);
+
+    @synchronized (self) {
+        return self.spaces[spaceId];
+    }
+}
+
+- (void)putWithSpaceId:(nonnull NSUUID *)spaceId originatorSet:(nonnull NSSet<NSUUID *> *)originatorSet version:(int64_t)version {
+    DDLogVerbose(@"%@ putWithSpaceId: %@ version: %lld", LOG_TAG, spaceId, version);
+
+    NSSet<NSUUID *> *set = [originatorSet copy];
+    @synchronized (self) {
+        if (version == self.modificationCount) {
+            self.spaces[spaceId] = set;
+        }
+    }
+}
+
+- (void)updateWithOriginatorId:(nonnull NSUUID *)originatorId spaceId:(nullable NSUUID *)spaceId {
+    DDLogVerbose(@"%@ updateWithOriginatorId: %@ spaceId: %@", LOG_TAG, originatorId, spaceId);
+
+    @synchronized (self) {
+        self.modificationCount++;
+
+        // Only the sets which change are copied: the originator is in at most one space.
+        NSMutableDictionary<NSUUID *, NSSet<NSUUID *> *> *changes = nil;
+        for (NSUUID *key in self.spaces) {
+            NSSet<NSUUID *> *set = self.spaces[key];
+            BOOL member = [set containsObject:originatorId];
+            NSSet<NSUUID *> *newSet;
+            if ([key isEqual:spaceId]) {
+                if (member) {
+                    continue;
+                }
+                newSet = [set setByAddingObject:originatorId];
+            } else {
+                if (!member) {
+                    continue;
+                }
+                NSMutableSet<NSUUID *> *copy = [set mutableCopy];
+                [copy removeObject:originatorId];
+                newSet = [copy copy];
+            }
+            if (!changes) {
+                changes = [[NSMutableDictionary alloc] init];
+            }
+            changes[key] = newSet;
+        }
+        if (changes) {
+            [self.spaces addEntriesFromDictionary:changes];
+        }
+    }
+}
+
+- (void)removeWithSpaceId:(nonnull NSUUID *)spaceId {
+    DDLogVerbose(@"%@ removeWithSpaceId: %@", LOG_TAG, spaceId);
+
+    @synchronized (self) {
+        self.modificationCount++;
+        [self.spaces removeObjectForKey:spaceId];
+    }
+}
+
+- (void)removeAll {
+    DDLogVerbose(@"%@ removeAll", LOG_TAG);
+
+    @synchronized (self) {
+        self.modificationCount++;
+        [self.spaces removeAllObjects];
+    }
+}
+
+@end
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+@class TLSpace;
+
+//
+// Interface: TLSpaceSnapshot
+//
+
+/**
+ * Immutable set of the spaces known by the twinme context.
+ *
+ * A snapshot is never modified: adding or removing a space creates a new snapshot which is then
+ * published by the context.  Readers can use the snapshot they got without taking any lock.
+ */
+@interface TLSpaceSnapshot : NSObject
+
+/// The spaces indexed by their id and the same spaces in the order they were added.
+@property (readonly, nonnull) NSDictionary<NSUUID *, TLSpace *> *spaces;
+@property (readonly, nonnull) NSArray<TLSpace *> *list;
+
+- (nonnull instancetype)init;
+
+- (nullable TLSpace *)spaceWithSpaceId:(nonnull NSUUID *)spaceId;
+
+/// Get a snapshot with the space added or replacing the space with the same id.
+- (nonnull TLSpaceSnapshot *)snapshotWithSpace:(nonnull TLSpace *)space;
+
+/// Get a snapshot without the space (the same snapshot is returned when the space is not known).
+- (nonnull TLSpaceSnapshot *)snapshotWithoutSpaceId:(nonnull NSUUID *)spaceId;
+
+@end
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ *
+ *  Contributors:
+ *   Stephane Carrez (Stephane.Carrez@twin.life)
+ */
+
+#import "TLSpaceSnapshot.h"
+#import "TLSpace.h"
+
+//
+// Interface: TLSpaceSnapshot ()
+//
+
+@interface TLSpaceSnapshot ()
+
+- (nonnull instancetype)initWithSpaces:(nonnull NSDictionary<NSUUID *, TLSpace *> *)spaces list:(nonnull NSArray<TLSpace *> *)list;
+
+@end
+
+//
+// Implementation: TLSpaceSnapshot
+//
+
+@implementation TLSpaceSnapshot
+
+- (nonnull instancetype)init {
+
+    return [self initWithSpaces:@{} list:@[]];
+}
+
+- (nonnull instancetype)initWithSpaces:(nonnull NSDictionary<NSUUID *, TLSpace *> *)spaces list:(nonnull NSArray<TLSpace *> *)list {
+
+    self = [super init];
+    if (self) {
+        _spaces = spaces;
+        _list = list;
+    }
+    return self;
+}
+
+- (nullable TLSpace *)spaceWithSpaceId:(nonnull NSUUID *)spaceId {
+
+    return self.spaces[spaceId];
+}
+
+- (nonnull TLSpaceSnapshot *)snapshotWithSpace:(nonnull TLSpace *)space {
+
+    TLSpace *oldSpace = self.spaces[space.uuid];
+    if (oldSpace == space) {
+        return self;
+    }
+
+    NSMutableDictionary<NSUUID *, TLSpace *> *spaces = [self.spaces mutableCopy];
+    NSMutableArray<TLSpace *> *list = [self.list mutableCopy];
+    spaces[space.uuid] = space;
+    if (oldSpace) {
+        list[[list indexOfObjectIdenticalTo:oldSpace]] = space;
+    } else {
+        [list addObject:space];
+    }
+    return [[TLSpaceSnapshot alloc] initWithSpaces:[spaces copy] list:[list copy]];
+}
+
+- (nonnull TLSpaceSnapshot *)snapshotWithoutSpaceId:(nonnull NSUUID *)spaceId {
+
+    TLSpace *oldSpace = self.spaces[spaceId];
+    if (!oldSpace) {
+        return self;
+    }
+
+    NSMutableDictionary<NSUUID *, TLSpace *> *spaces = [self.spaces mutableCopy];
+    NSMutableArray<TLSpace *> *list = [self.list mutableCopy];
+    [spaces removeObjectForKey:spaceId];
+    [list removeObjectIdenticalTo:oldSpace];
+    return [[TLSpaceSnapshot alloc] initWithSpaces:[spaces copy] list:[list copy]];
+}
+
+@end
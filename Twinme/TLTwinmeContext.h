@@ -20,6 +20,12 @@
 #import <Twinlife/TLTwincodeOutboundService.h>
 #import "TLProfile.h"
 
+typedef enum {
+    TLConversationVisibilityAll,
+    TLConversationVisibilityVisible,
+    TLConversationVisibilityCurrentSpace
+} TLConversationVisibility;
+
 //
 // Protocol: TLTwinmeContextDelegate
 //
@@ -43,6 +49,8 @@
 @class TLAccountMigration;
 @class TLImageId;
 @class TLConversationDescriptorPair;
+@class TLConversationDescriptorSnapshot;
+@class TLConversationDescriptorDelta;
 @protocol TLConversation;
 @protocol TLNotificationCenter;
 @protocol TLGroupConversation;
@@ -126,6 +134,9 @@
 
 - (void)onCreateInvitationWithCodeWithRequestId:(int64_t)requestId invitation:(nonnull TLInvitation *)invitation;
 - (void)onGetInvitationCodeWithRequestId:(int64_t)requestId twincodeOutbound:(nonnull TLTwincodeOutbound *)twincodeOutbound publicKey:(nullable NSString *)publicKey;
+
+/// Called when the schedule of a watched originator enters (active) or leaves its time ranges.
+- (void)onScheduleTransitionWithOriginator:(nonnull id<TLOriginator>)originator active:(BOOL)active;
 @end
 
 //
@@ -358,12 +369,20 @@
 
 - (void)findConversationsWithPredicate:(nonnull BOOL (^)(id<TLOriginator> _Nonnull originator))predicate withBlock:(nonnull void (^)(NSMutableArray<id<TLConversation>> * _Nonnull list))block;
 
+/// Find the conversations whose originator is visible according to `visibility` (see isVisible and isCurrentSpace)
+/// and matches the predicate.  The filtering is made on the twinlife queue and only the matching conversations are returned.
+- (void)findConversationsWithPredicate:(nonnull BOOL (^)(id<TLOriginator> _Nonnull originator))predicate visibility:(TLConversationVisibility)visibility withBlock:(nonnull void (^)(NSMutableArray<id<TLConversation>> * _Nonnull list))block;
+
 - (void)setActiveConversationWithConversation:(nonnull id<TLConversation>)conversation;
 
 - (void)resetActiveConversationWithConversation:(nonnull id<TLConversation>)conversation;
 
 - (void)findConversationDescriptorsWithFilter:(nonnull TLFilter *)filter callsMode:(TLDisplayCallsMode)callsMode withBlock:(nonnull void (^)(NSArray<TLConversationDescriptorPair*> * _Nonnull list))block;
 
+/// Bring the conversation list snapshot to the current version and return only the conversations inserted, updated
+/// or removed since the snapshot version.  The last descriptors are not queried when no conversation was changed.
+- (void)findConversationDescriptorsWithSnapshot:(nonnull TLConversationDescriptorSnapshot *)snapshot withBlock:(nonnull void (^)(TLConversationDescriptorDelta * _Nonnull delta))block;
+
 - (void)pushObjectWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation sendTo:(nullable NSUUID *)sendTo replyTo:(nullable TLDescriptorId *)replyTo message:(nonnull NSString *)message copyAllowed:(BOOL)copyAllowed expireTimeout:(int64_t)expireTimeout;
 
 - (void)pushFileWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation sendTo:(nullable NSUUID *)sendTo replyTo:(nullable TLDescriptorId *)replyTo path:(nonnull NSString *)path type:(TLDescriptorType)type toBeDeleted:(BOOL)toBeDeleted copyAllowed:(BOOL)copyAllowed expireTimeout:(int64_t)expireTimeout;
@@ -435,6 +454,9 @@
 
 - (void)acknowledgeNotificationWithRequestId:(int64_t)requestId notification:(nonnull TLNotification *)notification;
 
+/// Acknowledge a list of notifications from a single twinlife queue operation followed by one badge refresh.
+- (void)acknowledgeNotificationsWithRequestId:(int64_t)requestId notifications:(nonnull NSArray<TLNotification *> *)notifications;
+
 - (void)deleteWithNotification:(nonnull TLNotification *)notification;
 
 - (void)getSpaceNotificationStatsWithBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLNotificationServiceNotificationStat * _Nonnull stats))block;
@@ -443,6 +465,29 @@
 
 - (void)scheduleRefreshNotifications;
 
+# pragma mark - Schedule management
+
+//
+// Schedule transitions: a single job is armed for the earliest transition of the watched originators.
+//
+
+- (void)watchScheduleWithOriginator:(nonnull id<TLOriginator>)originator;
+
+- (void)unwatchScheduleWithOriginatorId:(nonnull NSUUID *)originatorId;
+
+# pragma mark - Queue profiler
+
+/// Record how long the blocks dispatched by the context wait and run on the twinlife queue and log
+/// the labels which use the queue the most every `reportInterval` (the report is logged as a warning).
+- (void)startQueueProfilerWithReportInterval:(NSTimeInterval)reportInterval;
+
+- (void)stopQueueProfiler;
+
+# pragma mark - Cache management
+
+/// Get the estimated size in bytes of each cache of the context.
+- (nonnull NSDictionary<NSString *, NSNumber *> *)cacheFootprintReport;
+
 # pragma mark - Call receiver management
 
 //
@@ -23,6 +23,9 @@
 @class TLCallReceiver;
 @class TLPairInviteInvocation;
 @class TLIntegerConfigIdentifier;
+@class TLInvocationDispatcher;
+@class TLExecutorAdmission;
+@class TLInvitationCodeCache;
 
 //
 // Interface: TLExecutorAssertPoint ()
@@ -50,6 +53,27 @@
 
 + (BOOL)ENABLE_REPORT_LOCATION;
 
+/// The invocation handlers used by onProcessInvocation and their metrics.
++ (nonnull TLInvocationDispatcher *)invocationDispatcher;
+
+/// Dispatch the block on the twinlife queue, the label identifies the block for the queue profiler.
+- (void)dispatchWithLabel:(nonnull NSString *)label block:(nonnull dispatch_block_t)block;
+
+/// The concurrency limits of the executors, configured per executor class.
+@property (readonly, nonnull) TLExecutorAdmission *executorAdmission;
+
+/// The invitation codes resolved by the server.
+@property (readonly, nonnull) TLInvitationCodeCache *invitationCodeCache;
+
+/// Run the start block when the executor is admitted, the executor must be released when it is stopped.
+- (void)admitWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel;
+
+/// Release the slot of the executor and start the next executor waiting for it on the twinlife queue.
+- (void)releaseWithExecutor:(nonnull id)executor;
+
+/// Cancel the executors of the class that are waiting to be admitted.
+- (NSUInteger)cancelQueuedExecutorsWithClass:(nonnull Class)clazz;
+
 - (void)onCreateProfileWithRequestId:(int64_t)requestId profile:(nonnull TLProfile *)profile;
 
 - (void)onUpdateProfileWithRequestId:(int64_t)requestId profile:(nonnull TLProfile *)profile;
@@ -59,6 +59,18 @@
 #import "TLPushNotificationContent.h"
 #import "TLRoomCommand.h"
 #import "TLAccountMigration.h"
+#import "TLConversationDescriptorSnapshot.h"
+#import "TLConversationVisibilityFilter.h"
+#import "TLPeerIdParser.h"
+#import "TLInvocationDispatcher.h"
+#import "TLInvocationReplayScheduler.h"
+#import "TLSingleFlight.h"
+#import "TLSpaceSnapshot.h"
+#import "TLSpaceOriginatorCache.h"
+#import "TLCacheManager.h"
+#import "TLQueueProfiler.h"
+#import "TLExecutorAdmission.h"
+#import "TLInvitationCodeCache.h"
 
 #import "TLExecutor.h"
 #import "TLCreateProfileExecutor.h"
@@ -82,6 +94,8 @@
 #import "TLUpdateGroupExecutor.h"
 #import "TLReportStatsExecutor.h"
 #import "TLRefreshObjectExecutor.h"
+#import "TLRefreshObjectsExecutor.h"
+#import "TLRefreshBatcher.h"
 #import "TLUpdateStatsExecutor.h"
 #import "TLCreateInvitationExecutor.h"
 #import "TLDeleteInvitationExecutor.h"
@@ -101,6 +115,8 @@
 
 #import "TLTwinmeAction.h"
 #import "TLCallReceiver.h"
+#import "TLCapabilities.h"
+#import "TLSchedule.h"
 #import "TLCreateCallReceiverExecutor.h"
 #import "TLDeleteCallReceiverExecutor.h"
 #import "TLUpdateCallReceiverExecutor.h"
@@ -134,6 +150,52 @@ static const int ddLogLevel = DDLogLevelWarning;
 
 static const int REPORT_STATS = 3;
 
+// Maximum number of changed conversations remembered for the conversation descriptor snapshots.
+static const NSUInteger MAX_DIRTY_CONVERSATIONS = 1024;
+
+// Max number of invocations processed at the same time and max number started by one block of the twinlife queue.
+// Every TLProcessInvocationExecutor is started by the replay scheduler: its window is their only concurrency limit.
+static const int INVOCATION_REPLAY_WINDOW = 8;
+static const int INVOCATION_REPLAY_SLICE = 4;
+
+// Estimated size of the caches kept when the application is suspended and estimated cost of one cached entry.
+static const NSUInteger CACHE_BUDGET = 256 * 1024;
+static const NSUInteger CACHE_SPACE_COST = 2048;
+static const NSUInteger CACHE_GROUP_MEMBER_COST = 1024;
+static const NSUInteger CACHE_SPACE_ORIGINATOR_COST = 48;
+static const NSUInteger CACHE_INVITATION_CODE_COST = 1024;
+
+// Max number of invitation codes kept and how long a resolved code and an unknown code are kept.
+static const NSUInteger INVITATION_CODE_CACHE_SIZE = 32;
+static const NSTimeInterval INVITATION_CODE_TTL = 300.0;
+static const NSTimeInterval INVITATION_CODE_NEGATIVE_TTL = 30.0;
+
+// Period of the queue depth samples and number of labels reported by the twinlife queue profiler.
+static const NSTimeInterval QUEUE_PROFILER_SAMPLE_INTERVAL = 0.25;
+static const int QUEUE_PROFILER_TOP_COUNT = 10;
+
+// Max number of executors running at the same time for the executors which are started in bursts:
+// the contacts and groups deleted or updated for a space or a profile.
+static const int EXECUTOR_DELETE_LIMIT = 4;
+static const int EXECUTOR_UPDATE_LIMIT = 4;
+
+// Window during which the pair::refresh invocations are grouped and max number of objects refreshed by a batch.
+static const NSTimeInterval REFRESH_BATCH_DELAY = 0.2;
+static const NSUInteger REFRESH_BATCH_MAX_COUNT = 64;
+
+// Notification types acknowledged when the user opens the conversation.
+#define NOTIFICATION_TYPE_BIT(type) (1ULL << (type))
+static const uint64_t ACKNOWLEDGE_ON_ACTIVE_TYPES = NOTIFICATION_TYPE_BIT(TLNotificationTypeNewTextMessage)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeNewImageMessage)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeNewAudioMessage)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeNewVideoMessage)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeNewFileMessage)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeNewGroupInvitation)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeNewGroupJoined)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeNewGeolocation)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeResetConversation)
+    | NOTIFICATION_TYPE_BIT(TLNotificationTypeUpdatedAnnotation);
+
 #ifdef SKRED
 static const BOOL DELETE_CONTACT_ON_UNBIND_CONTACT = YES;
 static const BOOL ENABLE_REPORT_LOCATION = YES;
@@ -172,6 +234,20 @@ static const BOOL ENABLE_REPORT_LOCATION = NO;
 
 @end
 
+//
+// Interface: TLScheduleTransitionHandler ()
+//
+
+@interface TLScheduleTransitionHandler : NSObject <TLJob>
+
+@property (weak) TLTwinmeContext *twinmeContext;
+
+- (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext;
+
+- (void)runJob;
+
+@end
+
 //
 // Interface: TLTwinmeContext ()
 //
@@ -189,7 +265,8 @@ static const BOOL ENABLE_REPORT_LOCATION = NO;
 @property (readonly, nonnull) TLNotificationRefreshHandler *notificationRefresh;
 @property (readonly, nonnull) TLTwinmeActionTimeoutHandler *actionTimeout;
 @property volatile BOOL inBackground;
-@property NSMutableDictionary<NSUUID *, TLSpace *> *spaces;
+/// The spaces are published as an immutable snapshot: readers don't take the lock, writers hold @synchronized(self).
+@property (nonnull) TLSpaceSnapshot *spaces;
 @property (readonly, nonnull) NSMutableDictionary<NSString *, TLExecutor*> *executors;
 @property TLSpaceSettings *defaultCreateSpaceSettings;
 @property NSUUID *defaultSpaceId;
@@ -203,13 +280,28 @@ static const BOOL ENABLE_REPORT_LOCATION = NO;
 @property NSTimeInterval refreshBadgeDelay;
 @property TLSpace *currentSpace;
 @property TLProfile *currentProfile;
-@property NSMutableDictionary<NSUUID *, TLGroupMember *> *groupMembers;
+/// The groupMembers, requestIds and executors are protected by their own lock.
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, TLGroupMember *> *groupMembers;
+@property (readonly, nonnull) TLSingleFlight *groupMemberLookups;
+@property (readonly, nonnull) TLSingleFlight *groupMemberReceiverLookups;
+@property (readonly, nonnull) TLSpaceOriginatorCache *spaceOriginators;
+@property (readonly, nonnull) TLCacheManager *cacheManager;
+@property (nullable) dispatch_source_t memoryPressureSource;
+@property (nullable) TLQueueProfiler *queueProfiler;
+@property (nullable) TLRefreshBatcher *refreshBatcher;
+@property (readonly, nonnull) TLConversationChanges *conversationChanges;
 @property NSUUID *activeConversationId;
 @property TLNotificationServiceNotificationStat *visibleNotificationStats;
+@property (nullable) TLInvocationReplayScheduler *invocationReplay;
 @property int64_t reportRequestId;
 @property (nonatomic, readonly, nonnull) TLQueue *pendingActions;
 @property (nullable) TLJobId *actionTimeoutJob;
 @property (nullable) TLTwinmeAction *firstAction;
+@property (readonly, nonnull) TLScheduleTransitionHandler *scheduleTransition;
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, id<TLOriginator>> *scheduledOriginators;
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, NSNumber *> *scheduleStates;
+@property (nullable) TLJobId *scheduleJob;
+@property long scheduleDeadline;
 
 @property id<TLNotificationCenter> notificationCenter;
 @property (nullable) TLJobId *reportJob;
@@ -239,18 +331,34 @@ static const BOOL ENABLE_REPORT_LOCATION = NO;
 
 - (TLBaseServiceErrorCode)onInvokeTwincodeWithInvocation:(nonnull TLTwincodeInvocation *)invocation;
 
+- (TLInvocationReplayPriority)replayPriorityWithInvocation:(nonnull TLTwincodeInvocation *)invocation;
+
 - (void)onRefreshTwincodeWithTwincode:(nonnull TLTwincodeOutbound *)twincodeOutbound updatedAttributes:(nonnull NSArray<TLAttributeNameValue *> *)updatedAttributes;
 
 - (void)onLeaveGroupWithGroup:(id <TLGroupConversation>)group memberId:(NSUUID *)memberId;
 
 - (void)onRevokedWithConversation:(nonnull id <TLConversation>)conversation;
 
+- (void)onResetConversationWithConversation:(nonnull id <TLConversation>)conversation;
+
+- (void)onDeleteDescriptorsWithConversation:(nonnull id <TLConversation>)conversation descriptors:(nonnull NSArray<TLDescriptorId *> *)descriptors;
+
+- (void)onMarkDescriptorDeletedWithConversation:(nonnull id <TLConversation>)conversation descriptor:(nonnull TLDescriptor *)descriptor;
+
 - (void)onSignatureInfoWithConversation:(nonnull id<TLConversation>)conversation signedTwincode:(nonnull TLTwincodeOutbound *)signedTwincode;
 
 - (void)refreshNotifications;
 
 - (void)runJobActionTimeout;
 
+- (void)runJobScheduleTransition;
+
+- (void)registerCaches;
+
+- (void)onMemoryPressureWithStatus:(unsigned long)status;
+
+- (void)markConversationWithSubjectId:(nullable NSUUID *)subjectId;
+
 @end
 
 //
@@ -333,6 +441,33 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 
 @end
 
+//
+// Implementation: TLScheduleTransitionHandler ()
+//
+
+#undef LOG_TAG
+#define LOG_TAG @"TLScheduleTransitionHandler"
+
+@implementation TLScheduleTransitionHandler
+
+- (nonnull instancetype)initWithTwinmeContext:(nonnull TLTwinmeContext *)twinmeContext {
+    DDLogVerbose(@"%@ initWithTwinmeContext: %@", LOG_TAG, twinmeContext);
+    
+    self = [super init];
+    if (self) {
+        _twinmeContext = twinmeContext;
+    }
+    return self;
+}
+
+- (void)runJob {
+    DDLogVerbose(@"%@ runJob", LOG_TAG);
+    
+    [self.twinmeContext runJobScheduleTransition];
+}
+
+@end
+
 #pragma mark - ConversationService delegate
 
 //
@@ -403,6 +538,24 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     [self.twinmeContext onRevokedWithConversation:conversation];
 }
 
+- (void)onResetConversationWithRequestId:(int64_t)requestId conversation:(id <TLConversation>)conversation clearMode:(TLConversationServiceClearMode)clearMode {
+    DDLogVerbose(@"%@ onResetConversationWithRequestId: %lld conversation: %@ clearMode: %d", LOG_TAG, requestId, conversation, clearMode);
+    
+    [self.twinmeContext onResetConversationWithConversation:conversation];
+}
+
+- (void)onDeleteDescriptorsWithRequestId:(int64_t)requestId conversation:(id <TLConversation>)conversation descriptors:(NSArray<TLDescriptorId *> *)descriptors {
+    DDLogVerbose(@"%@ onDeleteDescriptorsWithRequestId: %lld conversation: %@ descriptors: %@", LOG_TAG, requestId, conversation, descriptors);
+    
+    [self.twinmeContext onDeleteDescriptorsWithConversation:conversation descriptors:descriptors];
+}
+
+- (void)onMarkDescriptorDeletedWithRequestId:(int64_t)requestId conversation:(id <TLConversation>)conversation descriptor:(TLDescriptor *)descriptor {
+    DDLogVerbose(@"%@ onMarkDescriptorDeletedWithRequestId: %lld conversation: %@ descriptor: %@", LOG_TAG, requestId, conversation, descriptor);
+    
+    [self.twinmeContext onMarkDescriptorDeletedWithConversation:conversation descriptor:descriptor];
+}
+
 - (void)onSignatureInfoWithConversation:(nonnull id<TLConversation>)conversation signedTwincode:(nonnull TLTwincodeOutbound *)signedTwincode {
     DDLogVerbose(@"%@ onSignatureInfoWithConversation: %@ signedTwincode: %@", LOG_TAG, conversation, signedTwincode);
     
@@ -601,9 +754,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.twinmeContext.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteNotificationsWithList:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinmeContext.twinlife twinlifeQueue], ^{
+            [self.twinmeContext dispatchWithLabel:@"onDeleteNotificationsWithList" block:^{
                 [lDelegate onDeleteNotificationsWithList:list];
-            });
+            }];
         }
     }
     [self.twinmeContext scheduleRefreshNotifications];
@@ -665,6 +818,59 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     return ENABLE_REPORT_LOCATION;
 }
 
++ (nonnull TLInvocationDispatcher *)invocationDispatcher {
+    
+    static TLInvocationDispatcher *dispatcher;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        dispatcher = [[TLInvocationDispatcher alloc] init];
+        
+        // Background invocations received through the twincode inbound of the receiver.
+        [dispatcher registerWithReceiverClass:[TLProfile class] invocationClass:[TLPairInviteInvocation class] name:@"profile.pair-invite" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext createContactPhase2WithInvocation:(TLPairInviteInvocation *)invocation profile:(TLProfile *)receiver];
+        }];
+        [dispatcher registerWithReceiverClass:[TLInvitation class] invocationClass:[TLPairInviteInvocation class] name:@"invitation.pair-invite" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext createContactPhase2WithInvocation:(TLPairInviteInvocation *)invocation invitation:(TLInvitation *)receiver];
+        }];
+        [dispatcher registerWithReceiverClass:[TLContact class] invocationClass:[TLPairBindInvocation class] name:@"contact.pair-bind" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext bindContactWithInvocation:(TLPairBindInvocation *)invocation contact:(TLContact *)receiver];
+        }];
+        [dispatcher registerWithReceiverClass:[TLContact class] invocationClass:[TLPairUnbindInvocation class] name:@"contact.pair-unbind" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext unbindContactWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] invocationId:invocation.uuid contact:(TLContact *)receiver];
+        }];
+        [dispatcher registerWithReceiverClass:[TLContact class] invocationClass:[TLPairRefreshInvocation class] name:@"contact.pair-refresh" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext refreshObjectWithInvocation:(TLPairRefreshInvocation *)invocation subject:(TLContact *)receiver];
+        }];
+        [dispatcher registerWithReceiverClass:[TLGroup class] invocationClass:[TLGroupRegisteredInvocation class] name:@"group.registered" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            TLGroupRegisteredExecutor *groupRegisteredExecutor = [[TLGroupRegisteredExecutor alloc] initWithTwinmeContext:twinmeContext requestId:[TLBaseService DEFAULT_REQUEST_ID] groupRegisteredInvocation:(TLGroupRegisteredInvocation *)invocation group:(TLGroup *)receiver];
+            [twinmeContext dispatchWithLabel:@"TLGroupRegisteredExecutor" block:^{
+                [groupRegisteredExecutor start];
+            }];
+        }];
+        [dispatcher registerWithReceiverClass:[TLGroup class] invocationClass:[TLPairRefreshInvocation class] name:@"group.pair-refresh" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext refreshObjectWithInvocation:(TLPairRefreshInvocation *)invocation subject:(TLGroup *)receiver];
+        }];
+        [dispatcher registerWithReceiverClass:[TLAccountMigration class] invocationClass:[TLPairInviteInvocation class] name:@"account-migration.pair-invite" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            TLPairInviteInvocation *pairBindInvocation = (TLPairInviteInvocation *)invocation;
+            [twinmeContext bindAccountMigrationWithRequestId:TLBaseService.DEFAULT_REQUEST_ID invocationId:pairBindInvocation.uuid accountMigration:(TLAccountMigration *)receiver peerTwincodeOutboundId:pairBindInvocation.twincodeOutbound.uuid];
+        }];
+        [dispatcher registerWithReceiverClass:[TLAccountMigration class] invocationClass:[TLPairUnbindInvocation class] name:@"account-migration.pair-unbind" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext deleteAccountMigrationWithAccountMigration:(TLAccountMigration *)receiver withBlock:^(TLBaseServiceErrorCode errorCode, NSUUID * _Nullable uuid) {
+                [twinmeContext acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeSuccess];
+            }];
+        }];
+        
+        // Invocations that only notify an update of the receiver.
+        [dispatcher registerWithReceiverClass:[TLProfile class] name:@"profile.update" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext onUpdateProfileWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] profile:(TLProfile *)receiver];
+        }];
+        [dispatcher registerWithReceiverClass:[TLContact class] name:@"contact.update" block:^(TLTwinmeContext *twinmeContext, TLInvocation *invocation, id<TLRepositoryObject> receiver) {
+            [twinmeContext onUpdateContactWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] contact:(TLContact *)receiver];
+        }];
+    });
+    return dispatcher;
+}
+
 + (nonnull NSString *)APPLICATION_SCHEME {
 #ifdef SKRED
     return @"skred";
@@ -683,9 +889,25 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         _inBackground = YES;
         _notificationRefresh = [[TLNotificationRefreshHandler alloc] initWithTwinmeContext:self];
         _actionTimeout = [[TLTwinmeActionTimeoutHandler alloc] initWithTwinmeContext:self];
-        _spaces = [[NSMutableDictionary alloc] init];
+        _scheduleTransition = [[TLScheduleTransitionHandler alloc] initWithTwinmeContext:self];
+        _scheduledOriginators = [[NSMutableDictionary alloc] init];
+        _scheduleStates = [[NSMutableDictionary alloc] init];
+        _scheduleDeadline = TIME_RANGE_NO_TRANSITION;
+        _spaces = [[TLSpaceSnapshot alloc] init];
         _getSpacesDone = NO;
         _groupMembers = [[NSMutableDictionary alloc] init];
+        _groupMemberLookups = [[TLSingleFlight alloc] init];
+        _groupMemberReceiverLookups = [[TLSingleFlight alloc] init];
+        _spaceOriginators = [[TLSpaceOriginatorCache alloc] init];
+        _cacheManager = [[TLCacheManager alloc] initWithBudget:CACHE_BUDGET];
+        _invitationCodeCache = [[TLInvitationCodeCache alloc] initWithCapacity:INVITATION_CODE_CACHE_SIZE ttl:INVITATION_CODE_TTL negativeTtl:INVITATION_CODE_NEGATIVE_TTL];
+        _executorAdmission = [[TLExecutorAdmission alloc] init];
+        [_executorAdmission setLimit:EXECUTOR_DELETE_LIMIT withClass:[TLDeleteContactExecutor class]];
+        [_executorAdmission setLimit:EXECUTOR_DELETE_LIMIT withClass:[TLDeleteGroupExecutor class]];
+        [_executorAdmission setLimit:EXECUTOR_DELETE_LIMIT withClass:[TLDeleteInvitationExecutor class]];
+        [_executorAdmission setLimit:EXECUTOR_UPDATE_LIMIT withClass:[TLUpdateContactAndIdentityExecutor class]];
+        [_executorAdmission setLimit:EXECUTOR_UPDATE_LIMIT withClass:[TLUpdateGroupExecutor class]];
+        _conversationChanges = [[TLConversationChanges alloc] initWithCapacity:MAX_DIRTY_CONVERSATIONS];
         _notificationCenter = [_twinmeApplication allocNotificationCenterWithTwinmeContext:self];
         _requestIds = [[NSMutableDictionary alloc] init];
         _reportRequestId = [TLBaseService DEFAULT_REQUEST_ID];
@@ -715,6 +937,8 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         // Get default space UUID if there is one.
         _defaultSpaceId = _defaultSpaceConfig.uuidValue;
         _defaultSettingsId = _defaultSettingsConfig.uuidValue;
+
+        [self registerCaches];
     }
     
     return self;
@@ -755,9 +979,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             for (id delegate in self.delegates) {
                 if ([delegate respondsToSelector:@selector(onOpenURL:)]) {
                     id<TLTwinmeContextDelegate> lDelegate = delegate;
-                    dispatch_async([self.twinlife twinlifeQueue], ^{
+                    [self dispatchWithLabel:@"onOpenURL" block:^{
                         [lDelegate onOpenURL:url];
-                    });
+                    }];
                 }
             }
             result = YES;
@@ -792,10 +1016,10 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLGetPushNotificationContentExecutor *getPushNotificationContentExecutor = [[TLGetPushNotificationContentExecutor alloc] initWithTwinmeContext:self dictionaryPayload:dictionaryPayload withBlock:block];
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLGetPushNotificationContentExecutor" block:^{
         
         [getPushNotificationContentExecutor start];
-    });
+    }];
 }
 
 - (void)didReceiveIncomingPushWithPayload:(nonnull NSDictionary *)dictionaryPayload application:(nullable id<TLApplication>)application completionHandler:(nonnull void (^)(TLBaseServiceErrorCode status, TLPushNotificationContent * _Nullable notificationContent))completionHandler terminateCompletionHandler:(nullable void (^)(TLBaseServiceErrorCode status))terminateHandler {
@@ -845,17 +1069,21 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ getGroupMemberReceiverWithTwincodeInboundId: %@ memberTwincodeOutboundId: %@", LOG_TAG, twincodeInboundId, memberTwincodeOutboundId);
     
     TLGroupMember *groupMember;
-    @synchronized (self) {
+    @synchronized (self.groupMembers) {
         groupMember = self.groupMembers[memberTwincodeOutboundId];
     }
     
     if (groupMember && [twincodeInboundId isEqual:[groupMember twincodeInboundId]]) {
         block(TLBaseServiceErrorCodeSuccess, groupMember);
     } else {
-        TLGetGroupMemberReceiverExecutor *getGroupMemberReceiverExecutor = [[TLGetGroupMemberReceiverExecutor alloc] initWithTwinmeContext:self twincodeInboundId:twincodeInboundId memberTwincodeOutboundId:memberTwincodeOutboundId withBlock:block];
-        dispatch_async([self.twinlife twinlifeQueue], ^{
-            [getGroupMemberReceiverExecutor start];
-        });
+        // Only the first caller starts the executor, the others get its result.
+        TLSingleFlightKey *key = [[TLSingleFlightKey alloc] initWithFirst:twincodeInboundId second:memberTwincodeOutboundId];
+        [self.groupMemberReceiverLookups lookupWithKey:key block:block start:^(TLSingleFlightBlock complete) {
+            TLGetGroupMemberReceiverExecutor *getGroupMemberReceiverExecutor = [[TLGetGroupMemberReceiverExecutor alloc] initWithTwinmeContext:self twincodeInboundId:twincodeInboundId memberTwincodeOutboundId:memberTwincodeOutboundId withBlock:complete];
+            [self dispatchWithLabel:@"TLGetGroupMemberReceiverExecutor" block:^{
+                [getGroupMemberReceiverExecutor start];
+            }];
+        }];
     }
 }
 
@@ -888,12 +1116,10 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (BOOL)isProfileTwincode:(nonnull NSUUID *)twincodeId {
     DDLogVerbose(@"%@ isProfileTwincode: %@", LOG_TAG, twincodeId);
     
-    @synchronized(self) {
-        for (TLSpace *space in self.spaces.allValues) {
-            TLProfile *profile = space.profile;
-            if (profile && [twincodeId isEqual:profile.twincodeOutbound.uuid]) {
-                return YES;
-            }
+    for (TLSpace *space in self.spaces.list) {
+        TLProfile *profile = space.profile;
+        if (profile && [twincodeId isEqual:profile.twincodeOutbound.uuid]) {
+            return YES;
         }
     }
     
@@ -903,7 +1129,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)getProfilesWithBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, NSMutableArray<TLProfile*> * _Nonnull list))block {
     DDLogVerbose(@"%@ getProfilesWithWithBlock", LOG_TAG);
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"getProfilesWithBlock" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         TLFilter *filter = [self createSpaceFilter];
         [repositoryService listObjectsWithFactory:[TLProfile FACTORY] filter:filter withBlock:^(TLBaseServiceErrorCode errorCode, NSArray<id<TLRepositoryObject>> *list) {
@@ -913,7 +1139,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             }
             block(errorCode, result);
         }];
-    });
+    }];
 }
 
 - (void)createProfileWithRequestId:(const int64_t)requestId name:(nonnull NSString *)name avatar:(nonnull UIImage *)avatar largeAvatar:(nullable UIImage *)largeAvatar description:(nullable NSString *)description capabilities:(nullable TLCapabilities*)capabilities space:(nonnull TLSpace *)space {
@@ -925,18 +1151,18 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLCreateProfileExecutor *createProfileExecutor = [[TLCreateProfileExecutor alloc] initWithTwinmeContext:self requestId:requestId name:name avatar:avatar largeAvatar:largeAvatar description:description capabilities:capabilities space:space];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateProfileExecutor" block:^{
         [createProfileExecutor start];
-    });
+    }];
 }
 
 - (void)createProfileWithRequestId:(const int64_t)requestId name:(NSString *)name avatar:(UIImage *)avatar largeAvatar:(nullable UIImage *)largeAvatar description:(nullable NSString *)description capabilities:(nullable TLCapabilities*)capabilities {
     DDLogVerbose(@"%@ createProfileWithRequestId: %lld name: %@ avatar: %@ largeAvatar: %@ description: %@ capabilities: %@", LOG_TAG, requestId, name, avatar, largeAvatar, description, capabilities);
     
     TLCreateProfileExecutor *createProfileExecutor = [[TLCreateProfileExecutor alloc] initWithTwinmeContext:self requestId:requestId name:name avatar:avatar largeAvatar:largeAvatar description:description capabilities:capabilities space:nil];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateProfileExecutor" block:^{
         [createProfileExecutor start];
-    });
+    }];
 }
 
 - (void)onCreateProfileWithRequestId:(int64_t)requestId profile:(TLProfile *)profile {
@@ -945,9 +1171,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onCreateProfileWithRequestId:profile:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onCreateProfileWithRequestId" block:^{
                 [lDelegate onCreateProfileWithRequestId:requestId profile:profile];
-            });
+            }];
         }
     }
 }
@@ -956,9 +1182,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ updateProfileWithRequestId: %lld profile: %@ updateMode: %d @name: %@ avatar: %@ largeAvatar: %@ description: %@ capabilities: %@", LOG_TAG, requestId, profile, updateMode, name, avatar, largeAvatar, description, capabilities);
     
     TLUpdateProfileExecutor *updateProfileExecutor = [[TLUpdateProfileExecutor alloc] initWithTwinmeContext:self requestId:requestId profile:profile updateMode:updateMode name:name avatar:avatar largeAvatar:largeAvatar description:description capabilities:capabilities];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateProfileExecutor" block:^{
         [updateProfileExecutor start];
-    });
+    }];
 }
 
 - (void)onUpdateProfileWithRequestId:(int64_t)requestId profile:(TLProfile *)profile {
@@ -967,9 +1193,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onUpdateProfileWithRequestId:profile:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onUpdateProfileWithRequestId" block:^{
                 [lDelegate onUpdateProfileWithRequestId:requestId profile:profile];
-            });
+            }];
         }
     }
 }
@@ -978,9 +1204,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ changeProfileTwincodeWithRequestId: %lld profile: %@", LOG_TAG, requestId, profile);
     
     TLChangeProfileTwincodeExecutor *changeProfileTwincodeExecutor = [[TLChangeProfileTwincodeExecutor alloc] initWithTwinmeContext:self requestId:requestId profile:profile];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLChangeProfileTwincodeExecutor" block:^{
         [changeProfileTwincodeExecutor start];
-    });
+    }];
 }
 
 - (void)onChangeProfileTwincodeWithRequestId:(int64_t)requestId profile:(TLProfile *)profile {
@@ -989,9 +1215,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onChangeProfileTwincodeWithRequestId:profile:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onChangeProfileTwincodeWithRequestId" block:^{
                 [lDelegate onChangeProfileTwincodeWithRequestId:requestId profile:profile];
-            });
+            }];
         }
     }
 }
@@ -1002,9 +1228,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     TLDeleteProfileExecutor *deleteProfileExecutor = [[TLDeleteProfileExecutor alloc] initWithTwinmeContext:self requestId:requestId profile:profile timeout:DBL_MAX withBlock:^(TLBaseServiceErrorCode errorCode, NSUUID *profileId) {
         [self onDeleteProfileWithRequestId:requestId profileId:profileId];
     }];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLDeleteProfileExecutor" block:^{
         [deleteProfileExecutor start];
-    });
+    }];
 }
 
 - (void)onDeleteProfileWithRequestId:(int64_t)requestId profileId:(NSUUID *)profileId{
@@ -1013,9 +1239,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteProfileWithRequestId:profileId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onDeleteProfileWithRequestId" block:^{
                 [lDelegate onDeleteProfileWithRequestId:requestId profileId:profileId];
-            });
+            }];
         }
     }
 }
@@ -1024,9 +1250,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ deleteAccountWithRequestId: %lld", LOG_TAG, requestId);
     
     TLDeleteAccountExecutor *deleteAccountExecutor = [[TLDeleteAccountExecutor alloc] initWithTwinmeContext:self requestId:requestId];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLDeleteAccountExecutor" block:^{
         [deleteAccountExecutor start];
-    });
+    }];
 }
 
 - (void)onDeleteAccountWithRequestId:(int64_t)requestId {
@@ -1035,9 +1261,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteAccountWithRequestId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onDeleteAccountWithRequestId" block:^{
                 [lDelegate onDeleteAccountWithRequestId:requestId];
-            });
+            }];
         }
     }
 }
@@ -1049,9 +1275,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLGetAccountMigrationExecutor *executor = [[TLGetAccountMigrationExecutor alloc] initWithTwinmeContext:self deviceMigrationId:accountMigrationId withBlock:block];
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"TLGetAccountMigrationExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)createAccountMigrationWithBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLAccountMigration * _Nullable accountMigration))block{
@@ -1059,9 +1285,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLCreateAccountMigrationExecutor *createAccountMigrationExecutor = [[TLCreateAccountMigrationExecutor alloc] initWithTwinmeContext:self withBlock:block];
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"TLCreateAccountMigrationExecutor" block:^{
         [createAccountMigrationExecutor start];
-    });
+    }];
 }
 
 - (void)bindAccountMigrationWithAccountMigration:(nonnull TLAccountMigration *)accountMigration twincodeOutbound:(nullable TLTwincodeOutbound *)peerTwincodeOutbound withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLAccountMigration * _Nullable uuid))block{
@@ -1069,9 +1295,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLBindAccountMigrationExecutor *executor = [[TLBindAccountMigrationExecutor alloc] initWithTwinmeContext:self accountMigration:accountMigration peerTwincodeOutbound:peerTwincodeOutbound consumer:block];
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"TLBindAccountMigrationExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)bindAccountMigrationWithRequestId:(int64_t)requestId invocationId:(nonnull NSUUID *)invocationId accountMigration:(nonnull TLAccountMigration *)accountMigration peerTwincodeOutboundId:(nonnull NSUUID *)peerTwincodeOutboundId {
@@ -1079,9 +1305,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLBindAccountMigrationExecutor *executor = [[TLBindAccountMigrationExecutor alloc] initWithTwinmeContext:self requestId:requestId invocationId:invocationId accountMigration:accountMigration peerTwincodeOutboundId:peerTwincodeOutboundId];
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"TLBindAccountMigrationExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)deleteAccountMigrationWithAccountMigration:(nonnull TLAccountMigration *)accountMigration withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, NSUUID * _Nullable uuid))block{
@@ -1089,9 +1315,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLDeleteAccountMigrationExecutor *executor = [[TLDeleteAccountMigrationExecutor alloc] initWithTwinmeContext:self accountMigration:accountMigration withBlock:block];
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"TLDeleteAccountMigrationExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)onUpdateAccountMigrationWithRequestId:(int64_t)requestId accountMigration:(nonnull TLAccountMigration *)accountMigration {
@@ -1100,9 +1326,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onUpdateAccountMigrationWithRequestId:accountMigration:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onUpdateAccountMigrationWithRequestId" block:^{
                 [lDelegate onUpdateAccountMigrationWithRequestId:requestId accountMigration:accountMigration];
-            });
+            }];
         }
     }
 }
@@ -1113,9 +1339,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteAccountMigrationWithRequestId:accountMigrationId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onDeleteAccountMigrationWithRequestId" block:^{
                 [lDelegate onDeleteAccountMigrationWithRequestId:requestId accountMigrationId:accountMigrationId];
-            });
+            }];
         }
     }
 }
@@ -1127,9 +1353,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLCreateInvitationCodeExecutor *executor = [[TLCreateInvitationCodeExecutor alloc] initWithTwinmeContext:self requestId:requestId validityPeriod:validityPeriod];
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"TLCreateInvitationCodeExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 
@@ -1139,9 +1365,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onCreateInvitationWithCodeWithRequestId:invitation:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onCreateInvitationWithCodeWithRequestId" block:^{
                 [lDelegate onCreateInvitationWithCodeWithRequestId:requestId invitation:invitation];
-            });
+            }];
         }
     }
 }
@@ -1151,9 +1377,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 
     TLGetInvitationCodeExecutor *executor = [[TLGetInvitationCodeExecutor alloc] initWithTwinmeContext:self requestId:requestId code:code];
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"TLGetInvitationCodeExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)onGetInvitationCodeWithRequestId:(int64_t)requestId twincodeOutbound:(nonnull TLTwincodeOutbound *)twincodeOutbound publicKey:(nullable NSString *)publicKey {
@@ -1162,9 +1388,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onGetInvitationCodeWithRequestId:twincodeOutbound:publicKey:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onGetInvitationCodeWithRequestId" block:^{
                 [lDelegate onGetInvitationCodeWithRequestId:requestId twincodeOutbound:twincodeOutbound publicKey:publicKey];
-            });
+            }];
         }
     }
 }
@@ -1178,7 +1404,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)findContactsWithFilter:(nonnull TLFilter *)filter withBlock:(nonnull void (^)(NSMutableArray<TLContact*> * _Nonnull list))block {
     DDLogVerbose(@"%@ findContactsWithFilter: %@", LOG_TAG, filter);
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"findContactsWithFilter" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         
         [repositoryService listObjectsWithFactory:[TLContact FACTORY] filter:filter withBlock:^(TLBaseServiceErrorCode errorCode, NSArray<id<TLRepositoryObject>> *list) {
@@ -1188,20 +1414,20 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             }
             block(result);
         }];
-    });
+    }];
 }
 
 - (void)getContactWithContactId:(nonnull NSUUID *)contactId withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLContact * _Nullable contact))block {
     DDLogVerbose(@"%@ getContactWithContactId: %@", LOG_TAG, contactId);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"getContactWithContactId" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         
         [repositoryService getObjectWithFactory:[TLContact FACTORY] objectId:contactId withBlock:^(TLBaseServiceErrorCode errorCode, id<TLRepositoryObject> object) {
             
             block(errorCode, (TLContact *)object);
         }];
-    });
+    }];
 }
 
 - (void)createContactPhase1WithRequestId:(int64_t)requestId peerTwincodeOutbound:(TLTwincodeOutbound *)peerTwincodeOutbound space:(nullable TLSpace *)space profile:(TLProfile *)profile {
@@ -1211,47 +1437,50 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         space = self.currentSpace;
     }
     TLCreateContactPhase1Executor *createContactPhase1Executor = [[TLCreateContactPhase1Executor alloc] initWithTwinmeContext:self requestId:requestId peerTwincodeOutbound:peerTwincodeOutbound space:space profile:profile];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateContactPhase1Executor" block:^{
         [createContactPhase1Executor start];
-    });
+    }];
 }
 
 - (void)createContactPhase1WithRequestId:(int64_t)requestId peerTwincodeOutbound:(TLTwincodeOutbound *)peerTwincodeOutbound identityName:(NSString *)identityName identityAvatarId:(TLImageId *)identityAvatarId {
     DDLogVerbose(@"%@ createContactPhase1WithRequestId: %lld  peerTwincodeOutbound: %@ identityName: %@ identityAvatarId: %@", LOG_TAG, requestId, peerTwincodeOutbound, identityName, identityAvatarId);
     
     TLCreateContactPhase1Executor *createContactPhase1Executor = [[TLCreateContactPhase1Executor alloc] initWithTwinmeContext:self requestId:requestId peerTwincodeOutbound:peerTwincodeOutbound space:self.currentSpace identityName:identityName identityAvatarId:identityAvatarId];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateContactPhase1Executor" block:^{
         [createContactPhase1Executor start];
-    });
+    }];
 }
 
 - (void)createContactPhase2WithInvocation:(nonnull TLPairInviteInvocation *)invocation profile:(nonnull TLProfile *)profile {
     DDLogVerbose(@"%@ createContactPhase2WithInvocation: %@ profile: %@", LOG_TAG, invocation, profile);
     
     TLCreateContactPhase2Executor *createContactPhase2Executor = [[TLCreateContactPhase2Executor alloc] initWithTwinmeContext:self invocation:invocation space:profile.space profile:profile];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateContactPhase2Executor" block:^{
         [createContactPhase2Executor start];
-    });
+    }];
 }
 
 - (void)createContactPhase2WithInvocation:(nonnull TLPairInviteInvocation *)invocation invitation:(nonnull TLInvitation *)invitation {
     DDLogVerbose(@"%@ createContactPhase2WithInvocation: %@ invitation: %@", LOG_TAG, invocation, invitation);
     
     TLCreateContactPhase2Executor *createContactPhase2Executor = [[TLCreateContactPhase2Executor alloc] initWithTwinmeContext:self invocation:invocation invitation:invitation];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateContactPhase2Executor" block:^{
         [createContactPhase2Executor start];
-    });
+    }];
 }
 
 - (void)onCreateContactWithRequestId:(int64_t)requestId contact:(TLContact *)contact {
     DDLogVerbose(@"%@ onCreateContactWithRequestId: %lld contact: %@", LOG_TAG, requestId, contact);
     
+    [self.spaceOriginators updateWithOriginatorId:contact.uuid spaceId:contact.space.uuid];
+    [self markConversationWithSubjectId:contact.uuid];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onCreateContactWithRequestId:contact:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onCreateContactWithRequestId" block:^{
                 [lDelegate onCreateContactWithRequestId:requestId contact:contact];
-            });
+            }];
         }
     }
 }
@@ -1259,44 +1488,74 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ updateContactWithRequestId: %lld contact: %@ description: %@", LOG_TAG, requestId, contact, description);
     
     TLUpdateContactAndIdentityExecutor *updateContactAndIdentityExecutor = [[TLUpdateContactAndIdentityExecutor alloc] initWithTwinmeContext:self requestId:requestId contact:contact contactName:contactName description:description];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateContactAndIdentityExecutor" block:^{
         [updateContactAndIdentityExecutor start];
-    });
+    }];
 }
 
 - (void)updateContactIdentityWithRequestId:(int64_t)requestId contact:(TLContact *)contact identityName:(NSString *)identityName identityAvatar:(UIImage *)identityAvatar identityLargeAvatar:(UIImage *)identityLargeAvatar description:(nullable NSString *)description capabilities:(nullable TLCapabilities*)capabilities {
     DDLogVerbose(@"%@ updateContactIdentityWithRequestId: %lld contact: %@ identityName: %@ identityAvatar: %@ identityLargeAvatar: %@ description: %@ capabilities: %@", LOG_TAG, requestId, contact, identityName, identityAvatar, identityLargeAvatar, description, capabilities);
     
     TLUpdateContactAndIdentityExecutor *updateContactAndIdentityExecutor = [[TLUpdateContactAndIdentityExecutor alloc] initWithTwinmeContext:self requestId:requestId contact:contact identityName:identityName identityAvatar:identityAvatar identityLargeAvatar:identityLargeAvatar description:description capabilities:capabilities];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateContactAndIdentityExecutor" block:^{
         [updateContactAndIdentityExecutor start];
-    });
+    }];
 }
 
 - (void)bindContactWithInvocation:(nonnull TLPairBindInvocation *)invocation contact:(TLContact *)contact {
     DDLogVerbose(@"%@ bindContactWithInvocation: %@ contact: %@", LOG_TAG, invocation, contact);
     
     TLBindContactExecutor *bindContactExecutor = [[TLBindContactExecutor alloc] initWithTwinmeContext:self invocation:invocation contact:contact];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLBindContactExecutor" block:^{
         [bindContactExecutor start];
-    });
+    }];
 }
 
 - (void)refreshObjectWithInvocation:(nonnull TLPairRefreshInvocation *)invocation subject:(nonnull id<TLOriginator>)subject {
     DDLogVerbose(@"%@ refreshObjectWithInvocation: %@ subject: %@", LOG_TAG, invocation, subject);
     
-    TLRefreshObjectExecutor *refreshObjectExecutor = [[TLRefreshObjectExecutor alloc] initWithTwinmeContext:self invocation:invocation subject:subject];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    // The refresh of an object is grouped with the refreshes received within the batch window, the same
+    // object or group member refreshed by several invocations is refreshed once.
+    TLRefreshBatcher *refreshBatcher;
+    @synchronized (self) {
+        refreshBatcher = self.refreshBatcher;
+        if (!refreshBatcher) {
+            refreshBatcher = [[TLRefreshBatcher alloc] initWithQueue:[self.twinlife twinlifeQueue] delay:REFRESH_BATCH_DELAY maxCount:REFRESH_BATCH_MAX_COUNT flush:^(NSArray<id<NSCopying>> *keys, NSDictionary<id<NSCopying>, NSArray *> *items) {
+                [self refreshObjectsWithKeys:keys items:items];
+            }];
+            self.refreshBatcher = refreshBatcher;
+        }
+    }
+
+    TLRefreshObjectRequest *request = [[TLRefreshObjectRequest alloc] initWithInvocation:invocation subject:subject];
+    [refreshBatcher addWithKey:[request batchKey] item:request];
+}
+
+- (void)refreshObjectsWithKeys:(nonnull NSArray<id<NSCopying>> *)keys items:(nonnull NSDictionary<id<NSCopying>, NSArray *> *)items {
+    DDLogVerbose(@"%@ refreshObjectsWithKeys: %lu", LOG_TAG, (unsigned long)keys.count);
+
+    // A single refresh is made by the TLRefreshObjectExecutor.
+    if (keys.count == 1 && items[keys[0]].count == 1) {
+        TLRefreshObjectRequest *request = items[keys[0]][0];
+        TLRefreshObjectExecutor *refreshObjectExecutor = [[TLRefreshObjectExecutor alloc] initWithTwinmeContext:self invocation:request.invocation subject:request.subject];
         [refreshObjectExecutor start];
-    });
+        return;
+    }
+
+    NSMutableArray<NSArray<TLRefreshObjectRequest *> *> *requests = [[NSMutableArray alloc] initWithCapacity:keys.count];
+    for (id<NSCopying> key in keys) {
+        [requests addObject:items[key]];
+    }
+    TLRefreshObjectsExecutor *refreshObjectsExecutor = [[TLRefreshObjectsExecutor alloc] initWithTwinmeContext:self requests:requests];
+    [refreshObjectsExecutor start];
 }
 
 - (void)verifyContactWithUri:(nonnull TLTwincodeURI *)twincodeURI trustMethod:(TLTrustMethod)trustMethod  withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLContact * _Nullable contact))block {
 
     TLVerifyContactExecutor *verifyContactExecutor = [[TLVerifyContactExecutor alloc] initWithTwinmeContext:self twincodeURI:twincodeURI trustMethod:trustMethod withBlock:block];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLVerifyContactExecutor" block:^{
         [verifyContactExecutor start];
-    });
+    }];
 }
 
 - (void)unbindContactWithRequestId:(int64_t)requestId invocationId:(NSUUID *)invocationId contact:(TLContact *)contact {
@@ -1304,26 +1563,28 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     if (DELETE_CONTACT_ON_UNBIND_CONTACT) {
         TLDeleteContactExecutor *deleteContactExecutor = [[TLDeleteContactExecutor alloc] initWithTwinmeContext:self requestId:requestId contact:contact invocationId:invocationId timeout:DBL_MAX];
-        dispatch_async([self.twinlife twinlifeQueue], ^{
+        [self dispatchWithLabel:@"TLDeleteContactExecutor" block:^{
             [deleteContactExecutor start];
-        });
+        }];
     } else {
         TLUnbindContactExecutor *unbindContactExecutor = [[TLUnbindContactExecutor alloc] initWithTwinmeContext:self requestId:requestId invocationId:invocationId contact:contact];
-        dispatch_async([self.twinlife twinlifeQueue], ^{
+        [self dispatchWithLabel:@"TLUnbindContactExecutor" block:^{
             [unbindContactExecutor start];
-        });
+        }];
     }
 }
 
 - (void)onUpdateContactWithRequestId:(int64_t)requestId contact:(TLContact *)contact {
     DDLogVerbose(@"%@ onUpdateContactWithRequestId: %lld contact: %@", LOG_TAG, requestId, contact);
     
+    [self.spaceOriginators updateWithOriginatorId:contact.uuid spaceId:contact.space.uuid];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onUpdateContactWithRequestId:contact:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onUpdateContactWithRequestId" block:^{
                 [lDelegate onUpdateContactWithRequestId:requestId contact:contact];
-            });
+            }];
         }
     }
 }
@@ -1331,12 +1592,15 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)onMoveToSpaceWithRequestId:(int64_t)requestId contact:(TLContact *)contact oldSpace:(TLSpace *)oldSpace {
     DDLogVerbose(@"%@ onMoveToSpaceWithRequestId: %lld contact: %@", LOG_TAG, requestId, contact);
     
+    [self.spaceOriginators updateWithOriginatorId:contact.uuid spaceId:contact.space.uuid];
+    [self markConversationWithSubjectId:nil];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onMoveToSpaceWithRequestId:contact:oldSpace:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onMoveToSpaceWithRequestId" block:^{
                 [lDelegate onMoveToSpaceWithRequestId:requestId contact:contact oldSpace:oldSpace];
-            });
+            }];
         }
     }
 }
@@ -1345,20 +1609,23 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ deleteContactWithRequestId: %lld contact: %@", LOG_TAG, requestId, contact);
     
     TLDeleteContactExecutor *deleteContactExecutor = [[TLDeleteContactExecutor alloc] initWithTwinmeContext:self requestId:requestId contact:contact invocationId:nil timeout:DEFAULT_TIMEOUT];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLDeleteContactExecutor" block:^{
         [deleteContactExecutor start];
-    });
+    }];
 }
 
 - (void)onDeleteContactWithRequestId:(int64_t)requestId contactId:(NSUUID *)contactId {
     DDLogVerbose(@"%@ onDeleteContactWithRequestId: %lld contact: %@", LOG_TAG, requestId, contactId);
     
+    [self.spaceOriginators updateWithOriginatorId:contactId spaceId:nil];
+    [self markConversationWithSubjectId:nil];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteContactWithRequestId:contactId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onDeleteContactWithRequestId" block:^{
                 [lDelegate onDeleteContactWithRequestId:requestId contactId:contactId];
-            });
+            }];
         }
     }
 }
@@ -1397,20 +1664,22 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLCreateCallReceiverExecutor *createCallReceiverExecutor = [[TLCreateCallReceiverExecutor  alloc] initWithTwinmeContext:self requestId:requestId name:name description:description identityName:identityName identityDescription:identityDescription avatar:avatar largeAvatar:largeAvatar capabilities:capabilities space:space];
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateCallReceiverExecutor" block:^{
         [createCallReceiverExecutor start];
-    });
+    }];
 }
 
 - (void)onCreateCallReceiverWithRequestId:(int64_t)requestId callReceiver:(TLCallReceiver *)callReceiver {
     DDLogVerbose(@"%@ onCreateCallReceiverWithRequestId: %lld callReceiver: %@", LOG_TAG, requestId, callReceiver);
     
+    [self watchScheduleWithOriginator:callReceiver];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onCreateCallReceiverWithRequestId:callReceiver:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onCreateCallReceiverWithRequestId" block:^{
                 [lDelegate onCreateCallReceiverWithRequestId:requestId callReceiver:callReceiver];
-            });
+            }];
         }
     }
 }
@@ -1418,14 +1687,14 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)getCallReceiverWithCallReceiverId:(nonnull NSUUID *)callReceiverId withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLCallReceiver * _Nullable callReceiver))block {
     DDLogVerbose(@"%@ getCallReceiverWithCallReceiverId: %@", LOG_TAG, callReceiverId);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"getCallReceiverWithCallReceiverId" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         
         [repositoryService getObjectWithFactory:[TLCallReceiver FACTORY] objectId:callReceiverId withBlock:^(TLBaseServiceErrorCode errorCode, id<TLRepositoryObject> object) {
             
             block(errorCode, (TLCallReceiver *)object);
         }];
-    });
+    }];
 }
 
 - (void)getCallReceiversWithRequestId:(int64_t)requestId withBlock:(void (^)(NSArray<TLCallReceiver *> *))block {
@@ -1441,20 +1710,22 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLDeleteCallReceiverExecutor *executor = [[TLDeleteCallReceiverExecutor alloc] initWithTwinmeContext:self requestId:requestId callReceiver:callReceiver timeout:DEFAULT_TIMEOUT];
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLDeleteCallReceiverExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)onDeleteCallReceiverWithRequestId:(int64_t)requestId callReceiverId:(NSUUID *)callReceiverId {
     DDLogVerbose(@"%@ onDeleteCallReceiverWithRequestId: %lld callReceiverId: %@", LOG_TAG, requestId, callReceiverId);
     
+    [self unwatchScheduleWithOriginatorId:callReceiverId];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteCallReceiverWithRequestId:callReceiverId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onDeleteCallReceiverWithRequestId" block:^{
                 [lDelegate onDeleteCallReceiverWithRequestId:requestId callReceiverId:callReceiverId];
-            });
+            }];
         }
     }
 }
@@ -1464,20 +1735,22 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLUpdateCallReceiverExecutor *executor = [[TLUpdateCallReceiverExecutor alloc] initWithTwinmeContext:self requestId:requestId callReceiver:callReceiver name:name description:description identityName:identityName identityDescription:identityDescription avatar:avatar largeAvatar:largeAvatar capabilities:capabilities];
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateCallReceiverExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)onUpdateCallReceiverWithRequestId:(int64_t)requestId callReceiver:(nonnull TLCallReceiver *)callReceiver {
     DDLogVerbose(@"%@ onUpdateCallReceiverWithRequestId: %lld callReceiver: %@", LOG_TAG, requestId, callReceiver);
     
+    [self watchScheduleWithOriginator:callReceiver];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onUpdateCallReceiverWithRequestId:callReceiver:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onUpdateCallReceiverWithRequestId" block:^{
                 [lDelegate onUpdateCallReceiverWithRequestId:requestId callReceiver:callReceiver];
-            });
+            }];
         }
     }
 }
@@ -1487,9 +1760,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLChangeCallReceiverTwincodeExecutor *executor = [[TLChangeCallReceiverTwincodeExecutor alloc] initWithTwinmeContext:self requestId:requestId callReceiver:callReceiver];
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLChangeCallReceiverTwincodeExecutor" block:^{
         [executor start];
-    });
+    }];
 }
 
 - (void)onChangeCallReceiverTwincodeWithRequestId:(int64_t)requestId callReceiver:(nonnull TLCallReceiver *)callReceiver {
@@ -1498,9 +1771,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onChangeCallReceiverTwincodeWithRequestId:callReceiver:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onChangeCallReceiverTwincodeWithRequestId" block:^{
                 [lDelegate onChangeCallReceiverTwincodeWithRequestId:requestId callReceiver:callReceiver];
-            });
+            }];
         }
     }
 }
@@ -1508,7 +1781,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)findCallReceiversWithFilter:(nonnull TLFilter*)filter withBlock:(nonnull void (^)(NSMutableArray<TLCallReceiver*> * _Nonnull list))block {
     DDLogVerbose(@"%@ findCallReceiversWithFilter: %@", LOG_TAG, filter);
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"findCallReceiversWithFilter" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         
         [repositoryService listObjectsWithFactory:[TLCallReceiver FACTORY] filter:filter withBlock:^(TLBaseServiceErrorCode errorCode, NSArray<id<TLRepositoryObject>> *list) {
@@ -1516,15 +1789,18 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             for (id<TLRepositoryObject> object in list) {
                 [result addObject:(TLCallReceiver *)object];
             }
+            
+            // Loaded call receivers may come from another space or from the database: make sure their schedule is watched.
+            [self watchScheduleWithOriginators:result];
             block(result);
         }];
-    });
+    }];
 }
 
 - (void)findInvitationsWithFilter:(nonnull TLFilter*)filter withBlock:(nonnull void (^)(NSArray<TLInvitation*> * _Nonnull list))block {
     DDLogVerbose(@"%@ findCallReceiversWithFilter: %@", LOG_TAG, filter);
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"findInvitationsWithFilter" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         
         [repositoryService listObjectsWithFactory:[TLInvitation FACTORY] filter:filter withBlock:^(TLBaseServiceErrorCode errorCode, NSArray<id<TLRepositoryObject>> *list) {
@@ -1534,7 +1810,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             }
             block(result);
         }];
-    });
+    }];
 }
 
 #pragma mark - Invitation management
@@ -1547,18 +1823,18 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ createInvitationWithRequestId: %lld groupMember: %@", LOG_TAG, requestId, groupMember);
     
     TLCreateInvitationExecutor *createInvitationExecutor = [[TLCreateInvitationExecutor alloc] initWithTwinmeContext:self requestId:requestId space:self.currentSpace groupMember:groupMember];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateInvitationExecutor" block:^{
         [createInvitationExecutor start];
-    });
+    }];
 }
 
 - (void)createInvitationWithRequestId:(int64_t)requestId contact:(nonnull TLContact *)contact sendTo:(nonnull NSUUID *)sendTo {
     DDLogVerbose(@"%@ createInvitationWithRequestId: %lld contact: %@ sendTo: %@", LOG_TAG, requestId, contact, sendTo);
     
     TLCreateInvitationExecutor *createInvitationExecutor = [[TLCreateInvitationExecutor alloc] initWithTwinmeContext:self requestId:requestId space:self.currentSpace contact:contact sendTo:sendTo];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateInvitationExecutor" block:^{
         [createInvitationExecutor start];
-    });
+    }];
 }
 
 - (void)onCreateInvitationWithRequestId:(int64_t)requestId invitation:(TLInvitation *)invitation {
@@ -1576,18 +1852,18 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ getInvitationWithInvitationId: %@", LOG_TAG, invitationId);
     
     TLGetInvitationAction *getInvitationExecutor = [[TLGetInvitationAction alloc] initWithTwinmeContext:self invitationId:invitationId withBlock:block];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLGetInvitationAction" block:^{
         [getInvitationExecutor start];
-    });
+    }];
 }
 
 - (void)deleteInvitationWithRequestId:(int64_t)requestId invitation:(TLInvitation *)invitation {
     DDLogVerbose(@"%@ deleteInvitationWithRequestId: %lld invitation: %@", LOG_TAG, requestId, invitation);
     
     TLDeleteInvitationExecutor *deleteInvitationExecutor = [[TLDeleteInvitationExecutor alloc] initWithTwinmeContext:self requestId:requestId invitation:invitation timeout:DEFAULT_TIMEOUT];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLDeleteInvitationExecutor" block:^{
         [deleteInvitationExecutor start];
-    });
+    }];
 }
 
 - (void)onDeleteInvitationWithRequestId:(int64_t)requestId invitationId:(NSUUID *)invitationId {
@@ -1596,9 +1872,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteInvitationWithRequestId:invitationId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onDeleteInvitationWithRequestId" block:^{
                 [lDelegate onDeleteInvitationWithRequestId:requestId invitationId:invitationId];
-            });
+            }];
         }
     }
 }
@@ -1612,7 +1888,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)findGroupsWithFilter:(nonnull TLFilter*)filter withBlock:(nonnull void (^)(NSMutableArray<TLGroup*> * _Nonnull list))block {
     DDLogVerbose(@"%@ findGroupsWithFilter: %@", LOG_TAG, filter);
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"findGroupsWithFilter" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         
         [repositoryService listObjectsWithFactory:[TLGroup FACTORY] filter:filter withBlock:^(TLBaseServiceErrorCode errorCode, NSArray<id<TLRepositoryObject>> *list) {
@@ -1622,58 +1898,61 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             }
             block(result);
         }];
-    });
+    }];
 }
 
 - (void)getGroupWithGroupId:(nonnull NSUUID *)groupId withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLGroup * _Nullable group))block {
     DDLogVerbose(@"%@ getGroupWithGroupId: %@", LOG_TAG, groupId);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"getGroupWithGroupId" block:^{
         TLRepositoryService *repositoryService = [self getRepositoryService];
         
         [repositoryService getObjectWithFactory:[TLGroup FACTORY] objectId:groupId withBlock:^(TLBaseServiceErrorCode errorCode, id<TLRepositoryObject> object) {
             
             block(errorCode, (TLGroup *)object);
         }];
-    });
+    }];
 }
 
 - (void)createGroupWithRequestId:(int64_t)requestId name:(NSString *)name description:(nullable NSString *)description avatar:(UIImage *)avatar largeAvatar:(UIImage *)largeAvatar {
     DDLogVerbose(@"%@ createGroupWithRequestId: %lld name: %@", LOG_TAG, requestId, name);
     
     TLCreateGroupExecutor *createGroupExecutor = [[TLCreateGroupExecutor alloc] initWithTwinmeContext:self requestId:requestId space:self.currentSpace name:name description:description avatar:avatar largeAvatar:largeAvatar];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateGroupExecutor" block:^{
         [createGroupExecutor start];
-    });
+    }];
 }
 
 - (void)createGroupWithRequestId:(int64_t)requestId invitation:(nonnull TLInvitationDescriptor *)invitation {
     DDLogVerbose(@"%@ createGroupWithRequestId: %lld invitation: %@", LOG_TAG, requestId, invitation);
     
     TLCreateGroupExecutor *createGroupExecutor = [[TLCreateGroupExecutor alloc] initWithTwinmeContext:self requestId:requestId space:self.currentSpace invitation:invitation];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateGroupExecutor" block:^{
         [createGroupExecutor start];
-    });
+    }];
 }
 
 - (void)createGroupWithRequestId:(int64_t)requestId invitationTwincode:(nonnull TLTwincodeOutbound *)invitationTwincode space:(nonnull TLSpace *)space {
     DDLogVerbose(@"%@ createGroupWithRequestId: %lld invitationTwincodeId: %@ space: %@", LOG_TAG, requestId, invitationTwincode, space);
     
     TLCreateGroupExecutor *createGroupExecutor = [[TLCreateGroupExecutor alloc] initWithTwinmeContext:self requestId:requestId space:space invitationTwincode:invitationTwincode];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateGroupExecutor" block:^{
         [createGroupExecutor start];
-    });
+    }];
 }
 
 - (void)onCreateGroupWithRequestId:(int64_t)requestId group:(TLGroup *)group conversation:(id<TLGroupConversation>)conversation {
     DDLogVerbose(@"%@ onCreateGroupWithRequestId: %lld group: %@ conversation: %@", LOG_TAG, requestId, group, conversation);
     
+    [self.spaceOriginators updateWithOriginatorId:group.uuid spaceId:group.space.uuid];
+    [self markConversationWithSubjectId:group.uuid];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onCreateGroupWithRequestId:group:conversation:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onCreateGroupWithRequestId" block:^{
                 [lDelegate onCreateGroupWithRequestId:requestId group:group conversation:conversation];
-            });
+            }];
         }
     }
 }
@@ -1682,29 +1961,31 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ updateGroupWithRequestId: %lld group: %@ name: %@ groupAvatar: %@ groupLargeAvatar: %@", LOG_TAG, requestId, group, name, groupAvatar, groupLargeAvatar);
     
     TLUpdateGroupExecutor *updateGroupExecutor = [[TLUpdateGroupExecutor alloc] initWithTwinmeContext:self requestId:requestId group:group name:name groupDescription:description groupAvatar:groupAvatar groupLargeAvatar:groupLargeAvatar groupCapabilities:capabilities];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateGroupExecutor" block:^{
         [updateGroupExecutor start];
-    });
+    }];
 }
 
 - (void)updateGroupProfileWithRequestId:(int64_t)requestId group:(nonnull TLGroup *)group name:(nonnull NSString *)name profileAvatar:(nullable UIImage *)profileAvatar profileLargeAvatar:(nullable UIImage *)profileLargeAvatar {
     DDLogVerbose(@"%@ updateGroupWithRequestId: %lld group: %@ name: %@ profileAvatar: %@", LOG_TAG, requestId, group, name, profileAvatar);
     
     TLUpdateGroupExecutor *updateGroupExecutor = [[TLUpdateGroupExecutor alloc] initWithTwinmeContext:self requestId:requestId group:group name:name profileAvatar:profileAvatar profileLargeAvatar:profileLargeAvatar];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateGroupExecutor" block:^{
         [updateGroupExecutor start];
-    });
+    }];
 }
 
 - (void)onUpdateGroupWithRequestId:(int64_t)requestId group:(TLGroup *)group {
     DDLogVerbose(@"%@ onUpdateGroupWithRequestId: %lld group: %@", LOG_TAG, requestId, group);
     
+    [self.spaceOriginators updateWithOriginatorId:group.uuid spaceId:group.space.uuid];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onUpdateGroupWithRequestId:group:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onUpdateGroupWithRequestId" block:^{
                 [lDelegate onUpdateGroupWithRequestId:requestId group:group];
-            });
+            }];
         }
     }
 }
@@ -1712,12 +1993,15 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)onMoveToSpaceWithRequestId:(int64_t)requestId group:(TLGroup *)group oldSpace:(TLSpace *)oldSpace {
     DDLogVerbose(@"%@ onMoveToSpaceWithRequestId: %lld group: %@", LOG_TAG, requestId, group);
     
+    [self.spaceOriginators updateWithOriginatorId:group.uuid spaceId:group.space.uuid];
+    [self markConversationWithSubjectId:nil];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onMoveToSpaceWithRequestId:group:oldSpace:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onMoveToSpaceWithRequestId" block:^{
                 [lDelegate onMoveToSpaceWithRequestId:requestId group:group oldSpace:oldSpace];
-            });
+            }];
         }
     }
 }
@@ -1726,20 +2010,23 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ deleteGroupWithRequestId: %lld group: %@", LOG_TAG, requestId, group);
     
     TLDeleteGroupExecutor *deleteGroupExecutor = [[TLDeleteGroupExecutor alloc] initWithTwinmeContext:self requestId:requestId group:group timeout:DEFAULT_TIMEOUT];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLDeleteGroupExecutor" block:^{
         [deleteGroupExecutor start];
-    });
+    }];
 }
 
 - (void)onDeleteGroupWithRequestId:(int64_t)requestId groupId:(NSUUID *)groupId {
     DDLogVerbose(@"%@ onDeleteGroupWithRequestId: %lld groupId: %@", LOG_TAG, requestId, groupId);
     
+    [self.spaceOriginators updateWithOriginatorId:groupId spaceId:nil];
+    [self markConversationWithSubjectId:nil];
+    
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteGroupWithRequestId:groupId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onDeleteGroupWithRequestId" block:^{
                 [lDelegate onDeleteGroupWithRequestId:requestId groupId:groupId];
-            });
+            }];
         }
     }
 }
@@ -1748,7 +2035,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ getGroupMemberWithOwner: %@ memberTwincodeId: %@", LOG_TAG, owner, memberTwincodeId);
     
     TLGroupMember *groupMember;
-    @synchronized(self) {
+    @synchronized(self.groupMembers) {
         groupMember = self.groupMembers[memberTwincodeId];
 
         // If the cache contains an old member, remove and ignore it (use pointer equality for the test!).
@@ -1762,10 +2049,14 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         block(TLBaseServiceErrorCodeSuccess, groupMember);
         
     } else {
-        TLGetGroupMemberExecutor *getGroupMemberExecutor = [[TLGetGroupMemberExecutor alloc] initWithTwinmeContext:self  owner:owner groupMemberTwincodeId:memberTwincodeId withBlock:block];
-        dispatch_async([self.twinlife twinlifeQueue], ^{
-            [getGroupMemberExecutor start];
-        });
+        // Only the first caller starts the executor, the others get its result.
+        TLSingleFlightKey *key = [[TLSingleFlightKey alloc] initWithFirst:owner.uuid second:memberTwincodeId];
+        [self.groupMemberLookups lookupWithKey:key block:block start:^(TLSingleFlightBlock complete) {
+            TLGetGroupMemberExecutor *getGroupMemberExecutor = [[TLGetGroupMemberExecutor alloc] initWithTwinmeContext:self  owner:owner groupMemberTwincodeId:memberTwincodeId withBlock:complete];
+            [self dispatchWithLabel:@"TLGetGroupMemberExecutor" block:^{
+                [getGroupMemberExecutor start];
+            }];
+        }];
     }
 }
 
@@ -1773,7 +2064,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ onGetGroupMemberWithRequestId: %u groupMember: %@", LOG_TAG, errorCode, groupMember);
     
     if (errorCode == TLBaseServiceErrorCodeSuccess && groupMember) {
-        @synchronized(self) {
+        @synchronized(self.groupMembers) {
             self.groupMembers[groupMember.memberTwincodeOutboundId] = groupMember;
         }
     }
@@ -1784,7 +2075,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)fetchExistingMembersWithOwner:(nonnull id<TLOriginator>)owner members:(nonnull NSArray<NSUUID *> *)members knownMembers:(nonnull NSMutableArray<TLGroupMember *> *)knownMembers unknownMembers:(nonnull NSMutableArray<NSUUID *> *)unknownMembers {
     DDLogVerbose(@"%@ fetchExistingMembersWithOwner: %@ members: %@", LOG_TAG, owner, members);
 
-    @synchronized (self) {
+    @synchronized (self.groupMembers) {
         for (NSUUID *memberTwincodeId in members) {
             TLGroupMember *groupMember = self.groupMembers[memberTwincodeId];
 
@@ -1805,25 +2096,34 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ listGroupMembersWithGroup: %@ filter: %u", LOG_TAG, group, filter);
 
     TLListMembersExecutor *listGroupMemberExecutor = [[TLListMembersExecutor alloc] initWithTwinmeContext:self group:group filter:filter withBlock:block];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLListMembersExecutor" block:^{
         [listGroupMemberExecutor start];
-    });
+    }];
 }
 
 - (void)listMembersWithOwner:(nonnull id<TLOriginator>)owner memberTwincodeList:(nonnull NSMutableArray *)memberTwincodeList withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, NSMutableArray<TLGroupMember *> * _Nullable list))block {
     DDLogVerbose(@"%@ listMembersWithOwner: %@ memberTwincodeList: %@", LOG_TAG, owner, memberTwincodeList);
 
     TLListMembersExecutor *listGroupMemberExecutor = [[TLListMembersExecutor alloc] initWithTwinmeContext:self owner:owner memberTwincodeList:memberTwincodeList withBlock:block];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLListMembersExecutor" block:^{
         [listGroupMemberExecutor start];
-    });
+    }];
 }
 
 - (void)getSpaceOriginatorSet:(nonnull TLSpace *)space withBlock:(nonnull void (^)(NSSet<NSUUID *> * _Nonnull originatorSet))block {
+    DDLogVerbose(@"%@ getSpaceOriginatorSet: %@", LOG_TAG, space);
+    
+    NSSet<NSUUID *> *originatorSet = [self.spaceOriginators originatorSetWithSpaceId:space.uuid];
+    if (originatorSet) {
+        block(originatorSet);
+        return;
+    }
     
+    // Load the set from the repository and keep it if no contact or group was changed in the meantime.
+    int64_t version = self.spaceOriginators.version;
     NSMutableSet<NSUUID *> *result = [[NSMutableSet alloc] init];
-    TLFilter *filter = [TLFilter alloc];
-    filter.owner = self.currentSpace;
+    TLFilter *filter = [[TLFilter alloc] init];
+    filter.owner = space;
     [self findContactsWithFilter:filter withBlock:^(NSMutableArray<TLContact *> *list) {
         for (TLContact *contact in list) {
             [result addObject:contact.uuid];
@@ -1832,6 +2132,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             for (TLGroup *group in list) {
                 [result addObject:group.uuid];
             }
+            [self.spaceOriginators putWithSpaceId:space.uuid originatorSet:result version:version];
             block(result);
         }];
     }];
@@ -1841,9 +2142,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ updateStatsWithRequestId: %lld updateScore: %d", LOG_TAG, requestId, updateScore);
     
     TLUpdateStatsExecutor *updateStatsExecutor = [[TLUpdateStatsExecutor alloc] initWithTwinmeContext:self requestId:requestId updateScore:updateScore];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateStatsExecutor" block:^{
         [updateStatsExecutor start];
-    });
+    }];
 }
 
 - (void)onUpdateStatsWithRequestId:(int64_t)requestId contacts:(NSArray<id<TLRepositoryObject>> *)contacts groups:(NSArray<id<TLRepositoryObject>> *)groups {
@@ -1876,9 +2177,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onUpdateStatsWithRequestId:contacts:groups:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onUpdateStatsWithRequestId" block:^{
                 [lDelegate onUpdateStatsWithRequestId:requestId contacts:updatedContacts groups:updatedGroups];
-            });
+            }];
         }
     }
 #endif
@@ -1991,21 +2292,13 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ getSpaceWithSpaceId: %@", LOG_TAG, spaceId);
     
     if (self.getSpacesDone) {
-        TLSpace *lSpace;
-        
-        @synchronized(self) {
-            lSpace = self.spaces[spaceId];
-        }
+        TLSpace *lSpace = [self.spaces spaceWithSpaceId:spaceId];
         block(lSpace ? TLBaseServiceErrorCodeSuccess : TLBaseServiceErrorCodeItemNotFound, lSpace);
     } else {
         [self findSpacesWithPredicate:^BOOL(TLSpace *space) {
             return false;
         } withBlock:^(NSMutableArray<TLSpace *> *list) {
-            TLSpace *lSpace;
-            @synchronized(self) {
-                lSpace = self.spaces[spaceId];
-            }
-            
+            TLSpace *lSpace = [self.spaces spaceWithSpaceId:spaceId];
             block(lSpace ? TLBaseServiceErrorCodeSuccess : TLBaseServiceErrorCodeItemNotFound, lSpace);
         }];
     }
@@ -2015,14 +2308,14 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ findSpacesWithPredicate", LOG_TAG);
     
     if (self.getSpacesDone || (!self.hasSpaces && !self.hasProfiles)) {
-        dispatch_async(self.twinlife.twinlifeQueue, ^{
+        [self dispatchWithLabel:@"findSpacesWithPredicate" block:^{
             [self resolveFindSpacesWithPredicate:predicate withBlock:block];
-        });
+        }];
     } else {
         TLExecutor *getSpacesExecutor;
         BOOL created;
         
-        @synchronized(self) {
+        @synchronized(self.executors) {
             getSpacesExecutor = self.executors[@"TLGetSpacesExecutor"];
             created = getSpacesExecutor ? NO : YES;
             if (created) {
@@ -2035,9 +2328,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         }];
         
         if (created) {
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"TLGetSpacesExecutor" block:^{
                 [getSpacesExecutor start];
-            });
+            }];
         }
     }
 }
@@ -2062,7 +2355,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     self.getSpacesDone = YES;
     
-    @synchronized(self) {
+    @synchronized(self.executors) {
         [self.executors removeObjectForKey:@"TLGetSpacesExecutor"];
     }
 }
@@ -2070,20 +2363,17 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)resolveFindSpacesWithPredicate:(nonnull BOOL (^)(TLSpace * _Nonnull space))predicate withBlock:(nonnull void (^)(NSMutableArray<TLSpace*> * _Nonnull list))block {
     DDLogVerbose(@"%@ resolveFindSpacesWithPredicate", LOG_TAG);
     
-    NSMutableArray<TLSpace*> *result;
-    @synchronized(self) {
-        result = [[NSMutableArray alloc] initWithCapacity:self.spaces.count];
-        for (NSUUID *spaceId in self.spaces) {
-            TLSpace *space = self.spaces[spaceId];
-            if (predicate(space)) {
-                [result addObject:space];
-            }
+    NSArray<TLSpace *> *spaces = self.spaces.list;
+    NSMutableArray<TLSpace*> *result = [[NSMutableArray alloc] initWithCapacity:spaces.count];
+    for (TLSpace *space in spaces) {
+        if (predicate(space)) {
+            [result addObject:space];
         }
     }
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"resolveFindSpacesWithPredicate" block:^{
         block(result);
-    });
+    }];
 }
 
 - (void)getDefaultSpaceWithBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLSpace *space))block {
@@ -2106,10 +2396,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)getCurrentSpaceWithBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLSpace *space))block {
     DDLogVerbose(@"%@ getCurrentSpaceWithBlock", LOG_TAG);
     
-    TLSpace *space;
-    @synchronized(self) {
-        space = self.currentSpace;
-    }
+    TLSpace *space = self.currentSpace;
     if (space) {
         block(TLBaseServiceErrorCodeSuccess, space);
     } else {
@@ -2146,9 +2433,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onSetCurrentSpaceWithRequestId:space:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async(self.twinlife.twinlifeQueue, ^{
+            [self dispatchWithLabel:@"onSetCurrentSpaceWithRequestId" block:^{
                 [lDelegate onSetCurrentSpaceWithRequestId:requestId space:space];
-            });
+            }];
         }
     }
 }
@@ -2156,17 +2443,14 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (BOOL)isDefaultSpace:(TLSpace *)space {
     DDLogVerbose(@"%@ isDefaultSpace: %@", LOG_TAG, space);
     
-    @synchronized(self) {
-        return self.defaultSpaceId && [space.uuid isEqual:self.defaultSpaceId];
-    }
+    NSUUID *defaultSpaceId = self.defaultSpaceId;
+    return defaultSpaceId && [space.uuid isEqual:defaultSpaceId];
 }
 
 - (nullable TLSpace *)getCurrentSpace {
     DDLogVerbose(@"%@ getCurrentSpace", LOG_TAG);
     
-    @synchronized(self) {
-        return self.currentSpace;
-    }
+    return self.currentSpace;
 }
 
 - (void)setDefaultSpace:(TLSpace *)space {
@@ -2208,9 +2492,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         }
         block(errorCode, settings);
     }];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateSettingsExecutor" block:^{
         [updateSettingsExecutor start];
-    });
+    }];
 }
 
 - (TLSpaceSettings *)defaultSpaceSettings {
@@ -2227,9 +2511,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLCreateSpaceExecutor *createSpaceExecutor = [[TLCreateSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId settings:settings spaceAvatar:spaceAvatar spaceLargeAvatar:spaceLargeAvatar name:nil avatar:nil largeAvatar:nil isDefault:NO];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateSpaceExecutor" block:^{
         [createSpaceExecutor start];
-    });
+    }];
 }
 
 - (void)createSpaceWithRequestId:(int64_t)requestId settings:(TLSpaceSettings *)settings spaceAvatar:(nullable UIImage *)spaceAvatar spaceLargeAvatar:(nullable UIImage *)spaceLargeAvatar name:(NSString *)name avatar:(UIImage *)avatar largeAvatar:(UIImage *)largeAvatar {
@@ -2241,9 +2525,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLCreateSpaceExecutor *createSpaceExecutor = [[TLCreateSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId settings:settings spaceAvatar:spaceAvatar spaceLargeAvatar:spaceLargeAvatar name:name avatar:avatar largeAvatar:largeAvatar isDefault:NO];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateSpaceExecutor" block:^{
         [createSpaceExecutor start];
-    });
+    }];
 }
 
 - (void)createSpaceWithRequestId:(int64_t)requestId settings:(TLSpaceSettings *)settings profile:(TLProfile *)profile {
@@ -2255,9 +2539,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLCreateSpaceExecutor *createSpaceExecutor = [[TLCreateSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId settings:settings profile:profile isDefault:NO];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateSpaceExecutor" block:^{
         [createSpaceExecutor start];
-    });
+    }];
 }
 
 - (void)createDefaultSpaceWithRequestId:(int64_t)requestId settings:(TLSpaceSettings *)settings profile:(TLProfile *)profile {
@@ -2269,9 +2553,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLCreateSpaceExecutor *createSpaceExecutor = [[TLCreateSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId settings:settings profile:profile isDefault:YES];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateSpaceExecutor" block:^{
         [createSpaceExecutor start];
-    });
+    }];
 }
 
 - (void)createDefaultSpaceWithRequestId:(int64_t)requestId settings:(TLSpaceSettings *)settings name:(NSString *)name avatar:(UIImage *)avatar largeAvatar:(UIImage *)largeAvatar {
@@ -2283,9 +2567,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLCreateSpaceExecutor *createSpaceExecutor = [[TLCreateSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId settings:settings spaceAvatar:nil spaceLargeAvatar:nil name:name avatar:avatar largeAvatar:largeAvatar isDefault:YES];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLCreateSpaceExecutor" block:^{
         [createSpaceExecutor start];
-    });
+    }];
 }
 
 - (void)onCreateSpaceWithRequestId:(int64_t)requestId space:(TLSpace *)space {
@@ -2301,9 +2585,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onCreateSpaceWithRequestId:space:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onCreateSpaceWithRequestId" block:^{
                 [lDelegate onCreateSpaceWithRequestId:requestId space:lSpace];
-            });
+            }];
         }
     }
 }
@@ -2321,9 +2605,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         
     } else {
         TLDeleteSpaceExecutor *deleteSpaceExecutor = [[TLDeleteSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId space:space];
-        dispatch_async([self.twinlife twinlifeQueue], ^{
+        [self dispatchWithLabel:@"TLDeleteSpaceExecutor" block:^{
             [deleteSpaceExecutor start];
-        });
+        }];
     }
 }
 
@@ -2335,9 +2619,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onDeleteSpaceWithRequestId:spaceId:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onDeleteSpaceWithRequestId" block:^{
                 [lDelegate onDeleteSpaceWithRequestId:requestId spaceId:spaceId];
-            });
+            }];
         }
     }
 }
@@ -2373,9 +2657,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLUpdateContactAndIdentityExecutor *updateContactExecutor = [[TLUpdateContactAndIdentityExecutor alloc] initWithTwinmeContext:self requestId:requestId contact:contact space:space];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateContactAndIdentityExecutor" block:^{
         [updateContactExecutor start];
-    });
+    }];
 }
 
 - (void)moveToSpaceWithRequestId:(int64_t)requestId group:(TLGroup *)group space:(TLSpace *)space {
@@ -2387,9 +2671,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLUpdateGroupExecutor *updateGroupExecutor = [[TLUpdateGroupExecutor alloc] initWithTwinmeContext:self requestId:requestId group:group space:space];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateGroupExecutor" block:^{
         [updateGroupExecutor start];
-    });
+    }];
 }
 
 - (void)updateSpaceWithRequestId:(int64_t)requestId space:(nonnull TLSpace *)space profile:(nonnull TLProfile *)profile {
@@ -2401,9 +2685,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLUpdateSpaceExecutor *updateSpaceExecutor = [[TLUpdateSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId space:space profile:profile settings:nil spaceAvatar:nil spaceLargeAvatar:nil];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateSpaceExecutor" block:^{
         [updateSpaceExecutor start];
-    });
+    }];
 }
 
 - (void)updateSpaceWithRequestId:(int64_t)requestId space:(nonnull TLSpace *)space settings:(nonnull TLSpaceSettings *)settings spaceAvatar:(nullable UIImage *)spaceAvatar spaceLargeAvatar:(nullable UIImage *)spaceLargeAvatar {
@@ -2415,9 +2699,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     TLUpdateSpaceExecutor *updateSpaceExecutor = [[TLUpdateSpaceExecutor alloc] initWithTwinmeContext:self requestId:requestId space:space profile:nil settings:settings spaceAvatar:spaceAvatar spaceLargeAvatar:spaceLargeAvatar];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLUpdateSpaceExecutor" block:^{
         [updateSpaceExecutor start];
-    });
+    }];
 }
 
 - (void)onUpdateSpaceWithRequestId:(int64_t)requestId space:(TLSpace *)space {
@@ -2440,9 +2724,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     for (id delegate in self.delegates) {
         if ([delegate respondsToSelector:@selector(onUpdateSpaceWithRequestId:space:)]) {
             id<TLTwinmeContextDelegate> lDelegate = delegate;
-            dispatch_async([self.twinlife twinlifeQueue], ^{
+            [self dispatchWithLabel:@"onUpdateSpaceWithRequestId" block:^{
                 [lDelegate onUpdateSpaceWithRequestId:requestId space:lSpace];
-            });
+            }];
         }
     }
 }
@@ -2456,10 +2740,23 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)findConversationsWithPredicate:(nonnull BOOL (^)(id<TLOriginator> _Nonnull originator))predicate withBlock:(nonnull void (^)(NSMutableArray<id<TLConversation>> * _Nonnull list))block {
     DDLogVerbose(@"%@ findConversationsWithPredicate", LOG_TAG);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
-        NSMutableArray<id<TLConversation>> *list = [[self getConversationService] listConversationsWithFilter:nil];
-        block(list);
-    });
+    [self findConversationsWithPredicate:predicate visibility:TLConversationVisibilityAll withBlock:block];
+}
+
+- (void)findConversationsWithPredicate:(nonnull BOOL (^)(id<TLOriginator> _Nonnull originator))predicate visibility:(TLConversationVisibility)visibility withBlock:(nonnull void (^)(NSMutableArray<id<TLConversation>> * _Nonnull list))block {
+    DDLogVerbose(@"%@ findConversationsWithPredicate visibility: %d", LOG_TAG, visibility);
+    
+    [self dispatchWithLabel:@"findConversationsWithPredicate" block:^{
+        NSMutableArray<id<TLConversation>> *conversations = [[self getConversationService] listConversationsWithFilter:nil];
+        TLSpace *currentSpace;
+        @synchronized(self) {
+            currentSpace = self.currentSpace;
+        }
+        
+        // The visibility is computed once per space from the space of each originator, without lock.
+        TLConversationVisibilityFilter *filter = [[TLConversationVisibilityFilter alloc] initWithCurrentSpace:currentSpace visibility:visibility];
+        block([filter filterWithConversations:conversations predicate:predicate]);
+    }];
 }
 
 - (void)setActiveConversationWithConversation:(nonnull id<TLConversation>)conversation {
@@ -2470,15 +2767,17 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
     
     NSMutableArray<TLNotification *> *notifications = [[self.twinlife getNotificationService] getPendingNotificationsWithSubject:conversation.subject];
-    
-    for (TLNotification *notif in notifications) {
-        TLNotification *notification = (TLNotification *)notif;
+    NSMutableArray<TLNotification *> *acknowledgeList = [[NSMutableArray alloc] initWithCapacity:notifications.count];
+    for (TLNotification *notification in notifications) {
+        TLNotificationType type = notification.notificationType;
         
-        if (!notification.acknowledged && (notification.notificationType == TLNotificationTypeNewTextMessage || notification.notificationType == TLNotificationTypeNewImageMessage || notification.notificationType == TLNotificationTypeNewAudioMessage || notification.notificationType == TLNotificationTypeNewVideoMessage || notification.notificationType == TLNotificationTypeNewFileMessage || notification.notificationType == TLNotificationTypeNewGroupInvitation || notification.notificationType == TLNotificationTypeNewGroupJoined || notification.notificationType == TLNotificationTypeNewGeolocation || notification.notificationType == TLNotificationTypeResetConversation || notification.notificationType == TLNotificationTypeUpdatedAnnotation)) {
-            
-            [self acknowledgeNotificationWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] notification:notification];
+        if (!notification.acknowledged && (unsigned int)type < 64 && (ACKNOWLEDGE_ON_ACTIVE_TYPES & NOTIFICATION_TYPE_BIT(type)) != 0) {
+            [acknowledgeList addObject:notification];
         }
     }
+    if (acknowledgeList.count > 0) {
+        [self acknowledgeNotificationsWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] notifications:acknowledgeList];
+    }
     
     [self.notificationCenter onSetActiveConversationWithConversationId:conversation.uuid];
 }
@@ -2495,98 +2794,117 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)findConversationDescriptorsWithFilter:(nonnull TLFilter *)filter callsMode:(TLDisplayCallsMode)callsMode withBlock:(nonnull void (^)(NSArray<TLConversationDescriptorPair*> * _Nonnull list))block {
     DDLogVerbose(@"%@ findConversationDescriptorsWithFilter: %@", LOG_TAG, filter);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"findConversationDescriptorsWithFilter" block:^{
         NSArray<TLConversationDescriptorPair *> *list = [[self getConversationService] getLastConversationDescriptorsWithFilter:filter callsMode:callsMode];
         block(list);
-    });
+    }];
+}
+
+- (void)findConversationDescriptorsWithSnapshot:(nonnull TLConversationDescriptorSnapshot *)snapshot withBlock:(nonnull void (^)(TLConversationDescriptorDelta * _Nonnull delta))block {
+    DDLogVerbose(@"%@ findConversationDescriptorsWithSnapshot: %@", LOG_TAG, snapshot);
+    
+    [self dispatchWithLabel:@"findConversationDescriptorsWithSnapshot" block:^{
+        // The version is read first: a conversation changed after it is reported again by the next call.
+        int64_t version = self.conversationChanges.version;
+        
+        // Nothing changed since the caller's version: no need to query the last descriptors.
+        if (snapshot.version == version) {
+            block([snapshot updateWithVersion:version]);
+            return;
+        }
+        
+        NSSet<NSUUID *> *dirtyConversations = [self.conversationChanges subjectIdsSinceVersion:snapshot.version];
+        NSArray<TLConversationDescriptorPair *> *list = [[self getConversationService] getLastConversationDescriptorsWithFilter:snapshot.filter callsMode:snapshot.callsMode];
+        block([snapshot updateWithList:list version:version dirtyConversations:dirtyConversations]);
+    }];
 }
 
 - (void)pushObjectWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation sendTo:(nullable NSUUID *)sendTo replyTo:(nullable TLDescriptorId *)replyTo message:(nonnull NSString *)message copyAllowed:(BOOL)copyAllowed expireTimeout:(int64_t)expireTimeout {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"pushObjectWithRequestId" block:^{
         [[self getConversationService] pushObjectWithRequestId:requestId conversation:conversation sendTo:sendTo replyTo:replyTo message:message copyAllowed:copyAllowed expireTimeout:expireTimeout];
-    });
+    }];
 }
 
 - (void)pushFileWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation sendTo:(nullable NSUUID *)sendTo replyTo:(nullable TLDescriptorId *)replyTo path:(nonnull NSString *)path type:(TLDescriptorType)type toBeDeleted:(BOOL)toBeDeleted copyAllowed:(BOOL)copyAllowed expireTimeout:(int64_t)expireTimeout {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"pushFileWithRequestId" block:^{
         [[self getConversationService] pushFileWithRequestId:requestId conversation:conversation sendTo:sendTo replyTo:replyTo path:path type:type toBeDeleted:toBeDeleted copyAllowed:copyAllowed expireTimeout:expireTimeout];
-    });
+    }];
 }
 
 - (void)pushTransientObjectWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation object:(nonnull NSObject *)object {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"pushTransientObjectWithRequestId" block:^{
         [[self getConversationService] pushTransientObjectWithRequestId:requestId conversation:conversation object:object];
-    });
+    }];
 }
 
 - (void)pushGeolocationWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation sendTo:(nullable NSUUID *)sendTo replyTo:(nullable TLDescriptorId *)replyTo longitude:(double)longitude latitude:(double)latitude altitude:(double)altitude mapLongitudeDelta:(double)mapLongitudeDelta mapLatitudeDelta:(double)mapLatitudeDelta localMapPath:(nullable NSString *)localMapPath expireTimeout:(int64_t)expireTimeout {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"pushGeolocationWithRequestId" block:^{
         [[self getConversationService] pushGeolocationWithRequestId:requestId conversation:conversation sendTo:sendTo replyTo:replyTo longitude:longitude latitude:latitude altitude:altitude mapLongitudeDelta:mapLongitudeDelta mapLatitudeDelta:mapLatitudeDelta localMapPath:localMapPath expireTimeout:expireTimeout];
-    });
+    }];
 }
 
 - (void)saveGeolocationMapWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation descriptorId:(nonnull TLDescriptorId *)descriptorId path:(nonnull NSString *)path {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"saveGeolocationMapWithRequestId" block:^{
         [[self getConversationService] saveGeolocationMapWithRequestId:requestId conversation:conversation descriptorId:descriptorId path:path];
-    });
+    }];
 }
 
 - (void)forwardDescriptorWithRequestId:(int64_t)requestId conversation:(nonnull id<TLConversation>)conversation sendTo:(nullable NSUUID *)sendTo descriptorId:(nonnull TLDescriptorId *)descriptorId copyAllowed:(BOOL)copyAllowed expireTimeout:(int64_t)expireTimeout {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"forwardDescriptorWithRequestId" block:^{
         [[self getConversationService] forwardDescriptorWithRequestId:requestId conversation:conversation sendTo:sendTo descriptorId:descriptorId copyAllowed:copyAllowed expireTimeout:expireTimeout];
-    });
+    }];
 }
 
 - (void)deleteDescriptorWithRequestId:(int64_t)requestId descriptorId:(nonnull TLDescriptorId *)descriptorId {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"deleteDescriptorWithRequestId" block:^{
         [[self getConversationService] deleteDescriptorWithRequestId:requestId descriptorId:descriptorId];
-    });
+    }];
 }
 
 - (void)markDescriptorReadWithRequestId:(int64_t)requestId descriptorId:(nonnull TLDescriptorId *)descriptorId {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"markDescriptorReadWithRequestId" block:^{
         [[self getConversationService] markDescriptorReadWithRequestId:requestId descriptorId:descriptorId];
-    });
+    }];
 }
 
 - (void)markDescriptorDeletedWithRequestId:(int64_t)requestId descriptorId:(nonnull TLDescriptorId *)descriptorId {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"markDescriptorDeletedWithRequestId" block:^{
         [[self getConversationService] markDescriptorDeletedWithRequestId:requestId descriptorId:descriptorId];
-    });
+    }];
 }
 
 - (void)toggleAnnotationWithDescriptorId:(nonnull TLDescriptorId *)descriptorId type:(TLDescriptorAnnotationType)type value:(int)value {
     DDLogVerbose(@"%@ toggleAnnotationWithDescriptorId: %@ type: %u value: %d", LOG_TAG, descriptorId, type, value);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"toggleAnnotationWithDescriptorId" block:^{
         [[self getConversationService] toggleAnnotationWithDescriptorId:descriptorId type:type value:value];
-    });
+    }];
 }
 
 - (void)listAnnotationsWithDescriptorId:(nonnull TLDescriptorId *)descriptorId withBlock:(nonnull void (^)(NSMutableDictionary<NSUUID *, TLDescriptorAnnotationPair*> * _Nonnull list))block {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"listAnnotationsWithDescriptorId" block:^{
         NSMutableDictionary<NSUUID *, TLDescriptorAnnotationPair*> *annotations = [[self getConversationService] listAnnotationsWithDescriptorId:descriptorId];
         block(annotations);
-    });
+    }];
 }
 
 - (void)getDescriptorWithDescriptorId:(nonnull TLDescriptorId *)descriptorId withBlock:(nonnull void (^)(TLDescriptor * _Nullable descriptor))block {
     DDLogVerbose(@"%@ getDescriptorWithDescriptorId: %@", LOG_TAG, descriptorId.toString);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"getDescriptorWithDescriptorId" block:^{
         TLDescriptor *descriptor = [[self getConversationService] getDescriptorWithDescriptorId:descriptorId];
         block(descriptor);
-    });
+    }];
 }
 
 
@@ -2722,7 +3040,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 
 - (void)getNotificationWithNotificationId:(nonnull NSUUID *)notificationId withBlock:(nonnull void (^)(TLBaseServiceErrorCode status, TLNotification *notification))block {
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"getNotificationWithNotificationId" block:^{
         TLNotificationService *notificationService = [self getNotificationService];
         TLNotification *notification = [notificationService getNotificationWithNotificationId:notificationId];
         if (notification) {
@@ -2730,17 +3048,17 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         } else {
             block(TLBaseServiceErrorCodeItemNotFound, nil);
         }
-    });
+    }];
 }
 
 - (void)findNotificationsWithFilter:(nonnull TLFilter *)filter maxDescriptors:(int)maxDescriptors withBlock:(nonnull void (^)(NSMutableArray<TLNotification*> * _Nonnull list))block {
     DDLogVerbose(@"%@ findNotificationsWithFilter: %@ maxDescriptor: %d", LOG_TAG, filter, maxDescriptors);
     
-    dispatch_async(self.twinlife.twinlifeQueue, ^{
+    [self dispatchWithLabel:@"findNotificationsWithFilter" block:^{
         TLNotificationService *notificationService = [self getNotificationService];
         NSMutableArray<TLNotification*> *notifications = [notificationService listNotificationsWithFilter:filter maxDescriptors:maxDescriptors];
         block(notifications);
-    });
+    }];
 }
 
 - (nullable TLNotification *)createNotificationWithType:(TLNotificationType)type notificationId:(nullable NSUUID *)notificationId subject:(nonnull id<TLRepositoryObject>)subject descriptorId:(nullable TLDescriptorId *)descriptorId annotatingUser:(nullable TLTwincodeOutbound *)annotatingUser {
@@ -2756,9 +3074,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         for (id delegate in self.delegates) {
             if ([delegate respondsToSelector:@selector(onAddNotificationWithNotification:)]) {
                 id<TLTwinmeContextDelegate> lDelegate = delegate;
-                dispatch_async([self.twinlife twinlifeQueue], ^{
+                [self dispatchWithLabel:@"onAddNotificationWithNotification" block:^{
                     [lDelegate onAddNotificationWithNotification:notification];
-                });
+                }];
             }
         }
         
@@ -2770,17 +3088,29 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)acknowledgeNotificationWithRequestId:(int64_t)requestId notification:(TLNotification *)notification {
     DDLogVerbose(@"%@ acknowledgeNotificationsWithRequestId: %lld notification: %@", LOG_TAG, requestId, notification);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"acknowledgeNotificationWithRequestId" block:^{
         TLNotificationService *notificationService = [self getNotificationService];
         [notificationService acknowledgeWithNotification:notification];
         [self scheduleRefreshNotifications];
-    });
+    }];
+}
+
+- (void)acknowledgeNotificationsWithRequestId:(int64_t)requestId notifications:(nonnull NSArray<TLNotification *> *)notifications {
+    DDLogVerbose(@"%@ acknowledgeNotificationsWithRequestId: %lld notifications: %lu", LOG_TAG, requestId, (unsigned long)notifications.count);
+    
+    [self dispatchWithLabel:@"acknowledgeNotificationsWithRequestId" block:^{
+        TLNotificationService *notificationService = [self getNotificationService];
+        for (TLNotification *notification in notifications) {
+            [notificationService acknowledgeWithNotification:notification];
+        }
+        [self scheduleRefreshNotifications];
+    }];
 }
 
 - (void)deleteWithNotification:(nonnull TLNotification *)notification {
     DDLogVerbose(@"%@ deleteWithNotification: %@", LOG_TAG, notification);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"deleteWithNotification" block:^{
         TLNotificationService *notificationService = [self getNotificationService];
         [notificationService deleteWithNotification:notification];
         
@@ -2788,20 +3118,20 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         for (id delegate in self.delegates) {
             if ([delegate respondsToSelector:@selector(onDeleteNotificationsWithList:)]) {
                 id<TLTwinmeContextDelegate> lDelegate = delegate;
-                dispatch_async([self.twinlife twinlifeQueue], ^{
+                [self dispatchWithLabel:@"onDeleteNotificationsWithList" block:^{
                     [lDelegate onDeleteNotificationsWithList:list];
-                });
+                }];
             }
         }
         
         [self scheduleRefreshNotifications];
-    });
+    }];
 }
 
 - (void)getSpaceNotificationStatsWithBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLNotificationServiceNotificationStat *stats))block {
     DDLogVerbose(@"%@ getSpaceNotificationStatsWithBlock", LOG_TAG);
 
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"getSpaceNotificationStatsWithBlock" block:^{
         NSMutableDictionary<NSUUID *, TLNotificationServiceNotificationStat *> *stats = [[self.twinlife getNotificationService] getNotificationStats];
         long pendingCount = 0;
         long acknowledgedCount = 0;
@@ -2817,16 +3147,16 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         block(TLBaseServiceErrorCodeSuccess, [[TLNotificationServiceNotificationStat alloc] initWithPendingCount:pendingCount acknowledgedCount:acknowledgedCount]);
         
         [self refreshNotificationsWithStats:stats];
-    });
+    }];
 }
 
 - (void)getNotificationStatsWithBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, NSDictionary<NSUUID *, TLNotificationServiceNotificationStat *>* _Nonnull stats))block {
     DDLogVerbose(@"%@ getNotificationStatsWithBlock", LOG_TAG);
     
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"getNotificationStatsWithBlock" block:^{
         NSMutableDictionary<NSUUID *, TLNotificationServiceNotificationStat *>* stats = [[self.twinlife getNotificationService] getNotificationStats];
         block(TLBaseServiceErrorCodeSuccess, stats);
-    });
+    }];
 }
 
 - (void)scheduleRefreshNotifications {
@@ -2862,10 +3192,11 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     long spacePendingCount = 0;
     long acknowledgedCount = 0;
     BOOL modified;
+    TLSpaceSnapshot *spaces = self.spaces;
     @synchronized (self) {
         for (NSUUID *spaceId in stats) {
             TLNotificationServiceNotificationStat *stat = stats[spaceId];
-            TLSpace *space = self.spaces[spaceId];
+            TLSpace *space = [spaces spaceWithSpaceId:spaceId];
             
             if (stat && space) {
                 if (space == self.currentSpace || ![space.settings isSecret]) {
@@ -2889,9 +3220,9 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         for (id delegate in self.delegates) {
             if ([delegate respondsToSelector:@selector(onUpdatePendingNotificationsWithRequestId:hasPendingNotifications:)]) {
                 id<TLTwinmeContextDelegate> lDelegate = delegate;
-                dispatch_async([self.twinlife twinlifeQueue], ^{
+                [self dispatchWithLabel:@"onUpdatePendingNotificationsWithRequestId" block:^{
                     [lDelegate onUpdatePendingNotificationsWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] hasPendingNotifications:hasPendingNotifications];
-                });
+                }];
             }
         }
         
@@ -2976,25 +3307,279 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     }
 }
 
+#pragma mark - Schedule transitions
+
+- (nullable TLSchedule *)scheduleWithOriginator:(nonnull id<TLOriginator>)originator {
+    
+    // The call receiver schedule defines when we accept calls, for others it is the peer's schedule.
+    if ([(NSObject *)originator isKindOfClass:[TLCallReceiver class]]) {
+        return originator.identityCapabilities.schedule;
+    } else {
+        return originator.capabilities.schedule;
+    }
+}
+
+/// The originator is active when it has no schedule, when its schedule is disabled or when we are in the schedule.
+- (BOOL)isActiveWithSchedule:(nullable TLSchedule *)schedule {
+    
+    return !schedule || !schedule.enabled || [schedule isNowInRange];
+}
+
+- (void)watchScheduleWithOriginator:(nonnull id<TLOriginator>)originator {
+    DDLogVerbose(@"%@ watchScheduleWithOriginator: %@", LOG_TAG, originator);
+    
+    [self watchScheduleWithOriginators:@[originator]];
+}
+
+- (void)watchScheduleWithOriginators:(nonnull NSArray<id<TLOriginator>> *)originators {
+    DDLogVerbose(@"%@ watchScheduleWithOriginators: %lu", LOG_TAG, (unsigned long)originators.count);
+    
+    @synchronized (self) {
+        for (id<TLOriginator> originator in originators) {
+            TLSchedule *schedule = [self scheduleWithOriginator:originator];
+            if (!schedule || !schedule.enabled) {
+                [self.scheduledOriginators removeObjectForKey:originator.uuid];
+                [self.scheduleStates removeObjectForKey:originator.uuid];
+            } else {
+                self.scheduledOriginators[originator.uuid] = originator;
+                self.scheduleStates[originator.uuid] = [NSNumber numberWithBool:[self isActiveWithSchedule:schedule]];
+            }
+        }
+        [self armScheduleTransition];
+    }
+}
+
+- (void)unwatchScheduleWithOriginatorId:(nonnull NSUUID *)originatorId {
+    DDLogVerbose(@"%@ unwatchScheduleWithOriginatorId: %@", LOG_TAG, originatorId);
+    
+    @synchronized (self) {
+        if (self.scheduledOriginators[originatorId]) {
+            [self.scheduledOriginators removeObjectForKey:originatorId];
+            [self.scheduleStates removeObjectForKey:originatorId];
+            [self armScheduleTransition];
+        }
+    }
+}
+
+/// Arm the job for the earliest transition of the watched schedules (must be called with the lock held).
+- (void)armScheduleTransition {
+    DDLogVerbose(@"%@ armScheduleTransition", LOG_TAG);
+    
+    long now = (long)[[NSDate date] timeIntervalSince1970];
+    long deadline = TIME_RANGE_NO_TRANSITION;
+    for (id<TLOriginator> originator in self.scheduledOriginators.allValues) {
+        TLSchedule *schedule = [self scheduleWithOriginator:originator];
+        if (schedule) {
+            deadline = MIN(deadline, [schedule nextTransitionAfter:now]);
+        }
+    }
+    
+    if (deadline == self.scheduleDeadline && self.scheduleJob) {
+        return;
+    }
+    if (self.scheduleJob) {
+        [self.scheduleJob cancel];
+        self.scheduleJob = nil;
+    }
+    self.scheduleDeadline = deadline;
+    if (deadline != TIME_RANGE_NO_TRANSITION) {
+        self.scheduleJob = [[self.twinlife getJobService] scheduleWithJob:self.scheduleTransition deadline:[NSDate dateWithTimeIntervalSince1970:deadline] priority:TLJobPriorityMessage];
+    }
+}
+
+- (void)runJobScheduleTransition {
+    DDLogVerbose(@"%@ runJobScheduleTransition", LOG_TAG);
+    
+    NSMutableArray<id<TLOriginator>> *changedList = nil;
+    NSMutableArray<NSNumber *> *stateList = nil;
+    @synchronized (self) {
+        self.scheduleJob = nil;
+        for (NSUUID *originatorId in self.scheduledOriginators.allKeys) {
+            id<TLOriginator> originator = self.scheduledOriginators[originatorId];
+            TLSchedule *schedule = [self scheduleWithOriginator:originator];
+            NSNumber *active = [NSNumber numberWithBool:[self isActiveWithSchedule:schedule]];
+            if (![active isEqual:self.scheduleStates[originatorId]]) {
+                self.scheduleStates[originatorId] = active;
+                if (!changedList) {
+                    changedList = [[NSMutableArray alloc] init];
+                    stateList = [[NSMutableArray alloc] init];
+                }
+                [changedList addObject:originator];
+                [stateList addObject:active];
+            }
+        }
+        [self armScheduleTransition];
+    }
+    
+    for (NSUInteger i = 0; i < changedList.count; i++) {
+        id<TLOriginator> originator = changedList[i];
+        BOOL active = stateList[i].boolValue;
+        for (id delegate in self.delegates) {
+            if ([delegate respondsToSelector:@selector(onScheduleTransitionWithOriginator:active:)]) {
+                id<TLTwinmeContextDelegate> lDelegate = delegate;
+                [self dispatchWithLabel:@"onScheduleTransitionWithOriginator" block:^{
+                    [lDelegate onScheduleTransitionWithOriginator:originator active:active];
+                }];
+            }
+        }
+    }
+}
+
+#pragma mark - Queue profiler
+
+- (void)startQueueProfilerWithReportInterval:(NSTimeInterval)reportInterval {
+    DDLogVerbose(@"%@ startQueueProfilerWithReportInterval: %f", LOG_TAG, reportInterval);
+    
+    TLQueueProfiler *queueProfiler = [[TLQueueProfiler alloc] initWithQueue:[self.twinlife twinlifeQueue] reportInterval:reportInterval sampleInterval:QUEUE_PROFILER_SAMPLE_INTERVAL topCount:QUEUE_PROFILER_TOP_COUNT];
+
+    // The profiler was started on purpose: its report is logged whatever the log level of the context.
+    queueProfiler.onReport = ^(TLQueueProfileReport *report) {
+        DDLogWarn(@"%@ twinlife queue: %lld blocks occupancy %.1f%% depth %@", LOG_TAG, report.blockCount, report.occupancy, [report.depthSamples componentsJoinedByString:@" "]);
+        for (TLQueueProfileEntry *entry in report.topEntries) {
+            DDLogWarn(@"%@ %@", LOG_TAG, entry);
+        }
+    };
+    @synchronized (self) {
+        [self.queueProfiler stop];
+        self.queueProfiler = queueProfiler;
+    }
+    [queueProfiler start];
+}
+
+- (void)stopQueueProfiler {
+    DDLogVerbose(@"%@ stopQueueProfiler", LOG_TAG);
+    
+    @synchronized (self) {
+        [self.queueProfiler stop];
+        self.queueProfiler = nil;
+    }
+}
+
+- (void)dispatchWithLabel:(nonnull NSString *)label block:(nonnull dispatch_block_t)block {
+    
+    TLQueueProfiler *queueProfiler = self.queueProfiler;
+    if (queueProfiler) {
+        [queueProfiler dispatchWithLabel:label block:block];
+    } else {
+        dispatch_async([self.twinlife twinlifeQueue], block);
+    }
+}
+
+#pragma mark - Executor admission
+
+- (void)admitWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+    DDLogVerbose(@"%@ admitWithExecutor: %@", LOG_TAG, executor);
+
+    if (![self.executorAdmission submitWithExecutor:executor priority:TLExecutorPriorityNormal start:start cancel:cancel]) {
+        DDLogInfo(@"%@ executor %@ waits for admission", LOG_TAG, executor);
+    }
+}
+
+- (void)releaseWithExecutor:(nonnull id)executor {
+    DDLogVerbose(@"%@ releaseWithExecutor: %@", LOG_TAG, executor);
+
+    // Start the next executor from the twinlife queue: the executor being stopped is still running its stop().
+    dispatch_block_t start = [self.executorAdmission releaseWithExecutor:executor];
+    if (start) {
+        [self dispatchWithLabel:@"TLExecutorAdmission" block:start];
+    }
+}
+
+- (NSUInteger)cancelQueuedExecutorsWithClass:(nonnull Class)clazz {
+    DDLogVerbose(@"%@ cancelQueuedExecutorsWithClass: %@", LOG_TAG, clazz);
+
+    NSArray<dispatch_block_t> *cancelList = [self.executorAdmission cancelWithClass:clazz];
+    for (dispatch_block_t cancel in cancelList) {
+        cancel();
+    }
+    return cancelList.count;
+}
+
+#pragma mark - Cache management
+
+- (nonnull NSDictionary<NSString *, NSNumber *> *)cacheFootprintReport {
+    DDLogVerbose(@"%@ cacheFootprintReport", LOG_TAG);
+    
+    NSMutableDictionary<NSString *, NSNumber *> *result = [[NSMutableDictionary alloc] init];
+    for (TLCacheFootprint *footprint in [self.cacheManager footprintReport]) {
+        result[footprint.name] = [NSNumber numberWithUnsignedInteger:footprint.bytes];
+    }
+    return result;
+}
+
+- (void)registerCaches {
+    DDLogVerbose(@"%@ registerCaches", LOG_TAG);
+    
+    // The weak reference avoids the retain cycle between the context, its cache manager and the blocks.
+    __weak TLTwinmeContext *weakSelf = self;
+    [self.cacheManager registerCacheWithName:@"groupMembers" priority:TLCachePriorityLow entryCost:CACHE_GROUP_MEMBER_COST count:^NSUInteger{
+        NSMutableDictionary<NSUUID *, TLGroupMember *> *groupMembers = weakSelf.groupMembers;
+        @synchronized (groupMembers) {
+            return groupMembers.count;
+        }
+    } clear:^{
+        NSMutableDictionary<NSUUID *, TLGroupMember *> *groupMembers = weakSelf.groupMembers;
+        @synchronized (groupMembers) {
+            [groupMembers removeAllObjects];
+        }
+    }];
+    [self.cacheManager registerCacheWithName:@"spaceOriginators" priority:TLCachePriorityNormal entryCost:CACHE_SPACE_ORIGINATOR_COST count:^NSUInteger{
+        return weakSelf.spaceOriginators.count;
+    } clear:^{
+        [weakSelf.spaceOriginators removeAll];
+    }];
+    [self.cacheManager registerCacheWithName:@"invitationCodes" priority:TLCachePriorityLow entryCost:CACHE_INVITATION_CODE_COST count:^NSUInteger{
+        return weakSelf.invitationCodeCache.count;
+    } clear:^{
+        [weakSelf.invitationCodeCache removeAll];
+    }];
+    
+    // The spaces are loaded once by getSpaces and they are needed by almost every operation.
+    [self.cacheManager registerCacheWithName:@"spaces" priority:TLCachePriorityHigh entryCost:CACHE_SPACE_COST count:^NSUInteger{
+        return weakSelf.spaces.list.count;
+    } clear:^{
+        TLTwinmeContext *strongSelf = weakSelf;
+        @synchronized (strongSelf) {
+            strongSelf.spaces = [[TLSpaceSnapshot alloc] init];
+            strongSelf.currentSpace = nil;
+            strongSelf.currentProfile = nil;
+            strongSelf.getSpacesDone = NO;
+        }
+    }];
+}
+
+- (void)onMemoryPressureWithStatus:(unsigned long)status {
+    DDLogVerbose(@"%@ onMemoryPressureWithStatus: %lu", LOG_TAG, status);
+    
+    if (status & DISPATCH_MEMORYPRESSURE_CRITICAL) {
+        [self.cacheManager trimWithLevel:TLCacheTrimLevelCritical];
+    } else if (status & DISPATCH_MEMORYPRESSURE_WARN) {
+        [self.cacheManager trimWithLevel:TLCacheTrimLevelWarning];
+    }
+}
+
 #pragma mark - Report methods
 
 - (void)reportStatsWithRequestId:(int64_t)requestId {
     DDLogVerbose(@"%@ reportStatsWithRequestId: %lld", LOG_TAG, requestId);
     
     TLReportStatsExecutor *reportStatsExecutor = [[TLReportStatsExecutor alloc] initWithTwinmeContext:self requestId:requestId];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    [self dispatchWithLabel:@"TLReportStatsExecutor" block:^{
         [reportStatsExecutor start];
-    });
+    }];
 }
 
 - (void)onReportStatsWithRequestId:(int64_t)requestId delay:(NSTimeInterval)delay {
     DDLogVerbose(@"%@ onReportStatsWithRequestId: %lld", LOG_TAG, requestId);
     
     NSNumber *lRequestId = [NSNumber numberWithLongLong:requestId];
+    NSNumber *operationId;
+    @synchronized (self.requestIds) {
+        operationId = self.requestIds[lRequestId];
+        [self.requestIds removeObjectForKey:lRequestId];
+    }
     @synchronized (self) {
-        NSNumber *operationId = self.requestIds[lRequestId];
         if (operationId != nil) {
-            [self.requestIds removeObjectForKey:lRequestId];
             if (requestId == self.reportRequestId) {
                 self.reportRequestId = [TLBaseService DEFAULT_REQUEST_ID];
             }
@@ -3034,6 +3619,17 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     [[self getTwincodeOutboundService] addDelegate:self.twincodeOutboundServiceDelegate];
     [[self getNotificationService] addDelegate:self.notificationServiceDelegate];
     
+    self.invocationReplay = [[TLInvocationReplayScheduler alloc] initWithQueue:[self.twinlife twinlifeQueue] window:INVOCATION_REPLAY_WINDOW sliceSize:INVOCATION_REPLAY_SLICE];
+
+    if (!self.memoryPressureSource) {
+        self.memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, [self.twinlife twinlifeQueue]);
+        dispatch_source_t memoryPressureSource = self.memoryPressureSource;
+        dispatch_source_set_event_handler(memoryPressureSource, ^{
+            [self onMemoryPressureWithStatus:dispatch_source_get_data(memoryPressureSource)];
+        });
+        dispatch_resume(memoryPressureSource);
+    }
+
     TLTwincodeInvocationListener invocationListener = ^TLBaseServiceErrorCode(TLTwincodeInvocation *invocation) {
         return [self onInvokeTwincodeWithInvocation:invocation];
     };
@@ -3069,6 +3665,10 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         }];
     }
     
+    // Watch the schedule of every call receiver, not only those created or updated since the start.
+    [self findCallReceiversWithFilter:[[TLFilter alloc] init] withBlock:^(NSMutableArray<TLCallReceiver *> *list) {
+    }];
+    
     // Trigger the onTwinlifeReady on registered services at the end after knowing if we have spaces and profiles.
     [super onTwinlifeReady];
 }
@@ -3107,8 +3707,12 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         self.currentProfile = nil;
         self.hasProfiles = false;
         self.hasSpaces = false;
-        [self.spaces removeAllObjects];
-        [self.groupMembers removeAllObjects];
+        self.spaces = [[TLSpaceSnapshot alloc] init];
+        @synchronized (self.groupMembers) {
+            [self.groupMembers removeAllObjects];
+        }
+        [self.spaceOriginators removeAll];
+        [self.conversationChanges reset];
         self.getSpacesDone = false;
         
         // Cancel any job report.
@@ -3120,8 +3724,34 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
             [self.notificationRefreshJob cancel];
             self.notificationRefreshJob = nil;
         }
+        [self.scheduledOriginators removeAllObjects];
+        [self.scheduleStates removeAllObjects];
+        if (self.scheduleJob) {
+            [self.scheduleJob cancel];
+            self.scheduleJob = nil;
+        }
+        self.scheduleDeadline = TIME_RANGE_NO_TRANSITION;
+
+        // Drop the pair::refresh invocations waiting for their batch.
+        [self.refreshBatcher reset];
+        self.refreshBatcher = nil;
     }
+
+    // The invitation codes were resolved for the old account.
+    [self.invitationCodeCache removeAll];
     
+    // The invocations not yet processed belong to the old account.
+    [self.invocationReplay reset];
+
+    // The executors waiting for admission must not start on the new account.
+    for (Class clazz in [self.executorAdmission limitedClasses]) {
+        [self cancelQueuedExecutorsWithClass:clazz];
+    }
+
+    // The callers waiting for a group member of the old account must not wait for an executor that may never finish.
+    [self.groupMemberLookups completeAllWithErrorCode:TLBaseServiceErrorCodeCanceledOperation];
+    [self.groupMemberReceiverLookups completeAllWithErrorCode:TLBaseServiceErrorCodeCanceledOperation];
+
     // Clear the notification badge.
     [self.notificationCenter updateApplicationBadgeNumber:0];
 }
@@ -3133,28 +3763,37 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     // For the NotificationServiceExtension, we only load one object at a time
     // except for the spaces.  The application can keep the profile and spaces since they
     // are never modified by the extension.  For both, we must cleanup the contacts and groups.
+    // When the caches are enabled, the application keeps them within the budget so that the resume is fast.
+    [self.cacheManager trimWithLevel:self.enableCaches ? TLCacheTrimLevelSuspend : TLCacheTrimLevelAll];
     @synchronized (self) {
-        if (!self.enableCaches) {
-            [self.spaces removeAllObjects];
-            self.currentSpace = nil;
-            self.currentProfile = nil;
-            self.getSpacesDone = NO;
-            [self.groupMembers removeAllObjects];
-        }
-        
         // Make sure we reload the groups, contacts, conversations at the next resume.
         self.visibleNotificationStats = nil;
+        [self.spaceOriginators removeAll];
+    }
+    
+    if (ENABLE_REPORT_LOCATION) {
+        [TLLocationReport flush];
     }
 }
 
 #pragma mark - Private methods
 
+// The conversations are marked by their subject: the events of a group are reported on the
+// group member conversations which share the contact or group subject of the conversation list.
+- (void)markConversationWithSubjectId:(nullable NSUUID *)subjectId {
+    DDLogVerbose(@"%@ markConversationWithSubjectId: %@", LOG_TAG, subjectId);
+    
+    // A conversation removed or moved has no subject: the version change is enough for the next
+    // snapshot to query the list and compute the removed conversations.
+    [self.conversationChanges markWithSubjectId:subjectId];
+}
+
 - (TLSpace *)putSpace:(TLSpace *)space {
     DDLogVerbose(@"%@ putSpace: %@", LOG_TAG, space);
     
     TLSpace *setCurrent = nil;
     @synchronized(self) {
-        self.spaces[space.uuid] = space;
+        self.spaces = [self.spaces snapshotWithSpace:space];
         
         // Check the default space validity.
         if (!self.defaultSpaceId) {
@@ -3180,14 +3819,15 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     
     TLSpace *setCurrent;
     @synchronized(self) {
-        [self.spaces removeObjectForKey:spaceId];
+        self.spaces = [self.spaces snapshotWithoutSpaceId:spaceId];
+        [self.spaceOriginators removeWithSpaceId:spaceId];
         
         // If the current space was deleted, invalidate and switch to the default space if there is one.
         if (self.currentSpace && [self.currentSpace.uuid isEqual:spaceId]) {
             self.currentSpace = nil;
             self.currentProfile = nil;
             if (self.defaultSpaceId) {
-                setCurrent = self.spaces[self.defaultSpaceId];
+                setCurrent = [self.spaces spaceWithSpaceId:self.defaultSpaceId];
             }
         }
     }
@@ -3204,20 +3844,40 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     [[self getTwincodeOutboundService] evictTwincode:memberId];
     
     // And make sure the group member cache is also cleared (in case we are re-invited in the same group).
-    @synchronized (self) {
+    @synchronized (self.groupMembers) {
         [self.groupMembers removeObjectForKey:memberId];
     }
+    [self markConversationWithSubjectId:group.subject.objectId];
 }
 
 - (void)onRevokedWithConversation:(id<TLConversation>)conversation {
     DDLogVerbose(@"%@ onRevokedWithConversation: %@", LOG_TAG, conversation);
     
     id<TLRepositoryObject> subject = conversation.subject;
+    [self markConversationWithSubjectId:subject.objectId];
     if ([subject isKindOfClass:[TLContact class]]) {
         [self unbindContactWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] invocationId:nil contact:(TLContact *)subject];
     }
 }
 
+- (void)onResetConversationWithConversation:(id<TLConversation>)conversation {
+    DDLogVerbose(@"%@ onResetConversationWithConversation: %@", LOG_TAG, conversation);
+    
+    [self markConversationWithSubjectId:conversation.subject.objectId];
+}
+
+- (void)onDeleteDescriptorsWithConversation:(id<TLConversation>)conversation descriptors:(NSArray<TLDescriptorId *> *)descriptors {
+    DDLogVerbose(@"%@ onDeleteDescriptorsWithConversation: %@ descriptors: %@", LOG_TAG, conversation, descriptors);
+    
+    [self markConversationWithSubjectId:conversation.subject.objectId];
+}
+
+- (void)onMarkDescriptorDeletedWithConversation:(id<TLConversation>)conversation descriptor:(TLDescriptor *)descriptor {
+    DDLogVerbose(@"%@ onMarkDescriptorDeletedWithConversation: %@ descriptor: %@", LOG_TAG, conversation, descriptor);
+    
+    [self markConversationWithSubjectId:conversation.subject.objectId];
+}
+
 - (void)onSignatureInfoWithConversation:(nonnull id<TLConversation>)conversation signedTwincode:(nonnull TLTwincodeOutbound *)signedTwincode {
     DDLogVerbose(@"%@ onSignatureInfoWithConversation: %@ signedTwincode: %@", LOG_TAG, conversation, signedTwincode);
     
@@ -3241,108 +3901,32 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ onProcessInvocation: %@", LOG_TAG, invocation);
 
     id<TLRepositoryObject> receiver = invocation.receiver;
-    if (invocation.background) {
-        if ([receiver class] == [TLProfile class]) {
-            if ([invocation class] == [TLPairInviteInvocation class]) {
-                [self createContactPhase2WithInvocation:(TLPairInviteInvocation *)invocation profile:(TLProfile *)receiver];
-            } else {
-                [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
-                
-                [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
-            }
-        } else if ([receiver class] == [TLInvitation class]) {
-            if ([invocation class] == [TLPairInviteInvocation class]) {
-                [self createContactPhase2WithInvocation:(TLPairInviteInvocation *)invocation invitation:(TLInvitation *)receiver];
-            } else {
-                [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
-
-                [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
-            }
-        } else if ([receiver class] == [TLContact class]) {
-            TLContact *contact = (TLContact *)receiver;
-            if ([invocation class] == [TLPairBindInvocation class]) {
-                [self bindContactWithInvocation:(TLPairBindInvocation *)invocation contact:contact];
-            } else if ([invocation class] == [TLPairUnbindInvocation class]) {
-                TLPairUnbindInvocation *pairUnbindInvocation = (TLPairUnbindInvocation *)invocation;
-                [self unbindContactWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] invocationId:pairUnbindInvocation.uuid contact:contact];
-            } else if ([invocation class] == [TLPairRefreshInvocation class]) {
-                [self refreshObjectWithInvocation:(TLPairRefreshInvocation *)invocation subject:contact];
-            } else {
-                [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
-                
-                [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
-            }
-        } else if ([receiver class] == [TLGroup class]) {
-            TLGroup *group = (TLGroup *)receiver;
-            if ([invocation class] == [TLGroupRegisteredInvocation class]) {
-                TLGroupRegisteredInvocation *groupRegisteredInvocation = (TLGroupRegisteredInvocation *)invocation;
-                TLGroupRegisteredExecutor *groupRegisteredExecutor = [[TLGroupRegisteredExecutor alloc] initWithTwinmeContext:self requestId:[TLBaseService DEFAULT_REQUEST_ID] groupRegisteredInvocation:groupRegisteredInvocation group:group];
-                dispatch_async([self.twinlife twinlifeQueue], ^{
-                    [groupRegisteredExecutor start];
-                });
-            } else if ([invocation class] == [TLPairRefreshInvocation class]) {
-                [self refreshObjectWithInvocation:(TLPairRefreshInvocation *)invocation subject:group];
-
-            } else {
-                [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
-                
-                [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
-            }
-        } else if ([receiver class] == [TLAccountMigration class]) {
-            TLAccountMigration *accountMigration = (TLAccountMigration *)receiver;
-            
-            if ([invocation class] == [TLPairInviteInvocation class]) {
-                TLPairInviteInvocation *pairBindInvocation = (TLPairInviteInvocation *)invocation;
-                [self bindAccountMigrationWithRequestId:TLBaseService.DEFAULT_REQUEST_ID invocationId:pairBindInvocation.uuid accountMigration:accountMigration peerTwincodeOutboundId:pairBindInvocation.twincodeOutbound.uuid];
-            } else if ([invocation class] == [TLPairUnbindInvocation class]) {
-                [self deleteAccountMigrationWithAccountMigration:accountMigration withBlock:^(TLBaseServiceErrorCode errorCode, NSUUID * _Nullable uuid) {
-                    [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeSuccess];
-                }];
-            } else {
-                [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
-
-                [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
-            }
-        } else {
-            [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
-
-            [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
-        }
+    TLInvocationHandler *handler = [[TLTwinmeContext invocationDispatcher] handlerWithInvocation:invocation receiver:receiver];
+    if (handler) {
+        [handler invokeWithTwinmeContext:self invocation:invocation receiver:receiver];
     } else {
-        if ([receiver class] == [TLProfile class]) {
-            
-            [self onUpdateProfileWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] profile:(TLProfile *)receiver];
-        } else if ([receiver class] == [TLContact class]) {
-            
-            [self onUpdateContactWithRequestId:[TLBaseService DEFAULT_REQUEST_ID] contact:(TLContact *)receiver];
-        } else {
-            [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
-            
-            [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
-        }
+        [self assertionWithAssertPoint:[TLTwinmeAssertPoint PROCESS_INVOCATION], [TLAssertValue initWithSubject:receiver], [TLAssertValue initWithInvocationId:invocation.uuid], nil];
+
+        [self acknowledgeInvocationWithInvocationId:invocation.uuid errorCode:TLBaseServiceErrorCodeBadRequest];
     }
 }
 
 - (void)onIncomingPeerConnectionWithPeerConnectionId:(NSUUID *)peerConnectionId peerId:(NSString *)peerId offer:(nonnull TLOffer *)offer {
     DDLogVerbose(@"%@ onIncomingPeerConnectionWithPeerConnectionId: %@ peerId: %@ offer: %@", LOG_TAG, peerConnectionId, peerId, offer);
     
-    NSArray<NSString *> *items = [peerId componentsSeparatedByString:@"@"];
-    if (items.count != 2 || ![items[1] hasPrefix:@"inbound.twincode.twinlife"]) {
+    TLPeerIdInfo info;
+    TLPeerIdStatus status = [TLPeerIdParser parseWithPeerId:peerId info:&info];
+    if (status == TLPeerIdStatusInvalid) {
         
         return;
     }
     
-    NSUUID *twincodeInboundId = [[NSUUID alloc] initWithUUIDString:items[0]];
-    if (!twincodeInboundId) {
+    if (status == TLPeerIdStatusBadTwincode) {
         [[self getPeerConnectionService] terminatePeerConnectionWithPeerConnectionId:peerConnectionId terminateReason:TLPeerConnectionServiceTerminateReasonGeneralError];
         return;
     }
-    NSUUID *callingUserTwincodeId;
-        
-    NSArray<NSString *> *domainAndResource = [items[1] componentsSeparatedByString:@"/"];
-    if (domainAndResource.count == 2) {
-        callingUserTwincodeId = [[NSUUID alloc] initWithUUIDString:domainAndResource[1]];
-    }
+    NSUUID *twincodeInboundId = [[NSUUID alloc] initWithUUIDBytes:info.twincodeInboundId];
+    NSUUID *callingUserTwincodeId = info.hasCallingUserTwincodeId ? [[NSUUID alloc] initWithUUIDBytes:info.callingUserTwincodeId] : nil;
 
     TLFindResult *result = [self getReceiverWithTwincodeInboundId:twincodeInboundId];
     if (result.errorCode != TLBaseServiceErrorCodeSuccess || [result.object class] != [TLGroup class]) {
@@ -3466,19 +4050,39 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
         return TLBaseServiceErrorCodeQueued;
     }
 
-    TLProcessInvocationExecutor *processInvocationExecutor = [[TLProcessInvocationExecutor alloc] initWithTwinmeContext:self invocation:invocation withBlock:^(TLBaseServiceErrorCode errorCode, TLInvocation *newInvocation) {
-        if (errorCode != TLBaseServiceErrorCodeSuccess || !newInvocation) {
-            [self acknowledgeInvocationWithInvocationId:invocation.invocationId errorCode:errorCode];
-        } else {
-            [self onProcessInvocation:newInvocation];
-        }
-    }];
-    dispatch_async([self.twinlife twinlifeQueue], ^{
+    // After a long disconnection the server replays a large backlog: the scheduler starts the invocations
+    // by small slices so that the twinlife queue remains available for other work.
+    [self.invocationReplay addJobWithPriority:[self replayPriorityWithInvocation:invocation] job:^(dispatch_block_t completion) {
+        TLProcessInvocationExecutor *processInvocationExecutor = [[TLProcessInvocationExecutor alloc] initWithTwinmeContext:self invocation:invocation withBlock:^(TLBaseServiceErrorCode errorCode, TLInvocation *newInvocation) {
+            if (errorCode != TLBaseServiceErrorCodeSuccess || !newInvocation) {
+                [self acknowledgeInvocationWithInvocationId:invocation.invocationId errorCode:errorCode];
+            } else {
+                [self onProcessInvocation:newInvocation];
+            }
+            completion();
+        }];
         [processInvocationExecutor start];
-    });
+    }];
     return TLBaseServiceErrorCodeQueued;
 }
 
+- (TLInvocationReplayPriority)replayPriorityWithInvocation:(nonnull TLTwincodeInvocation *)invocation {
+    DDLogVerbose(@"%@ replayPriorityWithInvocation: %@", LOG_TAG, invocation);
+
+    // Bind, unbind and refresh on a contact or group the user can see are processed first.
+    NSString *action = invocation.action;
+    if (![[TLPairProtocol ACTION_PAIR_BIND] isEqualToString:action] && ![[TLPairProtocol ACTION_PAIR_UNBIND] isEqualToString:action]
+        && ![[TLPairProtocol ACTION_PAIR_REFRESH] isEqualToString:action]) {
+        return TLInvocationReplayPriorityNormal;
+    }
+
+    id<TLRepositoryObject> subject = invocation.subject;
+    if (![(id)subject conformsToProtocol:@protocol(TLOriginator)]) {
+        return TLInvocationReplayPriorityNormal;
+    }
+    return [self isVisible:(id<TLOriginator>)subject] ? TLInvocationReplayPriorityHigh : TLInvocationReplayPriorityNormal;
+}
+
 - (void)onRefreshTwincodeWithTwincode:(nonnull TLTwincodeOutbound *)twincodeOutbound updatedAttributes:(nonnull NSArray<TLAttributeNameValue *> *)updatedAttributes {
     DDLogVerbose(@"%@ onRefreshTwincodeWithTwincode: %@ updatedAttributes: %@", LOG_TAG, twincodeOutbound, updatedAttributes);
     
@@ -3519,6 +4123,8 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)onPushDescriptorWithConversation:(id <TLConversation>)conversation descriptor:(TLDescriptor *)descriptor {
     DDLogVerbose(@"%@ onPushDescriptorWithConversation: %@ descriptor: %@", LOG_TAG, conversation, descriptor);
     
+    [self markConversationWithSubjectId:conversation.subject.objectId];
+    
     switch ([descriptor getType]) {
         case TLDescriptorTypeObjectDescriptor:
             [[self getRepositoryService] incrementStatWithObject:conversation.subject statType:TLRepositoryServiceStatTypeNbMessageSent];
@@ -3567,6 +4173,8 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)onPopDescriptorWithConversation:(id <TLConversation>)conversation descriptor:(TLDescriptor *)descriptor {
     DDLogVerbose(@"%@ onPopDescriptorWithConversation: %@ descriptor: %@", LOG_TAG, conversation, descriptor);
     
+    [self markConversationWithSubjectId:conversation.subject.objectId];
+    
     switch ([descriptor getType]) {
         case TLDescriptorTypeObjectDescriptor:
             [[self getRepositoryService] incrementStatWithObject:conversation.subject statType:TLRepositoryServiceStatTypeNbMessageReceived];
@@ -3715,6 +4323,8 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)onUpdateDescriptorWithConversation:(id <TLConversation>)conversation descriptor:(TLDescriptor *)descriptor updateType:(TLConversationServiceUpdateType)updateType {
     DDLogVerbose(@"%@ onUpdateDescriptorWithConversation: %@ descriptor: %@ updateType: %u", LOG_TAG, conversation, descriptor, updateType);
     
+    [self markConversationWithSubjectId:conversation.subject.objectId];
+    
     switch ([descriptor getType]) {
         case TLDescriptorTypeTwincodeDescriptor:
             break;
@@ -3823,6 +4433,8 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
 - (void)onUpdateAnnotationWithConversation:(id <TLConversation>)conversation descriptor:(TLDescriptor *)descriptor annotatingUser:(nonnull TLTwincodeOutbound *)annotatingUser {
     DDLogVerbose(@"%@ onUpdateAnnotationWithConversation: %@ descriptor: %@ annotatingUser: %@", LOG_TAG, conversation, descriptor, annotatingUser);
     
+    [self markConversationWithSubjectId:conversation.subject.objectId];
+    
     if (!self.inBackground) {
         @synchronized(self) {
             if ([conversation isConversationWithUUID:self.activeConversationId]) {
@@ -3874,7 +4486,7 @@ TL_CREATE_ASSERT_POINT(INCOMING_PEER_CONNECTION, 3004)
     DDLogVerbose(@"%@ newOperation: %d", LOG_TAG, operationId);
     
     int64_t requestId = [self newRequestId];
-    @synchronized(self) {
+    @synchronized(self.requestIds) {
         self.requestIds[[NSNumber numberWithLongLong:requestId]] = [NSNumber numberWithInt:operationId];
     }
     return requestId;
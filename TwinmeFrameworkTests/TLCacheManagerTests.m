@@ -0,0 +1,181 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLCacheManager.h"
+
+#define BUDGET (64 * 1024)
+#define LOAD_LATENCY_US 50
+
+//
+// Interface: TLTestCache
+//
+
+/// Stand-in for a context cache: an entry missing from the cache is loaded after a fixed latency.
+@interface TLTestCache : NSObject
+
+@property (readonly, nonnull) NSMutableDictionary<NSNumber *, NSNumber *> *entries;
+@property int loadCount;
+
+@end
+
+@implementation TLTestCache
+
+- (nonnull instancetype)initWithCount:(int)count {
+
+    self = [super init];
+    if (self) {
+        _entries = [[NSMutableDictionary alloc] init];
+        for (int i = 0; i < count; i++) {
+            _entries[[NSNumber numberWithInt:i]] = [NSNumber numberWithInt:i];
+        }
+    }
+    return self;
+}
+
+- (void)getWithKey:(int)key {
+
+    NSNumber *number = [NSNumber numberWithInt:key];
+    @synchronized (self) {
+        if (self.entries[number]) {
+            return;
+        }
+    }
+    usleep(LOAD_LATENCY_US);
+    @synchronized (self) {
+        self.entries[number] = number;
+        self.loadCount++;
+    }
+}
+
+- (void)registerWithManager:(nonnull TLCacheManager *)manager name:(nonnull NSString *)name priority:(TLCachePriority)priority entryCost:(NSUInteger)entryCost {
+
+    [manager registerCacheWithName:name priority:priority entryCost:entryCost count:^NSUInteger{
+        @synchronized (self) {
+            return self.entries.count;
+        }
+    } clear:^{
+        @synchronized (self) {
+            [self.entries removeAllObjects];
+        }
+    }];
+}
+
+@end
+
+@interface TLCacheManagerTests : XCTestCase
+
+@property TLCacheManager *manager;
+@property TLTestCache *spaces;
+@property TLTestCache *originatorSpaces;
+@property TLTestCache *spaceOriginators;
+@property TLTestCache *groupMembers;
+
+@end
+
+@implementation TLCacheManagerTests
+
+// The caches of the twinme context with a size that exceeds the budget.
+- (void)setUp {
+    self.manager = [[TLCacheManager alloc] initWithBudget:BUDGET];
+    self.spaces = [[TLTestCache alloc] initWithCount:4];
+    self.originatorSpaces = [[TLTestCache alloc] initWithCount:100];
+    self.spaceOriginators = [[TLTestCache alloc] initWithCount:400];
+    self.groupMembers = [[TLTestCache alloc] initWithCount:100];
+    [self.spaces registerWithManager:self.manager name:@"spaces" priority:TLCachePriorityHigh entryCost:2048];
+    [self.originatorSpaces registerWithManager:self.manager name:@"originatorSpaces" priority:TLCachePriorityNormal entryCost:64];
+    [self.spaceOriginators registerWithManager:self.manager name:@"spaceOriginators" priority:TLCachePriorityNormal entryCost:48];
+    [self.groupMembers registerWithManager:self.manager name:@"groupMembers" priority:TLCachePriorityLow entryCost:1024];
+}
+
+- (void)testFootprintReport {
+    NSArray<TLCacheFootprint *> *report = [self.manager footprintReport];
+
+    // Sorted on the trim order: lowest priority first, then the largest cache.
+    XCTAssertEqual((NSUInteger)4, report.count);
+    XCTAssertEqualObjects(@"groupMembers", report[0].name);
+    XCTAssertEqualObjects(@"spaceOriginators", report[1].name);
+    XCTAssertEqualObjects(@"originatorSpaces", report[2].name);
+    XCTAssertEqualObjects(@"spaces", report[3].name);
+    XCTAssertEqual((NSUInteger)100, report[0].count);
+    XCTAssertEqual((NSUInteger)(100 * 1024), report[0].bytes);
+    XCTAssertEqual((NSUInteger)(4 * 2048 + 100 * 64 + 400 * 48 + 100 * 1024), self.manager.footprint);
+}
+
+- (void)testTrimSuspend {
+    // Dropping the group members is enough to be within the budget.
+    XCTAssertEqualObjects(@[@"groupMembers"], [self.manager trimWithLevel:TLCacheTrimLevelSuspend]);
+    XCTAssertEqual((NSUInteger)0, self.groupMembers.entries.count);
+    XCTAssertEqual((NSUInteger)100, self.originatorSpaces.entries.count);
+    XCTAssertEqual((NSUInteger)400, self.spaceOriginators.entries.count);
+    XCTAssertEqual((NSUInteger)4, self.spaces.entries.count);
+    XCTAssertLessThanOrEqual(self.manager.footprint, (NSUInteger)BUDGET);
+
+    // Nothing to do when the caches are within the budget.
+    XCTAssertEqualObjects(@[], [self.manager trimWithLevel:TLCacheTrimLevelSuspend]);
+}
+
+- (void)testTrimWarning {
+    // The quarter of the budget is reached by dropping the largest normal priority cache.
+    XCTAssertEqualObjects((@[@"groupMembers", @"spaceOriginators"]), [self.manager trimWithLevel:TLCacheTrimLevelWarning]);
+    XCTAssertEqual((NSUInteger)0, self.groupMembers.entries.count);
+    XCTAssertEqual((NSUInteger)100, self.originatorSpaces.entries.count);
+    XCTAssertEqual((NSUInteger)0, self.spaceOriginators.entries.count);
+    XCTAssertEqual((NSUInteger)4, self.spaces.entries.count);
+    XCTAssertLessThanOrEqual(self.manager.footprint, (NSUInteger)(BUDGET / 4));
+}
+
+- (void)testTrimCritical {
+    // The high priority caches are kept even if the target is not reached.
+    XCTAssertEqualObjects((@[@"groupMembers", @"spaceOriginators", @"originatorSpaces"]), [self.manager trimWithLevel:TLCacheTrimLevelCritical]);
+    XCTAssertEqual((NSUInteger)0, self.groupMembers.entries.count);
+    XCTAssertEqual((NSUInteger)0, self.originatorSpaces.entries.count);
+    XCTAssertEqual((NSUInteger)0, self.spaceOriginators.entries.count);
+    XCTAssertEqual((NSUInteger)4, self.spaces.entries.count);
+    XCTAssertEqual((NSUInteger)(4 * 2048), self.manager.footprint);
+}
+
+- (void)testTrimAll {
+    XCTAssertEqual((NSUInteger)4, [self.manager trimWithLevel:TLCacheTrimLevelAll].count);
+    XCTAssertEqual((NSUInteger)0, self.manager.footprint);
+    XCTAssertEqual((NSUInteger)0, self.spaces.entries.count);
+}
+
+// Resume: the application looks at every space and at the members of the groups it displays.
+- (void)resumeAfterLevel:(TLCacheTrimLevel)level {
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        [self setUp];
+        [self.manager trimWithLevel:level];
+
+        [self startMeasuring];
+        for (int i = 0; i < 4; i++) {
+            [self.spaces getWithKey:i];
+        }
+        for (int i = 0; i < 100; i++) {
+            [self.groupMembers getWithKey:i];
+        }
+        for (int i = 0; i < 100; i++) {
+            [self.originatorSpaces getWithKey:i];
+        }
+        [self stopMeasuring];
+    }];
+}
+
+- (void)testResumeAfterFullClear {
+    [self resumeAfterLevel:TLCacheTrimLevelAll];
+    XCTAssertEqual(4, self.spaces.loadCount);
+    XCTAssertEqual(100, self.originatorSpaces.loadCount);
+    XCTAssertEqual(100, self.groupMembers.loadCount);
+}
+
+- (void)testResumeAfterTieredTrim {
+    [self resumeAfterLevel:TLCacheTrimLevelSuspend];
+    XCTAssertEqual(0, self.spaces.loadCount);
+    XCTAssertEqual(0, self.originatorSpaces.loadCount);
+    XCTAssertEqual(100, self.groupMembers.loadCount);
+}
+
+@end
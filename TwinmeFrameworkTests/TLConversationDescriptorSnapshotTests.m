@@ -0,0 +1,294 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <Twinlife/TLConversationService.h>
+#import <Twinlife/TLFilter.h>
+
+#import "TLConversationDescriptorSnapshot.h"
+
+//
+// Conversation, subject and descriptor with only the properties used by the snapshot.
+//
+
+@interface TLTestSubject : NSObject
+
+@property (nonnull) NSUUID *objectId;
+
+@end
+
+@implementation TLTestSubject
+@end
+
+@interface TLTestConversation : NSObject
+
+@property (nonnull) NSUUID *uuid;
+@property (nonnull) TLTestSubject *subject;
+
+@end
+
+@implementation TLTestConversation
+@end
+
+@interface TLTestDescriptor : NSObject
+
+@property (nonnull) TLDescriptorId *descriptorId;
+
+@end
+
+@implementation TLTestDescriptor
+@end
+
+@interface TLTestConversationPair : NSObject
+
+@property (nonnull) TLTestConversation *conversation;
+@property (nonnull) TLTestDescriptor *descriptor;
+
+@end
+
+@implementation TLTestConversationPair
+@end
+
+@interface TLConversationDescriptorSnapshotTests : XCTestCase
+@end
+
+@implementation TLConversationDescriptorSnapshotTests
+
+static TLTestDescriptor *newDescriptor(NSUUID *twincodeId, int64_t sequenceId) {
+
+    TLTestDescriptor *descriptor = [[TLTestDescriptor alloc] init];
+    descriptor.descriptorId = [[TLDescriptorId alloc] initWithTwincodeOutboundId:twincodeId sequenceId:sequenceId];
+    return descriptor;
+}
+
+/// A conversation whose uuid is not the subject id, as a group conversation.
+static TLConversationDescriptorPair *newPair(NSUUID *subjectId, TLTestDescriptor *descriptor) {
+
+    TLTestConversationPair *pair = [[TLTestConversationPair alloc] init];
+    pair.conversation = [[TLTestConversation alloc] init];
+    pair.conversation.uuid = [NSUUID UUID];
+    pair.conversation.subject = [[TLTestSubject alloc] init];
+    pair.conversation.subject.objectId = subjectId;
+    pair.descriptor = descriptor;
+    return (TLConversationDescriptorPair *)pair;
+}
+
+/// The same conversation with another last descriptor.
+static TLConversationDescriptorPair *pairWithDescriptor(TLConversationDescriptorPair *pair, TLTestDescriptor *descriptor) {
+
+    TLTestConversationPair *result = [[TLTestConversationPair alloc] init];
+    result.conversation = ((TLTestConversationPair *)pair).conversation;
+    result.descriptor = descriptor;
+    return (TLConversationDescriptorPair *)result;
+}
+
+static NSSet<NSUUID *> *subjectIds(NSArray<TLConversationDescriptorPair *> *pairs) {
+
+    NSMutableSet<NSUUID *> *result = [[NSMutableSet alloc] init];
+    for (TLConversationDescriptorPair *pair in pairs) {
+        [result addObject:((TLTestConversationPair *)pair).conversation.subject.objectId];
+    }
+    return result;
+}
+
+static TLConversationDescriptorSnapshot *newSnapshot(void) {
+
+    TLFilter *filter = nil;
+    return [[TLConversationDescriptorSnapshot alloc] initWithFilter:filter callsMode:TLDisplayCallsModeAll];
+}
+
+/// Bring the snapshot to the version of the changes as findConversationDescriptorsWithSnapshot does.
+static TLConversationDescriptorDelta *findDelta(TLConversationDescriptorSnapshot *snapshot, TLConversationChanges *changes, NSArray<TLConversationDescriptorPair *> *list) {
+
+    int64_t version = changes.version;
+    if (snapshot.version == version) {
+        return [snapshot updateWithVersion:version];
+    }
+    return [snapshot updateWithList:list version:version dirtyConversations:[changes subjectIdsSinceVersion:snapshot.version]];
+}
+
+- (void)testDirtyMerge {
+    NSUUID *twincodeId = [NSUUID UUID];
+    NSUUID *subject1 = [NSUUID UUID];
+    NSUUID *subject2 = [NSUUID UUID];
+    NSUUID *subject3 = [NSUUID UUID];
+    TLConversationDescriptorPair *pair1 = newPair(subject1, newDescriptor(twincodeId, 1));
+    TLConversationDescriptorPair *pair2 = newPair(subject2, newDescriptor(twincodeId, 2));
+    TLConversationDescriptorPair *pair3 = newPair(subject3, newDescriptor(twincodeId, 3));
+    TLConversationDescriptorSnapshot *snapshot = newSnapshot();
+
+    TLConversationDescriptorDelta *delta = [snapshot updateWithList:@[pair1, pair2] version:1 dirtyConversations:nil];
+    XCTAssertEqual(1LL, delta.version);
+    XCTAssertEqualObjects((@[pair1, pair2]), delta.inserted);
+    XCTAssertEqual((NSUInteger)0, delta.updated.count);
+    XCTAssertEqual((NSUInteger)0, delta.removed.count);
+
+    // Conversation 1 is dirty with the same last descriptor (updated or annotated), conversation 2
+    // has a new last descriptor which was not reported and conversation 3 is new.
+    TLConversationDescriptorPair *pair2bis = pairWithDescriptor(pair2, newDescriptor(twincodeId, 4));
+    delta = [snapshot updateWithList:@[pair1, pair2bis, pair3] version:3 dirtyConversations:[NSSet setWithObject:subject1]];
+    XCTAssertEqual(3LL, snapshot.version);
+    XCTAssertEqualObjects((@[pair3]), delta.inserted);
+    XCTAssertEqualObjects(([NSSet setWithObjects:subject1, subject2, nil]), subjectIds(delta.updated));
+    XCTAssertEqual((NSUInteger)0, delta.removed.count);
+
+    // Nothing dirty and the same descriptors: no change.
+    delta = [snapshot updateWithList:@[pair3, pair1, pair2bis] version:4 dirtyConversations:[NSSet set]];
+    XCTAssertTrue([delta isEmpty]);
+    XCTAssertEqual(4LL, delta.version);
+    XCTAssertEqual((NSUInteger)3, snapshot.list.count);
+}
+
+// An event on a group member conversation marks the group subject: the group conversation
+// of the list must be reported although its uuid is not the dirty one.
+- (void)testGroupMemberEvent {
+    NSUUID *groupId = [NSUUID UUID];
+    TLTestDescriptor *descriptor = newDescriptor([NSUUID UUID], 1);
+    TLConversationDescriptorPair *groupPair = newPair(groupId, descriptor);
+    TLConversationDescriptorSnapshot *snapshot = newSnapshot();
+
+    [snapshot updateWithList:@[groupPair] version:1 dirtyConversations:nil];
+    TLConversationDescriptorDelta *delta = [snapshot updateWithList:@[groupPair] version:2 dirtyConversations:[NSSet setWithObject:[NSUUID UUID]]];
+    XCTAssertTrue([delta isEmpty]);
+
+    delta = [snapshot updateWithList:@[groupPair] version:3 dirtyConversations:[NSSet setWithObject:groupId]];
+    XCTAssertEqualObjects((@[groupPair]), delta.updated);
+}
+
+// A snapshot older than the dirty conversations that are remembered gets every conversation as updated.
+- (void)testVersionMismatch {
+    NSUUID *twincodeId = [NSUUID UUID];
+    TLConversationDescriptorPair *pair1 = newPair([NSUUID UUID], newDescriptor(twincodeId, 1));
+    TLConversationDescriptorPair *pair2 = newPair([NSUUID UUID], newDescriptor(twincodeId, 2));
+    TLConversationDescriptorSnapshot *snapshot = newSnapshot();
+
+    [snapshot updateWithList:@[pair1, pair2] version:1 dirtyConversations:nil];
+    TLConversationDescriptorDelta *delta = [snapshot updateWithList:@[pair1, pair2] version:100 dirtyConversations:nil];
+    XCTAssertEqual(100LL, snapshot.version);
+    XCTAssertEqual((NSUInteger)0, delta.inserted.count);
+    XCTAssertEqual((NSUInteger)2, delta.updated.count);
+    XCTAssertEqual((NSUInteger)0, delta.removed.count);
+
+    // The version alone moves without touching the list.
+    delta = [snapshot updateWithVersion:101];
+    XCTAssertTrue([delta isEmpty]);
+    XCTAssertEqual(101LL, snapshot.version);
+    XCTAssertEqual((NSUInteger)2, snapshot.list.count);
+}
+
+- (void)testRemoval {
+    NSUUID *twincodeId = [NSUUID UUID];
+    TLConversationDescriptorPair *pair1 = newPair([NSUUID UUID], newDescriptor(twincodeId, 1));
+    TLConversationDescriptorPair *pair2 = newPair([NSUUID UUID], newDescriptor(twincodeId, 2));
+    TLConversationDescriptorPair *pair3 = newPair([NSUUID UUID], newDescriptor(twincodeId, 3));
+    TLConversationDescriptorSnapshot *snapshot = newSnapshot();
+
+    [snapshot updateWithList:@[pair1, pair2, pair3] version:1 dirtyConversations:nil];
+    TLConversationDescriptorDelta *delta = [snapshot updateWithList:@[pair2] version:2 dirtyConversations:[NSSet set]];
+    XCTAssertEqual((NSUInteger)0, delta.inserted.count);
+    XCTAssertEqual((NSUInteger)0, delta.updated.count);
+    NSSet<NSUUID *> *removed = [NSSet setWithObjects:((TLTestConversationPair *)pair1).conversation.uuid, ((TLTestConversationPair *)pair3).conversation.uuid, nil];
+    XCTAssertEqualObjects(removed, [NSSet setWithArray:delta.removed]);
+    XCTAssertEqualObjects((@[pair2]), snapshot.list);
+
+    // A removed conversation that comes back is inserted again.
+    delta = [snapshot updateWithList:@[pair2, pair1] version:3 dirtyConversations:[NSSet set]];
+    XCTAssertEqualObjects((@[pair1]), delta.inserted);
+    XCTAssertEqual((NSUInteger)0, delta.removed.count);
+
+    delta = [snapshot updateWithList:@[] version:4 dirtyConversations:nil];
+    XCTAssertEqual((NSUInteger)2, delta.removed.count);
+    XCTAssertEqual((NSUInteger)0, snapshot.list.count);
+}
+
+// A contact is created: its conversation is reported as inserted.
+- (void)testCreate {
+    TLConversationChanges *changes = [[TLConversationChanges alloc] initWithCapacity:16];
+    TLConversationDescriptorSnapshot *snapshot = newSnapshot();
+    NSUUID *contactId = [NSUUID UUID];
+    TLConversationDescriptorPair *pair1 = newPair([NSUUID UUID], newDescriptor([NSUUID UUID], 1));
+
+    findDelta(snapshot, changes, @[pair1]);
+    XCTAssertTrue([findDelta(snapshot, changes, @[pair1]) isEmpty]);
+
+    [changes markWithSubjectId:contactId];
+    TLConversationDescriptorPair *pair2 = newPair(contactId, newDescriptor([NSUUID UUID], 1));
+    TLConversationDescriptorDelta *delta = findDelta(snapshot, changes, @[pair1, pair2]);
+    XCTAssertEqual(changes.version, delta.version);
+    XCTAssertEqualObjects((@[pair2]), delta.inserted);
+    XCTAssertEqual((NSUInteger)0, delta.updated.count);
+}
+
+// The last descriptor of a conversation is deleted or marked deleted: the conversation is reported as
+// updated whether its last descriptor changes or is the same descriptor with a deleted content.
+- (void)testDeleteDescriptor {
+    TLConversationChanges *changes = [[TLConversationChanges alloc] initWithCapacity:16];
+    TLConversationDescriptorSnapshot *snapshot = newSnapshot();
+    NSUUID *twincodeId = [NSUUID UUID];
+    NSUUID *subjectId = [NSUUID UUID];
+    TLTestDescriptor *descriptor = newDescriptor(twincodeId, 2);
+    TLConversationDescriptorPair *pair1 = newPair(subjectId, descriptor);
+    TLConversationDescriptorPair *pair2 = newPair([NSUUID UUID], newDescriptor(twincodeId, 3));
+
+    findDelta(snapshot, changes, @[pair1, pair2]);
+
+    // Marked deleted: same last descriptor.
+    [changes markWithSubjectId:subjectId];
+    TLConversationDescriptorDelta *delta = findDelta(snapshot, changes, @[pair1, pair2]);
+    XCTAssertEqualObjects((@[pair1]), delta.updated);
+    XCTAssertEqual((NSUInteger)0, delta.inserted.count);
+    XCTAssertEqual((NSUInteger)0, delta.removed.count);
+
+    // Deleted: the previous descriptor becomes the last one.
+    [changes markWithSubjectId:subjectId];
+    TLConversationDescriptorPair *pair1bis = pairWithDescriptor(pair1, newDescriptor(twincodeId, 1));
+    delta = findDelta(snapshot, changes, @[pair1bis, pair2]);
+    XCTAssertEqualObjects((@[pair1bis]), delta.updated);
+    XCTAssertTrue([findDelta(snapshot, changes, @[pair1bis, pair2]) isEmpty]);
+}
+
+// A conversation is reset: it is reported as updated with its clear descriptor and the sign out
+// reset of the changes reports every conversation.
+- (void)testReset {
+    TLConversationChanges *changes = [[TLConversationChanges alloc] initWithCapacity:16];
+    TLConversationDescriptorSnapshot *snapshot = newSnapshot();
+    NSUUID *twincodeId = [NSUUID UUID];
+    NSUUID *subjectId = [NSUUID UUID];
+    TLConversationDescriptorPair *pair1 = newPair(subjectId, newDescriptor(twincodeId, 5));
+    TLConversationDescriptorPair *pair2 = newPair([NSUUID UUID], newDescriptor(twincodeId, 6));
+
+    findDelta(snapshot, changes, @[pair1, pair2]);
+    [changes markWithSubjectId:subjectId];
+    TLConversationDescriptorPair *cleared = pairWithDescriptor(pair1, newDescriptor(twincodeId, 7));
+    TLConversationDescriptorDelta *delta = findDelta(snapshot, changes, @[cleared, pair2]);
+    XCTAssertEqualObjects((@[cleared]), delta.updated);
+
+    [changes reset];
+    XCTAssertNil([changes subjectIdsSinceVersion:snapshot.version]);
+    delta = findDelta(snapshot, changes, @[cleared, pair2]);
+    XCTAssertEqual((NSUInteger)2, delta.updated.count);
+}
+
+// More changed subjects than the capacity: the older snapshots get every conversation as updated.
+- (void)testChangesCapacity {
+    TLConversationChanges *changes = [[TLConversationChanges alloc] initWithCapacity:4];
+    int64_t version = changes.version;
+    NSUUID *subjectId = [NSUUID UUID];
+
+    [changes markWithSubjectId:subjectId];
+    [changes markWithSubjectId:nil];
+    XCTAssertEqual(version + 2, changes.version);
+    XCTAssertEqualObjects([NSSet setWithObject:subjectId], [changes subjectIdsSinceVersion:version]);
+    XCTAssertEqual((NSUInteger)0, [changes subjectIdsSinceVersion:changes.version].count);
+
+    for (int i = 0; i < 4; i++) {
+        [changes markWithSubjectId:[NSUUID UUID]];
+    }
+    XCTAssertNil([changes subjectIdsSinceVersion:version]);
+    XCTAssertEqual((NSUInteger)0, [changes subjectIdsSinceVersion:changes.version].count);
+}
+
+@end
@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLConversationVisibilityFilter.h"
+
+#define CONVERSATION_COUNT 10000
+#define SPACE_COUNT 30
+#define SECRET_SPACE_COUNT 5
+
+//
+// Space, originator and conversation with only the properties used by the filter.
+//
+
+@interface TLTestVisibilitySpaceSettings : NSObject
+
+@property BOOL isSecret;
+
+@end
+
+@implementation TLTestVisibilitySpaceSettings
+@end
+
+@interface TLTestVisibilitySpace : NSObject
+
+@property (nonnull) TLTestVisibilitySpaceSettings *settings;
+
+@end
+
+@implementation TLTestVisibilitySpace
+@end
+
+@interface TLTestVisibilityOriginator : NSObject
+
+@property (nonnull) NSUUID *uuid;
+@property (nullable) TLTestVisibilitySpace *space;
+
+@end
+
+@implementation TLTestVisibilityOriginator
+@end
+
+@interface TLTestVisibilityConversation : NSObject
+
+@property (nonnull) TLTestVisibilityOriginator *subject;
+
+@end
+
+@implementation TLTestVisibilityConversation
+@end
+
+@interface TLConversationVisibilityFilterTests : XCTestCase
+
+@property (nonnull) NSMutableArray<TLTestVisibilitySpace *> *spaces;
+@property (nonnull) NSMutableArray<id<TLConversation>> *conversations;
+
+@end
+
+@implementation TLConversationVisibilityFilterTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.spaces = [[NSMutableArray alloc] initWithCapacity:SPACE_COUNT];
+    for (int i = 0; i < SPACE_COUNT; i++) {
+        TLTestVisibilitySpace *space = [[TLTestVisibilitySpace alloc] init];
+        space.settings = [[TLTestVisibilitySpaceSettings alloc] init];
+        space.settings.isSecret = i >= SPACE_COUNT - SECRET_SPACE_COUNT;
+        [self.spaces addObject:space];
+    }
+
+    // The last conversation has no space as a contact being created.
+    self.conversations = [[NSMutableArray alloc] initWithCapacity:CONVERSATION_COUNT];
+    for (int i = 0; i < CONVERSATION_COUNT; i++) {
+        TLTestVisibilityConversation *conversation = [[TLTestVisibilityConversation alloc] init];
+        conversation.subject = [[TLTestVisibilityOriginator alloc] init];
+        conversation.subject.uuid = [NSUUID UUID];
+        conversation.subject.space = i < CONVERSATION_COUNT - 1 ? self.spaces[i % SPACE_COUNT] : nil;
+        [self.conversations addObject:(id<TLConversation>)conversation];
+    }
+}
+
+- (NSUInteger)countWithVisibility:(TLConversationVisibility)visibility {
+
+    TLConversationVisibilityFilter *filter = [[TLConversationVisibilityFilter alloc] initWithCurrentSpace:(TLSpace *)self.spaces[0] visibility:visibility];
+    NSArray<id<TLConversation>> *list = [filter filterWithConversations:self.conversations predicate:^BOOL(id<TLOriginator> originator) {
+        return YES;
+    }];
+
+    // The conversations are kept in their order.
+    NSUInteger last = 0;
+    for (id<TLConversation> conversation in list) {
+        NSUInteger index = [self.conversations indexOfObjectIdenticalTo:conversation];
+        XCTAssertTrue(last == 0 || index > last);
+        last = index;
+    }
+    return list.count;
+}
+
+- (void)testVisibility {
+    NSUInteger perSpace = (CONVERSATION_COUNT - 1) / SPACE_COUNT;
+
+    XCTAssertEqual((NSUInteger)CONVERSATION_COUNT, [self countWithVisibility:TLConversationVisibilityAll]);
+    XCTAssertEqual(perSpace * (SPACE_COUNT - SECRET_SPACE_COUNT) + 9, [self countWithVisibility:TLConversationVisibilityVisible]);
+    XCTAssertEqual(perSpace + 1, [self countWithVisibility:TLConversationVisibilityCurrentSpace]);
+}
+
+- (void)testSecretCurrentSpace {
+    TLSpace *secret = (TLSpace *)self.spaces[SPACE_COUNT - 1];
+    TLConversationVisibilityFilter *filter = [[TLConversationVisibilityFilter alloc] initWithCurrentSpace:secret visibility:TLConversationVisibilityVisible];
+    NSArray<id<TLConversation>> *list = [filter filterWithConversations:self.conversations predicate:^BOOL(id<TLOriginator> originator) {
+        return YES;
+    }];
+
+    // The current space is visible even when it is secret.
+    NSUInteger perSpace = (CONVERSATION_COUNT - 1) / SPACE_COUNT;
+    XCTAssertEqual(perSpace * (SPACE_COUNT - SECRET_SPACE_COUNT + 1) + 9, list.count);
+}
+
+- (void)testPredicate {
+    TLConversationVisibilityFilter *filter = [[TLConversationVisibilityFilter alloc] initWithCurrentSpace:(TLSpace *)self.spaces[0] visibility:TLConversationVisibilityVisible];
+    __block NSUInteger calls = 0;
+    NSUUID *uuid = ((TLTestVisibilityOriginator *)self.conversations[42].subject).uuid;
+    NSArray<id<TLConversation>> *list = [filter filterWithConversations:self.conversations predicate:^BOOL(id<TLOriginator> originator) {
+        calls++;
+        return [originator.uuid isEqual:uuid];
+    }];
+
+    // The predicate is only called for the visible conversations.
+    XCTAssertEqual((NSUInteger)1, list.count);
+    XCTAssertEqual(self.conversations[42], list.firstObject);
+    XCTAssertEqual([self countWithVisibility:TLConversationVisibilityVisible], calls);
+}
+
+// Conversation list latency with 10k conversations across 30 spaces.
+- (void)testPerformance {
+    TLConversationVisibilityFilter *filter = [[TLConversationVisibilityFilter alloc] initWithCurrentSpace:(TLSpace *)self.spaces[0] visibility:TLConversationVisibilityVisible];
+
+    [self measureBlock:^{
+        NSArray<id<TLConversation>> *list = [filter filterWithConversations:self.conversations predicate:^BOOL(id<TLOriginator> originator) {
+            return YES;
+        }];
+        XCTAssertGreaterThan(list.count, (NSUInteger)0);
+    }];
+}
+
+@end
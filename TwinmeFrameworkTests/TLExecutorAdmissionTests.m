@@ -0,0 +1,251 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLExecutorAdmission.h"
+
+#define EXECUTOR_COUNT 1000
+#define EXECUTOR_LIMIT 4
+
+//
+// Interface: TLTestExecutor
+//
+
+/// Executor which does its work on a global queue and is stopped on the twinlife queue as the twinme executors.
+@interface TLTestExecutor : NSObject
+
+@property (readonly, nonnull) TLExecutorAdmission *admission;
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly, nonnull) NSMutableArray *log;
+@property (readonly) int index;
+
+- (nonnull instancetype)initWithAdmission:(nonnull TLExecutorAdmission *)admission queue:(nonnull dispatch_queue_t)queue log:(nonnull NSMutableArray *)log index:(int)index;
+
+@end
+
+/// Second executor class to check that the limits are applied per class.
+@interface TLOtherTestExecutor : TLTestExecutor
+
+@end
+
+//
+// Implementation: TLTestExecutor
+//
+
+static int runningCount;
+static int maxRunningCount;
+static int completedCount;
+
+@implementation TLTestExecutor
+
+- (nonnull instancetype)initWithAdmission:(nonnull TLExecutorAdmission *)admission queue:(nonnull dispatch_queue_t)queue log:(nonnull NSMutableArray *)log index:(int)index {
+
+    self = [super init];
+    if (self) {
+        _admission = admission;
+        _queue = queue;
+        _log = log;
+        _index = index;
+    }
+    return self;
+}
+
+- (void)startWithPriority:(TLExecutorPriority)priority dispatchGroup:(dispatch_group_t)group {
+
+    dispatch_group_enter(group);
+    [self.admission submitWithExecutor:self priority:priority start:^{
+        @synchronized (self.log) {
+            runningCount++;
+            maxRunningCount = MAX(maxRunningCount, runningCount);
+            [self.log addObject:[NSNumber numberWithInt:self.index]];
+        }
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (self.index % 3) * NSEC_PER_MSEC), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            dispatch_async(self.queue, ^{
+                [self stopWithDispatchGroup:group];
+            });
+        });
+    } cancel:^{
+        dispatch_group_leave(group);
+    }];
+}
+
+- (void)stopWithDispatchGroup:(dispatch_group_t)group {
+
+    @synchronized (self.log) {
+        runningCount--;
+        completedCount++;
+    }
+    dispatch_block_t start = [self.admission releaseWithExecutor:self];
+    if (start) {
+        dispatch_async(self.queue, start);
+    }
+    dispatch_group_leave(group);
+}
+
+@end
+
+@implementation TLOtherTestExecutor
+
+@end
+
+@interface TLExecutorAdmissionTests : XCTestCase
+@end
+
+@implementation TLExecutorAdmissionTests
+
+- (void)setUp {
+
+    runningCount = 0;
+    maxRunningCount = 0;
+    completedCount = 0;
+}
+
+// Burst of executors as when the invocations are replayed on reconnection: they are started from
+// several threads and each one is stopped on the twinlife queue.
+- (void)testConcurrencyBound {
+    TLExecutorAdmission *admission = [[TLExecutorAdmission alloc] init];
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *log = [[NSMutableArray alloc] init];
+    NSMutableArray<TLTestExecutor *> *executors = [[NSMutableArray alloc] init];
+    for (int i = 0; i < EXECUTOR_COUNT; i++) {
+        [executors addObject:[[TLTestExecutor alloc] initWithAdmission:admission queue:queue log:log index:i]];
+    }
+    [admission setLimit:EXECUTOR_LIMIT withClass:[TLTestExecutor class]];
+
+    dispatch_apply(EXECUTOR_COUNT, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        [executors[iteration] startWithPriority:(TLExecutorPriority)(iteration % 3) dispatchGroup:group];
+    });
+
+    XCTAssertEqual(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 60 * NSEC_PER_SEC)));
+    XCTAssertEqual(EXECUTOR_LIMIT, maxRunningCount);
+    XCTAssertEqual(EXECUTOR_COUNT, completedCount);
+    XCTAssertEqual((NSUInteger)EXECUTOR_COUNT, [NSSet setWithArray:log].count);
+    XCTAssertEqual(0, [admission runningCountWithClass:[TLTestExecutor class]]);
+    XCTAssertEqual((NSUInteger)0, [admission waitingCountWithClass:[TLTestExecutor class]]);
+}
+
+- (void)testPriorityOrder {
+    TLExecutorAdmission *admission = [[TLExecutorAdmission alloc] init];
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *log = [[NSMutableArray alloc] init];
+    [admission setLimit:1 withClass:[TLTestExecutor class]];
+
+    // The first executor is admitted and the next ones wait until it is stopped from the twinlife queue.
+    TLExecutorPriority priorities[] = { TLExecutorPriorityNormal, TLExecutorPriorityLow, TLExecutorPriorityNormal, TLExecutorPriorityHigh, TLExecutorPriorityLow, TLExecutorPriorityHigh };
+    dispatch_sync(queue, ^{
+        for (int i = 0; i < 6; i++) {
+            TLTestExecutor *executor = [[TLTestExecutor alloc] initWithAdmission:admission queue:queue log:log index:i];
+            [executor startWithPriority:priorities[i] dispatchGroup:group];
+        }
+        XCTAssertEqual(1, [admission runningCountWithClass:[TLTestExecutor class]]);
+        XCTAssertEqual((NSUInteger)5, [admission waitingCountWithClass:[TLTestExecutor class]]);
+    });
+
+    XCTAssertEqual(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    NSArray *expected = @[@0, @3, @5, @2, @1, @4];
+    XCTAssertEqualObjects(expected, log);
+    XCTAssertEqual(1, maxRunningCount);
+}
+
+- (void)testCancelAndRelease {
+    TLExecutorAdmission *admission = [[TLExecutorAdmission alloc] init];
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *log = [[NSMutableArray alloc] init];
+    [admission setLimit:2 withClass:[TLTestExecutor class]];
+
+    __block NSArray<dispatch_block_t> *cancelList;
+    dispatch_sync(queue, ^{
+        for (int i = 0; i < 5; i++) {
+            TLTestExecutor *executor = [[TLTestExecutor alloc] initWithAdmission:admission queue:queue log:log index:i];
+            [executor startWithPriority:TLExecutorPriorityNormal dispatchGroup:group];
+        }
+
+        // Executors of another class are not limited.
+        for (int i = 5; i < 8; i++) {
+            TLOtherTestExecutor *executor = [[TLOtherTestExecutor alloc] initWithAdmission:admission queue:queue log:log index:i];
+            [executor startWithPriority:TLExecutorPriorityNormal dispatchGroup:group];
+        }
+        XCTAssertEqual((NSUInteger)3, [admission waitingCountWithClass:[TLTestExecutor class]]);
+        XCTAssertEqual((NSUInteger)0, [admission waitingCountWithClass:[TLOtherTestExecutor class]]);
+
+        // Stopping a waiting executor removes it from the queue, releasing it again has no effect.
+        TLTestExecutor *waiting = [[TLTestExecutor alloc] initWithAdmission:admission queue:queue log:log index:8];
+        [admission submitWithExecutor:waiting priority:TLExecutorPriorityHigh start:^{
+            XCTFail(@"Executor started after being released");
+        } cancel:nil];
+        XCTAssertEqual((NSUInteger)4, [admission waitingCountWithClass:[TLTestExecutor class]]);
+        XCTAssertNil([admission releaseWithExecutor:waiting]);
+        XCTAssertNil([admission releaseWithExecutor:waiting]);
+        XCTAssertEqual((NSUInteger)3, [admission waitingCountWithClass:[TLTestExecutor class]]);
+
+        cancelList = [admission cancelWithClass:[TLTestExecutor class]];
+        XCTAssertEqual((NSUInteger)0, [admission waitingCountWithClass:[TLTestExecutor class]]);
+    });
+    XCTAssertEqual((NSUInteger)3, cancelList.count);
+    for (dispatch_block_t cancel in cancelList) {
+        cancel();
+    }
+
+    XCTAssertEqual(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    NSArray *expected = @[@0, @1, @5, @6, @7];
+    XCTAssertEqualObjects(expected, log);
+    XCTAssertEqual(5, completedCount);
+}
+
+- (void)testRaiseLimit {
+    TLExecutorAdmission *admission = [[TLExecutorAdmission alloc] init];
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *log = [[NSMutableArray alloc] init];
+    [admission setLimit:1 withClass:[TLTestExecutor class]];
+    XCTAssertEqual(1, [admission limitWithClass:[TLTestExecutor class]]);
+    XCTAssertEqual(0, [admission limitWithClass:[TLOtherTestExecutor class]]);
+
+    dispatch_sync(queue, ^{
+        for (int i = 0; i < 4; i++) {
+            TLTestExecutor *executor = [[TLTestExecutor alloc] initWithAdmission:admission queue:queue log:log index:i];
+            [executor startWithPriority:TLExecutorPriorityNormal dispatchGroup:group];
+        }
+        XCTAssertEqual((NSUInteger)3, [admission waitingCountWithClass:[TLTestExecutor class]]);
+
+        // Removing the limit starts the waiting executors.
+        [admission setLimit:0 withClass:[TLTestExecutor class]];
+        XCTAssertEqual((NSUInteger)0, [admission waitingCountWithClass:[TLTestExecutor class]]);
+        XCTAssertEqual(4, [admission runningCountWithClass:[TLTestExecutor class]]);
+    });
+
+    XCTAssertEqual(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    XCTAssertEqual(4, completedCount);
+    XCTAssertEqual(4, maxRunningCount);
+}
+
+// The executors of a class without limit, a subclass of a limited class included, are not tracked.
+- (void)testUnlimitedClass {
+    TLExecutorAdmission *admission = [[TLExecutorAdmission alloc] init];
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *log = [[NSMutableArray alloc] init];
+    [admission setLimit:1 withClass:[TLTestExecutor class]];
+    XCTAssertEqualObjects(@[[TLTestExecutor class]], [admission limitedClasses]);
+
+    dispatch_sync(queue, ^{
+        for (int i = 0; i < EXECUTOR_LIMIT; i++) {
+            TLTestExecutor *executor = [[TLOtherTestExecutor alloc] initWithAdmission:admission queue:queue log:log index:i];
+            [executor startWithPriority:TLExecutorPriorityNormal dispatchGroup:group];
+        }
+        XCTAssertEqual((NSUInteger)EXECUTOR_LIMIT, log.count);
+        XCTAssertEqual(0, [admission runningCountWithClass:[TLOtherTestExecutor class]]);
+        XCTAssertEqual(0, [admission runningCountWithClass:[TLTestExecutor class]]);
+    });
+
+    XCTAssertEqual(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    XCTAssertEqual(EXECUTOR_LIMIT, completedCount);
+}
+
+@end
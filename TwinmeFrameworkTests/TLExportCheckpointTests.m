@@ -0,0 +1,269 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLExportExecutor.h"
+#import "TLExportCheckpoint.h"
+
+//
+// Interface: TLTestZipBuilder
+//
+
+/// Build a ZIP archive with stored entries as SSZipArchive writes it: the local entries, the central
+/// directory and the end records.  The entries keep their offset when an entry is added.
+@interface TLTestZipBuilder : NSObject
+
+@property (readonly, nonnull) NSMutableData *entries;
+@property (readonly, nonnull) NSMutableData *directory;
+@property (readonly) int count;
+@property BOOL zip64;
+
+- (void)addWithName:(nonnull NSString *)name content:(nonnull NSString *)content;
+
+- (nonnull NSData *)data;
+
+@end
+
+static void putLE16(NSMutableData *data, uint16_t value) {
+
+    uint8_t bytes[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+    [data appendBytes:bytes length:2];
+}
+
+static void putLE32(NSMutableData *data, uint32_t value) {
+
+    putLE16(data, (uint16_t)value);
+    putLE16(data, (uint16_t)(value >> 16));
+}
+
+static void putLE64(NSMutableData *data, uint64_t value) {
+
+    putLE32(data, (uint32_t)value);
+    putLE32(data, (uint32_t)(value >> 32));
+}
+
+@implementation TLTestZipBuilder
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _entries = [[NSMutableData alloc] init];
+        _directory = [[NSMutableData alloc] init];
+    }
+    return self;
+}
+
+- (void)addWithName:(nonnull NSString *)name content:(nonnull NSString *)content {
+
+    NSData *nameData = [name dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *contentData = [content dataUsingEncoding:NSUTF8StringEncoding];
+    uint32_t offset = (uint32_t)self.entries.length;
+    uint32_t crc = 0x12345678 + (uint32_t)self.count;
+
+    putLE32(self.entries, 0x04034b50);
+    putLE16(self.entries, 20);
+    putLE16(self.entries, 0);
+    putLE16(self.entries, 0);
+    putLE32(self.entries, 0);
+    putLE32(self.entries, crc);
+    putLE32(self.entries, (uint32_t)contentData.length);
+    putLE32(self.entries, (uint32_t)contentData.length);
+    putLE16(self.entries, (uint16_t)nameData.length);
+    putLE16(self.entries, 0);
+    [self.entries appendData:nameData];
+    [self.entries appendData:contentData];
+
+    putLE32(self.directory, 0x02014b50);
+    putLE16(self.directory, 20);
+    putLE16(self.directory, 20);
+    putLE16(self.directory, 0);
+    putLE16(self.directory, 0);
+    putLE32(self.directory, 0);
+    putLE32(self.directory, crc);
+    putLE32(self.directory, (uint32_t)contentData.length);
+    putLE32(self.directory, (uint32_t)contentData.length);
+    putLE16(self.directory, (uint16_t)nameData.length);
+    putLE16(self.directory, 0);
+    putLE16(self.directory, 0);
+    putLE16(self.directory, 0);
+    putLE16(self.directory, 0);
+    putLE32(self.directory, 0);
+    putLE32(self.directory, offset);
+    [self.directory appendData:nameData];
+    _count++;
+}
+
+- (nonnull NSData *)data {
+
+    NSMutableData *data = [[NSMutableData alloc] initWithData:self.entries];
+    uint64_t offset = self.entries.length;
+    [data appendData:self.directory];
+    if (self.zip64) {
+        uint64_t zip64Offset = data.length;
+        putLE32(data, 0x06064b50);
+        putLE64(data, 44);
+        putLE16(data, 45);
+        putLE16(data, 45);
+        putLE32(data, 0);
+        putLE32(data, 0);
+        putLE64(data, self.count);
+        putLE64(data, self.count);
+        putLE64(data, self.directory.length);
+        putLE64(data, offset);
+
+        putLE32(data, 0x07064b50);
+        putLE32(data, 0);
+        putLE64(data, zip64Offset);
+        putLE32(data, 1);
+    }
+    putLE32(data, 0x06054b50);
+    putLE16(data, 0);
+    putLE16(data, 0);
+    putLE16(data, self.zip64 ? 0xffff : (uint16_t)self.count);
+    putLE16(data, self.zip64 ? 0xffff : (uint16_t)self.count);
+    putLE32(data, self.zip64 ? 0xffffffff : (uint32_t)self.directory.length);
+    putLE32(data, self.zip64 ? 0xffffffff : (uint32_t)offset);
+    putLE16(data, 0);
+    return data;
+}
+
+@end
+
+@interface TLExportCheckpointTests : XCTestCase
+
+@property (nonnull) NSString *zipPath;
+
+@end
+
+@implementation TLExportCheckpointTests
+
+- (void)setUp {
+
+    NSString *dir = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [[NSFileManager defaultManager] createDirectoryAtPath:dir withIntermediateDirectories:YES attributes:nil error:nil];
+    self.zipPath = [dir stringByAppendingPathComponent:@"export.zip"];
+}
+
+- (void)tearDown {
+
+    [[NSFileManager defaultManager] removeItemAtPath:[self.zipPath stringByDeletingLastPathComponent] error:nil];
+}
+
+/// Simulate an export killed while it was writing an entry after the checkpoint: the central
+/// directory is replaced by a partial local entry.
+- (void)interruptWithBuilder:(nonnull TLTestZipBuilder *)builder {
+
+    NSMutableData *data = [[NSMutableData alloc] initWithData:builder.entries];
+    putLE32(data, 0x04034b50);
+    [data appendData:[@"partial entry" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertTrue([data writeToFile:self.zipPath atomically:NO]);
+}
+
+- (void)checkResumeWithZip64:(BOOL)zip64 {
+    NSString *signature = [TLExportCheckpoint signatureWithSelection:@"selection" password:nil];
+    NSUUID *first = [NSUUID UUID];
+    NSUUID *second = [NSUUID UUID];
+    TLTestZipBuilder *builder = [[TLTestZipBuilder alloc] init];
+    builder.zip64 = zip64;
+    [builder addWithName:@"John/" content:@""];
+    [builder addWithName:@"John/messages.txt" content:@"[Jan 1, 2025 at 10:00] John: Hello"];
+    XCTAssertTrue([[builder data] writeToFile:self.zipPath atomically:NO]);
+
+    TLExportCheckpoint *checkpoint = [[TLExportCheckpoint alloc] initWithZipPath:self.zipPath signature:signature];
+    TLExportStats *stats = [[TLExportStats alloc] init];
+    XCTAssertFalse([checkpoint restoreWithStats:stats]);
+    [checkpoint addWithConversationId:first];
+    stats.conversationCount = 1;
+    stats.msgCount = 1;
+    XCTAssertTrue([checkpoint saveWithStats:stats]);
+    XCTAssertEqual((uint64_t)builder.entries.length, checkpoint.centralDirectoryOffset);
+
+    // Second checkpoint: only the new central directory entries are read.
+    [builder addWithName:@"Paul/" content:@""];
+    [builder addWithName:@"Paul/messages.txt" content:@"[Jan 1, 2025 at 10:01] Paul: Hi"];
+    XCTAssertTrue([[builder data] writeToFile:self.zipPath atomically:NO]);
+    [checkpoint addWithConversationId:second];
+    stats.conversationCount = 2;
+    stats.msgCount = 2;
+    XCTAssertTrue([checkpoint saveWithStats:stats]);
+
+    [self interruptWithBuilder:builder];
+
+    TLExportCheckpoint *resumed = [[TLExportCheckpoint alloc] initWithZipPath:self.zipPath signature:signature];
+    TLExportStats *resumedStats = [[TLExportStats alloc] init];
+    XCTAssertTrue([resumed restoreWithStats:resumedStats]);
+    XCTAssertEqualObjects([builder data], [NSData dataWithContentsOfFile:self.zipPath]);
+    XCTAssertTrue([resumed isExportedWithConversationId:first]);
+    XCTAssertTrue([resumed isExportedWithConversationId:second]);
+    XCTAssertFalse([resumed isExportedWithConversationId:[NSUUID UUID]]);
+    XCTAssertEqual(2LL, resumedStats.conversationCount);
+    XCTAssertEqual(2LL, resumedStats.msgCount);
+
+    // The restored central directory is the base of the next checkpoint.
+    [builder addWithName:@"Zoe/" content:@""];
+    XCTAssertTrue([[builder data] writeToFile:self.zipPath atomically:NO]);
+    XCTAssertTrue([resumed saveWithStats:resumedStats]);
+    [self interruptWithBuilder:builder];
+    XCTAssertTrue([[[TLExportCheckpoint alloc] initWithZipPath:self.zipPath signature:signature] restoreWithStats:resumedStats]);
+    XCTAssertEqualObjects([builder data], [NSData dataWithContentsOfFile:self.zipPath]);
+}
+
+- (void)testResume {
+    [self checkResumeWithZip64:NO];
+}
+
+- (void)testResumeZip64 {
+    [self checkResumeWithZip64:YES];
+}
+
+- (void)testSignature {
+    NSString *signature = [TLExportCheckpoint signatureWithSelection:@"0:1,2:0\nA=John" password:@"secret"];
+
+    XCTAssertEqualObjects(signature, [TLExportCheckpoint signatureWithSelection:@"0:1,2:0\nA=John" password:@"secret"]);
+    XCTAssertNotEqualObjects(signature, [TLExportCheckpoint signatureWithSelection:@"0:1,2:0\nB=Paul" password:@"secret"]);
+    XCTAssertNotEqualObjects(signature, [TLExportCheckpoint signatureWithSelection:@"0:1,2:0\nA=John" password:@"other"]);
+    XCTAssertNotEqualObjects([TLExportCheckpoint signatureWithSelection:@"x" password:nil], [TLExportCheckpoint signatureWithSelection:@"x" password:@""]);
+    XCTAssertFalse([signature containsString:@"secret"]);
+}
+
+- (void)testSelectionChanged {
+    TLTestZipBuilder *builder = [[TLTestZipBuilder alloc] init];
+    [builder addWithName:@"John/" content:@""];
+    XCTAssertTrue([[builder data] writeToFile:self.zipPath atomically:NO]);
+    NSString *signature = [TLExportCheckpoint signatureWithSelection:@"A=John" password:@"secret"];
+    TLExportCheckpoint *checkpoint = [[TLExportCheckpoint alloc] initWithZipPath:self.zipPath signature:signature];
+    [checkpoint addWithConversationId:[NSUUID UUID]];
+    XCTAssertTrue([checkpoint saveWithStats:[[TLExportStats alloc] init]]);
+
+    // Another export to the same path does not resume and removes the manifest.
+    NSString *otherSignature = [TLExportCheckpoint signatureWithSelection:@"A=John\nB=Paul" password:@"secret"];
+    TLExportCheckpoint *other = [[TLExportCheckpoint alloc] initWithZipPath:self.zipPath signature:otherSignature];
+    XCTAssertFalse([other restoreWithStats:[[TLExportStats alloc] init]]);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:checkpoint.path]);
+}
+
+- (void)testTruncatedArchive {
+    TLTestZipBuilder *builder = [[TLTestZipBuilder alloc] init];
+    [builder addWithName:@"John/" content:@""];
+    [builder addWithName:@"John/messages.txt" content:@"[Jan 1, 2025 at 10:00] John: Hello"];
+    XCTAssertTrue([[builder data] writeToFile:self.zipPath atomically:NO]);
+    NSString *signature = [TLExportCheckpoint signatureWithSelection:@"A=John" password:nil];
+    TLExportCheckpoint *checkpoint = [[TLExportCheckpoint alloc] initWithZipPath:self.zipPath signature:signature];
+    [checkpoint addWithConversationId:[NSUUID UUID]];
+    XCTAssertTrue([checkpoint saveWithStats:[[TLExportStats alloc] init]]);
+
+    // The archive lost entries saved by the checkpoint: the export restarts from the beginning.
+    NSData *truncated = [builder.entries subdataWithRange:NSMakeRange(0, builder.entries.length - 4)];
+    XCTAssertTrue([truncated writeToFile:self.zipPath atomically:NO]);
+    XCTAssertFalse([[[TLExportCheckpoint alloc] initWithZipPath:self.zipPath signature:signature] restoreWithStats:[[TLExportStats alloc] init]]);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:checkpoint.path]);
+
+    // An archive without end of central directory cannot be checkpointed.
+    XCTAssertFalse([checkpoint saveWithStats:[[TLExportStats alloc] init]]);
+}
+
+@end
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+#import <zlib.h>
+
+#import "TLExportExecutor.h"
+#import "TLExporter.h"
+
+#define FILE_SIZE (4 * 1024 * 1024)
+
+@interface TLExportCompressionTests : XCTestCase
+
+@property (nonnull) NSString *dir;
+/// Mixed media of a conversation: photo, video, voice message, document and a text file.
+@property (nonnull) NSArray<NSArray *> *files;
+
+@end
+
+@implementation TLExportCompressionTests
+
+/// Content with the given number of distinct byte values (the entropy is log2(symbols) bits per byte).
+static NSData *contentWithSymbols(int symbols, NSUInteger length) {
+
+    NSMutableData *data = [[NSMutableData alloc] initWithLength:length];
+    uint8_t *bytes = data.mutableBytes;
+    arc4random_buf(bytes, length);
+    if (symbols < 256) {
+        for (NSUInteger i = 0; i < length; i++) {
+            bytes[i] = (uint8_t)(bytes[i] % symbols);
+        }
+    }
+    return data;
+}
+
+static NSData *textContent(NSUInteger length) {
+
+    NSMutableString *text = [[NSMutableString alloc] initWithCapacity:length];
+    int line = 0;
+    while (text.length < length) {
+        [text appendFormat:@"[Jan 1, 2025 at 10:%02d] John: message %d about the meeting of tomorrow\r\n", line % 60, line];
+        line++;
+    }
+    return [[text dataUsingEncoding:NSUTF8StringEncoding] subdataWithRange:NSMakeRange(0, length)];
+}
+
+- (nonnull NSString *)writeWithName:(nonnull NSString *)name data:(nonnull NSData *)data {
+
+    NSString *path = [self.dir stringByAppendingPathComponent:name];
+    XCTAssertTrue([data writeToFile:path atomically:NO]);
+    return path;
+}
+
+- (void)setUp {
+
+    self.dir = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [[NSFileManager defaultManager] createDirectoryAtPath:self.dir withIntermediateDirectories:YES attributes:nil error:nil];
+
+    // Type, path, extension and expected level.
+    self.files = @[
+        @[@(TLDescriptorTypeImageDescriptor), [self writeWithName:@"photo.jpg" data:contentWithSymbols(256, FILE_SIZE)], @"jpg", @(0)],
+        @[@(TLDescriptorTypeVideoDescriptor), [self writeWithName:@"video.mp4" data:contentWithSymbols(256, FILE_SIZE)], @"mp4", @(0)],
+        @[@(TLDescriptorTypeAudioDescriptor), [self writeWithName:@"voice.m4a" data:contentWithSymbols(256, FILE_SIZE / 4)], @"m4a", @(0)],
+        @[@(TLDescriptorTypeNamedFileDescriptor), [self writeWithName:@"archive.bin" data:contentWithSymbols(256, FILE_SIZE)], @"bin", @(0)],
+        @[@(TLDescriptorTypeNamedFileDescriptor), [self writeWithName:@"sensor.dat" data:contentWithSymbols(100, FILE_SIZE)], @"dat", @(Z_BEST_SPEED)],
+        @[@(TLDescriptorTypeImageDescriptor), [self writeWithName:@"drawing.raw" data:contentWithSymbols(8, FILE_SIZE)], @"raw", @(Z_BEST_SPEED)],
+        @[@(TLDescriptorTypeNamedFileDescriptor), [self writeWithName:@"notes.txt" data:textContent(FILE_SIZE)], @"TXT", @(Z_DEFAULT_COMPRESSION)]
+    ];
+}
+
+- (void)tearDown {
+
+    [[NSFileManager defaultManager] removeItemAtPath:self.dir error:nil];
+}
+
+- (void)testCompressionLevel {
+    for (NSArray *file in self.files) {
+        int level = [TLExporter compressionLevelWithType:(TLDescriptorType)[file[0] intValue] path:file[1] ext:file[2]];
+        XCTAssertEqual([file[3] intValue], level, @"%@", file[1]);
+    }
+
+    // The extension is enough for the compressed formats, an unreadable file is stored as is.
+    XCTAssertEqual(0, [TLExporter compressionLevelWithType:TLDescriptorTypeNamedFileDescriptor path:self.files.lastObject[1] ext:@"JPEG"]);
+    XCTAssertEqual(0, [TLExporter compressionLevelWithType:TLDescriptorTypeNamedFileDescriptor path:[self.dir stringByAppendingPathComponent:@"missing.txt"] ext:@"txt"]);
+    XCTAssertEqual(Z_DEFAULT_COMPRESSION, [TLExporter compressionLevelWithType:TLDescriptorTypeNamedFileDescriptor path:[self writeWithName:@"empty.txt" data:textContent(10)] ext:@"txt"]);
+}
+
+/// Compress the files as SSZipArchive does and return the archive size.
+- (uLong)compressWithLevels:(BOOL)chooseLevel {
+
+    uLong total = 0;
+    for (NSArray *file in self.files) {
+        int level = chooseLevel ? [TLExporter compressionLevelWithType:(TLDescriptorType)[file[0] intValue] path:file[1] ext:file[2]] : Z_DEFAULT_COMPRESSION;
+        NSData *data = [NSData dataWithContentsOfFile:file[1]];
+        if (level == 0) {
+            total += data.length;
+            continue;
+        }
+        uLong length = compressBound(data.length);
+        NSMutableData *output = [[NSMutableData alloc] initWithLength:length];
+        XCTAssertEqual(Z_OK, compress2(output.mutableBytes, &length, data.bytes, data.length, level));
+        total += length;
+    }
+    return total;
+}
+
+- (void)testChosenLevelsKeepArchiveSize {
+    uLong chosen = [self compressWithLevels:YES];
+    uLong deflated = [self compressWithLevels:NO];
+
+    // The incompressible media are stored: the archive is at most 5% larger than when everything is deflated.
+    XCTAssertGreaterThan(chosen, (uLong)0);
+    XCTAssertLessThanOrEqual(chosen, deflated + deflated / 20);
+}
+
+- (void)testMixedMediaPerformance {
+    [self measureBlock:^{
+        [self compressWithLevels:YES];
+    }];
+}
+
+// Baseline: every file deflated with the default level.
+- (void)testMixedMediaDeflatePerformance {
+    [self measureBlock:^{
+        [self compressWithLevels:NO];
+    }];
+}
+
+@end
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLExportExecutor.h"
+#import "TLExporter.h"
+
+@interface TLExportNamesTests : XCTestCase
+@end
+
+@implementation TLExportNamesTests
+
+- (void)testSpecialCharactersRemoved {
+    XCTAssertEqualObjects(@"John", [TLExportExecutor exportWithName:@"John"]);
+    XCTAssertEqualObjects(@"John Doe", [TLExportExecutor exportWithName:@"J|o\\h?n* <D\"o:e>/'"]);
+    XCTAssertEqualObjects(@"", [TLExportExecutor exportWithName:@"|\\?*<\":>/'"]);
+    XCTAssertEqualObjects(@"", [TLExportExecutor exportWithName:@""]);
+}
+
+- (void)testUnicodeNames {
+    // Non ASCII characters are never removed, including surrogate pairs and combining marks.
+    XCTAssertEqualObjects(@"Zoë", [TLExportExecutor exportWithName:@"Zoë"]);
+    XCTAssertEqualObjects(@"Zoë", [TLExportExecutor exportWithName:@"Zoë"]);
+    XCTAssertEqualObjects(@"😀 Smile", [TLExportExecutor exportWithName:@"😀 <Smile>"]);
+    XCTAssertEqualObjects(@"李小龙", [TLExportExecutor exportWithName:@"李/小/龙"]);
+
+    // Full width variants look like forbidden characters but are valid file name characters.
+    XCTAssertEqualObjects(@"a：b／c", [TLExportExecutor exportWithName:@"a：b／c"]);
+
+    // Long names go through the allocated buffer.
+    NSString *longName = [@"" stringByPaddingToLength:1000 withString:@"é/" startingAtIndex:0];
+    NSString *expected = [@"" stringByPaddingToLength:500 withString:@"é" startingAtIndex:0];
+    XCTAssertEqualObjects(expected, [TLExportExecutor exportWithName:longName]);
+}
+
+- (void)testDuplicateNames {
+    TLExportNames *names = [[TLExportNames alloc] init];
+
+    XCTAssertEqualObjects(@"John", [names uniqueNameWithName:@"John"]);
+    XCTAssertEqualObjects(@"John_1", [names uniqueNameWithName:@"John"]);
+    XCTAssertEqualObjects(@"John_2", [names uniqueNameWithName:@"J:ohn"]);
+    XCTAssertEqualObjects(@"Paul", [names uniqueNameWithName:@"Paul"]);
+}
+
+- (void)testDuplicateNamesWithCounterCollision {
+    TLExportNames *names = [[TLExportNames alloc] init];
+
+    XCTAssertEqualObjects(@"John_2", [names uniqueNameWithName:@"John_2"]);
+    XCTAssertEqualObjects(@"John", [names uniqueNameWithName:@"John"]);
+    XCTAssertEqualObjects(@"John_1", [names uniqueNameWithName:@"John"]);
+    XCTAssertEqualObjects(@"John_3", [names uniqueNameWithName:@"John"]);
+    XCTAssertEqualObjects(@"John_1_1", [names uniqueNameWithName:@"John_1"]);
+    XCTAssertEqualObjects(@"John_4", [names uniqueNameWithName:@"John"]);
+}
+
+static NSTimeInterval allocateNames(TLExportNames *names, int count) {
+
+    NSDate *start = [NSDate date];
+    for (int i = 0; i < count; i++) {
+        [names uniqueNameWithName:@"John"];
+    }
+    return -[start timeIntervalSinceNow];
+}
+
+- (void)testIdenticalNamesFlood {
+    TLExportNames *names = [[TLExportNames alloc] init];
+    NSMutableSet<NSString *> *allocated = [[NSMutableSet alloc] init];
+    const int count = 10000;
+
+    for (int i = 0; i < count; i++) {
+        NSString *name = [names uniqueNameWithName:@"John"];
+        NSString *expected = i == 0 ? @"John" : [NSString stringWithFormat:@"John_%d", i];
+
+        XCTAssertEqualObjects(expected, name);
+        [allocated addObject:name];
+    }
+    XCTAssertEqual((NSUInteger)count, allocated.count);
+
+    // The quadratic allocation took 16 times longer for 4 times more identical names: compare
+    // the two runs instead of a wall-clock limit that depends on the machine.
+    NSTimeInterval small = allocateNames([[TLExportNames alloc] init], count);
+    NSTimeInterval large = allocateNames([[TLExportNames alloc] init], 4 * count);
+    XCTAssertLessThan(large, 8 * small);
+}
+
+- (void)testIdenticalNamesPerformance {
+    [self measureBlock:^{
+        allocateNames([[TLExportNames alloc] init], 10000);
+    }];
+}
+
+@end
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLExportExecutor.h"
+#import "TLExporter.h"
+
+#define EVENT_COUNT 200000
+// Time spent by the scan on each message.
+#define EVENT_DURATION NSEC_PER_MSEC
+
+/// Private methods of the exporter called by its scan and export loops.
+@interface TLExporter (Testing)
+
+- (nonnull TLExportStats *)stats;
+
+- (void)reportProgress;
+
+@end
+
+//
+// Interface: TLTestExportDelegate
+//
+
+@interface TLTestExportDelegate : NSObject <TLExportDelegate>
+
+@property int progressCount;
+@property (nullable) TLExportStats *lastStats;
+@property TLExportState lastState;
+
+@end
+
+@implementation TLTestExportDelegate
+
+- (void)onProgressWithState:(TLExportState)state stats:(nonnull TLExportStats *)stats {
+
+    self.progressCount++;
+    self.lastState = state;
+    self.lastStats = stats;
+}
+
+- (void)onErrorWithMessage:(nonnull NSString *)message {
+}
+
+@end
+
+/// Exporter with a time which is advanced by the test.
+@interface TLTestProgressExporter : TLExporter
+
+@property uint64_t time;
+
+@end
+
+@implementation TLTestProgressExporter
+
+- (uint64_t)now {
+
+    return self.time;
+}
+
+@end
+
+@interface TLExportProgressTests : XCTestCase
+@end
+
+@implementation TLExportProgressTests
+
+- (void)assertStats:(nonnull TLExportStats *)stats equalTo:(nonnull TLExportStats *)expected {
+
+    for (NSString *key in @[@"conversationCount", @"imageCount", @"imageSize", @"videoCount", @"videoSize", @"fileCount", @"fileSize",
+                            @"audioCount", @"audioSize", @"msgCount", @"msgSize", @"totalSize", @"storedCount", @"fastCount", @"deflateCount"]) {
+        XCTAssertEqualObjects([expected valueForKey:key], [stats valueForKey:key], @"%@", key);
+    }
+}
+
+- (nonnull TLTestProgressExporter *)exporterWithDelegate:(nonnull TLTestExportDelegate *)delegate {
+
+    // The context is only used to get the conversation service which is not needed to report the progress.
+    TLTwinmeContext *twinmeContext = nil;
+    return [[TLTestProgressExporter alloc] initWithTwinmeContext:twinmeContext delegate:delegate dateFilter:0 typeFilter:nil statAllDescriptors:NO];
+}
+
+/// Run the same scan: each message takes EVENT_DURATION, updates the stats and asks to report the progress.
+- (void)scanWithExporter:(nonnull TLTestProgressExporter *)exporter throttled:(BOOL)throttled {
+
+    exporter.time = NSEC_PER_SEC;
+    [exporter updateWithState:TLExportStateScanning];
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        exporter.time += EVENT_DURATION;
+        exporter.stats.msgCount++;
+        exporter.stats.msgSize += i % 100;
+        if (i % 1000 == 0) {
+            exporter.stats.conversationCount++;
+        }
+        if (throttled) {
+            [exporter reportProgress];
+        } else {
+            [exporter updateWithState:TLExportStateExporting];
+        }
+    }
+    [exporter updateWithState:TLExportStateWait];
+}
+
+- (void)testThrottledProgress {
+    TLTestExportDelegate *throttledDelegate = [[TLTestExportDelegate alloc] init];
+    TLTestExportDelegate *delegate = [[TLTestExportDelegate alloc] init];
+
+    [self scanWithExporter:[self exporterWithDelegate:throttledDelegate] throttled:YES];
+    [self scanWithExporter:[self exporterWithDelegate:delegate] throttled:NO];
+
+    // One report every 100ms of the scan with the scanning and wait state changes.
+    int scanReports = (int)(EVENT_COUNT * EVENT_DURATION / (NSEC_PER_SEC / 10));
+    XCTAssertEqual(EVENT_COUNT + 2, delegate.progressCount);
+    XCTAssertEqual(scanReports + 2, throttledDelegate.progressCount);
+
+    // The final report has the exact stats.
+    XCTAssertEqual(TLExportStateWait, throttledDelegate.lastState);
+    XCTAssertEqual((int64_t)EVENT_COUNT, throttledDelegate.lastStats.msgCount);
+    [self assertStats:throttledDelegate.lastStats equalTo:delegate.lastStats];
+}
+
+- (void)testReportedStatsAreSnapshots {
+    TLTestExportDelegate *delegate = [[TLTestExportDelegate alloc] init];
+    TLExporter *exporter = [self exporterWithDelegate:delegate];
+
+    [exporter updateWithState:TLExportStateExporting];
+    TLExportStats *reported = delegate.lastStats;
+    exporter.stats.msgCount++;
+    XCTAssertEqual(0LL, reported.msgCount);
+    XCTAssertNotEqual(reported, exporter.stats);
+}
+
+@end
@@ -0,0 +1,325 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <SSZipArchive.h>
+
+#import "TLExportExecutor.h"
+#import "TLExporter.h"
+#import "TLExportCheckpoint.h"
+
+#define CONTACT_COUNT 8
+#define MAX_MESSAGE_COUNT 35
+#define TRIAL_COUNT 20
+
+// Jan 1, 2025 at 10:00 in milliseconds.
+#define FIRST_MESSAGE_DATE 1735725600000LL
+
+//
+// Contact, conversation, descriptor and conversation service with only the methods used by TLExporter.
+//
+
+@interface TLTestResumeContact : NSObject
+
+@property (nonnull) NSUUID *uuid;
+@property (nonnull) NSUUID *twincodeOutboundId;
+@property (nonnull) NSUUID *peerTwincodeOutboundId;
+@property (nonnull) NSString *identityName;
+@property (nonnull) NSString *name;
+@property (nullable) id space;
+
+@end
+
+@implementation TLTestResumeContact
+
+- (nonnull NSUUID *)objectId {
+
+    return self.uuid;
+}
+
+@end
+
+@interface TLTestResumeConversation : NSObject
+
+@property (nonnull) NSUUID *twincodeOutboundId;
+@property (nonnull) NSArray *descriptors;
+
+@end
+
+@implementation TLTestResumeConversation
+@end
+
+@interface TLTestResumeDescriptorId : NSObject
+
+@property (nonnull) NSUUID *twincodeOutboundId;
+@property int64_t sequenceId;
+
+@end
+
+@implementation TLTestResumeDescriptorId
+@end
+
+@interface TLTestResumeDescriptor : NSObject
+
+@property (nonnull) TLTestResumeDescriptorId *descriptorId;
+@property (nonnull) NSString *message;
+@property int64_t createdTimestamp;
+@property int64_t deletedTimestamp;
+@property int64_t expireTimeout;
+
+@end
+
+@implementation TLTestResumeDescriptor
+
+- (BOOL)isExpired {
+
+    return NO;
+}
+
+- (BOOL)copyAllowed {
+
+    return YES;
+}
+
+@end
+
+/// The conversation service kills the export by raising an exception when it is called for the killAt time.
+@interface TLTestResumeService : NSObject
+
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, TLTestResumeConversation *> *conversations;
+@property int calls;
+@property int killAt;
+
+@end
+
+@implementation TLTestResumeService
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _conversations = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (nullable id)getConversationWithSubject:(nonnull TLTestResumeContact *)subject {
+
+    return self.conversations[subject.objectId];
+}
+
+- (nullable NSArray *)getDescriptorsWithConversation:(nonnull TLTestResumeConversation *)conversation descriptorType:(TLDescriptorType)descriptorType callsMode:(TLDisplayCallsMode)callsMode beforeTimestamp:(int64_t)beforeTimestamp maxDescriptors:(int)maxDescriptors {
+
+    if (++self.calls == self.killAt) {
+        @throw [NSException exceptionWithName:@"TLTestResumeKill" reason:@"export killed" userInfo:nil];
+    }
+
+    // The descriptors are sorted from the newest to the oldest.
+    NSMutableArray *result = [[NSMutableArray alloc] initWithCapacity:maxDescriptors];
+    for (TLTestResumeDescriptor *descriptor in conversation.descriptors) {
+        if (descriptor.createdTimestamp < beforeTimestamp && result.count < maxDescriptors) {
+            [result addObject:descriptor];
+        }
+    }
+    return result;
+}
+
+@end
+
+@interface TLTestResumeContext : NSObject
+
+@property (nonnull) TLTestResumeService *conversationService;
+
+@end
+
+@implementation TLTestResumeContext
+
+- (nonnull TLTestResumeService *)getConversationService {
+
+    return self.conversationService;
+}
+
+@end
+
+@interface TLTestResumeDelegate : NSObject <TLExportDelegate>
+
+@property (nullable) TLExportStats *lastStats;
+@property (nullable) NSString *error;
+
+@end
+
+@implementation TLTestResumeDelegate
+
+- (void)onProgressWithState:(TLExportState)state stats:(nonnull TLExportStats *)stats {
+
+    self.lastStats = stats;
+}
+
+- (void)onErrorWithMessage:(nonnull NSString *)message {
+
+    self.error = message;
+}
+
+@end
+
+@interface TLExportResumeTests : XCTestCase
+
+@property (nonnull) NSString *dir;
+@property (nonnull) TLTestResumeContext *context;
+@property (nonnull) NSMutableArray<TLContact *> *contacts;
+
+@end
+
+@implementation TLExportResumeTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.dir = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [[NSFileManager defaultManager] createDirectoryAtPath:self.dir withIntermediateDirectories:YES attributes:nil error:nil];
+
+    self.context = [[TLTestResumeContext alloc] init];
+    self.context.conversationService = [[TLTestResumeService alloc] init];
+    self.contacts = [[NSMutableArray alloc] initWithCapacity:CONTACT_COUNT];
+    srand48(28);
+    for (int i = 0; i < CONTACT_COUNT; i++) {
+        TLTestResumeContact *contact = [[TLTestResumeContact alloc] init];
+        contact.uuid = [NSUUID UUID];
+        contact.twincodeOutboundId = [NSUUID UUID];
+        contact.peerTwincodeOutboundId = [NSUUID UUID];
+        contact.identityName = @"Me";
+        contact.name = [NSString stringWithFormat:@"Contact %d", i];
+
+        TLTestResumeConversation *conversation = [[TLTestResumeConversation alloc] init];
+        conversation.twincodeOutboundId = contact.twincodeOutboundId;
+        NSMutableArray *descriptors = [[NSMutableArray alloc] init];
+        int count = 1 + (int)(drand48() * MAX_MESSAGE_COUNT);
+        for (int j = count; j > 0; j--) {
+            TLTestResumeDescriptor *descriptor = [[TLTestResumeDescriptor alloc] init];
+            descriptor.descriptorId = [[TLTestResumeDescriptorId alloc] init];
+            descriptor.descriptorId.twincodeOutboundId = (j % 3) ? contact.peerTwincodeOutboundId : contact.twincodeOutboundId;
+            descriptor.descriptorId.sequenceId = j;
+            descriptor.createdTimestamp = FIRST_MESSAGE_DATE + j * 60000LL;
+            descriptor.message = [NSString stringWithFormat:@"Message %d of %@", j, contact.name];
+            [descriptors addObject:descriptor];
+        }
+        conversation.descriptors = descriptors;
+        self.context.conversationService.conversations[contact.uuid] = conversation;
+        [self.contacts addObject:(TLContact *)contact];
+    }
+}
+
+- (void)tearDown {
+
+    [[NSFileManager defaultManager] removeItemAtPath:self.dir error:nil];
+    [super tearDown];
+}
+
+/// Run the export as TLExportExecutor does with a checkpoint after each conversation.
+///
+/// @return the final stats or nil when the export was killed while exporting.
+- (nullable TLExportStats *)exportWithPath:(nonnull NSString *)path killAt:(int)killAt {
+
+    TLTestResumeService *service = self.context.conversationService;
+    TLTestResumeDelegate *delegate = [[TLTestResumeDelegate alloc] init];
+    TLExporter *exporter = [[TLExporter alloc] initWithTwinmeContext:(TLTwinmeContext *)self.context delegate:delegate dateFilter:INT64_MAX typeFilter:@[@(TLDescriptorTypeObjectDescriptor)] statAllDescriptors:NO];
+    exporter.checkpointMaxSize = 0;
+    exporter.checkpointMaxDelay = 0;
+
+    service.killAt = 0;
+    [exporter updateWithState:TLExportStateScanning];
+    [exporter exportWithContacts:self.contacts members:@{}];
+    [exporter updateWithState:TLExportStateExporting];
+    [exporter createZipWithPath:path password:nil];
+
+    service.calls = 0;
+    service.killAt = killAt;
+    @try {
+        [exporter exportWithContacts:self.contacts members:@{}];
+    } @catch (NSException *exception) {
+        // The process is killed: the archive is neither closed nor checkpointed.
+        return nil;
+    }
+    [exporter closeZip];
+    [exporter updateWithState:TLExportStateDone];
+    XCTAssertNil(delegate.error);
+    return delegate.lastStats;
+}
+
+/// Read the number of entries from the end of central directory record (there is no archive comment).
+- (int)entryCountWithPath:(nonnull NSString *)path {
+
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    XCTAssertGreaterThanOrEqual(data.length, (NSUInteger)22);
+    const uint8_t *end = (const uint8_t *)data.bytes + data.length - 22;
+    XCTAssertEqual(0x06054b50, end[0] | (end[1] << 8) | (end[2] << 16) | ((uint32_t)end[3] << 24));
+    return end[10] | (end[11] << 8);
+}
+
+/// Extract the archive and get the content of each entry.
+- (nonnull NSDictionary<NSString *, NSData *> *)entriesWithPath:(nonnull NSString *)path {
+
+    NSString *dest = [path stringByAppendingString:@".d"];
+    XCTAssertTrue([SSZipArchive unzipFileAtPath:path toDestination:dest]);
+
+    NSMutableDictionary<NSString *, NSData *> *entries = [[NSMutableDictionary alloc] init];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    for (NSString *name in [fileManager subpathsOfDirectoryAtPath:dest error:nil]) {
+        BOOL isDirectory;
+        NSString *file = [dest stringByAppendingPathComponent:name];
+        if ([fileManager fileExistsAtPath:file isDirectory:&isDirectory] && isDirectory) {
+            entries[name] = [NSData data];
+        } else {
+            entries[name] = [NSData dataWithContentsOfFile:file];
+        }
+    }
+    return entries;
+}
+
+- (void)assertStats:(nonnull TLExportStats *)stats equalTo:(nonnull TLExportStats *)expected trial:(int)trial {
+
+    for (NSString *key in @[@"conversationCount", @"imageCount", @"imageSize", @"videoCount", @"videoSize", @"fileCount", @"fileSize",
+                            @"audioCount", @"audioSize", @"msgCount", @"msgSize", @"totalSize", @"storedCount", @"fastCount", @"deflateCount"]) {
+        XCTAssertEqualObjects([expected valueForKey:key], [stats valueForKey:key], @"trial %d: %@", trial, key);
+    }
+}
+
+// Kill the export at a random point one or two times, resume it and compare the archive with
+// an uninterrupted export entry for entry.
+- (void)testKillAndResume {
+    NSString *expectedPath = [self.dir stringByAppendingPathComponent:@"expected.zip"];
+    TLExportStats *expectedStats = [self exportWithPath:expectedPath killAt:0];
+    XCTAssertNotNil(expectedStats);
+    int callCount = self.context.conversationService.calls;
+    int expectedCount = [self entryCountWithPath:expectedPath];
+    NSDictionary<NSString *, NSData *> *expected = [self entriesWithPath:expectedPath];
+    XCTAssertEqual(2 * CONTACT_COUNT, expectedCount);
+    XCTAssertEqual((NSUInteger)expectedCount, expected.count);
+
+    srand48(280);
+    for (int trial = 0; trial < TRIAL_COUNT; trial++) {
+        NSString *path = [self.dir stringByAppendingPathComponent:[NSString stringWithFormat:@"export-%d.zip", trial]];
+        int killCount = 1 + trial % 2;
+
+        // The first export is always killed, the resumed one has less calls and it may complete.
+        TLExportStats *stats = nil;
+        for (int i = 0; i < killCount && !stats; i++) {
+            stats = [self exportWithPath:path killAt:1 + (int)(drand48() * callCount)];
+            XCTAssertTrue(i > 0 || !stats, @"trial %d", trial);
+        }
+        if (!stats) {
+            stats = [self exportWithPath:path killAt:0];
+        }
+
+        XCTAssertNotNil(stats, @"trial %d", trial);
+        [self assertStats:stats equalTo:expectedStats trial:trial];
+        XCTAssertEqual(expectedCount, [self entryCountWithPath:path], @"trial %d", trial);
+        XCTAssertEqualObjects(expected, [self entriesWithPath:path], @"trial %d", trial);
+        XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[[TLExportCheckpoint alloc] initWithZipPath:path signature:@""].path]);
+    }
+}
+
+@end
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLExporter.h"
+
+#define MESSAGE_COUNT 500000
+#define MESSAGE_INTERVAL_MS 7000L
+
+@interface TLExportTranscriptTests : XCTestCase
+@end
+
+@implementation TLExportTranscriptTests
+
+static NSString *expectedLine(int64_t date, NSString *text) {
+
+    NSDate *d = [[NSDate alloc] initWithTimeIntervalSince1970:date / 1000L];
+    NSString *localizedDateTime = [NSDateFormatter localizedStringFromDate:d dateStyle:NSDateFormatterMediumStyle timeStyle:NSDateFormatterShortStyle];
+    return [NSString stringWithFormat:@"[%@] %@\r\n", localizedDateTime, text];
+}
+
+- (void)testSameOutputAsLocalizedString {
+    TLExportTranscript *transcript = [[TLExportTranscript alloc] init];
+    NSMutableString *expected = [[NSMutableString alloc] init];
+    int64_t date = 1700000000000L;
+    NSArray<NSString *> *texts = @[@"John: Hello", @"Zoë: 😀 é", @"李: 你好", @"John: ", [@"" stringByPaddingToLength:5000 withString:@"abcé" startingAtIndex:0]];
+
+    for (NSString *text in texts) {
+        [transcript appendWithDate:date text:text];
+        [expected appendString:expectedLine(date, text)];
+        date += 20000L;
+    }
+    XCTAssertEqualObjects([expected dataUsingEncoding:NSUTF8StringEncoding], transcript.data);
+
+    [transcript reset];
+    XCTAssertEqual((NSUInteger)0, transcript.data.length);
+}
+
+// A lone surrogate, for example from a message truncated in the middle of an emoji, is replaced
+// and the rest of the message is kept.
+- (void)testLoneSurrogate {
+    TLExportTranscript *transcript = [[TLExportTranscript alloc] init];
+    unichar highFirst[] = { 'a', 0xD83D, 'b', 'c' };
+    unichar lowOnly[] = { 0xDE00, 'x' };
+    unichar highLast[] = { 'y', 0xD83D };
+    NSString *texts[] = {
+        [NSString stringWithCharacters:highFirst length:4],
+        [NSString stringWithCharacters:lowOnly length:2],
+        [NSString stringWithCharacters:highLast length:2],
+    };
+    NSString *replaced[] = { @"a�bc", @"�x", @"y�" };
+    NSMutableString *expected = [[NSMutableString alloc] init];
+
+    for (int i = 0; i < 3; i++) {
+        [transcript appendWithDate:0 text:texts[i]];
+        [expected appendString:expectedLine(0, replaced[i])];
+    }
+
+    // The surrogate is also replaced after the first chunk of a long text.
+    NSString *longText = [[@"" stringByPaddingToLength:3000 withString:@"é" startingAtIndex:0] stringByAppendingString:texts[0]];
+    [transcript appendWithDate:0 text:longText];
+    [expected appendString:expectedLine(0, [[@"" stringByPaddingToLength:3000 withString:@"é" startingAtIndex:0] stringByAppendingString:replaced[0]])];
+
+    XCTAssertEqualObjects([expected dataUsingEncoding:NSUTF8StringEncoding], transcript.data);
+}
+
+// Transcript of a conversation with 500k messages, one message every 7 seconds.
+- (void)testLargeConversationPerformance {
+    NSMutableArray<NSString *> *texts = [[NSMutableArray alloc] initWithCapacity:MESSAGE_COUNT];
+    for (int i = 0; i < MESSAGE_COUNT; i++) {
+        [texts addObject:[NSString stringWithFormat:@"%@: message %d with some text é", (i % 2) ? @"John" : @"Zoë", i]];
+    }
+    TLExportTranscript *transcript = [[TLExportTranscript alloc] init];
+
+    void (^build)(void) = ^{
+        int64_t date = 1700000000000L;
+        for (NSString *text in texts) {
+            [transcript appendWithDate:date text:text];
+            date += MESSAGE_INTERVAL_MS;
+        }
+        [transcript reset];
+    };
+    if (@available(iOS 13.0, *)) {
+        [self measureWithMetrics:@[[[XCTClockMetric alloc] init], [[XCTMemoryMetric alloc] init]] block:build];
+    } else {
+        [self measureBlock:build];
+    }
+}
+
+@end
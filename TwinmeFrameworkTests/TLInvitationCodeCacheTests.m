@@ -0,0 +1,387 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <Twinlife/TLTwincodeOutboundService.h>
+
+#import "TLInvitationCodeCache.h"
+#import "TLGetInvitationCodeExecutor.h"
+#import "TLTestService.h"
+
+#define CODE_COUNT 20
+#define LOOKUP_COUNT 1000
+#define SERVER_LATENCY 0.005
+
+/// Cache with a time which is advanced by the test.
+@interface TLTestInvitationCodeCache : TLInvitationCodeCache
+
+@property NSTimeInterval time;
+
+@end
+
+@implementation TLTestInvitationCodeCache
+
+- (NSTimeInterval)now {
+
+    @synchronized (self) {
+        return self.time;
+    }
+}
+
+@end
+
+@interface TLTestInvitationCodeTwincode : NSObject
+
+@property (nonnull) NSUUID *uuid;
+
+@end
+
+@implementation TLTestInvitationCodeTwincode
+@end
+
+/// Twinme context with the invitation code cache and the twincode outbound service used by TLGetInvitationCodeExecutor.
+@interface TLTestInvitationCodeContext : NSObject
+
+@property (readonly, nonnull) TLTestService *service;
+@property (readonly, nonnull) TLInvitationCodeCache *invitationCodeCache;
+@property (readonly, nonnull) NSDictionary<NSString *, TLTestInvitationCodeTwincode *> *twincodes;
+@property (readonly, nonnull) NSMutableDictionary<NSNumber *, TLTestInvitationCodeTwincode *> *results;
+@property (readonly, nonnull) NSMutableDictionary<NSNumber *, NSNumber *> *errors;
+@property (nullable) XCTestExpectation *finished;
+
+- (nonnull instancetype)initWithService:(nonnull TLTestService *)service twincodes:(nonnull NSDictionary<NSString *, TLTestInvitationCodeTwincode *> *)twincodes;
+
+@end
+
+@implementation TLTestInvitationCodeContext
+
+- (nonnull instancetype)initWithService:(nonnull TLTestService *)service twincodes:(nonnull NSDictionary<NSString *, TLTestInvitationCodeTwincode *> *)twincodes {
+
+    self = [super init];
+    if (self) {
+        _service = service;
+        _twincodes = twincodes;
+        _invitationCodeCache = [[TLInvitationCodeCache alloc] initWithCapacity:4 ttl:60 negativeTtl:60];
+        _results = [[NSMutableDictionary alloc] init];
+        _errors = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (nonnull id)getTwincodeOutboundService {
+
+    return self;
+}
+
+- (void)admitWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+
+    start();
+}
+
+- (void)releaseWithExecutor:(nonnull id)executor {
+}
+
+/// The action is started while we are connected to the server as addDelegate does.
+- (void)startActionWithAction:(nonnull TLTwinmeAction *)action {
+
+    dispatch_async(self.service.queue, ^{
+        [action onTwinlifeOnline];
+    });
+}
+
+- (void)finishActionWithAction:(nonnull TLTwinmeAction *)action {
+
+    [self.finished fulfill];
+}
+
+- (void)fireOnErrorWithRequestId:(int64_t)requestId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(nullable NSString *)errorParameter {
+
+    self.errors[[NSNumber numberWithLongLong:requestId]] = [NSNumber numberWithInt:errorCode];
+}
+
+- (void)onGetInvitationCodeWithRequestId:(int64_t)requestId twincodeOutbound:(nonnull TLTestInvitationCodeTwincode *)twincodeOutbound publicKey:(nullable NSString *)publicKey {
+
+    NSNumber *key = [NSNumber numberWithLongLong:requestId];
+    if (self.results[key]) {
+        self.errors[key] = [NSNumber numberWithInt:TLBaseServiceErrorCodeBadRequest];
+    }
+    self.results[key] = twincodeOutbound;
+}
+
+- (void)getInvitationCodeWithCode:(nonnull NSString *)code withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLTwincodeOutbound *twincodeOutbound, NSString *publicKey))block {
+
+    [self.service requestWithKey:code complete:^(TLBaseServiceErrorCode errorCode) {
+        TLTestInvitationCodeTwincode *twincode = errorCode == TLBaseServiceErrorCodeSuccess ? self.twincodes[code] : nil;
+        block(twincode ? errorCode : TLBaseServiceErrorCodeItemNotFound, (TLTwincodeOutbound *)twincode, twincode ? code : nil);
+    }];
+}
+
+@end
+
+@interface TLInvitationCodeCacheTests : XCTestCase
+@end
+
+@implementation TLInvitationCodeCacheTests
+
+static NSString *codeName(int i) {
+
+    return [NSString stringWithFormat:@"CODE%04d", i];
+}
+
+/// The server knows the codes of the dictionary, the other codes are unknown.
+static TLTestService *newService(NSDictionary<NSString *, NSUUID *> *codes, int count) {
+
+    TLTestService *service = [[TLTestService alloc] initWithQueue:dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL) latency:SERVER_LATENCY];
+    for (int i = 0; i < count; i++) {
+        if (!codes[codeName(i)]) {
+            [service failWithKey:codeName(i) errorCode:TLBaseServiceErrorCodeItemNotFound count:-1];
+        }
+    }
+    return service;
+}
+
+/// Resolve the code through the cache as the TLGetInvitationCodeExecutor does.
+static void resolve(TLTestService *service, NSDictionary<NSString *, NSUUID *> *codes, TLInvitationCodeCache *cache, NSString *code, TLInvitationCodeBlock block) {
+
+    TLInvitationCodeResolution *resolution = [cache resolveWithCode:code block:block];
+    if (!resolution) {
+        return;
+    }
+    [service requestWithKey:code complete:^(TLBaseServiceErrorCode errorCode) {
+        NSUUID *twincodeId = errorCode == TLBaseServiceErrorCodeSuccess ? codes[code] : nil;
+        [cache completeWithResolution:resolution errorCode:errorCode twincode:twincodeId twincodeId:twincodeId publicKey:twincodeId ? code : nil];
+    }];
+}
+
+// Invitation previews resolve the same codes while the user re-scans them: half of the codes are unknown.
+- (void)testRepeatedLookups {
+    NSMutableDictionary<NSString *, NSUUID *> *codes = [[NSMutableDictionary alloc] init];
+    for (int i = 0; i < CODE_COUNT; i += 2) {
+        codes[codeName(i)] = [NSUUID UUID];
+    }
+    TLTestService *service = newService(codes, CODE_COUNT);
+    TLInvitationCodeCache *cache = [[TLInvitationCodeCache alloc] initWithCapacity:CODE_COUNT ttl:60 negativeTtl:60];
+    dispatch_group_t group = dispatch_group_create();
+    __block int errors = 0;
+
+    for (int round = 0; round < 2; round++) {
+        dispatch_apply(LOOKUP_COUNT, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+            NSString *code = codeName((int)(iteration % CODE_COUNT));
+            NSUUID *expected = codes[code];
+            dispatch_group_enter(group);
+            resolve(service, codes, cache, code, ^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+                BOOL valid = expected ? (errorCode == TLBaseServiceErrorCodeSuccess && twincode == expected && [code isEqualToString:publicKey])
+                                      : (errorCode == TLBaseServiceErrorCodeItemNotFound && !twincode);
+                if (!valid) {
+                    @synchronized (service) {
+                        errors++;
+                    }
+                }
+                dispatch_group_leave(group);
+            });
+        });
+        XCTAssertEqual(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    }
+
+    // The concurrent lookups are merged and the second round is answered by the cache.
+    XCTAssertEqual(0, errors);
+    XCTAssertEqual((NSUInteger)CODE_COUNT, service.requests.count);
+    XCTAssertEqual((NSUInteger)CODE_COUNT, cache.count);
+}
+
+- (void)testExpiration {
+    NSString *known = codeName(1);
+    NSString *unknown = codeName(2);
+    NSDictionary<NSString *, NSUUID *> *codes = @{ known: [NSUUID UUID] };
+    TLTestService *service = newService(codes, 3);
+    TLTestInvitationCodeCache *cache = [[TLTestInvitationCodeCache alloc] initWithCapacity:4 ttl:30 negativeTtl:10];
+    cache.time = 1000;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"resolved"];
+    expectation.expectedFulfillmentCount = 2;
+    resolve(service, codes, cache, known, ^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        XCTAssertEqual(TLBaseServiceErrorCodeSuccess, errorCode);
+        [expectation fulfill];
+    });
+    resolve(service, codes, cache, unknown, ^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        XCTAssertEqual(TLBaseServiceErrorCodeItemNotFound, errorCode);
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    XCTAssertEqual((NSUInteger)2, service.requests.count);
+
+    // The codes are kept until their expiration.
+    cache.time = 1009.9;
+    XCTAssertNil([cache resolveWithCode:unknown block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {}]);
+
+    // The unknown code expires first, a server error is not cached.
+    cache.time = 1010;
+    __block TLBaseServiceErrorCode result = TLBaseServiceErrorCodeSuccess;
+    XCTAssertNil([cache resolveWithCode:known block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {}]);
+    TLInvitationCodeResolution *resolution = [cache resolveWithCode:unknown block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        result = errorCode;
+    }];
+    XCTAssertNotNil(resolution);
+    [cache completeWithResolution:resolution errorCode:TLBaseServiceErrorCodeTwinlifeOffline twincode:nil twincodeId:nil publicKey:nil];
+    XCTAssertEqual(TLBaseServiceErrorCodeTwinlifeOffline, result);
+    XCTAssertEqual((NSUInteger)1, cache.count);
+
+    cache.time = 1030;
+    XCTAssertNotNil([cache resolveWithCode:known block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {}]);
+    XCTAssertEqual((NSUInteger)0, cache.count);
+}
+
+- (void)testInvalidation {
+    TLInvitationCodeCache *cache = [[TLInvitationCodeCache alloc] initWithCapacity:3 ttl:60 negativeTtl:60];
+    NSUUID *twincodeId = [NSUUID UUID];
+    NSUUID *otherTwincodeId = [NSUUID UUID];
+    TLInvitationCodeBlock ignore = ^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {};
+
+    for (int i = 0; i < 3; i++) {
+        TLInvitationCodeResolution *resolution = [cache resolveWithCode:codeName(i) block:ignore];
+        XCTAssertNotNil(resolution);
+        [cache completeWithResolution:resolution errorCode:TLBaseServiceErrorCodeSuccess twincode:twincodeId twincodeId:i == 0 ? otherTwincodeId : twincodeId publicKey:nil];
+    }
+    XCTAssertEqual((NSUInteger)3, cache.count);
+
+    // The least recently used code is dropped when the cache is full.
+    XCTAssertNil([cache resolveWithCode:codeName(0) block:ignore]);
+    TLInvitationCodeResolution *resolution = [cache resolveWithCode:codeName(3) block:ignore];
+    XCTAssertNotNil(resolution);
+    [cache completeWithResolution:resolution errorCode:TLBaseServiceErrorCodeItemNotFound twincode:nil twincodeId:nil publicKey:nil];
+    XCTAssertEqual((NSUInteger)3, cache.count);
+    resolution = [cache resolveWithCode:codeName(1) block:ignore];
+    XCTAssertNotNil(resolution);
+
+    // The invitation code is created: a negative entry is removed.
+    [cache invalidateWithCode:codeName(3)];
+    XCTAssertEqual((NSUInteger)2, cache.count);
+
+    // The invitation is deleted: the codes resolved to its twincode are removed.
+    [cache completeWithResolution:resolution errorCode:TLBaseServiceErrorCodeSuccess twincode:twincodeId twincodeId:twincodeId publicKey:nil];
+    XCTAssertEqual((NSUInteger)3, cache.count);
+    [cache invalidateWithTwincodeId:twincodeId];
+    XCTAssertEqual((NSUInteger)1, cache.count);
+    XCTAssertNil([cache resolveWithCode:codeName(0) block:ignore]);
+
+    // A resolution invalidated while in progress is given to the callers but not cached.
+    __block int calls = 0;
+    resolution = [cache resolveWithCode:codeName(4) block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        calls++;
+    }];
+    XCTAssertNotNil(resolution);
+    XCTAssertNil([cache resolveWithCode:codeName(4) block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        calls++;
+    }]);
+    [cache invalidateWithCode:codeName(4)];
+    [cache completeWithResolution:resolution errorCode:TLBaseServiceErrorCodeSuccess twincode:twincodeId twincodeId:twincodeId publicKey:nil];
+    XCTAssertEqual(2, calls);
+    XCTAssertEqual((NSUInteger)1, cache.count);
+
+    [cache removeAll];
+    XCTAssertEqual((NSUInteger)0, cache.count);
+}
+
+// The invitation is deleted while one of its codes is being resolved: the twincode is known only
+// when the resolution completes and it must not be cached.
+- (void)testInvalidateTwincodeInProgress {
+    TLInvitationCodeCache *cache = [[TLInvitationCodeCache alloc] initWithCapacity:3 ttl:60 negativeTtl:60];
+    NSUUID *twincodeId = [NSUUID UUID];
+    NSUUID *otherTwincodeId = [NSUUID UUID];
+    __block int calls = 0;
+    TLInvitationCodeBlock count = ^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        calls++;
+    };
+
+    TLInvitationCodeResolution *deleted = [cache resolveWithCode:codeName(0) block:count];
+    TLInvitationCodeResolution *other = [cache resolveWithCode:codeName(1) block:count];
+    XCTAssertNotNil(deleted);
+    XCTAssertNotNil(other);
+    [cache invalidateWithTwincodeId:twincodeId];
+    [cache completeWithResolution:deleted errorCode:TLBaseServiceErrorCodeSuccess twincode:twincodeId twincodeId:twincodeId publicKey:nil];
+    [cache completeWithResolution:other errorCode:TLBaseServiceErrorCodeSuccess twincode:otherTwincodeId twincodeId:otherTwincodeId publicKey:nil];
+
+    // Only the code of the other twincode is cached.
+    XCTAssertEqual(2, calls);
+    XCTAssertEqual((NSUInteger)1, cache.count);
+    XCTAssertNotNil([cache resolveWithCode:codeName(0) block:count]);
+    XCTAssertNil([cache resolveWithCode:codeName(1) block:count]);
+    XCTAssertEqual(3, calls);
+}
+
+// The cache is cleared while a code is being resolved: the code is resolved again by the next caller
+// and the late completion of the first resolution is given to its callers only.
+- (void)testRemoveAllInProgress {
+    TLInvitationCodeCache *cache = [[TLInvitationCodeCache alloc] initWithCapacity:3 ttl:60 negativeTtl:60];
+    NSUUID *twincodeId = [NSUUID UUID];
+    __block int firstCalls = 0;
+    __block int secondCalls = 0;
+
+    TLInvitationCodeResolution *first = [cache resolveWithCode:codeName(0) block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        firstCalls++;
+    }];
+    XCTAssertNotNil(first);
+    [cache removeAll];
+
+    TLInvitationCodeResolution *second = [cache resolveWithCode:codeName(0) block:^(TLBaseServiceErrorCode errorCode, id twincode, NSString *publicKey) {
+        secondCalls++;
+    }];
+    XCTAssertNotNil(second);
+    XCTAssertNotEqual(first, second);
+
+    [cache completeWithResolution:first errorCode:TLBaseServiceErrorCodeSuccess twincode:twincodeId twincodeId:twincodeId publicKey:nil];
+    XCTAssertEqual(1, firstCalls);
+    XCTAssertEqual(0, secondCalls);
+    XCTAssertEqual((NSUInteger)0, cache.count);
+
+    [cache completeWithResolution:second errorCode:TLBaseServiceErrorCodeSuccess twincode:twincodeId twincodeId:twincodeId publicKey:nil];
+    XCTAssertEqual(1, firstCalls);
+    XCTAssertEqual(1, secondCalls);
+    XCTAssertEqual((NSUInteger)1, cache.count);
+}
+
+// Several executors get the same codes: the cached results are given synchronously from onOperation
+// and each executor must report its result once.
+- (void)testGetInvitationCodeExecutor {
+    NSString *known = codeName(1);
+    NSString *unknown = codeName(2);
+    TLTestInvitationCodeTwincode *twincode = [[TLTestInvitationCodeTwincode alloc] init];
+    twincode.uuid = [NSUUID UUID];
+    TLTestService *service = newService(@{}, 0);
+    TLTestInvitationCodeContext *context = [[TLTestInvitationCodeContext alloc] initWithService:service twincodes:@{ known: twincode }];
+
+    // Two executors resolve each code concurrently, then two more get them from the cache.
+    for (int round = 0; round < 2; round++) {
+        context.finished = [self expectationWithDescription:@"finished"];
+        context.finished.expectedFulfillmentCount = 4;
+        NSMutableArray<TLGetInvitationCodeExecutor *> *executors = [[NSMutableArray alloc] initWithCapacity:4];
+        for (int i = 0; i < 4; i++) {
+            int64_t requestId = round * 4 + i;
+            [executors addObject:[[TLGetInvitationCodeExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context requestId:requestId code:i % 2 ? unknown : known]];
+        }
+        dispatch_async(service.queue, ^{
+            for (TLGetInvitationCodeExecutor *executor in executors) {
+                [executor start];
+            }
+        });
+        [self waitForExpectationsWithTimeout:10 handler:nil];
+        dispatch_sync(service.queue, ^{});
+    }
+
+    XCTAssertEqual((NSUInteger)1, [service countWithKey:known]);
+    XCTAssertEqual((NSUInteger)1, [service countWithKey:unknown]);
+    for (int64_t requestId = 0; requestId < 8; requestId++) {
+        NSNumber *key = [NSNumber numberWithLongLong:requestId];
+        if (requestId % 2) {
+            XCTAssertNil(context.results[key], @"request %lld", requestId);
+            XCTAssertEqualObjects([NSNumber numberWithInt:TLBaseServiceErrorCodeItemNotFound], context.errors[key], @"request %lld", requestId);
+        } else {
+            XCTAssertEqual(twincode, context.results[key], @"request %lld", requestId);
+            XCTAssertNil(context.errors[key], @"request %lld", requestId);
+        }
+    }
+}
+
+@end
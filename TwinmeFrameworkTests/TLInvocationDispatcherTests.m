@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLTwinmeContextImpl.h"
+#import "TLInvocationDispatcher.h"
+#import "TLProfile.h"
+#import "TLInvitation.h"
+#import "TLContact.h"
+#import "TLGroup.h"
+#import "TLSpace.h"
+#import "TLCallReceiver.h"
+#import "TLAccountMigration.h"
+#import "TLPairInviteInvocation.h"
+#import "TLPairBindInvocation.h"
+#import "TLPairUnbindInvocation.h"
+#import "TLPairRefreshInvocation.h"
+#import "TLGroupRegisteredInvocation.h"
+
+@interface TLInvocationDispatcherTests : XCTestCase
+@end
+
+@implementation TLInvocationDispatcherTests
+
+- (void)testBackgroundMatrix {
+    TLInvocationDispatcher *dispatcher = [TLTwinmeContext invocationDispatcher];
+    NSArray<Class> *receivers = @[ [TLProfile class], [TLInvitation class], [TLContact class], [TLGroup class],
+                                   [TLAccountMigration class], [TLCallReceiver class], [TLSpace class] ];
+    NSArray<Class> *invocations = @[ [TLPairInviteInvocation class], [TLPairBindInvocation class], [TLPairUnbindInvocation class],
+                                     [TLPairRefreshInvocation class], [TLGroupRegisteredInvocation class] ];
+
+    // Every pair that is not listed must be rejected.
+    NSDictionary<NSString *, NSString *> *expect = @{
+        @"TLProfile/TLPairInviteInvocation": @"profile.pair-invite",
+        @"TLInvitation/TLPairInviteInvocation": @"invitation.pair-invite",
+        @"TLContact/TLPairBindInvocation": @"contact.pair-bind",
+        @"TLContact/TLPairUnbindInvocation": @"contact.pair-unbind",
+        @"TLContact/TLPairRefreshInvocation": @"contact.pair-refresh",
+        @"TLGroup/TLGroupRegisteredInvocation": @"group.registered",
+        @"TLGroup/TLPairRefreshInvocation": @"group.pair-refresh",
+        @"TLAccountMigration/TLPairInviteInvocation": @"account-migration.pair-invite",
+        @"TLAccountMigration/TLPairUnbindInvocation": @"account-migration.pair-unbind"
+    };
+
+    for (Class receiverClass in receivers) {
+        for (Class invocationClass in invocations) {
+            NSString *key = [NSString stringWithFormat:@"%@/%@", NSStringFromClass(receiverClass), NSStringFromClass(invocationClass)];
+            TLInvocationHandler *handler = [dispatcher handlerWithReceiverClass:receiverClass invocationClass:invocationClass];
+
+            XCTAssertEqualObjects(expect[key], handler.name, @"handler for %@", key);
+        }
+    }
+
+    // The dispatch uses the exact class: the base invocation class is rejected.
+    XCTAssertNil([dispatcher handlerWithReceiverClass:[TLContact class] invocationClass:[TLInvocation class]]);
+}
+
+- (void)testForegroundMatrix {
+    TLInvocationDispatcher *dispatcher = [TLTwinmeContext invocationDispatcher];
+
+    XCTAssertEqualObjects(@"profile.update", [dispatcher handlerWithReceiverClass:[TLProfile class]].name);
+    XCTAssertEqualObjects(@"contact.update", [dispatcher handlerWithReceiverClass:[TLContact class]].name);
+    XCTAssertNil([dispatcher handlerWithReceiverClass:[TLInvitation class]]);
+    XCTAssertNil([dispatcher handlerWithReceiverClass:[TLGroup class]]);
+    XCTAssertNil([dispatcher handlerWithReceiverClass:[TLAccountMigration class]]);
+    XCTAssertNil([dispatcher handlerWithReceiverClass:[TLCallReceiver class]]);
+    XCTAssertNil([dispatcher handlerWithReceiverClass:[TLSpace class]]);
+}
+
+- (void)testHandlers {
+    TLInvocationDispatcher *dispatcher = [TLTwinmeContext invocationDispatcher];
+
+    NSMutableSet<NSString *> *names = [[NSMutableSet alloc] init];
+    for (TLInvocationHandler *handler in dispatcher.handlers) {
+        XCTAssertFalse([names containsObject:handler.name], @"duplicate handler %@", handler.name);
+        [names addObject:handler.name];
+    }
+    XCTAssertEqual((NSUInteger)11, names.count);
+}
+
+@end
@@ -0,0 +1,231 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLInvocationReplayScheduler.h"
+#import "TLExecutorAdmission.h"
+#import "TLProcessInvocationExecutor.h"
+#import "TLPairProtocol.h"
+
+#define BACKLOG_SIZE 5000
+#define WINDOW 16
+#define SLICE_SIZE 4
+
+//
+// Twincode invocation and twinme context with only the methods used by TLProcessInvocationExecutor.
+//
+
+@interface TLTestInvocation : NSObject
+
+@property (nonnull) NSUUID *invocationId;
+@property (nonnull) id subject;
+@property (nonnull) NSString *action;
+@property (nullable) NSArray *attributes;
+@property (nullable) NSData *publicKey;
+
+@end
+
+@implementation TLTestInvocation
+@end
+
+@interface TLTestInvocationContext : NSObject
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly, nonnull) TLExecutorAdmission *admission;
+@property (readonly, nonnull) NSMutableArray *running;
+
+@end
+
+@implementation TLTestInvocationContext
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue limit:(int)limit {
+
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _admission = [[TLExecutorAdmission alloc] init];
+        [_admission setLimit:limit withClass:[TLProcessInvocationExecutor class]];
+        _running = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)admitWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+
+    [self.admission submitWithExecutor:executor priority:TLExecutorPriorityNormal start:start cancel:cancel];
+}
+
+- (void)releaseWithExecutor:(nonnull id)executor {
+
+    dispatch_block_t start = [self.admission releaseWithExecutor:executor];
+    if (start) {
+        dispatch_async(self.queue, start);
+    }
+}
+
+/// The admitted executors wait for the server and are retained until they are removed.
+- (void)addDelegate:(nonnull id)executor {
+
+    [self.running addObject:executor];
+}
+
+- (void)removeDelegate:(nonnull id)executor {
+
+    [self.running removeObject:executor];
+}
+
+- (int64_t)newRequestId {
+
+    return 1;
+}
+
+- (void)fireOnErrorWithRequestId:(int64_t)requestId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(nullable NSString *)errorParameter {
+}
+
+@end
+
+@interface TLInvocationReplaySchedulerTests : XCTestCase
+@end
+
+@implementation TLInvocationReplaySchedulerTests
+
+- (void)testPriority {
+    dispatch_queue_t queue = dispatch_queue_create("replayQueue", DISPATCH_QUEUE_SERIAL);
+    TLInvocationReplayScheduler *scheduler = [[TLInvocationReplayScheduler alloc] initWithQueue:queue window:2 sliceSize:1];
+    NSMutableArray<NSNumber *> *order = [[NSMutableArray alloc] init];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"drained"];
+
+    // Block the queue while the backlog is received.
+    dispatch_semaphore_t received = dispatch_semaphore_create(0);
+    dispatch_async(queue, ^{
+        dispatch_semaphore_wait(received, DISPATCH_TIME_FOREVER);
+    });
+    for (int i = 0; i < 20; i++) {
+        TLInvocationReplayPriority priority = (i % 5) == 4 ? TLInvocationReplayPriorityHigh : TLInvocationReplayPriorityNormal;
+        [scheduler addJobWithPriority:priority job:^(dispatch_block_t completion) {
+            [order addObject:[NSNumber numberWithInt:priority]];
+            XCTAssertLessThanOrEqual(scheduler.runningCount, 2);
+            if (order.count == 20) {
+                [expectation fulfill];
+            }
+            dispatch_async(queue, completion);
+        }];
+    }
+    dispatch_semaphore_signal(received);
+
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    for (int i = 0; i < 20; i++) {
+        XCTAssertEqual(i < 4 ? TLInvocationReplayPriorityHigh : TLInvocationReplayPriorityNormal, order[i].intValue, @"job %d", i);
+    }
+}
+
+- (void)testReset {
+    dispatch_queue_t queue = dispatch_queue_create("replayQueue", DISPATCH_QUEUE_SERIAL);
+    TLInvocationReplayScheduler *scheduler = [[TLInvocationReplayScheduler alloc] initWithQueue:queue window:1 sliceSize:1];
+    __block dispatch_block_t pending = nil;
+
+    for (int i = 0; i < 3; i++) {
+        [scheduler addJobWithPriority:TLInvocationReplayPriorityNormal job:^(dispatch_block_t completion) {
+            pending = completion;
+        }];
+    }
+    dispatch_sync(queue, ^{});
+    XCTAssertEqual(1, scheduler.runningCount);
+    XCTAssertEqual((NSUInteger)2, scheduler.pendingCount);
+
+    [scheduler reset];
+    XCTAssertEqual(0, scheduler.runningCount);
+    XCTAssertEqual((NSUInteger)0, scheduler.pendingCount);
+
+    // A job started before the reset must not release a slot.
+    dispatch_sync(queue, pending);
+    XCTAssertEqual(0, scheduler.runningCount);
+}
+
+// Backlog of 5k invocations: every slice starts at most SLICE_SIZE invocations in their order and the answers
+// posted on the queue by a slice are handled before the next slice starts.
+- (void)testSliceYielding {
+    dispatch_queue_t queue = dispatch_queue_create("replayQueue", DISPATCH_QUEUE_SERIAL);
+    TLInvocationReplayScheduler *scheduler = [[TLInvocationReplayScheduler alloc] initWithQueue:queue window:WINDOW sliceSize:SLICE_SIZE];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"drained"];
+    __block int started = 0;
+    __block int done = 0;
+    __block int errors = 0;
+
+    for (int i = 0; i < BACKLOG_SIZE; i++) {
+        [scheduler addJobWithPriority:TLInvocationReplayPriorityNormal job:^(dispatch_block_t completion) {
+            if (started != i || scheduler.runningCount > WINDOW) {
+                errors++;
+            }
+            started++;
+
+            // The server answer is queued behind the other blocks of the queue.
+            dispatch_async(queue, ^{
+                if (started > (i / SLICE_SIZE + 1) * SLICE_SIZE) {
+                    errors++;
+                }
+                completion();
+                if (++done == BACKLOG_SIZE) {
+                    [expectation fulfill];
+                }
+            });
+        }];
+    }
+
+    [self waitForExpectationsWithTimeout:60 handler:nil];
+    dispatch_sync(queue, ^{});
+    XCTAssertEqual(0, errors);
+    XCTAssertEqual(0, scheduler.runningCount);
+    XCTAssertEqual((NSUInteger)0, scheduler.pendingCount);
+}
+
+- (nonnull TLProcessInvocationExecutor *)newExecutorWithContext:(nonnull TLTestInvocationContext *)context errorCodes:(nonnull NSMutableArray<NSNumber *> *)errorCodes completion:(nonnull dispatch_block_t)completion {
+
+    TLTestInvocation *invocation = [[TLTestInvocation alloc] init];
+    invocation.invocationId = [NSUUID UUID];
+    invocation.subject = [[NSObject alloc] init];
+    invocation.action = [TLPairProtocol ACTION_PAIR_UNBIND];
+    return [[TLProcessInvocationExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context invocation:(TLTwincodeInvocation *)invocation withBlock:^(TLBaseServiceErrorCode errorCode, TLInvocation *newInvocation) {
+        [errorCodes addObject:[NSNumber numberWithInt:errorCode]];
+        completion();
+    }];
+}
+
+// An invocation executor canceled while it waits for admission must give its replay slot back.
+- (void)testCanceledExecutor {
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    TLInvocationReplayScheduler *scheduler = [[TLInvocationReplayScheduler alloc] initWithQueue:queue window:2 sliceSize:2];
+    TLTestInvocationContext *context = [[TLTestInvocationContext alloc] initWithQueue:queue limit:1];
+    NSMutableArray<NSNumber *> *errorCodes = [[NSMutableArray alloc] init];
+
+    for (int i = 0; i < 3; i++) {
+        [scheduler addJobWithPriority:TLInvocationReplayPriorityNormal job:^(dispatch_block_t completion) {
+            [[self newExecutorWithContext:context errorCodes:errorCodes completion:completion] start];
+        }];
+    }
+    dispatch_sync(queue, ^{});
+    XCTAssertEqual(2, scheduler.runningCount);
+    XCTAssertEqual((NSUInteger)1, context.running.count);
+    XCTAssertEqual((NSUInteger)1, [context.admission waitingCountWithClass:[TLProcessInvocationExecutor class]]);
+
+    // Cancel the executor which waits for admission as the sign out does.
+    dispatch_sync(queue, ^{
+        for (dispatch_block_t cancel in [context.admission cancelWithClass:[TLProcessInvocationExecutor class]]) {
+            cancel();
+        }
+    });
+    dispatch_sync(queue, ^{});
+    XCTAssertEqual((NSUInteger)1, errorCodes.count);
+    XCTAssertEqual(TLBaseServiceErrorCodeCanceledOperation, errorCodes.firstObject.intValue);
+
+    // The released slot is used by the third invocation which waits behind the running one.
+    XCTAssertEqual(2, scheduler.runningCount);
+    XCTAssertEqual((NSUInteger)0, scheduler.pendingCount);
+    XCTAssertEqual((NSUInteger)1, context.running.count);
+    XCTAssertEqual((NSUInteger)1, [context.admission waitingCountWithClass:[TLProcessInvocationExecutor class]]);
+}
+
+@end
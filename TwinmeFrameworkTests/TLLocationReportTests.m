@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLReportStatsExecutor.h"
+
+// Size of a location record in the file.
+#define RECORD_SIZE 40
+#define MAX_RECORDS 64
+#define LOCATION_COUNT 1000
+
+@interface TLLocationReportTests : XCTestCase
+
+@property (nonnull) NSString *path;
+
+@end
+
+@implementation TLLocationReportTests
+
+static NSString *expectedReport(int64_t timestamp, double longitude, double latitude, double altitude) {
+
+    return [NSString stringWithFormat:@"%lld:%f:%f:%f", timestamp, longitude, latitude, altitude];
+}
+
+static void removePreferences(void) {
+
+    NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+    for (NSString *key in @[@"locationTimestamp", @"longitude", @"latitude", @"altitude"]) {
+        [userDefaults removeObjectForKey:key];
+    }
+}
+
+- (unsigned long long)fileSize {
+
+    return [[[NSFileManager defaultManager] attributesOfItemAtPath:self.path error:nil] fileSize];
+}
+
+- (void)setUp {
+
+    self.path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [TLLocationReport setPath:self.path];
+    removePreferences();
+}
+
+- (void)tearDown {
+
+    [TLLocationReport setPath:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:self.path error:nil];
+    removePreferences();
+}
+
+- (void)testRecordAndReload {
+    XCTAssertNil([TLLocationReport report]);
+
+    [TLLocationReport recordWithTimestamp:1000 longitude:2.35 latitude:48.85 altitude:35.0];
+    [TLLocationReport recordWithTimestamp:2000 longitude:2.36 latitude:48.86 altitude:36.0];
+    XCTAssertEqualObjects(expectedReport(2000, 2.36, 48.86, 36.0), [TLLocationReport report]);
+
+    // Only the last location is written and a second flush has nothing to write.
+    XCTAssertTrue([TLLocationReport flush]);
+    XCTAssertFalse([TLLocationReport flush]);
+    XCTAssertEqual((unsigned long long)RECORD_SIZE, [self fileSize]);
+
+    [TLLocationReport setPath:self.path];
+    XCTAssertEqualObjects(expectedReport(2000, 2.36, 48.86, 36.0), [TLLocationReport report]);
+}
+
+// A kill during the append leaves a truncated record: the previous record is reported.
+- (void)testTruncatedRecord {
+    [TLLocationReport recordWithTimestamp:1000 longitude:1.0 latitude:2.0 altitude:3.0];
+    XCTAssertTrue([TLLocationReport flush]);
+    [TLLocationReport recordWithTimestamp:2000 longitude:4.0 latitude:5.0 altitude:6.0];
+    XCTAssertTrue([TLLocationReport flush]);
+
+    NSFileHandle *file = [NSFileHandle fileHandleForWritingAtPath:self.path];
+    [file truncateFileAtOffset:2 * RECORD_SIZE - 13];
+    [file closeFile];
+
+    [TLLocationReport setPath:self.path];
+    XCTAssertEqualObjects(expectedReport(1000, 1.0, 2.0, 3.0), [TLLocationReport report]);
+
+    // The next write replaces the file ending with the partial record.
+    [TLLocationReport recordWithTimestamp:3000 longitude:7.0 latitude:8.0 altitude:9.0];
+    XCTAssertTrue([TLLocationReport flush]);
+    XCTAssertEqual((unsigned long long)RECORD_SIZE, [self fileSize]);
+
+    [TLLocationReport setPath:self.path];
+    XCTAssertEqualObjects(expectedReport(3000, 7.0, 8.0, 9.0), [TLLocationReport report]);
+}
+
+// A torn write has the record size but not its content: the checksum rejects it.
+- (void)testTornRecord {
+    [TLLocationReport recordWithTimestamp:1000 longitude:1.0 latitude:2.0 altitude:3.0];
+    XCTAssertTrue([TLLocationReport flush]);
+    [TLLocationReport recordWithTimestamp:2000 longitude:4.0 latitude:5.0 altitude:6.0];
+    XCTAssertTrue([TLLocationReport flush]);
+
+    NSMutableData *content = [NSMutableData dataWithContentsOfFile:self.path];
+    memset((uint8_t *)content.mutableBytes + RECORD_SIZE + RECORD_SIZE / 2, 0, RECORD_SIZE / 2);
+    XCTAssertTrue([content writeToFile:self.path atomically:NO]);
+
+    [TLLocationReport setPath:self.path];
+    XCTAssertEqualObjects(expectedReport(1000, 1.0, 2.0, 3.0), [TLLocationReport report]);
+
+    // Nothing valid in the file.
+    memset(content.mutableBytes, 0xff, RECORD_SIZE);
+    XCTAssertTrue([content writeToFile:self.path atomically:NO]);
+    [TLLocationReport setPath:self.path];
+    XCTAssertNil([TLLocationReport report]);
+}
+
+- (void)testCompaction {
+    for (int i = 1; i <= MAX_RECORDS; i++) {
+        [TLLocationReport recordWithTimestamp:i longitude:i latitude:i altitude:i];
+        XCTAssertTrue([TLLocationReport flush]);
+    }
+    XCTAssertEqual((unsigned long long)(MAX_RECORDS * RECORD_SIZE), [self fileSize]);
+
+    [TLLocationReport recordWithTimestamp:100 longitude:1.0 latitude:1.0 altitude:1.0];
+    XCTAssertTrue([TLLocationReport flush]);
+    XCTAssertEqual((unsigned long long)RECORD_SIZE, [self fileSize]);
+
+    [TLLocationReport setPath:self.path];
+    XCTAssertEqualObjects(expectedReport(100, 1.0, 1.0, 1.0), [TLLocationReport report]);
+}
+
+// The location saved by a previous version is moved to the file and the user defaults are cleared.
+- (void)testMigration {
+    NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+    [userDefaults setObject:@(5000LL) forKey:@"locationTimestamp"];
+    [userDefaults setObject:@(2.5) forKey:@"longitude"];
+    [userDefaults setObject:@(45.5) forKey:@"latitude"];
+    [userDefaults setObject:@(120.0) forKey:@"altitude"];
+
+    XCTAssertEqualObjects(expectedReport(5000, 2.5, 45.5, 120.0), [TLLocationReport report]);
+    XCTAssertEqual((unsigned long long)RECORD_SIZE, [self fileSize]);
+    XCTAssertNil([userDefaults objectForKey:@"locationTimestamp"]);
+    XCTAssertNil([userDefaults objectForKey:@"altitude"]);
+
+    [TLLocationReport setPath:self.path];
+    XCTAssertEqualObjects(expectedReport(5000, 2.5, 45.5, 120.0), [TLLocationReport report]);
+}
+
+// Live location sharing: each location written to the file.
+- (void)testRecordPerformance {
+    [self measureBlock:^{
+        for (int i = 0; i < LOCATION_COUNT; i++) {
+            [TLLocationReport recordWithTimestamp:i longitude:2.35 latitude:48.85 altitude:35.0];
+            [TLLocationReport flush];
+        }
+    }];
+}
+
+// Baseline: each location saved in the user defaults as done by the previous versions.
+- (void)testPreferencesPerformance {
+    NSUserDefaults *userDefaults = [NSUserDefaults standardUserDefaults];
+    [self measureBlock:^{
+        for (int i = 0; i < LOCATION_COUNT; i++) {
+            [userDefaults setObject:[[NSNumber alloc] initWithLongLong:i] forKey:@"locationTimestamp"];
+            [userDefaults setObject:[[NSNumber alloc] initWithDouble:2.35] forKey:@"longitude"];
+            [userDefaults setObject:[[NSNumber alloc] initWithDouble:48.85] forKey:@"latitude"];
+            [userDefaults setObject:[[NSNumber alloc] initWithDouble:35.0] forKey:@"altitude"];
+            [userDefaults synchronize];
+        }
+    }];
+}
+
+@end
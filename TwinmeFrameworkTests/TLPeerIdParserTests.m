@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLPeerIdParser.h"
+
+@interface TLPeerIdParserTests : XCTestCase
+@end
+
+@implementation TLPeerIdParserTests
+
+// The parsing made by onIncomingPeerConnectionWithPeerConnectionId before the TLPeerIdParser.
+static TLPeerIdStatus splitPeerId(NSString *peerId, NSUUID **twincodeInboundId, NSUUID **callingUserTwincodeId) {
+
+    *twincodeInboundId = nil;
+    *callingUserTwincodeId = nil;
+    NSArray<NSString *> *items = [peerId componentsSeparatedByString:@"@"];
+    if (items.count != 2 || ![items[1] hasPrefix:@"inbound.twincode.twinlife"]) {
+        return TLPeerIdStatusInvalid;
+    }
+    *twincodeInboundId = [[NSUUID alloc] initWithUUIDString:items[0]];
+    if (!*twincodeInboundId) {
+        return TLPeerIdStatusBadTwincode;
+    }
+    NSArray<NSString *> *domainAndResource = [items[1] componentsSeparatedByString:@"/"];
+    if (domainAndResource.count == 2) {
+        *callingUserTwincodeId = [[NSUUID alloc] initWithUUIDString:domainAndResource[1]];
+    }
+    return TLPeerIdStatusSuccess;
+}
+
+- (void)checkPeerId:(NSString *)peerId {
+
+    NSUUID *expectInboundId, *expectCallingId;
+    TLPeerIdStatus expect = splitPeerId(peerId, &expectInboundId, &expectCallingId);
+
+    TLPeerIdInfo info;
+    TLPeerIdStatus status = [TLPeerIdParser parseWithPeerId:peerId info:&info];
+    XCTAssertEqual(expect, status, @"status for %@", peerId);
+    if (status != TLPeerIdStatusSuccess || expect != TLPeerIdStatusSuccess) {
+        return;
+    }
+
+    XCTAssertEqualObjects(expectInboundId, [[NSUUID alloc] initWithUUIDBytes:info.twincodeInboundId], @"inbound for %@", peerId);
+    XCTAssertEqual(expectCallingId != nil, info.hasCallingUserTwincodeId, @"calling user for %@", peerId);
+    if (expectCallingId && info.hasCallingUserTwincodeId) {
+        XCTAssertEqualObjects(expectCallingId, [[NSUUID alloc] initWithUUIDBytes:info.callingUserTwincodeId], @"calling user for %@", peerId);
+    }
+}
+
+- (void)testValidPeerIds {
+    NSString *inbound = @"8f3c2a61-5b0e-4d7a-9c1e-2f6b7a8d9e01";
+    NSString *calling = @"D7E5E971-2813-4418-AD23-D9DE2E1D085F";
+
+    TLPeerIdInfo info;
+    XCTAssertEqual(TLPeerIdStatusSuccess, [TLPeerIdParser parseWithPeerId:[NSString stringWithFormat:@"%@@inbound.twincode.twinlife", inbound] info:&info]);
+    XCTAssertEqualObjects([[NSUUID alloc] initWithUUIDString:inbound], [[NSUUID alloc] initWithUUIDBytes:info.twincodeInboundId]);
+    XCTAssertFalse(info.hasCallingUserTwincodeId);
+
+    XCTAssertEqual(TLPeerIdStatusSuccess, [TLPeerIdParser parseWithPeerId:[NSString stringWithFormat:@"%@@inbound.twincode.twinlife/%@", inbound, calling] info:&info]);
+    XCTAssertTrue(info.hasCallingUserTwincodeId);
+    XCTAssertEqualObjects([[NSUUID alloc] initWithUUIDString:calling], [[NSUUID alloc] initWithUUIDBytes:info.callingUserTwincodeId]);
+
+    [self checkPeerId:[NSString stringWithFormat:@"%@@inbound.twincode.twinlife.example.org/%@", inbound, calling]];
+    [self checkPeerId:[NSString stringWithFormat:@"%@@inbound.twincode.twinlife/%@/x", inbound, calling]];
+    [self checkPeerId:[NSString stringWithFormat:@"%@@inbound.twincode.twinlife/bad", inbound]];
+}
+
+- (void)testInvalidPeerIds {
+    NSString *inbound = @"8f3c2a61-5b0e-4d7a-9c1e-2f6b7a8d9e01";
+
+    [self checkPeerId:@""];
+    [self checkPeerId:@"@"];
+    [self checkPeerId:inbound];
+    [self checkPeerId:[NSString stringWithFormat:@"%@@outbound.twincode.twinlife", inbound]];
+    [self checkPeerId:[NSString stringWithFormat:@"%@@inbound.twincode.twinlife@x", inbound]];
+    [self checkPeerId:@"8f3c2a61-5b0e-4d7a-9c1e-2f6b7a8d9e0@inbound.twincode.twinlife"];
+    [self checkPeerId:@"8f3c2a61x5b0e-4d7a-9c1e-2f6b7a8d9e01@inbound.twincode.twinlife"];
+    [self checkPeerId:@"8f3c2a61-5b0e-4d7a-9c1e-2f6b7a8d9g01@inbound.twincode.twinlife"];
+    [self checkPeerId:@"8f3c2a61-5b0e-4d7a-9c1e-2f6b7a8d9e01é@inbound.twincode.twinlife"];
+    [self checkPeerId:[NSString stringWithFormat:@"%@@inbound.twincode.twinlif", inbound]];
+}
+
+- (void)testFuzzAgainstSplit {
+    NSArray<NSString *> *parts = @[ @"8f3c2a61-5b0e-4d7a-9c1e-2f6b7a8d9e01", @"D7E5E971-2813-4418-AD23-D9DE2E1D085F",
+                                    @"@", @"/", @"inbound.twincode.twinlife", @"outbound", @"-", @"0", @"a", @"F", @"g",
+                                    @"é", @"😀", @" ", @"." ];
+    srand48(42);
+    for (int i = 0; i < 100000; i++) {
+        NSMutableString *peerId = [[NSMutableString alloc] init];
+        int count = (int)(drand48() * 6);
+        for (int j = 0; j < count; j++) {
+            [peerId appendString:parts[(NSUInteger)(drand48() * parts.count)]];
+        }
+
+        // Mutate one character of a well formed peer id from time to time.
+        if (count == 0) {
+            [peerId appendFormat:@"%@@inbound.twincode.twinlife/%@", parts[0], parts[1]];
+            NSUInteger pos = (NSUInteger)(drand48() * peerId.length);
+            [peerId replaceCharactersInRange:NSMakeRange(pos, 1) withString:parts[(NSUInteger)(drand48() * parts.count)]];
+        }
+        [self checkPeerId:peerId];
+    }
+}
+
+- (void)testParsePerformance {
+    NSString *peerId = @"8f3c2a61-5b0e-4d7a-9c1e-2f6b7a8d9e01@inbound.twincode.twinlife/D7E5E971-2813-4418-AD23-D9DE2E1D085F";
+
+    [self measureBlock:^{
+        TLPeerIdInfo info;
+        for (int i = 0; i < 1000000; i++) {
+            [TLPeerIdParser parseWithPeerId:peerId info:&info];
+        }
+    }];
+}
+
+@end
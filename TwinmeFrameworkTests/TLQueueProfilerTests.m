@@ -0,0 +1,179 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <mach/mach_time.h>
+
+#import "TLQueueProfiler.h"
+
+#define FAST_COUNT 50
+#define SLOW_BLOCK_US 50000
+#define OVERHEAD_COUNT 2000
+// Duration of a typical block of the twinlife queue (a database query or an executor step)
+// and the maximum overhead of the profiler on such a block.
+#define BLOCK_DURATION_US 100
+#define MAX_OVERHEAD_PERCENT 1.0
+#define LABEL_COUNT 1000
+
+@interface TLQueueProfilerTests : XCTestCase
+@end
+
+@implementation TLQueueProfilerTests
+
+- (void)testHistogram {
+    TLLatencyHistogram *histogram = [[TLLatencyHistogram alloc] init];
+    for (int64_t value = 1; value <= 100000; value++) {
+        [histogram recordValue:value];
+    }
+
+    XCTAssertEqual(100000LL, histogram.count);
+    XCTAssertEqual(100000LL, histogram.maxValue);
+    XCTAssertEqual(100000LL * 100001LL / 2, histogram.totalValue);
+    XCTAssertEqualWithAccuracy(50000, [histogram valueAtPercentile:50], 50000 * 0.03);
+    XCTAssertEqualWithAccuracy(99000, [histogram valueAtPercentile:99], 99000 * 0.03);
+    XCTAssertEqual(100000LL, [histogram valueAtPercentile:100]);
+    XCTAssertEqual(1LL, [histogram valueAtPercentile:0]);
+
+    // Small values are exact and large values are bounded.
+    TLLatencyHistogram *small = [[TLLatencyHistogram alloc] init];
+    [small recordValue:7];
+    [small recordValue:-1];
+    [small recordValue:INT64_MAX];
+    XCTAssertEqual(0LL, [small valueAtPercentile:30]);
+    XCTAssertEqual(7LL, [small valueAtPercentile:60]);
+    XCTAssertEqual((1LL << 32) - 1, small.maxValue);
+}
+
+- (void)testSlowBlockAttribution {
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    TLQueueProfiler *profiler = [[TLQueueProfiler alloc] initWithQueue:queue reportInterval:3600 sampleInterval:1 topCount:10];
+
+    for (int i = 0; i < FAST_COUNT; i++) {
+        [profiler dispatchWithLabel:@"fast" block:^{
+        }];
+        if (i == 0) {
+            [profiler dispatchWithLabel:@"slow" block:^{
+                usleep(SLOW_BLOCK_US);
+            }];
+        }
+    }
+
+    __block TLQueueProfileReport *report;
+    dispatch_sync(queue, ^{
+        report = [profiler reportWithTopCount:1];
+    });
+
+    // The slow block is reported first and the fast blocks queued behind it waited for it.
+    XCTAssertEqual((NSUInteger)1, report.topEntries.count);
+    TLQueueProfileEntry *slow = report.topEntries[0];
+    XCTAssertEqualObjects(@"slow", slow.label);
+    XCTAssertEqual(1LL, slow.run.count);
+    XCTAssertGreaterThanOrEqual([slow.run valueAtPercentile:50], (int64_t)(SLOW_BLOCK_US * 0.97));
+    XCTAssertEqual((int64_t)(FAST_COUNT + 1), report.blockCount);
+
+    dispatch_sync(queue, ^{
+        report = [profiler reportWithTopCount:10];
+    });
+    TLQueueProfileEntry *fast = report.topEntries[1];
+    XCTAssertEqualObjects(@"fast", fast.label);
+    XCTAssertEqual((int64_t)FAST_COUNT, fast.run.count);
+    XCTAssertLessThan([fast.run valueAtPercentile:50], (int64_t)(SLOW_BLOCK_US / 10));
+    XCTAssertGreaterThanOrEqual(fast.wait.maxValue, (int64_t)(SLOW_BLOCK_US * 0.97));
+}
+
+- (void)testPeriodicReport {
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    TLQueueProfiler *profiler = [[TLQueueProfiler alloc] initWithQueue:queue reportInterval:0.5 sampleInterval:0.01 topCount:2];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"report"];
+    __block TLQueueProfileReport *report = nil;
+    profiler.onReport = ^(TLQueueProfileReport *lReport) {
+        if (!report) {
+            report = lReport;
+            [expectation fulfill];
+        }
+    };
+    [profiler start];
+
+    // Keep the queue busy so that the depth samples see the pending blocks.
+    for (int i = 0; i < 20; i++) {
+        [profiler dispatchWithLabel:(i % 2 ? @"even" : @"odd") block:^{
+            usleep(10000);
+        }];
+    }
+    [profiler dispatchWithLabel:@"last" block:^{
+    }];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    [profiler stop];
+
+    XCTAssertEqual((NSUInteger)2, report.topEntries.count);
+    XCTAssertEqual(21LL, report.blockCount);
+    XCTAssertGreaterThan(report.depthSamples.count, (NSUInteger)10);
+    XCTAssertGreaterThan([[report.depthSamples valueForKeyPath:@"@max.intValue"] intValue], 10);
+    XCTAssertGreaterThan(report.occupancy, 10.0);
+}
+
+/// Run a block for its duration: the block spins so that it takes the same time on every run.
+static void runBlock(uint64_t duration) {
+
+    uint64_t deadline = mach_absolute_time() + duration;
+    while (mach_absolute_time() < deadline) {
+    }
+}
+
+- (NSTimeInterval)runBlocksWithProfiler:(TLQueueProfiler *)profiler queue:(dispatch_queue_t)queue duration:(uint64_t)duration {
+
+    NSDate *start = [NSDate date];
+    for (int i = 0; i < OVERHEAD_COUNT; i++) {
+        if (profiler) {
+            [profiler dispatchWithLabel:@"block" block:^{
+                runBlock(duration);
+            }];
+        } else {
+            dispatch_async(queue, ^{
+                runBlock(duration);
+            });
+        }
+    }
+    dispatch_sync(queue, ^{});
+    return -[start timeIntervalSinceNow];
+}
+
+- (void)testOverhead {
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    TLQueueProfiler *profiler = [[TLQueueProfiler alloc] initWithQueue:queue reportInterval:3600 sampleInterval:1 topCount:10];
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    uint64_t duration = (BLOCK_DURATION_US * NSEC_PER_USEC * timebase.denom) / timebase.numer;
+
+    // Warm up and keep the best of 3 runs.
+    NSTimeInterval plain = DBL_MAX, profiled = DBL_MAX;
+    for (int i = 0; i < 3; i++) {
+        plain = MIN(plain, [self runBlocksWithProfiler:nil queue:queue duration:duration]);
+        profiled = MIN(profiled, [self runBlocksWithProfiler:profiler queue:queue duration:duration]);
+    }
+    XCTAssertLessThan((profiled - plain) * 100.0 / plain, MAX_OVERHEAD_PERCENT);
+}
+
+// The labels built for each dispatch, as the executor class names, share their entry.
+- (void)testBuiltLabels {
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    TLQueueProfiler *profiler = [[TLQueueProfiler alloc] initWithQueue:queue reportInterval:3600 sampleInterval:1 topCount:10];
+
+    for (int i = 0; i < LABEL_COUNT; i++) {
+        [profiler dispatchWithLabel:[NSString stringWithFormat:@"Executor%d", i % 2] block:^{
+        }];
+    }
+
+    __block TLQueueProfileReport *report;
+    dispatch_sync(queue, ^{
+        report = [profiler reportWithTopCount:10];
+    });
+    XCTAssertEqual((NSUInteger)2, report.topEntries.count);
+    XCTAssertEqual((int64_t)(LABEL_COUNT / 2), report.topEntries[0].run.count);
+    XCTAssertEqual((int64_t)(LABEL_COUNT / 2), report.topEntries[1].run.count);
+}
+
+@end
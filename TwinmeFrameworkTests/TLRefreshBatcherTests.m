@@ -0,0 +1,613 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <Twinlife/TLImageService.h>
+#import <Twinlife/TLAttributeNameValue.h>
+
+#import "TLRefreshBatcher.h"
+#import "TLRefreshObjectsExecutor.h"
+#import "TLPairRefreshInvocation.h"
+#import "TLPairProtocol.h"
+#import "TLSingleFlight.h"
+#import "TLContact.h"
+#import "TLTestService.h"
+
+#define CONTACT_COUNT 200
+#define INVOCATION_COUNT 2
+#define BATCH_MAX_COUNT 64
+#define CHANGED_AVATAR_MODULO 10
+#define CHANGED_NAME_MODULO 7
+#define LATENCY 0.001
+#define WINDOW_DELAY 0.05
+
+//
+// Peer twincode and contact with only the properties used by the refresh.
+//
+
+@interface TLTestTwincode : NSObject
+
+@property (nonnull) NSUUID *uuid;
+@property (nonnull) NSString *name;
+@property (nullable) NSUUID *avatarId;
+
+@end
+
+@implementation TLTestTwincode
+@end
+
+@interface TLTestContact : TLContact
+
+@property (nullable) TLTestTwincode *peer;
+
+@end
+
+@implementation TLTestContact
+
+- (nullable TLTwincodeOutbound *)peerTwincodeOutbound {
+
+    return (TLTwincodeOutbound *)self.peer;
+}
+
+- (void)setPeerTwincodeOutbound:(nullable TLTwincodeOutbound *)peerTwincodeOutbound {
+
+    self.peer = (TLTestTwincode *)peerTwincodeOutbound;
+}
+
+- (BOOL)checkInvariants {
+
+    return YES;
+}
+
+@end
+
+//
+// Interface: TLTestRefreshContext
+//
+
+/**
+ * Twinme context with the twincode, image and repository services used by TLRefreshObjectsExecutor.
+ *
+ * - a successful twincode refresh gives the new name or avatar prepared for the peer,
+ * - the invocations acknowledged or used to unbind a contact are recorded,
+ * - the `executors` group is entered when an executor is admitted and left when it is released,
+ * - the executors are retained and told when we are online as the twinme context does.
+ */
+@interface TLTestRefreshContext : NSObject
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly, nonnull) TLTestService *twincodeService;
+@property (readonly, nonnull) TLTestService *imageService;
+@property (readonly, nonnull) TLTestService *repositoryService;
+@property (readonly, nonnull) dispatch_group_t executors;
+@property (readonly, nonnull) NSMutableArray<NSUUID *> *acknowledged;
+@property (readonly, nonnull) NSMutableArray<NSUUID *> *unbound;
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, NSString *> *peerNames;
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, NSUUID *> *peerAvatars;
+@property (readonly, nonnull) NSMutableSet *delegates;
+@property (nullable) dispatch_group_t invocations;
+
+@end
+
+@implementation TLTestRefreshContext
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+        _twincodeService = [[TLTestService alloc] initWithQueue:_queue latency:LATENCY];
+        _imageService = [[TLTestService alloc] initWithQueue:_queue latency:LATENCY];
+        _repositoryService = [[TLTestService alloc] initWithQueue:_queue latency:LATENCY];
+        _executors = dispatch_group_create();
+        _acknowledged = [[NSMutableArray alloc] init];
+        _unbound = [[NSMutableArray alloc] init];
+        _peerNames = [[NSMutableDictionary alloc] init];
+        _peerAvatars = [[NSMutableDictionary alloc] init];
+        _delegates = [[NSMutableSet alloc] init];
+    }
+    return self;
+}
+
+/// We are online again: the executors are told from the queue as the twinme context does.
+- (void)online {
+
+    self.twincodeService.offline = NO;
+    dispatch_async(self.queue, ^{
+        NSArray<TLAbstractTwinmeExecutor *> *delegates;
+        @synchronized (self.delegates) {
+            delegates = self.delegates.allObjects;
+        }
+        for (TLAbstractTwinmeExecutor *executor in delegates) {
+            [executor onTwinlifeOnline];
+        }
+    });
+}
+
+#pragma mark - Twinme context
+
+- (nonnull id)twinlife {
+
+    return self;
+}
+
+- (nonnull dispatch_queue_t)twinlifeQueue {
+
+    return self.queue;
+}
+
+- (nonnull id)getTwincodeOutboundService {
+
+    return self;
+}
+
+- (nonnull id)getImageService {
+
+    return self;
+}
+
+- (nonnull id)getRepositoryService {
+
+    return self;
+}
+
+- (void)admitWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+
+    dispatch_group_enter(self.executors);
+    start();
+}
+
+- (void)releaseWithExecutor:(nonnull id)executor {
+
+    dispatch_group_leave(self.executors);
+}
+
+- (void)addDelegate:(nonnull TLAbstractTwinmeExecutor *)executor {
+
+    // The executor is retained until it is stopped.
+    @synchronized (self.delegates) {
+        [self.delegates addObject:executor];
+    }
+    dispatch_async(self.queue, ^{
+        [executor onTwinlifeOnline];
+    });
+}
+
+- (void)removeDelegate:(nonnull id)executor {
+
+    @synchronized (self.delegates) {
+        [self.delegates removeObject:executor];
+    }
+}
+
+- (BOOL)isVisible:(nullable id)originator {
+
+    return NO;
+}
+
+- (int64_t)newRequestId {
+
+    return 1;
+}
+
+- (void)fireOnErrorWithRequestId:(int64_t)requestId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(nullable NSString *)errorParameter {
+}
+
+- (void)onUpdateContactWithRequestId:(int64_t)requestId contact:(nonnull TLContact *)contact {
+}
+
+- (void)acknowledgeInvocationWithInvocationId:(nonnull NSUUID *)invocationId errorCode:(TLBaseServiceErrorCode)errorCode {
+
+    @synchronized (self) {
+        [self.acknowledged addObject:invocationId];
+    }
+    if (self.invocations) {
+        dispatch_group_leave(self.invocations);
+    }
+}
+
+- (void)unbindContactWithRequestId:(int64_t)requestId invocationId:(nullable NSUUID *)invocationId contact:(nonnull TLContact *)contact {
+
+    @synchronized (self) {
+        [self.unbound addObject:invocationId];
+    }
+    if (self.invocations) {
+        dispatch_group_leave(self.invocations);
+    }
+}
+
+#pragma mark - Twincode, image and repository services
+
+- (void)refreshTwincodeWithTwincode:(nonnull TLTestTwincode *)twincode withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, NSMutableArray *previousAttributes))block {
+
+    [self.twincodeService requestWithKey:twincode.uuid complete:^(TLBaseServiceErrorCode errorCode) {
+        if (errorCode != TLBaseServiceErrorCodeSuccess) {
+            block(errorCode, nil);
+            return;
+        }
+        @synchronized (self) {
+            NSString *name = self.peerNames[twincode.uuid];
+            if (name) {
+                twincode.name = name;
+            }
+            NSUUID *avatarId = self.peerAvatars[twincode.uuid];
+            if (avatarId) {
+                twincode.avatarId = avatarId;
+            }
+        }
+        block(errorCode, [[NSMutableArray alloc] init]);
+    }];
+}
+
+- (void)getImageWithImageId:(nonnull NSUUID *)imageId kind:(TLImageServiceKind)kind withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, UIImage *image))block {
+
+    [self.imageService requestWithKey:imageId complete:^(TLBaseServiceErrorCode errorCode) {
+        block(errorCode, nil);
+    }];
+}
+
+- (void)deleteImageWithImageId:(nonnull NSUUID *)imageId withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, NSUUID *imageId))block {
+
+    block(TLBaseServiceErrorCodeSuccess, imageId);
+}
+
+- (void)updateObjectWithObject:(nonnull TLContact *)object localOnly:(BOOL)localOnly withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, id object))block {
+
+    [self.repositoryService requestWithKey:object.uuid complete:^(TLBaseServiceErrorCode errorCode) {
+        block(errorCode, errorCode == TLBaseServiceErrorCodeSuccess ? object : nil);
+    }];
+}
+
+@end
+
+@interface TLRefreshBatcherTests : XCTestCase
+@end
+
+@implementation TLRefreshBatcherTests
+
+static TLTestContact *newContact(int index) {
+
+    TLDatabaseIdentifier *identifier = nil;
+    TLTestContact *contact = [[TLTestContact alloc] initWithIdentifier:identifier uuid:[NSUUID UUID] creationDate:0 modificationDate:0];
+    contact.peer = [[TLTestTwincode alloc] init];
+    contact.peer.uuid = [NSUUID UUID];
+    contact.peer.name = [NSString stringWithFormat:@"peer-%d", index];
+    contact.peer.avatarId = [NSUUID UUID];
+    contact.name = contact.peer.name;
+    return contact;
+}
+
+static NSArray<TLRefreshObjectRequest *> *newRequests(TLContact *contact, int count) {
+
+    NSMutableArray<TLRefreshObjectRequest *> *requests = [[NSMutableArray alloc] initWithCapacity:count];
+    for (int i = 0; i < count; i++) {
+        TLPairRefreshInvocation *invocation = [[TLPairRefreshInvocation alloc] initWithId:[NSUUID UUID] receiver:contact invocationAttributes:nil];
+        [requests addObject:[[TLRefreshObjectRequest alloc] initWithInvocation:invocation subject:contact]];
+    }
+    return requests;
+}
+
+static NSSet<NSUUID *> *invocationIds(NSArray<TLRefreshObjectRequest *> *requests) {
+
+    NSMutableSet<NSUUID *> *result = [[NSMutableSet alloc] init];
+    for (TLRefreshObjectRequest *request in requests) {
+        [result addObject:request.invocation.uuid];
+    }
+    return result;
+}
+
+- (void)runWithContext:(nonnull TLTestRefreshContext *)context requests:(nonnull NSArray<NSArray<TLRefreshObjectRequest *> *> *)requests {
+
+    TLRefreshObjectsExecutor *executor = [[TLRefreshObjectsExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context requests:requests];
+    [executor start];
+    XCTAssertEqual(0L, dispatch_group_wait(context.executors, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    dispatch_sync(context.queue, ^{});
+}
+
+/// Wait until the timers armed on the queue before now with the delay have fired.
+- (void)waitTimersWithQueue:(nonnull dispatch_queue_t)queue delay:(NSTimeInterval)delay {
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"timers"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * delay * NSEC_PER_SEC)), queue, ^{
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+}
+
+// A peer changes its identity on every space: the pair::refresh invocations for its contacts arrive in a burst
+// from several threads and each one is received twice.  The batches are refreshed by the executor.
+- (void)checkBurstWithMaxCount:(NSUInteger)maxCount {
+    TLTestRefreshContext *context = [[TLTestRefreshContext alloc] init];
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray<TLTestContact *> *contacts = [[NSMutableArray alloc] init];
+    NSMutableArray<TLRefreshObjectRequest *> *requests = [[NSMutableArray alloc] init];
+    NSMutableSet<NSUUID *> *renamed = [[NSMutableSet alloc] init];
+    NSMutableSet<NSUUID *> *oldAvatars = [[NSMutableSet alloc] init];
+    for (int i = 0; i < CONTACT_COUNT; i++) {
+        TLTestContact *contact = newContact(i);
+        [contacts addObject:contact];
+        [requests addObjectsFromArray:newRequests(contact, INVOCATION_COUNT)];
+        [oldAvatars addObject:contact.peer.avatarId];
+        if (i % CHANGED_AVATAR_MODULO == 0) {
+            context.peerAvatars[contact.peer.uuid] = [NSUUID UUID];
+        }
+        if (i % CHANGED_NAME_MODULO == 0) {
+            context.peerNames[contact.peer.uuid] = [NSString stringWithFormat:@"new-peer-%d", i];
+            [renamed addObject:contact.uuid];
+        }
+    }
+    context.invocations = group;
+
+    // The window is never closed by its timer: the last batch is flushed once the burst is received.
+    __block int executorCount = 0;
+    __block NSUInteger keyCount = 0;
+    TLRefreshBatcher *batcher = [[TLRefreshBatcher alloc] initWithQueue:context.queue delay:3600 maxCount:maxCount flush:^(NSArray<id<NSCopying>> *keys, NSDictionary<id<NSCopying>, NSArray *> *items) {
+        NSMutableArray<NSArray<TLRefreshObjectRequest *> *> *list = [[NSMutableArray alloc] initWithCapacity:keys.count];
+        for (id<NSCopying> key in keys) {
+            [list addObject:items[key]];
+        }
+        XCTAssertLessThanOrEqual(keys.count, maxCount);
+        executorCount++;
+        keyCount += keys.count;
+        [[[TLRefreshObjectsExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context requests:list] start];
+    }];
+
+    dispatch_apply(requests.count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        TLRefreshObjectRequest *request = requests[iteration];
+        dispatch_group_enter(group);
+        [batcher addWithKey:[request batchKey] item:request];
+    });
+    [batcher flush];
+
+    XCTAssertEqual(0L, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC)));
+    XCTAssertEqual(0L, dispatch_group_wait(context.executors, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    dispatch_sync(context.queue, ^{});
+
+    // Each key of a batch is refreshed exactly once: a duplicate invocation is merged in the same batch
+    // unless it arrives after its batch was taken.
+    NSUInteger refreshCount = context.twincodeService.requests.count;
+    XCTAssertEqual(keyCount, refreshCount);
+    XCTAssertEqual(executorCount, batcher.flushCount);
+    for (TLTestContact *contact in contacts) {
+        NSUInteger count = [context.twincodeService countWithKey:contact.peer.uuid];
+        XCTAssertTrue(count >= 1 && count <= INVOCATION_COUNT);
+        XCTAssertEqualObjects(context.peerAvatars[contact.peer.uuid] ?: contact.peer.avatarId, contact.peer.avatarId);
+    }
+    if (maxCount >= CONTACT_COUNT) {
+        XCTAssertEqual(1, executorCount);
+        XCTAssertEqual((NSUInteger)CONTACT_COUNT, refreshCount);
+    } else {
+        int minExecutors = (int)((CONTACT_COUNT + maxCount - 1) / maxCount);
+        XCTAssertGreaterThanOrEqual(executorCount, minExecutors);
+        XCTAssertLessThanOrEqual(executorCount, minExecutors * INVOCATION_COUNT);
+        XCTAssertLessThan(refreshCount, (NSUInteger)(CONTACT_COUNT * INVOCATION_COUNT));
+    }
+
+    // Only the avatars which changed are fetched and only the renamed contacts are updated.
+    NSSet *newAvatars = [NSSet setWithArray:context.peerAvatars.allValues];
+    XCTAssertEqualObjects(newAvatars, [NSSet setWithArray:context.imageService.requests]);
+    XCTAssertFalse([oldAvatars intersectsSet:[NSSet setWithArray:context.imageService.requests]]);
+    XCTAssertEqualObjects(renamed, [NSSet setWithArray:context.repositoryService.requests]);
+    XCTAssertEqualObjects(invocationIds(requests), [NSSet setWithArray:context.acknowledged]);
+    XCTAssertEqual(requests.count, context.acknowledged.count);
+    XCTAssertEqual((NSUInteger)0, batcher.pendingCount);
+}
+
+- (void)testBatchedRefresh {
+    [self checkBurstWithMaxCount:BATCH_MAX_COUNT];
+}
+
+// The burst fits in one window: every contact is refreshed once.
+- (void)testBurstInOneWindow {
+    [self checkBurstWithMaxCount:CONTACT_COUNT];
+}
+
+// The subject's own peer twincode and no twincode give the same key, a group member twincode another one.
+- (void)testBatchKey {
+    TLTestContact *contact = newContact(1);
+    NSUUID *memberTwincodeId = [NSUUID UUID];
+    TLRefreshObjectRequest *request = newRequests(contact, 1)[0];
+    NSArray<TLAttributeNameValue *> *peerAttributes = @[[[TLAttributeNameUUIDValue alloc] initWithName:PAIR_PROTOCOL_PARAM_TWINCODE_OUTBOUND_ID uuidValue:contact.peer.uuid]];
+    NSArray<TLAttributeNameValue *> *memberAttributes = @[[[TLAttributeNameUUIDValue alloc] initWithName:PAIR_PROTOCOL_PARAM_TWINCODE_OUTBOUND_ID uuidValue:memberTwincodeId]];
+    TLPairRefreshInvocation *peerInvocation = [[TLPairRefreshInvocation alloc] initWithId:[NSUUID UUID] receiver:contact invocationAttributes:peerAttributes];
+    TLPairRefreshInvocation *memberInvocation = [[TLPairRefreshInvocation alloc] initWithId:[NSUUID UUID] receiver:contact invocationAttributes:memberAttributes];
+    TLRefreshObjectRequest *peerRequest = [[TLRefreshObjectRequest alloc] initWithInvocation:peerInvocation subject:contact];
+    TLRefreshObjectRequest *memberRequest = [[TLRefreshObjectRequest alloc] initWithInvocation:memberInvocation subject:contact];
+
+    XCTAssertEqualObjects([request batchKey], [peerRequest batchKey]);
+    XCTAssertEqualObjects(contact.uuid, [peerRequest batchKey].second);
+    XCTAssertNotEqualObjects([request batchKey], [memberRequest batchKey]);
+    XCTAssertEqualObjects(memberTwincodeId, [memberRequest batchKey].second);
+
+    // The two invocations for the subject share the batch entry.
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    TLRefreshBatcher *batcher = [[TLRefreshBatcher alloc] initWithQueue:queue delay:3600 maxCount:BATCH_MAX_COUNT flush:^(NSArray<id<NSCopying>> *keys, NSDictionary<id<NSCopying>, NSArray *> *items) {
+    }];
+    XCTAssertTrue([batcher addWithKey:[request batchKey] item:request]);
+    XCTAssertFalse([batcher addWithKey:[peerRequest batchKey] item:peerRequest]);
+    XCTAssertTrue([batcher addWithKey:[memberRequest batchKey] item:memberRequest]);
+    XCTAssertEqual((NSUInteger)2, batcher.pendingCount);
+    [batcher reset];
+}
+
+// The peer twincode was deleted: the contact is unbound with its first invocation, the others are acknowledged.
+- (void)testItemNotFoundUnbind {
+    TLTestRefreshContext *context = [[TLTestRefreshContext alloc] init];
+    TLTestContact *deleted = newContact(1);
+    TLTestContact *contact = newContact(2);
+    NSArray<TLRefreshObjectRequest *> *deletedRequests = newRequests(deleted, 2);
+    NSArray<TLRefreshObjectRequest *> *requests = newRequests(contact, 2);
+    context.peerNames[deleted.peer.uuid] = @"deleted";
+    context.peerNames[contact.peer.uuid] = @"renamed";
+    [context.twincodeService failWithKey:deleted.peer.uuid errorCode:TLBaseServiceErrorCodeItemNotFound count:-1];
+
+    [self runWithContext:context requests:@[deletedRequests, requests]];
+
+    // The deleted twincode is not retried and its contact is neither renamed nor updated.
+    XCTAssertEqual((NSUInteger)1, [context.twincodeService countWithKey:deleted.peer.uuid]);
+    NSArray *expected = @[deletedRequests[0].invocation.uuid];
+    XCTAssertEqualObjects(expected, context.unbound);
+    expected = @[contact.uuid];
+    XCTAssertEqualObjects(expected, context.repositoryService.requests);
+    XCTAssertEqualObjects(@"peer-1", deleted.name);
+    XCTAssertEqualObjects(@"renamed", contact.name);
+    NSMutableSet<NSUUID *> *acknowledged = [invocationIds(requests) mutableCopy];
+    [acknowledged addObject:deletedRequests[1].invocation.uuid];
+    XCTAssertEqualObjects(acknowledged, [NSSet setWithArray:context.acknowledged]);
+}
+
+// The name is updated only when the peer changed it and it was not modified locally.
+- (void)testNeedUpdate {
+    TLTestRefreshContext *context = [[TLTestRefreshContext alloc] init];
+    TLTestContact *renamed = newContact(1);
+    TLTestContact *unchanged = newContact(2);
+    TLTestContact *local = newContact(3);
+    local.name = @"local name";
+    context.peerNames[renamed.peer.uuid] = @"renamed";
+    context.peerNames[local.peer.uuid] = @"renamed";
+
+    [self runWithContext:context requests:@[newRequests(renamed, 1), newRequests(unchanged, 1), newRequests(local, 1)]];
+
+    NSArray *expected = @[renamed.uuid];
+    XCTAssertEqualObjects(expected, context.repositoryService.requests);
+    XCTAssertEqualObjects(@"renamed", renamed.name);
+    XCTAssertEqualObjects(@"peer-2", unchanged.name);
+    XCTAssertEqualObjects(@"local name", local.name);
+    XCTAssertEqual((NSUInteger)3, context.acknowledged.count);
+    XCTAssertEqual((NSUInteger)0, context.imageService.requests.count);
+}
+
+// Two contacts share the same peer twincode: it is refreshed once and the new avatar fetched once.
+- (void)testChangedAvatar {
+    TLTestRefreshContext *context = [[TLTestRefreshContext alloc] init];
+    TLTestContact *contact1 = newContact(1);
+    TLTestContact *contact2 = newContact(1);
+    TLTestContact *contact3 = newContact(3);
+    contact2.peer = contact1.peer;
+    NSUUID *avatarId = [NSUUID UUID];
+    context.peerAvatars[contact1.peer.uuid] = avatarId;
+
+    [self runWithContext:context requests:@[newRequests(contact1, 1), newRequests(contact2, 1), newRequests(contact3, 1)]];
+
+    XCTAssertEqual((NSUInteger)1, [context.twincodeService countWithKey:contact1.peer.uuid]);
+    NSArray *expected = @[avatarId];
+    XCTAssertEqualObjects(expected, context.imageService.requests);
+    XCTAssertEqualObjects(avatarId, contact2.avatarId);
+    XCTAssertEqual((NSUInteger)3, context.acknowledged.count);
+}
+
+// The connection is lost during the refresh: the twincodes are refreshed again when we are online
+// and the invocations are acknowledged only then.
+- (void)testOfflineRefresh {
+    TLTestRefreshContext *context = [[TLTestRefreshContext alloc] init];
+    TLTestContact *contact1 = newContact(1);
+    TLTestContact *contact2 = newContact(2);
+    context.peerNames[contact1.peer.uuid] = @"renamed";
+    context.twincodeService.offline = YES;
+
+    TLRefreshObjectsExecutor *executor = [[TLRefreshObjectsExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context requests:@[newRequests(contact1, 2), newRequests(contact2, 1)]];
+    [executor start];
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"requests.@count == 2"] evaluatedWithObject:context.twincodeService handler:nil];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    [self waitTimersWithQueue:context.queue delay:context.twincodeService.latency];
+    XCTAssertEqual((NSUInteger)2, context.twincodeService.requests.count);
+    XCTAssertEqual((NSUInteger)0, context.acknowledged.count);
+    XCTAssertEqual((NSUInteger)0, context.repositoryService.requests.count);
+
+    [context online];
+    XCTAssertEqual(0L, dispatch_group_wait(context.executors, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    dispatch_sync(context.queue, ^{});
+    XCTAssertEqual((NSUInteger)2, [context.twincodeService countWithKey:contact1.peer.uuid]);
+    XCTAssertEqualObjects(@"renamed", contact1.name);
+    XCTAssertEqual((NSUInteger)3, context.acknowledged.count);
+}
+
+// The update of the object fails because we are offline: its invocations are kept to be replayed.
+- (void)testOfflineUpdateKeepsInvocations {
+    TLTestRefreshContext *context = [[TLTestRefreshContext alloc] init];
+    TLTestContact *contact1 = newContact(1);
+    TLTestContact *contact2 = newContact(2);
+    NSArray<TLRefreshObjectRequest *> *requests = newRequests(contact2, 1);
+    context.peerNames[contact1.peer.uuid] = @"renamed";
+    [context.repositoryService failWithKey:contact1.uuid errorCode:TLBaseServiceErrorCodeTwinlifeOffline count:1];
+
+    [self runWithContext:context requests:@[newRequests(contact1, 2), requests]];
+
+    XCTAssertEqualObjects(invocationIds(requests), [NSSet setWithArray:context.acknowledged]);
+    XCTAssertEqual((NSUInteger)0, context.unbound.count);
+}
+
+- (void)testWindow {
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    NSMutableArray<NSArray<id<NSCopying>> *> *batches = [[NSMutableArray alloc] init];
+    NSMutableArray<NSDictionary<id<NSCopying>, NSArray *> *> *batchItems = [[NSMutableArray alloc] init];
+    __block XCTestExpectation *flushed = nil;
+    TLRefreshBatcher *batcher = [[TLRefreshBatcher alloc] initWithQueue:queue delay:WINDOW_DELAY maxCount:3 flush:^(NSArray<id<NSCopying>> *keys, NSDictionary<id<NSCopying>, NSArray *> *items) {
+        [batches addObject:keys];
+        [batchItems addObject:items];
+        [flushed fulfill];
+    }];
+    NSUUID *first = [NSUUID UUID];
+    NSUUID *second = [NSUUID UUID];
+    NSUUID *third = [NSUUID UUID];
+    NSUUID *fourth = [NSUUID UUID];
+
+    // The batch is flushed by the timer.
+    flushed = [self expectationWithDescription:@"timer"];
+    XCTAssertTrue([batcher addWithKey:first item:@1]);
+    XCTAssertTrue([batcher addWithKey:second item:@2]);
+    XCTAssertFalse([batcher addWithKey:first item:@3]);
+    XCTAssertEqual((NSUInteger)2, batcher.pendingCount);
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    dispatch_sync(queue, ^{
+        flushed = nil;
+    });
+    XCTAssertEqual((NSUInteger)1, batches.count);
+    NSArray *expectedKeys = @[first, second];
+    NSArray *expectedItems = @[@1, @3];
+    XCTAssertEqualObjects(expectedKeys, batches[0]);
+    XCTAssertEqualObjects(expectedItems, batchItems[0][first]);
+
+    // The batch is taken as soon as it is full, the next key starts a new batch with its own timer.
+    dispatch_sync(queue, ^{
+        [batcher addWithKey:first item:@4];
+        [batcher addWithKey:second item:@5];
+        [batcher addWithKey:third item:@6];
+        XCTAssertTrue([batcher addWithKey:fourth item:@7]);
+        XCTAssertEqual((NSUInteger)1, batcher.pendingCount);
+        flushed = [self expectationWithDescription:@"timer"];
+    });
+    dispatch_sync(queue, ^{});
+    XCTAssertEqual((NSUInteger)2, batches.count);
+    expectedKeys = @[first, second, third];
+    XCTAssertEqualObjects(expectedKeys, batches[1]);
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    dispatch_sync(queue, ^{
+        flushed = nil;
+    });
+    XCTAssertEqual((NSUInteger)3, batches.count);
+    expectedKeys = @[fourth];
+    XCTAssertEqualObjects(expectedKeys, batches[2]);
+    XCTAssertEqual(3, batcher.flushCount);
+
+    // An explicit flush does not wait for the timer and the timer of the flushed batch is ignored.
+    [batcher addWithKey:third item:@8];
+    [batcher flush];
+    dispatch_sync(queue, ^{});
+    XCTAssertEqual((NSUInteger)4, batches.count);
+    XCTAssertEqual((NSUInteger)0, batcher.pendingCount);
+    [self waitTimersWithQueue:queue delay:WINDOW_DELAY];
+    XCTAssertEqual(4, batcher.flushCount);
+
+    // A reset drops the batch being collected (sign out).
+    [batcher addWithKey:first item:@9];
+    [batcher reset];
+    XCTAssertEqual((NSUInteger)0, batcher.pendingCount);
+    [self waitTimersWithQueue:queue delay:WINDOW_DELAY];
+    XCTAssertEqual(4, batcher.flushCount);
+}
+
+@end
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLRefreshPipeline.h"
+#import "TLTestService.h"
+
+#define MEMBER_COUNT 300
+#define INVOKE_LATENCY 0.005
+#define RETRY_DELAY 0.01
+
+@interface TLRefreshPipelineTests : XCTestCase
+@end
+
+@implementation TLRefreshPipelineTests
+
+static TLTestService *newService(void) {
+
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    return [[TLTestService alloc] initWithQueue:queue latency:INVOKE_LATENCY];
+}
+
+static TLRefreshPipeline *newPipeline(TLTestService *service, int window) {
+
+    return [[TLRefreshPipeline alloc] initWithQueue:service.queue window:window maxRetry:2 retryDelay:RETRY_DELAY invoke:^(id item, void (^complete)(TLBaseServiceErrorCode errorCode)) {
+        [service requestWithKey:(NSUUID *)item complete:complete];
+    }];
+}
+
+- (void)refreshWithService:(TLTestService *)service pipeline:(TLRefreshPipeline *)pipeline failedCount:(int *)failedCount {
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"refreshed"];
+    __block int completions = 0;
+    __block int failed = 0;
+    [pipeline startWithCompletion:^(int count) {
+        completions++;
+        failed = count;
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:60 handler:nil];
+
+    // Give a chance to a second completion to be reported.
+    dispatch_sync(service.queue, ^{});
+    XCTAssertEqual(1, completions);
+    if (failedCount) {
+        *failedCount = failed;
+    }
+}
+
+- (void)testThroughput {
+    NSMutableArray<NSUUID *> *members = [[NSMutableArray alloc] init];
+    for (int i = 0; i < MEMBER_COUNT; i++) {
+        [members addObject:[NSUUID UUID]];
+    }
+
+    TLTestService *sequentialService = newService();
+    TLRefreshPipeline *sequential = newPipeline(sequentialService, 1);
+    TLTestService *pipelinedService = newService();
+    TLRefreshPipeline *pipelined = newPipeline(pipelinedService, 8);
+    for (NSUUID *member in members) {
+        [sequential addWithKey:member item:member];
+        [pipelined addWithKey:member item:member];
+    }
+
+    [self refreshWithService:sequentialService pipeline:sequential failedCount:nil];
+    [self refreshWithService:pipelinedService pipeline:pipelined failedCount:nil];
+
+    // The members are invoked in their order with at most `window` invocations in progress.
+    XCTAssertEqualObjects(members, sequentialService.requests);
+    XCTAssertEqualObjects(members, pipelinedService.requests);
+    XCTAssertEqual(1, sequentialService.maxRunning);
+    XCTAssertEqual(8, pipelinedService.maxRunning);
+}
+
+- (void)testRetryAndDeduplicate {
+    TLTestService *service = newService();
+    TLRefreshPipeline *pipeline = newPipeline(service, 4);
+    NSUUID *flaky = [NSUUID UUID];
+    NSUUID *broken = [NSUUID UUID];
+    NSUUID *deleted = [NSUUID UUID];
+    NSUUID *member = [NSUUID UUID];
+    [service failWithKey:flaky errorCode:TLBaseServiceErrorCodeTimeoutError count:2];
+    [service failWithKey:broken errorCode:TLBaseServiceErrorCodeTimeoutError count:-1];
+    [service failWithKey:deleted errorCode:TLBaseServiceErrorCodeItemNotFound count:-1];
+
+    XCTAssertTrue([pipeline addWithKey:flaky item:flaky]);
+    XCTAssertTrue([pipeline addWithKey:broken item:broken]);
+    XCTAssertTrue([pipeline addWithKey:deleted item:deleted]);
+    XCTAssertTrue([pipeline addWithKey:member item:member]);
+    XCTAssertFalse([pipeline addWithKey:member item:member]);
+    XCTAssertFalse([pipeline addWithKey:flaky item:flaky]);
+
+    int failed = 0;
+    [self refreshWithService:service pipeline:pipeline failedCount:&failed];
+
+    // The first round is sent in order, the flaky member succeeds on its third attempt,
+    // the broken one fails after 2 retries and the deleted member is not retried.
+    NSArray<NSUUID *> *firstRound = @[flaky, broken, deleted, member];
+    XCTAssertEqualObjects(firstRound, [service.requests subarrayWithRange:NSMakeRange(0, 4)]);
+    XCTAssertEqual((NSUInteger)3, [service countWithKey:flaky]);
+    XCTAssertEqual((NSUInteger)3, [service countWithKey:broken]);
+    XCTAssertEqual((NSUInteger)1, [service countWithKey:deleted]);
+    XCTAssertEqual((NSUInteger)1, [service countWithKey:member]);
+    XCTAssertEqual(1, failed);
+    XCTAssertEqual(0, pipeline.runningCount);
+    XCTAssertEqual((NSUInteger)0, pipeline.pendingCount);
+}
+
+// The members that fail while we are offline wait for the resume and do not use their retries.
+- (void)testOfflineResume {
+    TLTestService *service = newService();
+    TLRefreshPipeline *pipeline = newPipeline(service, 2);
+    NSMutableArray<NSUUID *> *members = [[NSMutableArray alloc] init];
+    for (int i = 0; i < 5; i++) {
+        NSUUID *member = [NSUUID UUID];
+        [members addObject:member];
+        [pipeline addWithKey:member item:member];
+    }
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"refreshed"];
+    __block int failed = -1;
+    service.offline = YES;
+    [pipeline startWithCompletion:^(int count) {
+        failed = count;
+        [expectation fulfill];
+    }];
+
+    // Every member is parked and, once the retry delays are past, the pipeline is still not completed.
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"parkedCount == 5"] evaluatedWithObject:pipeline handler:nil];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    XCTestExpectation *retryDelay = [self expectationWithDescription:@"retry delay"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(RETRY_DELAY * 4 * NSEC_PER_SEC)), service.queue, ^{
+        [retryDelay fulfill];
+    });
+    [self waitForExpectations:@[retryDelay] timeout:10];
+    XCTAssertEqual((NSUInteger)5, pipeline.parkedCount);
+    XCTAssertEqual((NSUInteger)0, pipeline.pendingCount);
+    XCTAssertEqual(-1, failed);
+    XCTAssertEqual((NSUInteger)5, service.requests.count);
+
+    service.offline = NO;
+    [pipeline resume];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqual(0, failed);
+    XCTAssertEqual((NSUInteger)0, pipeline.parkedCount);
+    XCTAssertEqualObjects(members, [service.requests subarrayWithRange:NSMakeRange(5, 5)]);
+    for (NSUUID *member in members) {
+        XCTAssertEqual((NSUInteger)2, [service countWithKey:member]);
+    }
+}
+
+- (void)testEmptyPipeline {
+    TLTestService *service = newService();
+    TLRefreshPipeline *pipeline = newPipeline(service, 4);
+
+    int failed = -1;
+    [self refreshWithService:service pipeline:pipeline failedCount:&failed];
+    XCTAssertEqual(0, failed);
+    XCTAssertEqual((NSUInteger)0, service.requests.count);
+}
+
+@end
@@ -152,8 +152,88 @@ NSString * serializedDisabledDateTimeSchedule = @"en=0;tz=UTC;tr=dateTime,2023-1
     XCTAssertTrue([MONDAY_8AM_TO_10AM isTimestampInRangeWithTimeStamp:CHRISTMAS_2023_NINE_AM timeZone:UTC]);
 }
 
+- (void)testDateTimeNextTransition {
+    long start = CHRISTMAS_2023_PLUS_ONE_DAY - 86400;
+    
+    XCTAssertEqual(start, [dateTimeSchedule nextTransitionAfter:CHRISTMAS_2023_SEVEN_AM]);
+    XCTAssertEqual(NYE_2024_PLUS_ONE_HOUR - 3600 + 1, [dateTimeSchedule nextTransitionAfter:CHRISTMAS_2023_NINE_AM]);
+    XCTAssertEqual(TIME_RANGE_NO_TRANSITION, [dateTimeSchedule nextTransitionAfter:NYE_2024_PLUS_ONE_DAY]);
+}
+
+- (void)testWeeklyNextTransition {
+    // Monday 25/12 9am: leave at 10am, enter on Thursday 6pm, leave at 8pm and enter on Monday 8am.
+    long next = [weeklySchedule nextTransitionAfter:CHRISTMAS_2023_NINE_AM];
+    XCTAssertEqual(CHRISTMAS_2023_NINE_AM + 3600 + 1, next);
+    next = [weeklySchedule nextTransitionAfter:next];
+    XCTAssertEqual(CHRISTMAS_2023_NINE_AM + 3 * 86400 + 9 * 3600, next);
+    next = [weeklySchedule nextTransitionAfter:next];
+    XCTAssertEqual(CHRISTMAS_2023_NINE_AM + 3 * 86400 + 11 * 3600 + 1, next);
+    next = [weeklySchedule nextTransitionAfter:next];
+    XCTAssertEqual(CHRISTMAS_2023_NINE_AM + 7 * 86400 - 3600, next);
+}
+
+- (void)testDisabledNextTransition {
+    TLSchedule *schedule = [TLSchedule ofCapabilityWithCapabilityString:serializedDisabledDateTimeSchedule];
+    
+    XCTAssertEqual(TIME_RANGE_NO_TRANSITION, [schedule nextTransitionAfter:CHRISTMAS_2023_SEVEN_AM]);
+    schedule.enabled = YES;
+    XCTAssertEqual(CHRISTMAS_2023_PLUS_ONE_DAY - 86400, [schedule nextTransitionAfter:CHRISTMAS_2023_SEVEN_AM]);
+}
+
+- (void)testNextTransitionOverOneYear {
+    // The Sunday range contains the DST changes of Europe (last Sunday of March) and America (second Sunday of March).
+    NSArray<NSString *> *capabilities = @[
+        @"en=1;tz=%@;tr=weekly,1,08:00,10:00;tr=weekly,4,18:00,20:00",
+        @"en=1;tz=%@;tr=weekly,1-2-3-4-5,09:00,12:30;tr=weekly,1-2-3-4-5,12:30,18:00;tr=weekly,7,01:30,03:30",
+        @"en=1;tz=%@;tr=weekly,6,00:00,23:59;tr=dateTime,2024-03-30T12:00,2024-04-02T08:00;tr=dateTime,2024-10-26T23:00,2024-10-27T04:00"
+    ];
+    NSArray<NSString *> *timeZones = @[@"UTC", @"Europe/Paris", @"America/New_York"];
+    
+    for (NSString *timeZone in timeZones) {
+        for (NSString *capability in capabilities) {
+            NSString *serialized = [NSString stringWithFormat:capability, timeZone];
+            TLSchedule *schedule = [TLSchedule ofCapabilityWithCapabilityString:serialized];
+            XCTAssertNotNil(schedule, @"%@", serialized);
+            [self checkTransitionsWithSchedule:schedule from:CHRISTMAS_2023_SEVEN_AM to:CHRISTMAS_2023_SEVEN_AM + 366 * 86400 name:serialized];
+        }
+    }
+}
+
+- (void)testNextTransitionPerformance {
+    TLSchedule *schedule = [TLSchedule ofCapabilityWithCapabilityString:@"en=1;tz=Europe/Paris;tr=weekly,1-2-3-4-5,09:00,12:30;tr=weekly,1-2-3-4-5,14:00,18:00"];
+    
+    [self measureBlock:^{
+        long timestamp = CHRISTMAS_2023_SEVEN_AM;
+        for (int i = 0; i < 10000; i++) {
+            XCTAssertGreaterThan([schedule nextTransitionAfter:timestamp + i * 60], timestamp + i * 60);
+        }
+    }];
+}
+
 #pragma utilities
 
+/// Check minute by minute that the schedule state only changes at the transitions and that it changes at each of them.
+- (void) checkTransitionsWithSchedule:(TLSchedule *)schedule from:(long)from to:(long)to name:(NSString *)name {
+    BOOL state = [schedule isTimestampInRangeWithTimestamp:from];
+    long next = [schedule nextTransitionAfter:from];
+    int count = 0;
+    
+    for (long timestamp = from + 60; timestamp < to; timestamp += 60) {
+        while (next <= timestamp) {
+            BOOL nextState = [schedule isTimestampInRangeWithTimestamp:next];
+            XCTAssertNotEqual(state, nextState, @"%@: no change at %ld", name, next);
+            XCTAssertEqual(state, [schedule isTimestampInRangeWithTimestamp:next - 1], @"%@: change before %ld", name, next);
+            state = nextState;
+            count++;
+            long after = [schedule nextTransitionAfter:next];
+            XCTAssertGreaterThan(after, next, @"%@", name);
+            next = after;
+        }
+        XCTAssertEqual(state, [schedule isTimestampInRangeWithTimestamp:timestamp], @"%@: missed transition before %ld", name, timestamp);
+    }
+    XCTAssertGreaterThan(count, 0, @"%@", name);
+}
+
 - (TLTime *) mkTime:(NSString *)time{
     return [[TLTime alloc] initWithTimeString:time];
 }
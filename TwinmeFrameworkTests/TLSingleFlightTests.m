@@ -0,0 +1,352 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLSingleFlight.h"
+#import "TLGetGroupMemberExecutor.h"
+#import "TLGetGroupMemberReceiverExecutor.h"
+#import "TLTestService.h"
+
+#define LOOKUP_COUNT 1000
+#define MEMBER_COUNT 10
+#define LATENCY 0.01
+
+//
+// Group, find result and twinme context with only the methods used by the group member executors.
+//
+
+@interface TLTestOwner : NSObject
+
+@property (nonnull) NSUUID *uuid;
+
+@end
+
+@implementation TLTestOwner
+
+- (BOOL)isGroup {
+
+    return NO;
+}
+
+@end
+
+@interface TLTestFindResult : NSObject
+
+@property TLBaseServiceErrorCode errorCode;
+@property (nullable) id object;
+
+@end
+
+@implementation TLTestFindResult
+@end
+
+@interface TLTestTwinmeContext : NSObject
+
+@property (nonnull) TLTestService *twincodeService;
+@property BOOL cancelAdmission;
+@property TLBaseServiceErrorCode receiverErrorCode;
+@property int errorCount;
+@property int releaseCount;
+
+@end
+
+@implementation TLTestTwinmeContext
+
+- (void)admitWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+
+    if (self.cancelAdmission) {
+        cancel();
+    } else {
+        start();
+    }
+}
+
+- (void)releaseWithExecutor:(nonnull id)executor {
+
+    self.releaseCount++;
+}
+
+- (void)addDelegate:(nonnull TLAbstractTwinmeExecutor *)executor {
+
+    [executor onTwinlifeReady];
+}
+
+- (void)removeDelegate:(nonnull id)executor {
+}
+
+- (int64_t)newRequestId {
+
+    return 1;
+}
+
+- (void)fireOnErrorWithRequestId:(int64_t)requestId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(nullable NSString *)errorParameter {
+
+    self.errorCount++;
+}
+
+- (nonnull id)getTwincodeOutboundService {
+
+    return self;
+}
+
+- (void)getTwincodeWithTwincodeId:(nonnull NSUUID *)twincodeId refreshPeriod:(int64_t)refreshPeriod withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, id _Nullable twincodeOutbound))block {
+
+    [self.twincodeService requestWithKey:twincodeId complete:^(TLBaseServiceErrorCode errorCode) {
+        block(errorCode, nil);
+    }];
+}
+
+- (nonnull TLTestFindResult *)getReceiverWithTwincodeInboundId:(nonnull NSUUID *)twincodeInboundId {
+
+    TLTestFindResult *result = [[TLTestFindResult alloc] init];
+    result.errorCode = self.receiverErrorCode;
+    return result;
+}
+
+@end
+
+@interface TLSingleFlightTests : XCTestCase
+@end
+
+@implementation TLSingleFlightTests
+
+// Burst of lookups for the members of a group as when a group call starts: the executor
+// which loads a member only completes once every lookup was issued.
+- (void)testConcurrentLookups {
+    TLSingleFlight *lookups = [[TLSingleFlight alloc] init];
+    NSUUID *groupId = [NSUUID UUID];
+    NSMutableArray<NSUUID *> *members = [[NSMutableArray alloc] init];
+    for (int i = 0; i < MEMBER_COUNT; i++) {
+        [members addObject:[NSUUID UUID]];
+    }
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    dispatch_group_t issued = dispatch_group_create();
+    dispatch_group_t answered = dispatch_group_create();
+    __block int executorCount = 0;
+    __block int errors = 0;
+
+    dispatch_group_enter(issued);
+    dispatch_apply(LOOKUP_COUNT, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        NSUUID *memberId = members[iteration % MEMBER_COUNT];
+        TLSingleFlightKey *key = [[TLSingleFlightKey alloc] initWithFirst:groupId second:memberId];
+        dispatch_group_enter(answered);
+        int64_t generation = [lookups joinWithKey:key block:^(TLBaseServiceErrorCode errorCode, id result) {
+            if (errorCode != TLBaseServiceErrorCodeSuccess || ![memberId isEqual:result]) {
+                @synchronized (members) {
+                    errors++;
+                }
+            }
+            dispatch_group_leave(answered);
+        }];
+        if (generation) {
+            // Start the executor which answers on the twinlife queue.
+            dispatch_async(queue, ^{
+                @synchronized (members) {
+                    executorCount++;
+                }
+                dispatch_group_notify(issued, queue, ^{
+                    [lookups completeWithKey:key generation:generation errorCode:TLBaseServiceErrorCodeSuccess result:[[NSUUID alloc] initWithUUIDString:memberId.UUIDString]];
+                });
+            });
+        }
+    });
+    dispatch_group_leave(issued);
+
+    XCTAssertEqual(0L, dispatch_group_wait(answered, dispatch_time(DISPATCH_TIME_NOW, 10 * NSEC_PER_SEC)));
+    XCTAssertEqual(MEMBER_COUNT, executorCount);
+    XCTAssertEqual(0, errors);
+    XCTAssertEqual((NSUInteger)0, lookups.count);
+}
+
+- (void)testLookupAfterCompletion {
+    TLSingleFlight *lookups = [[TLSingleFlight alloc] init];
+    TLSingleFlightKey *key = [[TLSingleFlightKey alloc] initWithFirst:[NSUUID UUID] second:[NSUUID UUID]];
+    TLSingleFlightKey *sameKey = [[TLSingleFlightKey alloc] initWithFirst:key.first second:key.second];
+    __block int calls = 0;
+
+    XCTAssertEqualObjects(key, sameKey);
+    XCTAssertEqual(key.hash, sameKey.hash);
+    int64_t generation = [lookups joinWithKey:key block:^(TLBaseServiceErrorCode errorCode, id result) {
+        XCTAssertEqual(TLBaseServiceErrorCodeItemNotFound, errorCode);
+        calls++;
+    }];
+    XCTAssertNotEqual(0LL, generation);
+    XCTAssertEqual(0LL, [lookups joinWithKey:sameKey block:^(TLBaseServiceErrorCode errorCode, id result) {
+        calls++;
+    }]);
+    [lookups completeWithKey:key generation:generation errorCode:TLBaseServiceErrorCodeItemNotFound result:nil];
+    XCTAssertEqual(2, calls);
+
+    // The error is not remembered: a new lookup is started.
+    int64_t nextGeneration = [lookups joinWithKey:sameKey block:^(TLBaseServiceErrorCode errorCode, id result) {
+        calls++;
+    }];
+    XCTAssertGreaterThan(nextGeneration, generation);
+    [lookups completeWithKey:sameKey generation:nextGeneration errorCode:TLBaseServiceErrorCodeSuccess result:nil];
+    XCTAssertEqual(3, calls);
+}
+
+- (nonnull TLTestTwinmeContext *)newContext {
+
+    TLTestTwinmeContext *context = [[TLTestTwinmeContext alloc] init];
+    context.twincodeService = [[TLTestService alloc] initWithQueue:dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL) latency:LATENCY];
+    return context;
+}
+
+/// Look up the member the way the twinme context does: the executor is started from the twinlife queue.
+- (void)lookupMemberWithContext:(nonnull TLTestTwinmeContext *)context lookups:(nonnull TLSingleFlight *)lookups owner:(nonnull TLTestOwner *)owner memberId:(nonnull NSUUID *)memberId expect:(TLBaseServiceErrorCode)expect {
+
+    TLSingleFlightKey *key = [[TLSingleFlightKey alloc] initWithFirst:owner.uuid second:memberId];
+    XCTestExpectation *first = [self expectationWithDescription:@"first caller"];
+    XCTestExpectation *second = [self expectationWithDescription:@"second caller"];
+    __block int executorCount = 0;
+    TLSingleFlightStartBlock start = ^(TLSingleFlightBlock complete) {
+        executorCount++;
+        TLGetGroupMemberExecutor *executor = [[TLGetGroupMemberExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context owner:(id<TLOriginator>)owner groupMemberTwincodeId:memberId withBlock:complete];
+        dispatch_async(context.twincodeService.queue, ^{
+            [executor start];
+        });
+    };
+
+    [lookups lookupWithKey:key block:^(TLBaseServiceErrorCode errorCode, id result) {
+        XCTAssertEqual(expect, errorCode);
+        XCTAssertNil(result);
+        [first fulfill];
+    } start:start];
+    [lookups lookupWithKey:key block:^(TLBaseServiceErrorCode errorCode, id result) {
+        XCTAssertEqual(expect, errorCode);
+        [second fulfill];
+    } start:start];
+
+    [self waitForExpectations:@[first, second] timeout:10];
+    XCTAssertEqual(1, executorCount);
+    XCTAssertEqual((NSUInteger)0, lookups.count);
+}
+
+// The executor fails: the callers get the error and the next lookup starts a new executor.
+- (void)testGroupMemberExecutorError {
+    TLTestTwinmeContext *context = [self newContext];
+    TLSingleFlight *lookups = [[TLSingleFlight alloc] init];
+    TLTestOwner *owner = [[TLTestOwner alloc] init];
+    owner.uuid = [NSUUID UUID];
+    NSUUID *memberId = [NSUUID UUID];
+
+    [context.twincodeService failWithKey:memberId errorCode:TLBaseServiceErrorCodeItemNotFound count:1];
+    [self lookupMemberWithContext:context lookups:lookups owner:owner memberId:memberId expect:TLBaseServiceErrorCodeItemNotFound];
+    XCTAssertEqual(1, context.errorCount);
+    XCTAssertEqual(1, context.releaseCount);
+
+    [context.twincodeService failWithKey:memberId errorCode:TLBaseServiceErrorCodeTimeoutError count:1];
+    [self lookupMemberWithContext:context lookups:lookups owner:owner memberId:memberId expect:TLBaseServiceErrorCodeTimeoutError];
+    XCTAssertEqual((NSUInteger)2, [context.twincodeService countWithKey:memberId]);
+}
+
+// The executor is canceled while it waits to be admitted.
+- (void)testGroupMemberExecutorCanceled {
+    TLTestTwinmeContext *context = [self newContext];
+    TLSingleFlight *lookups = [[TLSingleFlight alloc] init];
+    TLTestOwner *owner = [[TLTestOwner alloc] init];
+    owner.uuid = [NSUUID UUID];
+    NSUUID *memberId = [NSUUID UUID];
+
+    context.cancelAdmission = YES;
+    [self lookupMemberWithContext:context lookups:lookups owner:owner memberId:memberId expect:TLBaseServiceErrorCodeCanceledOperation];
+    XCTAssertEqual(1, context.errorCount);
+    XCTAssertEqual((NSUInteger)0, [context.twincodeService countWithKey:memberId]);
+}
+
+- (void)testReceiverExecutorError {
+    TLTestTwinmeContext *context = [self newContext];
+    TLSingleFlight *lookups = [[TLSingleFlight alloc] init];
+    TLSingleFlightKey *key = [[TLSingleFlightKey alloc] initWithFirst:[NSUUID UUID] second:[NSUUID UUID]];
+    __block int calls = 0;
+
+    context.receiverErrorCode = TLBaseServiceErrorCodeItemNotFound;
+    for (int i = 0; i < 2; i++) {
+        [lookups lookupWithKey:key block:^(TLBaseServiceErrorCode errorCode, id result) {
+            XCTAssertEqual(TLBaseServiceErrorCodeItemNotFound, errorCode);
+            calls++;
+        } start:^(TLSingleFlightBlock complete) {
+            TLGetGroupMemberReceiverExecutor *executor = [[TLGetGroupMemberReceiverExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context twincodeInboundId:key.first memberTwincodeOutboundId:key.second withBlock:complete];
+            dispatch_async(context.twincodeService.queue, ^{
+                [executor start];
+            });
+        }];
+    }
+    dispatch_sync(context.twincodeService.queue, ^{});
+
+    XCTAssertEqual(2, calls);
+    XCTAssertEqual((NSUInteger)0, lookups.count);
+}
+
+// Sign out: the callers of the lookups in progress are released and the late result is dropped.
+- (void)testCompleteAll {
+    TLSingleFlight *lookups = [[TLSingleFlight alloc] init];
+    TLSingleFlightKey *key1 = [[TLSingleFlightKey alloc] initWithFirst:[NSUUID UUID] second:[NSUUID UUID]];
+    TLSingleFlightKey *key2 = [[TLSingleFlightKey alloc] initWithFirst:key1.first second:[NSUUID UUID]];
+    __block int calls = 0;
+    TLSingleFlightBlock block = ^(TLBaseServiceErrorCode errorCode, id result) {
+        XCTAssertEqual(TLBaseServiceErrorCodeCanceledOperation, errorCode);
+        calls++;
+    };
+
+    int64_t generation1 = [lookups joinWithKey:key1 block:block];
+    XCTAssertNotEqual(0LL, generation1);
+    XCTAssertEqual(0LL, [lookups joinWithKey:key1 block:block]);
+    XCTAssertNotEqual(0LL, [lookups joinWithKey:key2 block:block]);
+    [lookups completeAllWithErrorCode:TLBaseServiceErrorCodeCanceledOperation];
+    XCTAssertEqual(3, calls);
+    XCTAssertEqual((NSUInteger)0, lookups.count);
+
+    [lookups completeWithKey:key1 generation:generation1 errorCode:TLBaseServiceErrorCodeSuccess result:nil];
+    XCTAssertEqual(3, calls);
+}
+
+// The executor of the old account completes after the sign out while the new account looks up the
+// same member: its result is dropped and the new lookup gets the result of its own executor.
+- (void)testLateCompletionAfterCompleteAll {
+    TLSingleFlight *lookups = [[TLSingleFlight alloc] init];
+    TLSingleFlightKey *key = [[TLSingleFlightKey alloc] initWithFirst:[NSUUID UUID] second:[NSUUID UUID]];
+    NSUUID *oldMember = [NSUUID UUID];
+    NSUUID *newMember = [NSUUID UUID];
+    __block TLSingleFlightBlock oldComplete = nil;
+    __block TLSingleFlightBlock newComplete = nil;
+    __block int oldCalls = 0;
+    NSMutableArray *results = [[NSMutableArray alloc] init];
+
+    [lookups lookupWithKey:key block:^(TLBaseServiceErrorCode errorCode, id result) {
+        XCTAssertEqual(TLBaseServiceErrorCodeCanceledOperation, errorCode);
+        oldCalls++;
+    } start:^(TLSingleFlightBlock complete) {
+        oldComplete = complete;
+    }];
+    [lookups completeAllWithErrorCode:TLBaseServiceErrorCodeCanceledOperation];
+    XCTAssertEqual(1, oldCalls);
+
+    for (int i = 0; i < 2; i++) {
+        [lookups lookupWithKey:key block:^(TLBaseServiceErrorCode errorCode, id result) {
+            XCTAssertEqual(TLBaseServiceErrorCodeSuccess, errorCode);
+            [results addObject:result];
+        } start:^(TLSingleFlightBlock complete) {
+            XCTAssertNil(newComplete);
+            newComplete = complete;
+        }];
+    }
+    XCTAssertNotNil(newComplete);
+
+    // The late result of the old account is not given to the callers of the new lookup.
+    oldComplete(TLBaseServiceErrorCodeSuccess, oldMember);
+    XCTAssertEqual(1, oldCalls);
+    XCTAssertEqual((NSUInteger)0, results.count);
+    XCTAssertEqual((NSUInteger)1, lookups.count);
+
+    newComplete(TLBaseServiceErrorCodeSuccess, newMember);
+    NSArray *expected = @[newMember, newMember];
+    XCTAssertEqualObjects(expected, results);
+    XCTAssertEqual((NSUInteger)0, lookups.count);
+}
+
+@end
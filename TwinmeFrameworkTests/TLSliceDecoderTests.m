@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <Twinlife/TLBinaryDecoder.h>
+#import <Twinlife/TLBinaryEncoder.h>
+#import <Twinlife/TLConversationService.h>
+
+#import "TLSliceDecoder.h"
+#import "TLPushNotificationContent.h"
+
+#define FUZZ_COUNT 200
+#define MUTATION_COUNT 20
+#define BENCHMARK_COUNT 20000
+
+typedef BOOL (^TLSameObject)(NSObject *object1, NSObject *object2);
+
+@interface TLSliceDecoderTests : XCTestCase
+@end
+
+@implementation TLSliceDecoderTests
+
+static TLSerializerFactory *serializerFactory = nil;
+
+- (NSData *)encodeWithBlock:(void (^)(TLBinaryEncoder *encoder))block {
+
+    NSMutableData *data = [[NSMutableData alloc] init];
+    TLBinaryEncoder *encoder = [[TLBinaryEncoder alloc] initWithData:data];
+    block(encoder);
+    return data;
+}
+
+- (NSData *)encodeWithSerializer:(TLSerializer *)serializer object:(NSObject *)object {
+
+    return [self encodeWithBlock:^(TLBinaryEncoder *encoder) {
+        [serializer serializeWithSerializerFactory:serializerFactory encoder:encoder object:object];
+    }];
+}
+
+/// Decode the data with TLBinaryDecoder and with TLSliceDecoder: both must fail or give the same object.
+- (void)checkSerializer:(TLSerializer *)serializer data:(NSData *)data same:(TLSameObject)same {
+
+    NSObject *expect = nil, *object = nil;
+    BOOL expectFailed = NO, failed = NO;
+    @try {
+        TLBinaryDecoder *decoder = [[TLBinaryDecoder alloc] initWithData:data];
+        [decoder readUUID];
+        [decoder readInt];
+        expect = [serializer deserializeWithSerializerFactory:serializerFactory decoder:decoder];
+    } @catch (NSException *exception) {
+        expectFailed = YES;
+    }
+    @try {
+        TLSliceDecoder *decoder = [[TLSliceDecoder alloc] initWithData:data];
+        [decoder readUUID];
+        [decoder readInt];
+        object = [(id<TLSliceDeserializer>)serializer deserializeWithSliceDecoder:decoder];
+    } @catch (NSException *exception) {
+        failed = YES;
+    }
+    XCTAssertEqual(expectFailed, failed, @"%@ %@", serializer, data);
+    if (!expectFailed && !failed) {
+        XCTAssertTrue(same(expect, object), @"%@ %@", serializer, data);
+    }
+}
+
+/// Check the valid data, every truncation and some random mutations of the data.
+- (void)fuzzSerializer:(TLSerializer *)serializer data:(NSData *)data same:(TLSameObject)same {
+
+    [self checkSerializer:serializer data:data same:same];
+    for (NSUInteger length = 0; length < data.length; length++) {
+        [self checkSerializer:serializer data:[data subdataWithRange:NSMakeRange(0, length)] same:same];
+    }
+    for (int i = 0; i < MUTATION_COUNT && data.length > 0; i++) {
+        NSMutableData *mutated = [data mutableCopy];
+        uint8_t *bytes = mutated.mutableBytes;
+        bytes[random() % mutated.length] = (uint8_t)random();
+        [self checkSerializer:serializer data:mutated same:same];
+    }
+}
+
+- (void)setUp {
+    srandom(20251018);
+}
+
+- (void)testSliceDecoder {
+    NSUUID *uuid = [NSUUID UUID];
+    NSData *data = [self encodeWithBlock:^(TLBinaryEncoder *encoder) {
+        [encoder writeLong:INT64_MIN];
+        [encoder writeLong:INT64_MAX];
+        [encoder writeInt:-1];
+        [encoder writeEnum:14];
+        [encoder writeUUID:uuid];
+        [encoder writeString:@"push-message"];
+        [encoder writeString:@""];
+        [encoder writeData:[NSData dataWithBytes:"\x00\x01\x02" length:3]];
+    }];
+
+    TLSliceDecoder *decoder = [[TLSliceDecoder alloc] initWithData:data];
+    XCTAssertEqual(INT64_MIN, [decoder readLong]);
+    XCTAssertEqual(INT64_MAX, [decoder readLong]);
+    XCTAssertEqual(-1, [decoder readInt]);
+    XCTAssertEqual(14, [decoder readEnum]);
+    XCTAssertEqualObjects(uuid, [decoder readUUID]);
+    TLDataSlice *slice = [decoder readStringSlice];
+    XCTAssertTrue([slice isEqualToUTF8String:"push-message"]);
+    XCTAssertFalse([slice isEqualToUTF8String:"push-messages"]);
+    XCTAssertEqualObjects(@"push-message", slice.string);
+    XCTAssertEqual(slice.string, slice.string);
+    XCTAssertEqualObjects(@"", [decoder readStringSlice].string);
+    XCTAssertEqualObjects([NSData dataWithBytes:"\x00\x01\x02" length:3], [decoder readDataSlice].data);
+    XCTAssertEqual(data.length, decoder.offset);
+    XCTAssertThrows([decoder readLong]);
+}
+
+- (void)testPushNotificationContent {
+    TLSerializer *serializer = TLPushNotificationContent.SERIALIZER;
+    TLSameObject same = ^BOOL(NSObject *object1, NSObject *object2) {
+        TLPushNotificationContent *content1 = (TLPushNotificationContent *)object1;
+        TLPushNotificationContent *content2 = (TLPushNotificationContent *)object2;
+        return [content1.sessionId isEqual:content2.sessionId] && [content1.twincodeInboundId isEqual:content2.twincodeInboundId]
+            && content1.priority == content2.priority && content1.operation == content2.operation;
+    };
+
+    for (int i = 0; i < FUZZ_COUNT; i++) {
+        TLPeerConnectionServiceNotificationPriority priority = random() % 2 ? TLPeerConnectionServiceNotificationPriorityHigh : TLPeerConnectionServiceNotificationPriorityLow;
+        TLPeerConnectionServiceNotificationOperation operations[] = {
+            TLPeerConnectionServiceNotificationOperationAudioCall, TLPeerConnectionServiceNotificationOperationVideoCall,
+            TLPeerConnectionServiceNotificationOperationVideoBell, TLPeerConnectionServiceNotificationOperationPushMessage,
+            TLPeerConnectionServiceNotificationOperationPushFile, TLPeerConnectionServiceNotificationOperationPushImage,
+            TLPeerConnectionServiceNotificationOperationPushAudio, TLPeerConnectionServiceNotificationOperationPushVideo
+        };
+        TLPushNotificationContent *content = [[TLPushNotificationContent alloc] initWithSessionId:[NSUUID UUID] twincodeInboundId:[NSUUID UUID] priority:priority operation:operations[random() % 8]];
+        [self fuzzSerializer:serializer data:[self encodeWithSerializer:serializer object:content] same:same];
+    }
+
+    // Unknown priority and operation.
+    NSData *data = [self encodeWithBlock:^(TLBinaryEncoder *encoder) {
+        [encoder writeUUID:TLPushNotificationContent.SCHEMA_ID];
+        [encoder writeInt:TLPushNotificationContent.SCHEMA_VERSION];
+        [encoder writeUUID:[NSUUID UUID]];
+        [encoder writeUUID:[NSUUID UUID]];
+        [encoder writeString:@"hig"];
+        [encoder writeString:@"push-messages"];
+    }];
+    [self fuzzSerializer:serializer data:data same:same];
+}
+
+// Push notifications received while the application is in background: each one is decrypted and decoded.
+- (NSArray<NSData *> *)benchmarkContents {
+
+    TLSerializer *serializer = TLPushNotificationContent.SERIALIZER;
+    NSMutableArray<NSData *> *list = [[NSMutableArray alloc] initWithCapacity:BENCHMARK_COUNT];
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        TLPeerConnectionServiceNotificationPriority priority = i % 2 ? TLPeerConnectionServiceNotificationPriorityHigh : TLPeerConnectionServiceNotificationPriorityLow;
+        TLPushNotificationContent *content = [[TLPushNotificationContent alloc] initWithSessionId:[NSUUID UUID] twincodeInboundId:[NSUUID UUID] priority:priority operation:TLPeerConnectionServiceNotificationOperationPushMessage];
+        [list addObject:[self encodeWithSerializer:serializer object:content]];
+    }
+    return list;
+}
+
+- (void)testDecoderThroughput {
+    TLSerializer *serializer = TLPushNotificationContent.SERIALIZER;
+    NSArray<NSData *> *contents = [self benchmarkContents];
+
+    [self measureBlock:^{
+        int total = 0;
+        for (NSData *data in contents) {
+            TLBinaryDecoder *decoder = [[TLBinaryDecoder alloc] initWithData:data];
+            [decoder readUUID];
+            [decoder readInt];
+            TLPushNotificationContent *content = (TLPushNotificationContent *)[serializer deserializeWithSerializerFactory:serializerFactory decoder:decoder];
+            total += content.priority == TLPeerConnectionServiceNotificationPriorityHigh ? 1 : 0;
+        }
+        XCTAssertEqual(BENCHMARK_COUNT / 2, total);
+    }];
+}
+
+- (void)testSliceDecoderThroughput {
+    TLSerializer *serializer = TLPushNotificationContent.SERIALIZER;
+    NSArray<NSData *> *contents = [self benchmarkContents];
+
+    [self measureBlock:^{
+        int total = 0;
+        for (NSData *data in contents) {
+            TLSliceDecoder *decoder = [[TLSliceDecoder alloc] initWithData:data];
+            [decoder readUUID];
+            [decoder readInt];
+            TLPushNotificationContent *content = (TLPushNotificationContent *)[(id<TLSliceDeserializer>)serializer deserializeWithSliceDecoder:decoder];
+            total += content.priority == TLPeerConnectionServiceNotificationPriorityHigh ? 1 : 0;
+        }
+        XCTAssertEqual(BENCHMARK_COUNT / 2, total);
+    }];
+}
+
+@end
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLSpaceOriginatorCache.h"
+
+@interface TLSpaceOriginatorCacheTests : XCTestCase
+@end
+
+@implementation TLSpaceOriginatorCacheTests
+
+// The uncached path: scan every originator to find those of the space.
+static NSSet<NSUUID *> *loadOriginatorSet(NSDictionary<NSUUID *, NSUUID *> *originators, NSUUID *spaceId) {
+
+    NSMutableSet<NSUUID *> *result = [[NSMutableSet alloc] init];
+    for (NSUUID *originatorId in originators) {
+        if ([originators[originatorId] isEqual:spaceId]) {
+            [result addObject:originatorId];
+        }
+    }
+    return result;
+}
+
+static NSSet<NSUUID *> *getOriginatorSet(TLSpaceOriginatorCache *cache, NSDictionary<NSUUID *, NSUUID *> *originators, NSUUID *spaceId) {
+
+    NSSet<NSUUID *> *result = [cache originatorSetWithSpaceId:spaceId];
+    if (!result) {
+        int64_t version = cache.version;
+        result = loadOriginatorSet(originators, spaceId);
+        [cache putWithSpaceId:spaceId originatorSet:result version:version];
+    }
+    return result;
+}
+
+- (void)testRandomConsistency {
+    TLSpaceOriginatorCache *cache = [[TLSpaceOriginatorCache alloc] init];
+    NSMutableDictionary<NSUUID *, NSUUID *> *originators = [[NSMutableDictionary alloc] init];
+    NSMutableArray<NSUUID *> *spaces = [[NSMutableArray alloc] init];
+    for (int i = 0; i < 5; i++) {
+        [spaces addObject:[NSUUID UUID]];
+    }
+
+    srand48(38);
+    for (int i = 0; i < 20000; i++) {
+        NSUUID *spaceId = spaces[(NSUInteger)(drand48() * spaces.count)];
+        double op = drand48();
+        if (op < 0.25 || originators.count == 0) {
+            // Create a contact or group.
+            NSUUID *originatorId = [NSUUID UUID];
+            originators[originatorId] = spaceId;
+            [cache updateWithOriginatorId:originatorId spaceId:spaceId];
+
+        } else if (op < 0.4) {
+            // Move to another space.
+            NSUUID *originatorId = originators.allKeys[(NSUInteger)(drand48() * originators.count)];
+            originators[originatorId] = spaceId;
+            [cache updateWithOriginatorId:originatorId spaceId:spaceId];
+
+        } else if (op < 0.5) {
+            // Update without a space change.
+            NSUUID *originatorId = originators.allKeys[(NSUInteger)(drand48() * originators.count)];
+            [cache updateWithOriginatorId:originatorId spaceId:originators[originatorId]];
+
+        } else if (op < 0.6) {
+            NSUUID *originatorId = originators.allKeys[(NSUInteger)(drand48() * originators.count)];
+            [originators removeObjectForKey:originatorId];
+            [cache updateWithOriginatorId:originatorId spaceId:nil];
+
+        } else if (op < 0.61) {
+            [cache removeWithSpaceId:spaceId];
+
+        } else if (op < 0.615) {
+            [cache removeAll];
+
+        } else if (op < 0.65) {
+            // A change made while the set is loaded must prevent to cache the stale set.
+            int64_t version = cache.version;
+            NSSet<NSUUID *> *stale = loadOriginatorSet(originators, spaceId);
+            NSUUID *originatorId = [NSUUID UUID];
+            originators[originatorId] = spaceId;
+            [cache updateWithOriginatorId:originatorId spaceId:spaceId];
+            [cache putWithSpaceId:spaceId originatorSet:stale version:version];
+
+        } else {
+            XCTAssertEqualObjects(loadOriginatorSet(originators, spaceId), getOriginatorSet(cache, originators, spaceId), @"step %d", i);
+        }
+    }
+
+    for (NSUUID *spaceId in spaces) {
+        XCTAssertEqualObjects(loadOriginatorSet(originators, spaceId), getOriginatorSet(cache, originators, spaceId));
+    }
+}
+
+- (void)testLookupPerformance {
+    TLSpaceOriginatorCache *cache = [[TLSpaceOriginatorCache alloc] init];
+    NSMutableArray<NSUUID *> *spaces = [[NSMutableArray alloc] init];
+    for (int i = 0; i < 20; i++) {
+        NSUUID *spaceId = [NSUUID UUID];
+        NSMutableSet<NSUUID *> *originators = [[NSMutableSet alloc] init];
+        for (int j = 0; j < 1000; j++) {
+            [originators addObject:[NSUUID UUID]];
+        }
+        [spaces addObject:spaceId];
+        [cache putWithSpaceId:spaceId originatorSet:originators version:cache.version];
+    }
+
+    [self measureBlock:^{
+        NSUInteger count = 0;
+        for (int i = 0; i < 100000; i++) {
+            count += [cache originatorSetWithSpaceId:spaces[i % 20]].count;
+        }
+        XCTAssertEqual((NSUInteger)100000 * 1000, count);
+    }];
+}
+
+- (void)testUpdatePerformance {
+    TLSpaceOriginatorCache *cache = [[TLSpaceOriginatorCache alloc] init];
+    NSMutableArray<NSUUID *> *spaces = [[NSMutableArray alloc] init];
+    NSMutableArray<NSUUID *> *originators = [[NSMutableArray alloc] init];
+    for (int i = 0; i < 20; i++) {
+        NSUUID *spaceId = [NSUUID UUID];
+        NSMutableSet<NSUUID *> *set = [[NSMutableSet alloc] init];
+        for (int j = 0; j < 1000; j++) {
+            NSUUID *originatorId = [NSUUID UUID];
+            [set addObject:originatorId];
+            [originators addObject:originatorId];
+        }
+        [spaces addObject:spaceId];
+        [cache putWithSpaceId:spaceId originatorSet:set version:cache.version];
+    }
+
+    // Move originators between spaces: two sets of 1k are copied for each move.
+    [self measureBlock:^{
+        for (int i = 0; i < 1000; i++) {
+            [cache updateWithOriginatorId:originators[(i * 7919) % originators.count] spaceId:spaces[i % 20]];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,170 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "TLSpaceSnapshot.h"
+#import "TLSpace.h"
+
+#define SPACE_COUNT 16
+#define READ_COUNT 200000
+
+//
+// Interface: TLTestSpaceRegistry
+//
+
+/// Publish the spaces as the twinme context does: atomic snapshot for readers, writers hold the lock.
+@interface TLTestSpaceRegistry : NSObject
+
+@property (nonnull) TLSpaceSnapshot *spaces;
+@property (readonly, nonnull) NSMutableDictionary<NSUUID *, TLSpace *> *lockedSpaces;
+
+@end
+
+@implementation TLTestSpaceRegistry
+
+- (nonnull instancetype)init {
+
+    self = [super init];
+    if (self) {
+        _spaces = [[TLSpaceSnapshot alloc] init];
+        _lockedSpaces = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)putSpace:(nonnull TLSpace *)space {
+
+    @synchronized (self) {
+        self.spaces = [self.spaces snapshotWithSpace:space];
+        self.lockedSpaces[space.uuid] = space;
+    }
+}
+
+- (void)removeSpace:(nonnull NSUUID *)spaceId {
+
+    @synchronized (self) {
+        self.spaces = [self.spaces snapshotWithoutSpaceId:spaceId];
+        [self.lockedSpaces removeObjectForKey:spaceId];
+    }
+}
+
+@end
+
+@interface TLSpaceSnapshotTests : XCTestCase
+@end
+
+@implementation TLSpaceSnapshotTests
+
+static TLSpace *newSpace(NSUUID *spaceId) {
+
+    TLDatabaseIdentifier *identifier = nil;
+    return [[TLSpace alloc] initWithIdentifier:identifier uuid:spaceId creationDate:0 modificationDate:0];
+}
+
+- (void)testPutAndRemove {
+    TLSpaceSnapshot *empty = [[TLSpaceSnapshot alloc] init];
+    TLSpace *space1 = newSpace([NSUUID UUID]);
+    TLSpace *space2 = newSpace([NSUUID UUID]);
+    TLSpace *space1bis = newSpace(space1.uuid);
+
+    TLSpaceSnapshot *snapshot = [[empty snapshotWithSpace:space1] snapshotWithSpace:space2];
+    XCTAssertEqual((NSUInteger)0, empty.list.count);
+    XCTAssertEqual(snapshot, [snapshot snapshotWithSpace:space2]);
+    XCTAssertEqual(snapshot, [snapshot snapshotWithoutSpaceId:[NSUUID UUID]]);
+
+    // A new instance of a space replaces the old one at the same position.
+    TLSpaceSnapshot *replaced = [snapshot snapshotWithSpace:space1bis];
+    XCTAssertEqual(space1, snapshot.list[0]);
+    XCTAssertEqual(space1bis, replaced.list[0]);
+    XCTAssertEqual(space1bis, [replaced spaceWithSpaceId:space1.uuid]);
+    XCTAssertEqual((NSUInteger)2, replaced.list.count);
+
+    TLSpaceSnapshot *removed = [replaced snapshotWithoutSpaceId:space1.uuid];
+    XCTAssertNil([removed spaceWithSpaceId:space1.uuid]);
+    XCTAssertEqualObjects(@[space2], removed.list);
+    XCTAssertEqual(space1bis, [replaced spaceWithSpaceId:space1.uuid]);
+}
+
+- (void)testConcurrentReadersAndWriters {
+    TLTestSpaceRegistry *registry = [[TLTestSpaceRegistry alloc] init];
+    NSMutableArray<NSUUID *> *spaceIds = [[NSMutableArray alloc] init];
+    for (int i = 0; i < SPACE_COUNT; i++) {
+        [spaceIds addObject:[NSUUID UUID]];
+    }
+    __block int errors = 0;
+
+    // Even iterations write, odd iterations read: a snapshot must always be consistent.
+    dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (int i = 0; i < 20000; i++) {
+            NSUUID *spaceId = spaceIds[(i * 7 + iteration) % SPACE_COUNT];
+            if ((iteration & 1) == 0) {
+                if (i % 3 == 0) {
+                    [registry removeSpace:spaceId];
+                } else {
+                    [registry putSpace:newSpace(spaceId)];
+                }
+            } else {
+                TLSpaceSnapshot *snapshot = registry.spaces;
+                BOOL valid = snapshot.list.count == snapshot.spaces.count;
+                for (TLSpace *space in snapshot.list) {
+                    valid = valid && [snapshot spaceWithSpaceId:space.uuid] == space;
+                }
+                if (!valid) {
+                    @synchronized (spaceIds) {
+                        errors++;
+                    }
+                }
+            }
+        }
+    });
+
+    XCTAssertEqual(0, errors);
+    XCTAssertEqualObjects([NSSet setWithArray:registry.lockedSpaces.allValues], [NSSet setWithArray:registry.spaces.list]);
+}
+
+// Readers look up the spaces while other threads hold the context lock for unrelated work.
+- (void)measureReadsWithLock:(BOOL)locked {
+    TLTestSpaceRegistry *registry = [[TLTestSpaceRegistry alloc] init];
+    NSMutableArray<NSUUID *> *spaceIds = [[NSMutableArray alloc] init];
+    for (int i = 0; i < SPACE_COUNT; i++) {
+        NSUUID *spaceId = [NSUUID UUID];
+        [spaceIds addObject:spaceId];
+        [registry putSpace:newSpace(spaceId)];
+    }
+
+    [self measureBlock:^{
+        dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+            NSUInteger found = 0;
+            for (int i = 0; i < READ_COUNT; i++) {
+                NSUUID *spaceId = spaceIds[i % SPACE_COUNT];
+                if (iteration == 0 && i % 64 == 0) {
+                    // The context lock is also used by the other context operations.
+                    @synchronized (registry) {
+                        usleep(10);
+                    }
+                }
+                if (locked) {
+                    @synchronized (registry) {
+                        found += registry.lockedSpaces[spaceId] ? 1 : 0;
+                    }
+                } else {
+                    found += [registry.spaces spaceWithSpaceId:spaceId] ? 1 : 0;
+                }
+            }
+            XCTAssertEqual((NSUInteger)READ_COUNT, found);
+        });
+    }];
+}
+
+- (void)testSnapshotReadContention {
+    [self measureReadsWithLock:NO];
+}
+
+- (void)testLockedReadContention {
+    [self measureReadsWithLock:YES];
+}
+
+@end
@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <Twinlife/TLBaseService.h>
+
+//
+// Interface: TLTestService
+//
+
+/**
+ * Stand-in for a twinlife service call that makes a server round-trip.
+ *
+ * - each request is answered from the queue after the latency,
+ * - the requests are recorded in their order with the number of requests in progress,
+ * - a request fails with the error code given to failWithKey:errorCode:count:, while offline
+ *   every request fails with TwinlifeOffline.
+ */
+@interface TLTestService : NSObject
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly) NSTimeInterval latency;
+@property (readonly, nonnull) NSArray *requests;
+@property (readonly) int running;
+@property (readonly) int maxRunning;
+@property BOOL offline;
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue latency:(NSTimeInterval)latency;
+
+/// Fail the next `count` requests for the key with the error, a negative count fails all of them.
+- (void)failWithKey:(nonnull id<NSCopying>)key errorCode:(TLBaseServiceErrorCode)errorCode count:(int)count;
+
+/// Number of requests made for the key.
+- (NSUInteger)countWithKey:(nonnull id)key;
+
+/// Answer the request for the key after the latency.
+- (void)requestWithKey:(nonnull id<NSCopying>)key complete:(nonnull void (^)(TLBaseServiceErrorCode errorCode))complete;
+
+@end
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import "TLTestService.h"
+
+//
+// Interface: TLTestService ()
+//
+
+@interface TLTestService ()
+
+@property (readonly, nonnull) NSMutableArray *requestList;
+@property (readonly, nonnull) NSCountedSet *requestCounts;
+@property (readonly, nonnull) NSMutableDictionary<id<NSCopying>, NSNumber *> *failureCodes;
+@property (readonly, nonnull) NSMutableDictionary<id<NSCopying>, NSNumber *> *failureCounts;
+@property int runningCount;
+@property int maxRunningCount;
+
+@end
+
+//
+// Implementation: TLTestService
+//
+
+@implementation TLTestService
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue latency:(NSTimeInterval)latency {
+
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _latency = latency;
+        _requestList = [[NSMutableArray alloc] init];
+        _requestCounts = [[NSCountedSet alloc] init];
+        _failureCodes = [[NSMutableDictionary alloc] init];
+        _failureCounts = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (nonnull NSArray *)requests {
+
+    @synchronized (self) {
+        return [self.requestList copy];
+    }
+}
+
+- (int)running {
+
+    @synchronized (self) {
+        return self.runningCount;
+    }
+}
+
+- (int)maxRunning {
+
+    @synchronized (self) {
+        return self.maxRunningCount;
+    }
+}
+
+- (void)failWithKey:(nonnull id<NSCopying>)key errorCode:(TLBaseServiceErrorCode)errorCode count:(int)count {
+
+    @synchronized (self) {
+        self.failureCodes[key] = [NSNumber numberWithInt:errorCode];
+        self.failureCounts[key] = [NSNumber numberWithInt:count];
+    }
+}
+
+- (NSUInteger)countWithKey:(nonnull id)key {
+
+    @synchronized (self) {
+        return [self.requestCounts countForObject:key];
+    }
+}
+
+- (void)requestWithKey:(nonnull id<NSCopying>)key complete:(nonnull void (^)(TLBaseServiceErrorCode errorCode))complete {
+
+    TLBaseServiceErrorCode errorCode = TLBaseServiceErrorCodeSuccess;
+    @synchronized (self) {
+        [self.requestList addObject:key];
+        [self.requestCounts addObject:key];
+        self.runningCount++;
+        self.maxRunningCount = MAX(self.maxRunningCount, self.runningCount);
+        int count = self.failureCounts[key].intValue;
+        if (self.offline) {
+            errorCode = TLBaseServiceErrorCodeTwinlifeOffline;
+        } else if (count != 0) {
+            errorCode = (TLBaseServiceErrorCode)self.failureCodes[key].intValue;
+            if (count > 0) {
+                self.failureCounts[key] = [NSNumber numberWithInt:count - 1];
+            }
+        }
+    }
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.latency * NSEC_PER_SEC)), self.queue, ^{
+        @synchronized (self) {
+            self.runningCount--;
+        }
+        complete(errorCode);
+    });
+}
+
+@end
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <Twinlife/TLAttributeNameValue.h>
+
+#import "TLTwinmeRepositoryObject.h"
+
+#define READ_COUNT 1000000
+#define CONTACT_COUNT 1000
+
+//
+// Interface: TLTestExportObject
+//
+
+/// Object exporting its attributes as TLContact does and counting the attributes it creates.
+@interface TLTestExportObject : TLTwinmeOriginatorObject
+
+@property int buildCount;
+
+@end
+
+@implementation TLTestExportObject
+
+- (nonnull NSArray<TLAttributeNameValue *> *)attributesWithAll:(BOOL)exportAll {
+
+    NSString *name = self.name;
+    NSString *description = self.objectDescription;
+    TLSpace *space = self.space;
+    TLTwincodeInbound *twincodeInbound = self.twincodeInbound;
+    TLTwincodeOutbound *twincodeOutbound = self.twincodeOutbound;
+    NSUUID *twincodeFactoryId = self.twincodeFactoryId;
+    __unsafe_unretained id values[] = { name, description, space, twincodeInbound, twincodeOutbound, twincodeFactoryId };
+    return [self attributesWithAll:exportAll values:values count:sizeof(values) / sizeof(values[0]) builder:^NSArray<TLAttributeNameValue *> * {
+        NSMutableArray *attributes = [NSMutableArray array];
+        if (exportAll) {
+            [self exportAttributes:attributes name:name description:description twincodeInbound:twincodeInbound twincodeOutbound:twincodeOutbound twincodeFactoryId:twincodeFactoryId space:space];
+        }
+        self.buildCount += (int)attributes.count;
+        return attributes;
+    }];
+}
+
+@end
+
+@interface TLTwinmeRepositoryObjectTests : XCTestCase
+@end
+
+@implementation TLTwinmeRepositoryObjectTests
+
+static TLTwinmeOriginatorObject *newObject(void) {
+
+    TLDatabaseIdentifier *identifier = nil;
+    TLTwinmeOriginatorObject *object = [[TLTwinmeOriginatorObject alloc] initWithIdentifier:identifier uuid:[NSUUID UUID] creationDate:0 modificationDate:0];
+    object.name = @"name-0";
+    object.objectDescription = @"description-0";
+    return object;
+}
+
+- (void)testConcurrentReadersAndWriters {
+    TLTwinmeOriginatorObject *object = newObject();
+    NSMutableArray<NSString *> *names = [[NSMutableArray alloc] init];
+    NSMutableArray<NSUUID *> *factories = [[NSMutableArray alloc] init];
+    for (int i = 0; i < 16; i++) {
+        [names addObject:[NSString stringWithFormat:@"name-%d", i]];
+        [factories addObject:[NSUUID UUID]];
+    }
+    NSSet<NSString *> *validNames = [NSSet setWithArray:names];
+    NSSet<NSUUID *> *validFactories = [NSSet setWithArray:factories];
+    __block int errors = 0;
+
+    // Even iterations write, odd iterations read.
+    dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (int i = 0; i < 200000; i++) {
+            if ((iteration & 1) == 0) {
+                object.name = names[(i + iteration) % names.count];
+                object.twincodeFactoryId = factories[(i * 3 + iteration) % factories.count];
+                object.objectDescription = [NSString stringWithFormat:@"description-%d", i];
+            } else {
+                NSString *name = object.name;
+                NSUUID *factoryId = object.twincodeFactoryId;
+                NSString *description = object.objectDescription;
+                if (![validNames containsObject:name] || (factoryId && ![validFactories containsObject:factoryId]) || ![description hasPrefix:@"description-"]) {
+                    @synchronized (validNames) {
+                        errors++;
+                    }
+                }
+                (void)object.space;
+                (void)object.twincodeOutboundId;
+                (void)object.hasPrivateIdentity;
+            }
+        }
+    });
+
+    XCTAssertEqual(0, errors);
+}
+
+- (void)testExportedAttributesReused {
+    TLDatabaseIdentifier *identifier = nil;
+    TLTestExportObject *object = [[TLTestExportObject alloc] initWithIdentifier:identifier uuid:[NSUUID UUID] creationDate:0 modificationDate:0];
+    object.name = @"contact";
+    object.objectDescription = @"description";
+    object.twincodeFactoryId = [NSUUID UUID];
+
+    NSArray<TLAttributeNameValue *> *first = [object attributesWithAll:YES];
+    XCTAssertEqual(3, object.buildCount);
+
+    // Saving again without a change creates no attribute.
+    for (int i = 0; i < 10; i++) {
+        XCTAssertEqual(first, [object attributesWithAll:YES]);
+    }
+    XCTAssertEqual(3, object.buildCount);
+
+    // Each flavor has its own attributes.
+    XCTAssertEqual((NSUInteger)0, [object attributesWithAll:NO].count);
+    XCTAssertEqual([object attributesWithAll:NO], [object attributesWithAll:NO]);
+    XCTAssertEqual(first, [object attributesWithAll:YES]);
+
+    // A change rebuilds the attributes.
+    int count = object.buildCount;
+    object.twincodeFactoryId = [NSUUID UUID];
+    NSArray<TLAttributeNameValue *> *second = [object attributesWithAll:YES];
+    XCTAssertNotEqual(first, second);
+    XCTAssertEqual(count + 3, object.buildCount);
+    XCTAssertEqualObjects(object.twincodeFactoryId.UUIDString, ((TLAttributeNameStringValue *)second[2]).value);
+}
+
+// A profile update saves the 1k contacts of the profile while only one of them is modified.
+- (void)testSavePerformance {
+    NSMutableArray<TLTestExportObject *> *contacts = [[NSMutableArray alloc] initWithCapacity:CONTACT_COUNT];
+    for (int i = 0; i < CONTACT_COUNT; i++) {
+        TLDatabaseIdentifier *identifier = nil;
+        TLTestExportObject *contact = [[TLTestExportObject alloc] initWithIdentifier:identifier uuid:[NSUUID UUID] creationDate:0 modificationDate:0];
+        contact.name = [NSString stringWithFormat:@"contact-%d", i];
+        contact.objectDescription = @"description";
+        contact.twincodeFactoryId = [NSUUID UUID];
+        [contacts addObject:contact];
+    }
+
+    __block int iteration = 0;
+    [self measureBlock:^{
+        for (int i = 0; i < 100; i++) {
+            contacts[iteration++ % CONTACT_COUNT].objectDescription = [NSString stringWithFormat:@"description-%d", iteration];
+            for (TLTestExportObject *contact in contacts) {
+                [contact attributesWithAll:YES];
+            }
+        }
+    }];
+}
+
+- (void)testReadPerformance {
+    TLTwinmeOriginatorObject *object = newObject();
+
+    [self measureBlock:^{
+        dispatch_apply(4, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+            NSUInteger length = 0;
+            for (int i = 0; i < READ_COUNT; i++) {
+                length += object.name.length;
+            }
+            XCTAssertEqual((NSUInteger)READ_COUNT * 6, length);
+        });
+    }];
+}
+
+// The same reads with the recursive lock that the getters used to take.
+- (void)testLockedReadPerformance {
+    TLTwinmeOriginatorObject *object = newObject();
+
+    [self measureBlock:^{
+        dispatch_apply(4, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+            NSUInteger length = 0;
+            for (int i = 0; i < READ_COUNT; i++) {
+                @synchronized (object) {
+                    length += object.name.length;
+                }
+            }
+            XCTAssertEqual((NSUInteger)READ_COUNT * 6, length);
+        });
+    }];
+}
+
+@end
@@ -0,0 +1,255 @@
+/*
+ *  Copyright (c) 2025 twinlife SA.
+ *  SPDX-License-Identifier: AGPL-3.0-only
+ */
+
+#import <XCTest/XCTest.h>
+
+#import <Twinlife/TLTwincodeOutboundService.h>
+#import <Twinlife/TLConversationService.h>
+
+#import "TLUpdateGroupExecutor.h"
+#import "TLRefreshPipeline.h"
+#import "TLTestService.h"
+
+#define MEMBER_COUNT 12
+#define SERVICE_LATENCY 0.005
+
+/// The members refresh pipeline of the executor.
+@interface TLUpdateGroupExecutor (Testing)
+
+- (nullable TLRefreshPipeline *)refreshMembers;
+
+@end
+
+//
+// Twincode, group, group member and group conversation with only the properties used by TLUpdateGroupExecutor.
+//
+
+@interface TLTestUpdateGroupTwincode : NSObject
+
+@property (nonnull) NSUUID *uuid;
+
+@end
+
+@implementation TLTestUpdateGroupTwincode
+
+- (BOOL)isSigned {
+
+    return YES;
+}
+
+@end
+
+@interface TLTestUpdateGroup : NSObject
+
+@property (nonnull) TLTestUpdateGroupTwincode *twincodeOutbound;
+@property (nonnull) TLTestUpdateGroupTwincode *groupTwincodeOutbound;
+@property (nonnull) NSString *identityName;
+@property (nullable) TLImageId *identityAvatarId;
+@property (nullable) TLSpace *space;
+
+@end
+
+@implementation TLTestUpdateGroup
+@end
+
+@interface TLTestUpdateGroupMember : NSObject
+
+@property (nonnull) TLTestUpdateGroupTwincode *peerTwincodeOutbound;
+
+@end
+
+@implementation TLTestUpdateGroupMember
+@end
+
+@interface TLTestUpdateGroupConversation : NSObject
+
+@property (nonnull) NSArray<TLTestUpdateGroupMember *> *members;
+
+@end
+
+@implementation TLTestUpdateGroupConversation
+
+- (nonnull NSArray *)groupMembersWithFilter:(TLGroupMemberFilterType)filter {
+
+    return self.members;
+}
+
+@end
+
+/// Twinme context with the twincode outbound and conversation services used by TLUpdateGroupExecutor:
+/// the twincode updates and the member invocations are made on two test services answering on the twinlife queue.
+@interface TLTestUpdateGroupContext : NSObject
+
+@property (readonly, nonnull) dispatch_queue_t queue;
+@property (readonly, nonnull) TLTestService *twincodeService;
+@property (readonly, nonnull) TLTestService *invokeService;
+@property (nullable) TLTestUpdateGroupConversation *groupConversation;
+@property (nullable) TLTwinmeAction *action;
+@property (nullable) XCTestExpectation *updated;
+@property (nullable) XCTestExpectation *finished;
+@property int updateCount;
+@property int errorCount;
+@property BOOL runningAtUpdate;
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue;
+
+@end
+
+@implementation TLTestUpdateGroupContext
+
+- (nonnull instancetype)initWithQueue:(nonnull dispatch_queue_t)queue {
+
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _twincodeService = [[TLTestService alloc] initWithQueue:queue latency:SERVICE_LATENCY];
+        _invokeService = [[TLTestService alloc] initWithQueue:queue latency:SERVICE_LATENCY];
+    }
+    return self;
+}
+
+- (nonnull id)twinlife {
+
+    return self;
+}
+
+- (nonnull dispatch_queue_t)twinlifeQueue {
+
+    return self.queue;
+}
+
+- (nonnull id)getTwincodeOutboundService {
+
+    return self;
+}
+
+- (nonnull id)getConversationService {
+
+    return self;
+}
+
+- (void)admitWithExecutor:(nonnull id)executor start:(nonnull dispatch_block_t)start cancel:(nullable dispatch_block_t)cancel {
+
+    start();
+}
+
+- (void)releaseWithExecutor:(nonnull id)executor {
+}
+
+/// The action is started while we are connected to the server as addDelegate does.
+- (void)startActionWithAction:(nonnull TLTwinmeAction *)action {
+
+    self.action = action;
+    dispatch_async(self.queue, ^{
+        [action onTwinlifeOnline];
+    });
+}
+
+- (void)finishActionWithAction:(nonnull TLTwinmeAction *)action {
+
+    self.action = nil;
+    [self.finished fulfill];
+}
+
+- (void)fireOnErrorWithRequestId:(int64_t)requestId errorCode:(TLBaseServiceErrorCode)errorCode errorParameter:(nullable NSString *)errorParameter {
+
+    self.errorCount++;
+}
+
+- (void)onUpdateGroupWithRequestId:(int64_t)requestId group:(nonnull TLGroup *)group {
+
+    self.updateCount++;
+    self.runningAtUpdate = self.action != nil;
+    [self.updated fulfill];
+}
+
+- (void)updateTwincodeWithTwincode:(nonnull TLTestUpdateGroupTwincode *)twincode attributes:(nonnull NSArray *)attributes deleteAttributeNames:(nullable NSArray *)deleteAttributeNames withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, TLTwincodeOutbound *twincodeOutbound))block {
+
+    [self.twincodeService requestWithKey:twincode.uuid complete:^(TLBaseServiceErrorCode errorCode) {
+        block(errorCode, errorCode == TLBaseServiceErrorCodeSuccess ? (TLTwincodeOutbound *)twincode : nil);
+    }];
+}
+
+- (void)secureInvokeTwincodeWithTwincode:(nonnull TLTwincodeOutbound *)twincode senderTwincode:(nonnull TLTwincodeOutbound *)senderTwincode receiverTwincode:(nonnull TLTestUpdateGroupTwincode *)receiverTwincode options:(int)options action:(nonnull NSString *)action attributes:(nullable NSArray *)attributes withBlock:(nonnull void (^)(TLBaseServiceErrorCode errorCode, NSUUID *invocationId))block {
+
+    [self.invokeService requestWithKey:receiverTwincode.uuid complete:^(TLBaseServiceErrorCode errorCode) {
+        block(errorCode, errorCode == TLBaseServiceErrorCodeSuccess ? [NSUUID UUID] : nil);
+    }];
+}
+
+- (nullable id)getGroupConversationWithGroupTwincodeId:(nonnull NSUUID *)groupTwincodeId {
+
+    return self.groupConversation;
+}
+
+@end
+
+@interface TLUpdateGroupExecutorTests : XCTestCase
+@end
+
+@implementation TLUpdateGroupExecutorTests
+
+// Change our name in a group while the members cannot be invoked: the group update is reported
+// without waiting for them, the members are parked and they are refreshed when we are online again.
+- (void)testOfflineMembers {
+    dispatch_queue_t queue = dispatch_queue_create("twinlifeQueue", DISPATCH_QUEUE_SERIAL);
+    TLTestUpdateGroupContext *context = [[TLTestUpdateGroupContext alloc] initWithQueue:queue];
+    context.invokeService.offline = YES;
+
+    TLTestUpdateGroup *group = [[TLTestUpdateGroup alloc] init];
+    group.twincodeOutbound = [[TLTestUpdateGroupTwincode alloc] init];
+    group.twincodeOutbound.uuid = [NSUUID UUID];
+    group.groupTwincodeOutbound = [[TLTestUpdateGroupTwincode alloc] init];
+    group.groupTwincodeOutbound.uuid = [NSUUID UUID];
+    group.identityName = @"Old name";
+    NSMutableArray<TLTestUpdateGroupMember *> *members = [[NSMutableArray alloc] initWithCapacity:MEMBER_COUNT];
+    for (int i = 0; i < MEMBER_COUNT; i++) {
+        TLTestUpdateGroupMember *member = [[TLTestUpdateGroupMember alloc] init];
+        member.peerTwincodeOutbound = [[TLTestUpdateGroupTwincode alloc] init];
+        member.peerTwincodeOutbound.uuid = [NSUUID UUID];
+        [members addObject:member];
+    }
+    context.groupConversation = [[TLTestUpdateGroupConversation alloc] init];
+    context.groupConversation.members = members;
+
+    TLUpdateGroupExecutor *executor = [[TLUpdateGroupExecutor alloc] initWithTwinmeContext:(TLTwinmeContext *)context requestId:1 group:(TLGroup *)group identityName:@"New name" identityAvatarId:nil identityDescription:nil timeout:60];
+    context.updated = [self expectationWithDescription:@"updated"];
+    context.finished = [self expectationWithDescription:@"finished"];
+    dispatch_async(queue, ^{
+        [executor start];
+    });
+
+    // The group update is reported as soon as the members are invoked and each member is parked after its first invocation.
+    [self waitForExpectations:@[context.updated] timeout:10];
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"refreshMembers.parkedCount == %d", MEMBER_COUNT] evaluatedWithObject:executor handler:nil];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+    dispatch_sync(queue, ^{
+        XCTAssertTrue(context.runningAtUpdate);
+        XCTAssertNotNil(context.action);
+        XCTAssertEqual((NSUInteger)0, executor.refreshMembers.pendingCount);
+        XCTAssertEqual(0, executor.refreshMembers.runningCount);
+    });
+    XCTAssertEqual((NSUInteger)1, [context.twincodeService countWithKey:group.twincodeOutbound.uuid]);
+    for (TLTestUpdateGroupMember *member in members) {
+        XCTAssertEqual((NSUInteger)1, [context.invokeService countWithKey:member.peerTwincodeOutbound.uuid]);
+    }
+
+    // The parked members are invoked again from onTwinlifeOnline and the executor is finished.
+    dispatch_async(queue, ^{
+        context.invokeService.offline = NO;
+        [context.action onTwinlifeOnline];
+    });
+    [self waitForExpectations:@[context.finished] timeout:10];
+
+    XCTAssertEqual((NSUInteger)1, [context.twincodeService countWithKey:group.twincodeOutbound.uuid]);
+    for (TLTestUpdateGroupMember *member in members) {
+        XCTAssertEqual((NSUInteger)2, [context.invokeService countWithKey:member.peerTwincodeOutbound.uuid]);
+    }
+    XCTAssertEqual(8, context.invokeService.maxRunning);
+    XCTAssertEqual(1, context.updateCount);
+    XCTAssertEqual(0, context.errorCount);
+}
+
+@end